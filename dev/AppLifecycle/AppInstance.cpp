@@ -104,7 +104,7 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         m_moduleName = ComputeAppId();
         m_processName = wil::str_printf<std::wstring>(L"%s_%d", m_moduleName.c_str(), processId);
 
-        m_instances.Init(m_moduleName + L"_Module");
+        m_instances.Init(m_moduleName + c_instancesNameSuffix);
 
         // Wire up the Activated event.
         std::wstring eventName = m_processName + c_activatedEventNameSuffix;
@@ -159,26 +159,26 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
                 reinterpret_cast<void*>(static_cast<size_t>(m_processId)), INFINITE, WT_EXECUTEONLYONCE));
         }
 
-        m_redirectionArgs.Init(m_processName + L"_RedirectionQueue");
+        m_redirectionArgs.Init(m_processName + c_redirectionQueueNameSuffix);
+        m_redirectionSlab.Init(m_processName + c_redirectionSlabNameSuffix);
     }
 
     void AppInstance::RemoveInstance(uint32_t processId)
     {
-        auto releaseOnExit = m_dataMutex.acquire();
+        // The instance list is lock-free; no need for m_dataMutex.
         m_instances.Remove(processId);
     }
 
-    GUID AppInstance::DequeueRedirectionRequestId()
+    GUID AppInstance::DequeueRedirectionRequestId(UINT32& block)
     {
-        auto releaseOnExit = m_dataMutex.acquire();
-        auto id = m_redirectionArgs.Dequeue();
+        // The redirection queue has its own consumer lock; no need for m_dataMutex.
+        auto id = m_redirectionArgs.Dequeue(block, m_redirectionSlab);
         return id;
     }
 
-    void AppInstance::EnqueueRedirectionRequestId(GUID id)
+    void AppInstance::EnqueueRedirectionRequestId(GUID id, UINT32 block)
     {
-        auto releaseOnExit = m_dataMutex.acquire();
-        m_redirectionArgs.Enqueue(id);
+        m_redirectionArgs.Enqueue(id, block);
     }
 
     void AppInstance::ProcessRedirectionRequests()
@@ -186,8 +186,29 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         m_innerActivated.ResetEvent();
 
         GUID id;
-        while ((id = DequeueRedirectionRequestId()) != GUID_NULL)
+        UINT32 block{};
+        while ((id = DequeueRedirectionRequestId(block)) != GUID_NULL)
         {
+            if (block != RedirectionRequestSlab::c_noBlock)
+            {
+                // The payload's in our slab and the sender isn't waiting on anything.
+                AppLifecycle::AppActivationArguments args{ nullptr };
+                {
+                    auto freeOnExit = wil::scope_exit([&]
+                    {
+                        m_redirectionSlab.Free(block);
+                    });
+
+                    size_t size{};
+                    auto payload{ m_redirectionSlab.Get(block, size) };
+                    args = RedirectionPayload::Read(payload, size);
+                }
+
+                // Notify the app that the redirection request is here.
+                m_activatedEvent(*this, args);
+                continue;
+            }
+
             wil::unique_cotaskmem_string idString;
             THROW_IF_FAILED(StringFromCLSID(id, &idString));
 
@@ -208,6 +229,9 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
                 cleanupEvent.SetEvent();
             }
         }
+
+        // Take back slab blocks whose senders died before their requests got here.
+        m_redirectionArgs.ReclaimBlocks(m_redirectionSlab);
     }
 
     IAsyncAction AppInstance::QueueRequest(AppLifecycle::AppActivationArguments args)
@@ -220,6 +244,33 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
             featureUsageReported = true;
         }
 
+        // Built-in activation kinds that fit in a slab block are copied straight into the target's memory:
+        // no COM marshaling, no named packet or event per request, and nothing to wait for afterwards.
+        RedirectionPayload payload;
+        if (RedirectionPayload::TryCreate(args, payload))
+        {
+            UINT32 block{};
+            if (auto buffer{ m_redirectionSlab.TryAllocate(payload.Size(), block) })
+            {
+                auto freeOnFailure = wil::scope_exit([&]
+                {
+                    m_redirectionSlab.Free(block);
+                });
+                payload.Write(buffer);
+
+                GUID id;
+                THROW_IF_FAILED(CoCreateGuid(&id));
+
+                // Enqueue the request, transfer foreground rights and signal the activation.
+                m_redirectionSlab.MarkQueued(block);
+                EnqueueRedirectionRequestId(id, block);
+                freeOnFailure.release();
+                AllowSetForegroundWindow(m_processId);
+                m_innerActivated.SetEvent();
+                co_return;
+            }
+        }
+
         auto strongThis{ get_strong() };
 
         // Push this work onto a background thread.
@@ -281,24 +332,11 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
 
         IVector<Microsoft::Windows::AppLifecycle::AppInstance> instances{ winrt::single_threaded_vector<Microsoft::Windows::AppLifecycle::AppInstance>() };
 
-        // Grab the list of processes while under the lock, and then drop it since we'll be calling out to other code.
-        std::list<DWORD> pids;
-        {
-            auto releaseOnExit = s_current->m_dataMutex.acquire();
-
-            for (uint32_t index = 0; index < s_current->m_instances.Size(); index++)
-            {
-                auto pid = s_current->m_instances[index];
-                if (pid == 0)
-                {
-                    continue;
-                }
+        // Snapshot the live entries. The list is lock-free and only visits occupied slots.
+        const auto pids{ s_current->m_instances.GetProcessIds() };
 
-                pids.push_back(pid);
-            }
-        }
-
-        // Create the associated AppInstance objects while removing orphaned entries we find.
+        // Create the associated AppInstance objects, collecting orphaned entries to remove in one pass.
+        std::vector<DWORD> orphans;
         for (const auto& pid : pids)
         {
             if (GetCurrentProcessId() == pid)
@@ -314,13 +352,14 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
                 }
                 else
                 {
-                    // Remove orphan.
-                    auto releaseOnExit = s_current->m_dataMutex.acquire();
-                    s_current->m_instances.Remove(pid);
+                    orphans.push_back(pid);
                 }
             }
         }
 
+        // Remove orphans.
+        s_current->m_instances.Remove(orphans);
+
         return instances;
     }
 
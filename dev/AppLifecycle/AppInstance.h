@@ -8,11 +8,21 @@
 #include "RedirectionRequest.h"
 #include "SharedProcessList.h"
 #include "RedirectionRequestQueue.h"
+#include "RedirectionRequestSlab.h"
 
 namespace winrt::Microsoft::Windows::AppLifecycle::implementation
 {
     static PCWSTR c_requestPacketNameFormat = L"%s_RedirectionRequest_%s";
     static PCWSTR c_activatedEventNameSuffix = L"_ActivatedEvent";
+
+    // Queue items carry slab blocks, so the two shared memory layouts are versioned together.
+    // Instances of different versions don't open each other's.
+    static PCWSTR c_redirectionQueueNameSuffix = L"_RedirectionQueue4";
+    static PCWSTR c_redirectionSlabNameSuffix = L"_RedirectionSlab4";
+
+    // Versioned for the same reason: slots are claimed by their process id rather than their bit, and
+    // there is no shared count.
+    static PCWSTR c_instancesNameSuffix = L"_Instances3";
     static PCWSTR c_restartAgentFilename{ L"RestartAgent.exe" };
 
     struct AppInstance : AppInstanceT<AppInstance>
@@ -51,8 +61,8 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         void ProcessRedirectionRequests();
         bool TrySetKey(std::wstring const& key);
         Microsoft::Windows::AppLifecycle::AppInstance FindForKey(std::wstring const& key);
-        void EnqueueRedirectionRequestId(GUID id);
-        GUID DequeueRedirectionRequestId();
+        void EnqueueRedirectionRequestId(GUID id, UINT32 block = RedirectionRequestSlab::c_noBlock);
+        GUID DequeueRedirectionRequestId(UINT32& block);
 
         // Named object prefixes used to scope.
         std::wstring m_moduleName;
@@ -83,6 +93,7 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
 
         SharedProcessList m_instances;
         RedirectionRequestQueue m_redirectionArgs;
+        RedirectionRequestSlab m_redirectionSlab;
     };
 }
 
@@ -8,6 +8,121 @@
 
 namespace winrt::Microsoft::Windows::AppLifecycle::implementation
 {
+    bool RedirectionPayload::TryCreate(Microsoft::Windows::AppLifecycle::AppActivationArguments const& args, RedirectionPayload& payload)
+    {
+        // Only our own implementations are known to carry nothing beyond what the interfaces expose.
+        auto data{ args.Data() };
+        if (!data.try_as<IInternalValueMarshalable>())
+        {
+            return false;
+        }
+
+        payload.m_kind = args.Kind();
+        switch (payload.m_kind)
+        {
+        case ExtendedActivationKind::Launch:
+            payload.m_strings[0] = data.as<ILaunchActivatedEventArgs>().Arguments();
+            return true;
+
+        case ExtendedActivationKind::File:
+        {
+            auto fileArgs{ data.as<IFileActivatedEventArgs>() };
+            auto files{ fileArgs.Files() };
+            if (files.Size() != 1)
+            {
+                // Command template placeholders have no file to resolve.
+                return false;
+            }
+            payload.m_strings[0] = fileArgs.Verb();
+            payload.m_strings[1] = files.GetAt(0).Path();
+            return true;
+        }
+
+        case ExtendedActivationKind::Protocol:
+            payload.m_strings[0] = data.as<IProtocolActivatedEventArgs>().Uri().AbsoluteUri();
+            return true;
+
+        case ExtendedActivationKind::StartupTask:
+            payload.m_strings[0] = data.as<IStartupTaskActivatedEventArgs>().TaskId();
+            return true;
+        }
+        return false;
+    }
+
+    size_t RedirectionPayload::Size() const
+    {
+        size_t size{ sizeof(Header) };
+        for (const auto& string : m_strings)
+        {
+            size += string.size() * sizeof(wchar_t);
+        }
+        return size;
+    }
+
+    void RedirectionPayload::Write(uint8_t* buffer) const
+    {
+        Header header{ c_version, static_cast<INT32>(m_kind) };
+        for (UINT32 index = 0; index < c_maxStrings; ++index)
+        {
+            header.length[index] = m_strings[index].size();
+        }
+        memcpy(buffer, &header, sizeof(header));
+        buffer += sizeof(header);
+
+        for (const auto& string : m_strings)
+        {
+            const auto bytes{ string.size() * sizeof(wchar_t) };
+            memcpy(buffer, string.c_str(), bytes);
+            buffer += bytes;
+        }
+    }
+
+    Microsoft::Windows::AppLifecycle::AppActivationArguments RedirectionPayload::Read(const uint8_t* buffer, size_t size)
+    {
+        // The buffer came from another process; check it describes itself consistently before using it.
+        Header header{};
+        THROW_HR_IF(E_INVALIDARG, size < sizeof(header));
+        memcpy(&header, buffer, sizeof(header));
+        THROW_HR_IF(E_INVALIDARG, header.version != c_version);
+
+        const auto* next{ buffer + sizeof(header) };
+        size_t remaining{ size - sizeof(header) };
+        std::wstring strings[c_maxStrings];
+        for (UINT32 index = 0; index < c_maxStrings; ++index)
+        {
+            const size_t bytes{ static_cast<size_t>(header.length[index]) * sizeof(wchar_t) };
+            THROW_HR_IF(E_INVALIDARG, bytes > remaining);
+            strings[index].resize(header.length[index]);
+            memcpy(strings[index].data(), next, bytes);
+            next += bytes;
+            remaining -= bytes;
+        }
+
+        winrt::Windows::Foundation::IInspectable args;
+        switch (static_cast<ExtendedActivationKind>(header.kind))
+        {
+        case ExtendedActivationKind::Launch:
+            args = make<LaunchActivatedEventArgs>(winrt::hstring{ strings[0] });
+            break;
+
+        case ExtendedActivationKind::File:
+            args = make<FileActivatedEventArgs>(winrt::hstring{ strings[0] }, winrt::hstring{ strings[1] });
+            break;
+
+        case ExtendedActivationKind::Protocol:
+            args = make<ProtocolActivatedEventArgs>(winrt::hstring{ strings[0] });
+            break;
+
+        case ExtendedActivationKind::StartupTask:
+            args = make<StartupActivatedEventArgs>(winrt::hstring{ strings[0] });
+            break;
+
+        default:
+            THROW_HR(E_INVALIDARG);
+        }
+        return make<AppActivationArguments>(args.as<IActivatedEventArgs>());
+    }
+
     void RedirectionRequest::Open(const std::wstring& name)
     {
         m_data.Open(name);
@@ -16,6 +131,15 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
 
     void RedirectionRequest::MarshalArguments(Microsoft::Windows::AppLifecycle::AppActivationArguments const& args)
     {
+        RedirectionPayload payload;
+        if (RedirectionPayload::TryCreate(args, payload))
+        {
+            m_data.Resize(sizeof(RedirectionMarshaling) + payload.Size());
+            *m_data.Get() = static_cast<uint8_t>(RedirectionMarshaling::Binary);
+            payload.Write(m_data.Get() + sizeof(RedirectionMarshaling));
+            return;
+        }
+
         auto internalArgs = args.Data().try_as<IInternalValueMarshalable>();
         bool supportInternalValueMarshaling = (internalArgs != nullptr);
         
@@ -37,13 +161,12 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         }
 
         // Add space for the marshaling type data and resize the backing storage.
-        m_data.Resize(sizeof(bool) + streamSize);
+        m_data.Resize(sizeof(RedirectionMarshaling) + streamSize);
 
         // Mark payload with marshaling type information.
-        bool* marshalingMarker = reinterpret_cast<bool*>(m_data.Get());
-        *marshalingMarker = supportInternalValueMarshaling;
+        *m_data.Get() = static_cast<uint8_t>(supportInternalValueMarshaling ? RedirectionMarshaling::Uri : RedirectionMarshaling::Com);
 
-        uint8_t* streamStart = (m_data.Get() + sizeof(bool));
+        uint8_t* streamStart = (m_data.Get() + sizeof(RedirectionMarshaling));
 
         if (supportInternalValueMarshaling)
         {
@@ -78,11 +201,15 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
     Microsoft::Windows::AppLifecycle::AppActivationArguments RedirectionRequest::UnmarshalArguments()
     {
         // The first byte holds data about the marshaling type to use.
-        uint8_t* streamStart = (m_data.Get() + sizeof(bool));
-        ULONG streamSize = (static_cast<ULONG>(m_data.Size()) - sizeof(bool));
+        uint8_t* streamStart = (m_data.Get() + sizeof(RedirectionMarshaling));
+        ULONG streamSize = (static_cast<ULONG>(m_data.Size()) - sizeof(RedirectionMarshaling));
 
-        bool supportInternalValueMarshaling = *(reinterpret_cast<bool*>(m_data.Get()));
-        if (supportInternalValueMarshaling)
+        const auto marshaling{ static_cast<RedirectionMarshaling>(*m_data.Get()) };
+        if (marshaling == RedirectionMarshaling::Binary)
+        {
+            return RedirectionPayload::Read(streamStart, streamSize);
+        }
+        else if (marshaling == RedirectionMarshaling::Uri)
         {
             std::wstring_view uri_data{ reinterpret_cast<wchar_t*>(streamStart) };
 
@@ -7,6 +7,44 @@
 
 namespace winrt::Microsoft::Windows::AppLifecycle::implementation
 {
+    // Marks how a RedirectionRequest packet's payload is encoded. Stored in the packet's first byte
+    // (formerly a bool, so Com and Uri keep their old values).
+    enum class RedirectionMarshaling : uint8_t
+    {
+        Com = 0,
+        Uri = 1,
+        Binary = 2,
+    };
+
+    // Compact binary form of the built-in activation kinds (Launch, File, Protocol and StartupTask):
+    // a small header followed by the kind's strings, length-prefixed and unterminated. Unlike COM
+    // marshaling it doesn't depend on the sender staying alive, and unlike the launch URI it needs
+    // no escaping or parsing, so it can be copied straight into the target's RedirectionRequestSlab.
+    class RedirectionPayload
+    {
+    public:
+        static bool TryCreate(winrt::Microsoft::Windows::AppLifecycle::AppActivationArguments const& args, RedirectionPayload& payload);
+
+        size_t Size() const;
+        void Write(uint8_t* buffer) const;
+
+        static winrt::Microsoft::Windows::AppLifecycle::AppActivationArguments Read(const uint8_t* buffer, size_t size);
+
+    private:
+        static constexpr UINT32 c_version{ 1 };
+        static constexpr UINT32 c_maxStrings{ 2 };
+
+        struct Header
+        {
+            UINT32 version;
+            INT32 kind;
+            UINT32 length[c_maxStrings];
+        };
+
+        ExtendedActivationKind m_kind{};
+        winrt::hstring m_strings[c_maxStrings];
+    };
+
     class RedirectionRequest
     {
     public:
@@ -2,137 +2,285 @@
 // Licensed under the MIT License.
 #pragma once
 #include "SharedMemory.h"
-#include "RedirectionRequest.h"
+#include "RedirectionRequestSlab.h"
 #include <guiddef.h>
 
 namespace winrt::Microsoft::Windows::AppLifecycle::implementation
 {
+    // Bounded multi-producer/single-consumer ring buffer in shared memory.
+    //
+    // Any process may Enqueue (every instance redirecting to us) but only the process owning the queue
+    // may Dequeue. Producers claim a position by advancing tail; each slot's sequence number says whose
+    // turn it is: a producer may fill slot p % capacity when its sequence is p, marks it as being filled
+    // by setting it to p + c_filling and publishes by setting it to p + 1, the consumer may read it when
+    // its sequence is p + 1 and hands it to the next lap by setting it to p + capacity. Enqueue and Dequeue
+    // are O(1). Enqueue never takes a lock; Dequeue takes a process-local lock, as the owning process may
+    // dequeue from several threads.
+    //
+    // Alongside the request id an item carries the RedirectionRequestSlab block holding its payload, if any.
+    // Given the slab, Dequeue marks the block delivered and frees the block of a slot it skips, and
+    // ReclaimBlocks frees the blocks of senders that died before publishing them.
+    //
+    // A producer that dies between claiming a slot and publishing it would stall the consumer at that slot
+    // forever. Each slot records the process filling it; once that process is gone, or the slot has been
+    // stuck for c_abandonTimeout, the consumer skips it and hands it to the next lap. Producers move a slot
+    // from claimed to filling with a CAS before writing to it, so one that was merely slow finds its slot
+    // reclaimed, leaves it (and whichever later producer claimed it since) alone and claims another. A slot
+    // being filled is only skipped once its producer's gone.
     class RedirectionRequestQueue
     {
+        static constexpr LONG64 c_capacity{ 4096 };
+        static_assert((c_capacity & (c_capacity - 1)) == 0, "Capacity must be a power of 2");
+
+        static constexpr ULONGLONG c_abandonTimeout{ 5000 };
+
+        // Added to a slot's sequence while its producer writes the item. No lap ever reaches it.
+        static constexpr LONG64 c_filling{ 1LL << 62 };
+
         struct QueueItem
         {
-            bool inUse{ false };
-            size_t next{ 0 };
-            GUID id{ 0 };
+            // Stored minus the slot's index, so newly created (zeroed) memory is an empty queue.
+            volatile LONG64 sequence;
+            GUID id;
+            // Stored inverted, so newly created (zeroed) memory holds no block.
+            UINT32 block;
+            // Process id of the producer filling the slot, 0 if none (yet).
+            volatile LONG owner;
+        };
+
+        struct QueueData
+        {
+            // The consumer owns head and producers contend on tail. Keep them off each other's cache line.
+            alignas(64) volatile LONG64 head;
+            alignas(64) volatile LONG64 tail;
+            alignas(64) QueueItem items[c_capacity];
         };
 
     public:
         void Init(const std::wstring& name)
         {
             m_name = name;
-
-            // We store the head pointer at the beginning of the memory, and then items in the queue after.
-            m_data.Open(name, (sizeof(QueueItem) * 4096) + sizeof(QueueItem*));
-            m_dataStart = reinterpret_cast<QueueItem*>(m_data.Get() + sizeof(size_t));
+            m_data.Open(name, sizeof(DynamicSharedMemory<QueueData>));
         }
 
-        void Enqueue(const GUID& itemId)
+        void Enqueue(const GUID& itemId, UINT32 block = RedirectionRequestSlab::c_noBlock)
         {
-            auto newItem = AllocateItem();
-            auto cur = GetHead();
+            while (!Publish(Claim(), itemId, block))
+            {
+                // The consumer gave up on us and reclaimed the slot. Take another.
+            }
+        }
 
-            if (cur != nullptr)
+        // Claim the next slot for this process. Throws E_OUTOFMEMORY if the queue is full.
+        LONG64 Claim()
+        {
+            auto data{ m_data.Get() };
+            auto position{ ReadNoFence64(&data->tail) };
+            for (;;)
             {
-                // Zero is never a valid offset, as the offset 0 is our head pointer offset.
-                while (cur->next != 0)
+                auto& item{ data->items[position & (c_capacity - 1)] };
+                const auto sequence{ GetSequence(item, position) };
+                if (sequence == position)
+                {
+                    // The slot is free. Try to claim it
+                    const auto observed{ InterlockedCompareExchange64(&data->tail, position + 1, position) };
+                    if (observed == position)
+                    {
+                        WriteRelease(&item.owner, static_cast<LONG>(GetCurrentProcessId()));
+                        return position;
+                    }
+                    position = observed;
+                }
+                else if (sequence < position)
+                {
+                    // The slot still holds the previous lap's item. The queue is full.
+                    THROW_HR(E_OUTOFMEMORY);
+                }
+                else
                 {
-                    cur = FromOffset(cur->next);
+                    // Another producer got here first.
+                    position = ReadNoFence64(&data->tail);
                 }
             }
+        }
 
-            if (cur == nullptr)
-            {
-                // Enqueueing head.
-                cur = newItem;
-                SetHead(newItem);
-            }
-            else
+        // Fill and publish a slot from Claim(). Returns false if the consumer reclaimed it first.
+        bool Publish(LONG64 position, const GUID& itemId, UINT32 block = RedirectionRequestSlab::c_noBlock)
+        {
+            // Make sure the slot's still ours before writing to it. Once reclaimed it may belong to a
+            // producer on a later lap
+            auto& item{ m_data.Get()->items[position & (c_capacity - 1)] };
+            const auto claimed{ ToStored(position, position) };
+            if (InterlockedCompareExchange64(&item.sequence, ToStored(position + c_filling, position), claimed) != claimed)
             {
-                // Appending to the queue.
-                cur->next = ToOffset(newItem);
+                return false;
             }
+            item.id = itemId;
+            SetBlock(item, block);
+            SetSequence(item, position, position + 1);
+            return true;
+        }
 
-            newItem->inUse = true;
-            newItem->id = itemId;
-            newItem->next = 0;
+        // How long a claimed slot may stay unpublished while its owner's alive (tests shorten it).
+        void SetAbandonTimeout(ULONGLONG milliseconds)
+        {
+            m_abandonTimeout = milliseconds;
         }
 
         GUID Dequeue()
         {
-            auto head = GetHead();
-            if (head != nullptr)
-            {
-                SetHead(FromOffset(head->next));
+            UINT32 block{};
+            return Dequeue(block);
+        }
 
-                head->inUse = false;
-                head->next = 0;
+        GUID Dequeue(UINT32& block)
+        {
+            auto lock{ m_consumerLock.lock_exclusive() };
+            return DequeueLocked(block, nullptr);
+        }
 
-                return head->id;
-            }
+        // Dequeue, handing the item's block (if any) over to the caller, who frees it.
+        GUID Dequeue(UINT32& block, RedirectionRequestSlab& slab)
+        {
+            auto lock{ m_consumerLock.lock_exclusive() };
+            return DequeueLocked(block, &slab);
+        }
 
-            return GUID_NULL;
+        // Free the slab blocks of senders that died after MarkQueued but before publishing.
+        void ReclaimBlocks(RedirectionRequestSlab& slab)
+        {
+            auto lock{ m_consumerLock.lock_exclusive() };
+            slab.ReclaimQueued([&](UINT32 block) { return IsReferenced(block); });
         }
 
     private:
-        size_t GetBaseAddress()
+        GUID DequeueLocked(UINT32& block, RedirectionRequestSlab* slab)
         {
-            return reinterpret_cast<size_t>(m_data.Get());
+            auto data{ m_data.Get() };
+            for (;;)
+            {
+                const auto position{ ReadNoFence64(&data->head) };
+                auto& item{ data->items[position & (c_capacity - 1)] };
+                const auto sequence{ GetSequence(item, position) };
+                if (sequence == position + 1)
+                {
+                    const auto id{ item.id };
+                    block = GetBlock(item);
+                    if (slab)
+                    {
+                        slab->MarkDelivered(block);
+                    }
+                    SetBlock(item, RedirectionRequestSlab::c_noBlock);
+                    WriteNoFence(&item.owner, 0);
+                    SetSequence(item, position, position + c_capacity);
+                    WriteRelease64(&data->head, position + 1);
+                    return id;
+                }
+
+                LONG64 stalled{};
+                if ((sequence == position) && (ReadAcquire64(&data->tail) > position) && IsAbandoned(item, position))
+                {
+                    // Claimed but never filled. Skip it, unless its producer starts filling it after all
+                    stalled = position;
+                }
+                else if ((sequence == position + c_filling) && IsOwnerGone(item))
+                {
+                    // Its producer died while filling it. Free its block if it got that far; if not,
+                    // ReclaimBlocks will find the block isn't referenced
+                    stalled = position + c_filling;
+                    if (slab)
+                    {
+                        slab->Free(GetBlock(item));
+                    }
+                    SetBlock(item, RedirectionRequestSlab::c_noBlock);
+                }
+                else
+                {
+                    // Empty, or the producer owning the next slot hasn't published it yet
+                    // (it signals the consumer once it has).
+                    return GUID_NULL;
+                }
+
+                WriteNoFence(&item.owner, 0);
+                const auto expected{ ToStored(stalled, position) };
+                if (InterlockedCompareExchange64(&item.sequence, ToStored(position + c_capacity, position), expected) == expected)
+                {
+                    WriteRelease64(&data->head, position + 1);
+                }
+            }
         }
 
-        QueueItem* FromOffset(size_t offset)
+        bool IsReferenced(UINT32 block)
         {
-            if (offset == 0)
+            // Published, or being filled by a producer that may have written the block already
+            auto data{ m_data.Get() };
+            const auto tail{ ReadAcquire64(&data->tail) };
+            for (auto position = ReadNoFence64(&data->head); position < tail; ++position)
             {
-                return nullptr;
+                const auto& item{ data->items[position & (c_capacity - 1)] };
+                const auto sequence{ GetSequence(item, position) };
+                if (((sequence == position + 1) || (sequence == position + c_filling)) && (GetBlock(item) == block))
+                {
+                    return true;
+                }
             }
+            return false;
+        }
 
-            return reinterpret_cast<QueueItem*>(GetBaseAddress() + offset);
+        static bool IsOwnerGone(const QueueItem& item)
+        {
+            const auto owner{ static_cast<DWORD>(ReadAcquire(const_cast<volatile LONG*>(&item.owner))) };
+            return (owner != 0) && IsProcessGone(owner);
         }
 
-        size_t ToOffset(QueueItem* item)
+        bool IsAbandoned(const QueueItem& item, LONG64 position)
         {
-            size_t offset{ 0 };
-            if (item != nullptr)
+            if (IsOwnerGone(item))
             {
-                offset = reinterpret_cast<size_t>(item) - GetBaseAddress();
+                return true;
             }
-            return offset;
-        }
 
-        QueueItem* GetHead()
-        {
-            void** head = reinterpret_cast<void**>(m_data.Get());
-            if (*head == nullptr)
+            // No owner recorded (it died right after claiming) or it's still running. Give it time
+            if (m_stalledPosition != position)
             {
-                return nullptr;
+                m_stalledPosition = position;
+                m_stalledSince = GetTickCount64();
             }
+            return (GetTickCount64() - m_stalledSince) >= m_abandonTimeout;
+        }
 
-            return FromOffset(reinterpret_cast<size_t>(*head));
+        static UINT32 GetBlock(const QueueItem& item)
+        {
+            return ~item.block;
         }
 
-        void SetHead(QueueItem* value)
+        static void SetBlock(QueueItem& item, UINT32 block)
         {
-            // Store as offset, since it's a pointer into shared memory.
-            void** head = reinterpret_cast<void**>(m_data.Get());
-            (*head) = reinterpret_cast<void*>(ToOffset(value));
+            item.block = ~block;
         }
 
-        QueueItem* AllocateItem()
+        static LONG64 GetSequence(const QueueItem& item, LONG64 position)
         {
-            QueueItem* upperBounds = reinterpret_cast<QueueItem*>(m_data.Get()) + m_data.Size();
-            auto cur = m_dataStart;
+            return ReadAcquire64(const_cast<volatile LONG64*>(&item.sequence)) + (position & (c_capacity - 1));
+        }
 
-            while (cur < (upperBounds - sizeof(QueueItem)) && cur->inUse)
-            {
-                cur += sizeof(QueueItem);
-            }
+        static void SetSequence(QueueItem& item, LONG64 position, LONG64 sequence)
+        {
+            WriteRelease64(&item.sequence, ToStored(sequence, position));
+        }
 
-            THROW_HR_IF(E_OUTOFMEMORY, cur >= (upperBounds - sizeof(QueueItem)));
-            return cur;
+        static LONG64 ToStored(LONG64 sequence, LONG64 position)
+        {
+            return sequence - (position & (c_capacity - 1));
         }
 
         std::wstring m_name;
-        QueueItem* m_dataStart{ nullptr };
-        SharedMemory<size_t> m_data;
+        SharedMemory<QueueData> m_data;
+        wil::srwlock m_consumerLock;
+
+        // Consumer only, under m_consumerLock.
+        ULONGLONG m_abandonTimeout{ c_abandonTimeout };
+        LONG64 m_stalledPosition{ -1 };
+        ULONGLONG m_stalledSince{};
     };
 }
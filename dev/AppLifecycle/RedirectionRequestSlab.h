@@ -0,0 +1,156 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+#pragma once
+#include "SharedMemory.h"
+
+namespace winrt::Microsoft::Windows::AppLifecycle::implementation
+{
+    // Fixed-size payload blocks in the target instance's shared memory.
+    //
+    // A redirecting process claims a free block (CAS on its state), copies its payload in and passes the
+    // block's index to the target through the RedirectionRequestQueue, whose publish/consume ordering covers
+    // the payload too. The target frees the block when it's done with it. No named objects are created per
+    // request and the sender has nothing to wait for. Payloads that don't fit, or arrive when every block is
+    // busy, use a dedicated RedirectionRequest packet instead.
+    //
+    // Until it's handed over (MarkQueued) a block in use holds its sender's process id, then its negation until
+    // the target dequeues it (MarkDelivered). If every block is busy the allocator takes back those whose sender
+    // died before handing them over. Blocks whose sender died after handing them over but before publishing
+    // their queue item are taken back by the target (ReclaimQueued), which knows which ones its queue still holds.
+    class RedirectionRequestSlab
+    {
+    public:
+        static constexpr UINT32 c_noBlock{ MAXUINT32 };
+
+    private:
+        static constexpr UINT32 c_blockCount{ 32 };
+        static constexpr size_t c_blockSize{ 4096 };
+
+        static constexpr LONG c_free{ 0 };
+        // No process id negates to it.
+        static constexpr LONG c_delivered{ MINLONG };
+
+        struct Block
+        {
+            volatile LONG state;
+            UINT32 size;
+            uint8_t data[c_blockSize - sizeof(LONG) - sizeof(UINT32)];
+        };
+
+        struct SlabData
+        {
+            // Where the next allocation starts looking, to keep concurrent producers off each other's blocks.
+            volatile LONG nextBlock;
+            alignas(64) Block blocks[c_blockCount];
+        };
+
+    public:
+        static constexpr size_t c_maxPayloadSize{ sizeof(Block::data) };
+
+        void Init(const std::wstring& name)
+        {
+            m_name = name;
+            m_data.Open(name, sizeof(DynamicSharedMemory<SlabData>));
+        }
+
+        // Returns a buffer for size bytes and its block, or nullptr if the payload's too large or no block is free.
+        // sender is the sending process (tests stand in for others).
+        uint8_t* TryAllocate(size_t size, UINT32& block, DWORD sender = GetCurrentProcessId())
+        {
+            block = c_noBlock;
+            if (size > c_maxPayloadSize)
+            {
+                return nullptr;
+            }
+
+            auto data{ m_data.Get() };
+            const auto owner{ static_cast<LONG>(sender) };
+            const auto start{ static_cast<UINT32>(InterlockedIncrement(&data->nextBlock)) };
+            for (UINT32 attempt = 0; attempt < c_blockCount; ++attempt)
+            {
+                const auto index{ (start + attempt) % c_blockCount };
+                if (InterlockedCompareExchange(&data->blocks[index].state, owner, c_free) == c_free)
+                {
+                    return Claimed(index, size, block);
+                }
+            }
+
+            // Every block's busy. Take back one whose sender died before handing it over.
+            for (UINT32 attempt = 0; attempt < c_blockCount; ++attempt)
+            {
+                const auto index{ (start + attempt) % c_blockCount };
+                const auto state{ ReadAcquire(&data->blocks[index].state) };
+                if ((state > c_free) && IsProcessGone(static_cast<DWORD>(state)) &&
+                    (InterlockedCompareExchange(&data->blocks[index].state, owner, state) == state))
+                {
+                    return Claimed(index, size, block);
+                }
+            }
+            return nullptr;
+        }
+
+        // The block's about to be enqueued. From here on only the target frees it.
+        void MarkQueued(UINT32 block) noexcept
+        {
+            if (block < c_blockCount)
+            {
+                auto& state{ m_data.Get()->blocks[block].state };
+                InterlockedExchange(&state, -ReadNoFence(&state));
+            }
+        }
+
+        // The target dequeued the block. Called under the queue's consumer lock.
+        void MarkDelivered(UINT32 block) noexcept
+        {
+            if (block < c_blockCount)
+            {
+                InterlockedExchange(&m_data.Get()->blocks[block].state, c_delivered);
+            }
+        }
+
+        // Frees the blocks handed over by senders that died before publishing them: isReferenced(block)
+        // says whether a queue item holds the block. Target only, under the queue's consumer lock.
+        template <typename TIsReferenced>
+        void ReclaimQueued(TIsReferenced&& isReferenced)
+        {
+            auto data{ m_data.Get() };
+            for (UINT32 index = 0; index < c_blockCount; ++index)
+            {
+                const auto state{ ReadAcquire(&data->blocks[index].state) };
+                if ((state < c_free) && (state != c_delivered) && IsProcessGone(static_cast<DWORD>(-state)) && !isReferenced(index))
+                {
+                    InterlockedCompareExchange(&data->blocks[index].state, c_free, state);
+                }
+            }
+        }
+
+        const uint8_t* Get(UINT32 block, size_t& size)
+        {
+            THROW_HR_IF(E_INVALIDARG, block >= c_blockCount);
+            const auto& item{ m_data.Get()->blocks[block] };
+            THROW_HR_IF(E_UNEXPECTED, item.size > c_maxPayloadSize);
+            size = item.size;
+            return item.data;
+        }
+
+        void Free(UINT32 block) noexcept
+        {
+            if (block < c_blockCount)
+            {
+                InterlockedExchange(&m_data.Get()->blocks[block].state, c_free);
+            }
+        }
+
+    private:
+        uint8_t* Claimed(UINT32 index, size_t size, UINT32& block)
+        {
+            auto& claimed{ m_data.Get()->blocks[index] };
+            claimed.size = static_cast<UINT32>(size);
+            block = index;
+            return claimed.data;
+        }
+
+        std::wstring m_name;
+        SharedMemory<SlabData> m_data;
+    };
+}
@@ -2,6 +2,18 @@
 // Licensed under the MIT License.
 #pragma once
 
+// Has a process that claimed part of a shared memory region exited (so what it claimed can be taken back)?
+inline bool IsProcessGone(DWORD processId)
+{
+    wil::unique_handle process{ OpenProcess(SYNCHRONIZE, FALSE, processId) };
+    if (!process)
+    {
+        // Access denied means it's running (as someone else).
+        return GetLastError() == ERROR_INVALID_PARAMETER;
+    }
+    return WaitForSingleObject(process.get(), 0) == WAIT_OBJECT_0;
+}
+
 template <typename T>
 struct DynamicSharedMemory
 {
@@ -7,56 +7,360 @@
 namespace winrt::Microsoft::Windows::AppLifecycle::implementation
 {
     const auto c_maxInstanceCount{ 512 };
-    typedef DWORD SharedProcessListData[c_maxInstanceCount];
 
+    // The set of running instances of an app, shared by all of them.
+    //
+    // Each slot holds one process id. A process id to slot index (open addressing, twice the slot count)
+    // makes Insert and Remove O(1), and a bitmap of occupied slots means enumeration only visits those.
+    // All updates are lock-free so any process can add or remove entries at any time; a slot's process id
+    // is the point of truth. Whoever swaps it in from 0 owns the slot and whoever clears it releases it.
+    // A bit may be set for an empty slot but is never clear for an occupied one once its Insert returns.
+    // There's no shared count: a process dying mid-update would leave it off for good, so Size counts
+    // the occupied slots instead.
+    //
+    // Removed index entries leave tombstones so probes carry on past them. A tombstone whose successor
+    // is empty ends every probe that reaches it anyway, so Remove turns it (and any run of tombstones
+    // before it) back into an empty entry and the index doesn't fill up with them as instances churn.
     class SharedProcessList
     {
+        static constexpr UINT32 c_bitsPerWord{ 32 };
+        static constexpr UINT32 c_bitmapWords{ c_maxInstanceCount / c_bitsPerWord };
+        static constexpr UINT32 c_indexSize{ c_maxInstanceCount * 2 };
+        static_assert((c_indexSize & (c_indexSize - 1)) == 0, "Index size must be a power of 2");
+
+        // Index entries are (slot + 1) << 32 | processId, or one of these.
+        static constexpr LONG64 c_emptyEntry{ 0 };
+        static constexpr LONG64 c_removedEntry{ -1 };
+
+        struct SharedProcessListData
+        {
+            volatile LONG bitmap[c_bitmapWords];
+            volatile LONG processIds[c_maxInstanceCount];
+            volatile LONG64 index[c_indexSize];
+        };
+
     public:
         void Init(const std::wstring& filename)
         {
-            m_data.Open(filename);
-            m_view = std::move(winrt::array_view<DWORD>(reinterpret_cast<SharedProcessListData>(*m_data.Get())));
+            m_data.Open(filename, sizeof(DynamicSharedMemory<SharedProcessListData>));
         }
 
         void Insert(DWORD processId)
         {
-            for (DWORD index = 0 ; index < m_view.size() ; index++)
+            THROW_HR_IF(E_INVALIDARG, processId == 0);
+            UINT32 slot{};
+            THROW_HR_IF(E_UNEXPECTED, FindIndexEntry(processId, slot) != c_indexSize);
+
+            auto data{ m_data.Get() };
+            slot = ClaimSlot(processId);
+
+            const auto entry{ MakeIndexEntry(slot, processId) };
+            for (;;)
             {
-                THROW_HR_IF(E_UNEXPECTED, m_view[index] == processId);
-                if (m_view[index] == 0)
+                const auto position{ InsertIndexEntry(processId, entry) };
+                if (position == c_indexSize)
+                {
+                    // Unreachable while the index is larger than the slot count, but don't leak the slot.
+                    ReleaseSlot(slot, processId);
+                    THROW_HR(E_OUTOFMEMORY);
+                }
+
+                // A tombstone reclaimed after we probed past it (when it was still a live entry) can cut
+                // the entry off from its probe start. Check the chain back to it and if so, go again.
+                // (If it's already been removed there's nothing to move.)
+                if (IsReachable(processId, position) ||
+                    (InterlockedCompareExchange64(&data->index[position], c_removedEntry, entry) != entry))
                 {
-                    m_view[index] = processId;
                     return;
                 }
+                ReclaimTombstones(position);
             }
-
-            THROW_HR(E_OUTOFMEMORY);
         }
 
         void Remove(DWORD processId)
         {
-            for (DWORD index = 0; index < m_view.size(); index++)
+            auto data{ m_data.Get() };
+            UINT32 slot{};
+            const auto position{ FindIndexEntry(processId, slot) };
+            if (position != c_indexSize)
             {
-                if (m_view[index] == processId)
+                const auto entry{ MakeIndexEntry(slot, processId) };
+                if (InterlockedCompareExchange64(&data->index[position], c_removedEntry, entry) == entry)
                 {
-                    m_view[index] = 0;
-                    return;
+                    ReclaimTombstones(position);
+                }
+                ReleaseSlot(slot, processId);
+                return;
+            }
+
+            // An inserter that died before indexing its slot leaves it reachable only by scanning.
+            ForEachSlot([&](UINT32 liveSlot, DWORD liveProcessId)
+            {
+                if (liveProcessId != processId)
+                {
+                    return true;
                 }
+                ReleaseSlot(liveSlot, processId);
+                return false;
+            });
+        }
+
+        void Remove(const std::vector<DWORD>& processIds)
+        {
+            for (const auto processId : processIds)
+            {
+                Remove(processId);
             }
         }
 
+        // Number of live entries, visiting only occupied slots.
         const DWORD Size()
         {
-            return m_view.size();
+            DWORD count{};
+            ForEachSlot([&](UINT32 /*slot*/, DWORD /*processId*/)
+            {
+                ++count;
+                return true;
+            });
+            return count;
+        }
+
+        // Snapshot of the live entries, visiting only occupied slots.
+        std::vector<DWORD> GetProcessIds()
+        {
+            std::vector<DWORD> processIds;
+            ForEachSlot([&](UINT32 /*slot*/, DWORD processId)
+            {
+                processIds.push_back(processId);
+                return true;
+            });
+            return processIds;
+        }
+
+        // Test hooks. Leave a slot as a process that died in ClaimSlot (process id in, bit not yet set)
+        // or in ReleaseSlot (process id cleared, bit not yet cleared) would.
+        void TestAbandonClaim(UINT32 slot, DWORD processId)
+        {
+            THROW_HR_IF(E_INVALIDARG, slot >= c_maxInstanceCount);
+            THROW_HR_IF(E_UNEXPECTED, InterlockedCompareExchange(&m_data.Get()->processIds[slot], static_cast<LONG>(processId), 0) != 0);
+        }
+
+        void TestAbandonRelease(UINT32 slot)
+        {
+            THROW_HR_IF(E_INVALIDARG, slot >= c_maxInstanceCount);
+            THROW_HR_IF(E_UNEXPECTED, ReadAcquire(&m_data.Get()->processIds[slot]) != 0);
+            InterlockedOr(&m_data.Get()->bitmap[slot / c_bitsPerWord], BitMask(slot % c_bitsPerWord));
         }
 
-        const DWORD operator[](int index)
+        // Test hook. Number of index entries in use, tombstones included.
+        UINT32 TestIndexEntriesInUse()
         {
-            return m_view[index];
+            auto data{ m_data.Get() };
+            UINT32 inUse{};
+            for (UINT32 position = 0; position < c_indexSize; ++position)
+            {
+                if (ReadAcquire64(&data->index[position]) != c_emptyEntry)
+                {
+                    ++inUse;
+                }
+            }
+            return inUse;
         }
 
     private:
+        static UINT32 Hash(DWORD processId)
+        {
+            // Fibonacci hashing; process ids are multiples of 4 so use the high bits of the product.
+            return (static_cast<UINT32>(processId) * 2654435769u) >> (32 - 10);
+        }
+        static_assert(c_indexSize == (1 << 10), "Hash produces 10 bits");
+
+        static LONG64 MakeIndexEntry(UINT32 slot, DWORD processId)
+        {
+            return (static_cast<LONG64>(slot + 1) << 32) | static_cast<UINT32>(processId);
+        }
+
+        static LONG BitMask(DWORD bit)
+        {
+            return static_cast<LONG>(1UL << bit);
+        }
+
+        // Returns the index position for processId and its slot, or c_indexSize if it isn't indexed.
+        UINT32 FindIndexEntry(DWORD processId, UINT32& slot)
+        {
+            auto data{ m_data.Get() };
+            for (UINT32 probe = 0; probe < c_indexSize; ++probe)
+            {
+                const auto position{ (Hash(processId) + probe) & (c_indexSize - 1) };
+                const auto entry{ ReadAcquire64(&data->index[position]) };
+                if (entry == c_emptyEntry)
+                {
+                    break;
+                }
+                if ((entry != c_removedEntry) && (static_cast<DWORD>(entry) == processId))
+                {
+                    slot = static_cast<UINT32>(entry >> 32) - 1;
+                    return position;
+                }
+            }
+            return c_indexSize;
+        }
+
+        // Returns the index position entry was stored at, or c_indexSize if the index is full.
+        UINT32 InsertIndexEntry(DWORD processId, LONG64 entry)
+        {
+            auto data{ m_data.Get() };
+            for (UINT32 probe = 0; probe < c_indexSize; ++probe)
+            {
+                const auto position{ (Hash(processId) + probe) & (c_indexSize - 1) };
+                auto observed{ ReadAcquire64(&data->index[position]) };
+                while ((observed == c_emptyEntry) || (observed == c_removedEntry))
+                {
+                    // A tombstone may have just been reclaimed; take the position if it's still free.
+                    const auto previous{ InterlockedCompareExchange64(&data->index[position], entry, observed) };
+                    if (previous == observed)
+                    {
+                        return position;
+                    }
+                    observed = previous;
+                }
+            }
+            return c_indexSize;
+        }
+
+        // Is there no empty entry between processId's probe start and position? Checked backwards: a
+        // tombstone is only reclaimed while its successor is empty, so once every entry back to the start
+        // has been seen non-empty (in that order) none of them can empty while the entry at position lives.
+        bool IsReachable(DWORD processId, UINT32 position)
+        {
+            auto data{ m_data.Get() };
+            const auto start{ Hash(processId) };
+            while (position != start)
+            {
+                position = (position - 1) & (c_indexSize - 1);
+                if (ReadAcquire64(&data->index[position]) == c_emptyEntry)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Turn the tombstone at position, and the run of tombstones before it, back into empty entries
+        // for as long as the entry after each one is empty.
+        void ReclaimTombstones(UINT32 position)
+        {
+            auto data{ m_data.Get() };
+            for (UINT32 count = 0; count < c_indexSize; ++count)
+            {
+                const auto next{ (position + 1) & (c_indexSize - 1) };
+                if ((ReadAcquire64(&data->index[next]) != c_emptyEntry) ||
+                    (InterlockedCompareExchange64(&data->index[position], c_emptyEntry, c_removedEntry) != c_removedEntry))
+                {
+                    return;
+                }
+                position = (position - 1) & (c_indexSize - 1);
+            }
+        }
+
+        UINT32 ClaimSlot(DWORD processId)
+        {
+            // Slots whose bit is clear are usually free.
+            auto data{ m_data.Get() };
+            for (UINT32 word = 0; word < c_bitmapWords; ++word)
+            {
+                auto bits{ static_cast<ULONG>(~ReadAcquire(&data->bitmap[word])) };
+                while (bits != 0)
+                {
+                    DWORD bit{};
+                    _BitScanForward(&bit, bits);
+                    bits &= bits - 1;
+
+                    const auto slot{ (word * c_bitsPerWord) + bit };
+                    if (TryClaimSlot(slot, 0, processId))
+                    {
+                        return slot;
+                    }
+                }
+            }
+
+            // Full, or so it seems. A process that died in ReleaseSlot leaves an empty slot with its bit
+            // set, and one that died in ClaimSlot leaves its process id in a slot with its bit clear.
+            // Take either back. Only done when full so a claim still in flight isn't taken from a process
+            // id that was never a real process (as in tests).
+            for (UINT32 slot = 0; slot < c_maxInstanceCount; ++slot)
+            {
+                const auto owner{ static_cast<DWORD>(ReadAcquire(&data->processIds[slot])) };
+                if (owner == 0)
+                {
+                    if (TryClaimSlot(slot, 0, processId))
+                    {
+                        return slot;
+                    }
+                }
+                else if (((ReadAcquire(&data->bitmap[slot / c_bitsPerWord]) & BitMask(slot % c_bitsPerWord)) == 0) &&
+                         IsProcessGone(owner) && TryClaimSlot(slot, owner, processId))
+                {
+                    return slot;
+                }
+            }
+            THROW_HR(E_OUTOFMEMORY);
+        }
+
+        bool TryClaimSlot(UINT32 slot, DWORD owner, DWORD processId)
+        {
+            // The process id claims the slot, then the bit makes it visible to enumeration.
+            auto data{ m_data.Get() };
+            if (InterlockedCompareExchange(&data->processIds[slot], static_cast<LONG>(processId), static_cast<LONG>(owner)) != static_cast<LONG>(owner))
+            {
+                return false;
+            }
+            InterlockedOr(&data->bitmap[slot / c_bitsPerWord], BitMask(slot % c_bitsPerWord));
+            return true;
+        }
+
+        void ReleaseSlot(UINT32 slot, DWORD processId)
+        {
+            // Only the caller that clears the slot's process id frees it, so racing removals free it once.
+            auto data{ m_data.Get() };
+            if (InterlockedCompareExchange(&data->processIds[slot], 0, static_cast<LONG>(processId)) == static_cast<LONG>(processId))
+            {
+                // The slot may have been claimed again before its bit was cleared; if so set it again.
+                auto& bits{ data->bitmap[slot / c_bitsPerWord] };
+                InterlockedAnd(&bits, ~BitMask(slot % c_bitsPerWord));
+                if (ReadAcquire(&data->processIds[slot]) != 0)
+                {
+                    InterlockedOr(&bits, BitMask(slot % c_bitsPerWord));
+                }
+            }
+        }
+
+        // Calls callback(slot, processId) for each occupied slot until it returns false.
+        template <typename TCallback>
+        void ForEachSlot(TCallback&& callback)
+        {
+            auto data{ m_data.Get() };
+            for (UINT32 word = 0; word < c_bitmapWords; ++word)
+            {
+                auto bits{ static_cast<ULONG>(ReadAcquire(&data->bitmap[word])) };
+                while (bits != 0)
+                {
+                    DWORD bit{};
+                    _BitScanForward(&bit, bits);
+                    bits &= bits - 1;
+
+                    // A slot being emptied, or left by a process that died emptying it, may have its bit set
+                    // and no process id.
+                    const auto slot{ (word * c_bitsPerWord) + bit };
+                    const auto processId{ static_cast<DWORD>(ReadAcquire(&data->processIds[slot])) };
+                    if ((processId != 0) && !callback(slot, processId))
+                    {
+                        return;
+                    }
+                }
+            }
+        }
+
         SharedMemory<SharedProcessListData> m_data;
-        winrt::array_view<DWORD> m_view;
     };
 }
@@ -8,6 +8,11 @@
 #include <winrt/Windows.Globalization.DateTimeFormatting.h>
 #include "Microsoft.Windows.AppNotifications.Builder.AppNotificationBuilder.g.cpp"
 #include "AppNotificationBuilderUtility.h"
+#include "AppNotificationButton.h"
+#include "AppNotificationComboBox.h"
+#include "AppNotificationProgressBar.h"
+#include "AppNotificationTextProperties.h"
+#include "AppNotificationTemplate.h"
 #include <iomanip>
 #include <ctime>
 #include <sstream>
@@ -47,7 +52,7 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
 
         std::wstring timestamp{ buffer.str() };
         timestamp.insert(timestamp.size() - c_offsetIndexValue, L":");
-        m_timeStamp = wil::str_printf<std::wstring>(L" displayTimestamp='%ls'", timestamp.c_str());
+        m_timeStamp = std::move(timestamp);
 
         return *this;
     }
@@ -68,7 +73,7 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
     {
         THROW_HR_IF_MSG(E_INVALIDARG, m_textLines.size() >= c_maxTextElements, "Maximum number of text elements added");
 
-        m_textLines.push_back(wil::str_printf<std::wstring>(L"<text>%ls</text>", EncodeXml(text).c_str()).c_str());
+        m_textLines.push_back({ text });
         return *this;
     }
 
@@ -76,10 +81,10 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
     {
         THROW_HR_IF_MSG(E_INVALIDARG, m_textLines.size() >= c_maxTextElements, "Maximum number of text elements added");
 
-        std::wstring props{ properties.as<winrt::Windows::Foundation::IStringable>().ToString() };
-        m_textLines.push_back(wil::str_printf<std::wstring>(L"%ls%ls</text>", props.c_str(), EncodeXml(text).c_str()).c_str());
+        const auto useCallScenarioAlign{ properties.IncomingCallAlignment() };
+        m_textLines.push_back({ text, properties.Language(), properties.MaxLines(), useCallScenarioAlign });
 
-        if (properties.IncomingCallAlignment())
+        if (useCallScenarioAlign)
         {
             m_scenario = AppNotificationScenario::IncomingCall;
         }
@@ -88,7 +93,7 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
 
     winrt::Microsoft::Windows::AppNotifications::Builder::AppNotificationBuilder AppNotificationBuilder::SetAttributionText(hstring const& text)
     {
-        m_attributionText = wil::str_printf<std::wstring>(L"<text placement='attribution'>%ls</text>", EncodeXml(text).c_str());
+        m_attributionText = AttributionText{ text };
         return *this;
     }
 
@@ -96,13 +101,13 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
     {
         THROW_HR_IF_MSG(E_INVALIDARG, language.empty(), "You must provide a language calling SetAttributionText");
 
-        m_attributionText = wil::str_printf<std::wstring>(L"<text placement='attribution' lang='%ls'>%ls</text>", language.c_str(), EncodeXml(text).c_str());
+        m_attributionText = AttributionText{ text, language };
         return *this;
     }
 
     winrt::Microsoft::Windows::AppNotifications::Builder::AppNotificationBuilder AppNotificationBuilder::SetInlineImage(winrt::Windows::Foundation::Uri const& imageUri)
     {
-        m_inlineImage = wil::str_printf<std::wstring>(L"<image src='%ls'/>", imageUri.ToString().c_str());
+        m_inlineImage = { imageUri };
         return *this;
     }
 
@@ -110,7 +115,7 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
     {
         if (imageCrop == AppNotificationImageCrop::Circle)
         {
-            m_inlineImage = wil::str_printf<std::wstring>(L"<image src='%ls' hint-crop='circle'/>", imageUri.ToString().c_str());
+            m_inlineImage = { imageUri, {}, true };
         }
         else
         {
@@ -124,15 +129,14 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
     {
         THROW_HR_IF_MSG(E_INVALIDARG, alternateText.empty(), "You must provide an alternate text string calling SetInlineImage");
 
-        std::wstring hintCrop { imageCrop == AppNotificationImageCrop::Circle ? L" hint-crop='circle'" : L"" };
-        m_inlineImage = wil::str_printf<std::wstring>(L"<image src='%ls' alt='%ls'%ls/>", imageUri.ToString().c_str(), EncodeXml(alternateText).c_str(), hintCrop.c_str());
+        m_inlineImage = { imageUri, alternateText, imageCrop == AppNotificationImageCrop::Circle };
 
         return *this;
     }
 
     winrt::Microsoft::Windows::AppNotifications::Builder::AppNotificationBuilder AppNotificationBuilder::SetAppLogoOverride(winrt::Windows::Foundation::Uri const& imageUri)
     {
-        m_appLogoOverride = wil::str_printf<std::wstring>(L"<image placement='appLogoOverride' src='%ls'/>", imageUri.ToString().c_str());
+        m_appLogoOverride = { imageUri };
         return *this;
     }
 
@@ -140,7 +144,7 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
     {
         if (imageCrop == AppNotificationImageCrop::Circle)
         {
-            m_appLogoOverride = wil::str_printf<std::wstring>(L"<image placement='appLogoOverride' src='%ls' hint-crop='circle'/>", imageUri.ToString().c_str());
+            m_appLogoOverride = { imageUri, {}, true };
         }
         else
         {
@@ -154,15 +158,14 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
     {
         THROW_HR_IF_MSG(E_INVALIDARG, alternateText.empty(), "You must provide an alternate text string calling SetAppLogoOverride");
 
-        std::wstring hintCrop{ imageCrop == AppNotificationImageCrop::Circle ? L" hint-crop='circle'" : L"" };
-        m_appLogoOverride = wil::str_printf<std::wstring>(L"<image placement='appLogoOverride' src='%ls' alt='%ls'%ls/>", imageUri.ToString().c_str(), EncodeXml(alternateText).c_str(), hintCrop.c_str());
+        m_appLogoOverride = { imageUri, alternateText, imageCrop == AppNotificationImageCrop::Circle };
 
         return *this;
     }
 
     winrt::Microsoft::Windows::AppNotifications::Builder::AppNotificationBuilder AppNotificationBuilder::SetHeroImage(winrt::Windows::Foundation::Uri const& imageUri)
     {
-        m_heroImage = wil::str_printf<std::wstring>(L"<image placement='hero' src='%ls'/>", imageUri.ToString().c_str());
+        m_heroImage = { imageUri };
         return *this;
     }
 
@@ -170,37 +173,37 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
     {
         THROW_HR_IF_MSG(E_INVALIDARG, alternateText.empty(), "You must provide an alternate text string calling SetHeroImage");
 
-        m_heroImage = wil::str_printf<std::wstring>(L"<image placement='hero' src='%ls' alt='%ls'/>", imageUri.ToString().c_str(), EncodeXml(alternateText).c_str());
+        m_heroImage = { imageUri, alternateText };
         return *this;
     }
 
     winrt::Microsoft::Windows::AppNotifications::Builder::AppNotificationBuilder AppNotificationBuilder::SetAudioUri(winrt::Windows::Foundation::Uri const& audioUri)
     {
-        m_audio = wil::str_printf<std::wstring>(L"<audio src='%ls'/>", audioUri.ToString().c_str());
+        m_audio = Audio{ audioUri.ToString() };
         return *this;
     }
 
     winrt::Microsoft::Windows::AppNotifications::Builder::AppNotificationBuilder AppNotificationBuilder::SetAudioUri(winrt::Windows::Foundation::Uri const& audioUri, AppNotificationAudioLooping const& loop)
     {
-        m_audio = wil::str_printf<std::wstring>(L"<audio src='%ls' loop='%ls'/>", audioUri.ToString().c_str(), loop == AppNotificationAudioLooping::Loop ? L"true" : L"false");
+        m_audio = Audio{ audioUri.ToString(), loop == AppNotificationAudioLooping::Loop };
         return *this;
     }
 
     winrt::Microsoft::Windows::AppNotifications::Builder::AppNotificationBuilder AppNotificationBuilder::SetAudioEvent(AppNotificationSoundEvent const& soundEvent)
     {
-        m_audio = wil::str_printf<std::wstring>(L"<audio src='%ls'/>", GetWinSoundEventString(soundEvent));
+        m_audio = Audio{ GetWinSoundEventString(soundEvent) };
         return *this;
     }
 
     winrt::Microsoft::Windows::AppNotifications::Builder::AppNotificationBuilder AppNotificationBuilder::SetAudioEvent(AppNotificationSoundEvent const& soundEvent, AppNotificationAudioLooping const& loop)
     {
-        m_audio = wil::str_printf<std::wstring>(L"<audio src='%ls' loop='%ls'/>", GetWinSoundEventString(soundEvent), loop == AppNotificationAudioLooping::Loop ? L"true" : L"false");
+        m_audio = Audio{ GetWinSoundEventString(soundEvent), loop == AppNotificationAudioLooping::Loop };
         return *this;
     }
 
     winrt::Microsoft::Windows::AppNotifications::Builder::AppNotificationBuilder AppNotificationBuilder::MuteAudio()
     {
-        m_audio = L"<audio silent='true'/>";
+        m_audio = Audio{ {}, std::nullopt, true };
         return *this;
     }
 
@@ -216,7 +219,7 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
         ThrowIfMaxInputItemsExceeded();
         THROW_HR_IF_MSG(E_INVALIDARG, id.empty(), "You must provide an id for the TextBox");
 
-        m_textBoxList.push_back(wil::str_printf<std::wstring>(L"<input id='%ls' type='text'/>", EncodeXml(id).c_str()));
+        m_textBoxList.push_back({ id });
         return *this;
     }
 
@@ -225,7 +228,7 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
         ThrowIfMaxInputItemsExceeded();
         THROW_HR_IF_MSG(E_INVALIDARG, id.empty(), "You must provide an id for the TextBox");
 
-        m_textBoxList.push_back(wil::str_printf<std::wstring>(L"<input id='%ls' type='text' placeHolderContent='%ls' title='%ls'/>", EncodeXml(id).c_str(), EncodeXml(placeHolderText).c_str(), EncodeXml(title).c_str()));
+        m_textBoxList.push_back({ id, true, placeHolderText, title });
         return *this;
     }
 
@@ -258,114 +261,200 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
         return *this;
     }
 
-    std::wstring AppNotificationBuilder::GetDuration()
+    PCWSTR AppNotificationBuilder::GetScenario()
     {
-        return m_duration == AppNotificationDuration::Default ? L"" : L" duration='long'";
-    }
-
-    std::wstring AppNotificationBuilder::GetScenario()
-    {
-        // Add scenario attribute if set
         switch (m_scenario)
         {
         case AppNotificationScenario::Alarm:
-            return L" scenario='alarm'";
+            return L"alarm";
         case AppNotificationScenario::Reminder:
-            return L" scenario='reminder'";
+            return L"reminder";
         case AppNotificationScenario::IncomingCall:
-            return L" scenario='incomingCall'";
+            return L"incomingCall";
         case AppNotificationScenario::Urgent:
-            return L" scenario='urgent'";
+            return L"urgent";
         default:
-            return {};
+            return nullptr;
         }
     }
 
-    std::wstring AppNotificationBuilder::GetArguments()
+    size_t AppNotificationBuilder::EstimateLength()
     {
-        // Add launch arguments if given arguments
-        if (m_arguments.Size())
+        // Worked out from what's set now, so a component replaced by calling its setter again counts once.
+        size_t length{ c_baseEstimatedLength };
+        for (auto pair : m_arguments)
+        {
+            length += pair.Key().size() + pair.Value().size() + 2;
+        }
+        if (!m_timeStamp.empty())
         {
-            std::wstring arguments;
-            for (auto pair : m_arguments)
+            length += c_estimatedElementLength;
+        }
+        for (auto const& line : m_textLines)
+        {
+            length += c_estimatedElementLength + line.text.size() + line.language.size();
+            if (line.maxLines || line.useCallScenarioAlign)
             {
-                if (!pair.Value().empty())
-                {
-                    arguments.append(wil::str_printf<std::wstring>(L"%ls=%ls;", pair.Key().c_str(), pair.Value().c_str()));
-                }
-                else
-                {
-                    arguments.append(wil::str_printf<std::wstring>(L"%ls;", pair.Key().c_str()));
-                }
+                length += c_estimatedElementLength;
             }
-            arguments.pop_back();
-
-            return wil::str_printf<std::wstring>(L" launch='%ls'", arguments.c_str());
         }
-        else
+        if (m_attributionText)
         {
-            return {};
+            length += c_estimatedElementLength + m_attributionText->text.size() + m_attributionText->language.size();
         }
-    }
-
-    std::wstring AppNotificationBuilder::GetText()
-    {
-        std::wstring result{};
-        for (auto text : m_textLines)
+        for (auto const image : { &m_inlineImage, &m_appLogoOverride, &m_heroImage })
         {
-            result.append(text);
+            if (image->uri)
+            {
+                length += c_estimatedComponentLength + image->alternateText.size();
+            }
         }
-
-        return result;
+        if (m_audio)
+        {
+            length += c_estimatedElementLength + m_audio->source.size();
+        }
+        for (auto const& textBox : m_textBoxList)
+        {
+            length += (textBox.hasPlaceHolderTextAndTitle ? c_estimatedElementLength * 2 : c_estimatedElementLength) +
+                textBox.id.size() + textBox.placeHolderText.size() + textBox.title.size();
+        }
+        length += (m_progressBarList.size() + m_buttonList.size() + (m_comboBoxList.size() * 2)) * c_estimatedComponentLength;
+        return length;
     }
 
-    std::wstring AppNotificationBuilder::GetImages()
+    bool AppNotificationBuilder::UseButtonStyle()
     {
-        return wil::str_printf<std::wstring>(L"%ls%ls%ls", m_inlineImage.c_str(), m_heroImage.c_str(), m_appLogoOverride.c_str());
+        return std::any_of(m_buttonList.begin(), m_buttonList.end(), [](auto const& button)
+        {
+            return button.ButtonStyle() != AppNotificationButtonStyle::Default;
+        });
     }
 
-    std::wstring AppNotificationBuilder::GetActions()
+    void AppNotificationBuilder::WriteImage(AppNotificationXmlWriter& writer, PCWSTR placement, Image const& image)
     {
+        if (!image.uri)
+        {
+            return;
+        }
 
-        std::wstring result{};
-        for (auto input : m_textBoxList)
+        writer.StartElement(L"image");
+        if (placement)
+        {
+            writer.EncodedAttribute(L"placement", placement);
+        }
+        writer.Attribute(L"src", image.uri.ToString());
+        if (!image.alternateText.empty())
+        {
+            writer.Attribute(L"alt", image.alternateText);
+        }
+        if (image.circleCrop)
         {
-            result.append(input.c_str());
+            writer.EncodedAttribute(L"hint-crop", L"circle");
         }
+        writer.EndEmptyElement();
+    }
 
-        for (auto input : m_comboBoxList)
+    void AppNotificationBuilder::WriteActions(AppNotificationXmlWriter& writer)
+    {
+        if (m_textBoxList.empty() && m_comboBoxList.empty() && m_buttonList.empty())
         {
-            result.append(input.as<winrt::Windows::Foundation::IStringable>().ToString().c_str());
+            return;
         }
 
-        for (auto input : m_buttonList)
+        writer.StartElement(L"actions");
+        for (auto const& textBox : m_textBoxList)
         {
-            if (input.ButtonStyle() != AppNotificationButtonStyle::Default)
+            writer.StartElement(L"input").Attribute(L"id", textBox.id).EncodedAttribute(L"type", L"text");
+            if (textBox.hasPlaceHolderTextAndTitle)
             {
-                m_useButtonStyle = true;
+                writer.Attribute(L"placeHolderContent", textBox.placeHolderText).Attribute(L"title", textBox.title);
             }
+            writer.EndEmptyElement();
+        }
 
-            result.append(input.as<winrt::Windows::Foundation::IStringable>().ToString().c_str());
+        for (auto const& comboBox : m_comboBoxList)
+        {
+            winrt::get_self<implementation::AppNotificationComboBox>(comboBox)->WriteXml(writer);
         }
 
-        return (result.empty()) ? result : wil::str_printf<std::wstring>(L"<actions>%ls</actions>", result.c_str());
+        for (auto const& button : m_buttonList)
+        {
+            winrt::get_self<implementation::AppNotificationButton>(button)->WriteXml(writer);
+        }
+        writer.EndElement(L"actions");
     }
 
-    // You must call GetActions first to retrieve this value.
-    std::wstring AppNotificationBuilder::GetButtonStyle()
+    void AppNotificationBuilder::WriteXml(AppNotificationXmlWriter& writer)
     {
-        return m_useButtonStyle ? L" useButtonStyle='true'" : L"";
-    }
+        writer.StartElement(L"toast");
+        if (!m_timeStamp.empty())
+        {
+            writer.EncodedAttribute(L"displayTimestamp", m_timeStamp);
+        }
+        if (m_duration != AppNotificationDuration::Default)
+        {
+            writer.EncodedAttribute(L"duration", L"long");
+        }
+        if (auto scenario{ GetScenario() })
+        {
+            writer.EncodedAttribute(L"scenario", scenario);
+        }
+        if (m_arguments.Size())
+        {
+            writer.ArgumentsAttribute(L"launch", m_arguments);
+        }
+        if (UseButtonStyle())
+        {
+            writer.EncodedAttribute(L"useButtonStyle", L"true");
+        }
 
-    std::wstring AppNotificationBuilder::GetProgressBars()
-    {
-        std::wstring result{};
-        for (auto progressBar : m_progressBarList)
+        writer.StartElement(L"visual").StartElement(L"binding").EncodedAttribute(L"template", L"ToastGeneric");
+        for (auto const& line : m_textLines)
         {
-            result.append(progressBar.as<winrt::Windows::Foundation::IStringable>().ToString());
+            implementation::AppNotificationTextProperties::WriteStartTag(writer, line.language, line.maxLines, line.useCallScenarioAlign);
+            writer.Text(line.text).EndElement(L"text");
         }
 
-        return result;
+        if (m_attributionText)
+        {
+            writer.StartElement(L"text").EncodedAttribute(L"placement", L"attribution");
+            if (!m_attributionText->language.empty())
+            {
+                writer.Attribute(L"lang", m_attributionText->language);
+            }
+            writer.Text(m_attributionText->text).EndElement(L"text");
+        }
+
+        WriteImage(writer, nullptr, m_inlineImage);
+        WriteImage(writer, L"hero", m_heroImage);
+        WriteImage(writer, L"appLogoOverride", m_appLogoOverride);
+
+        for (auto const& progressBar : m_progressBarList)
+        {
+            winrt::get_self<implementation::AppNotificationProgressBar>(progressBar)->WriteXml(writer);
+        }
+        writer.EndElement(L"binding").EndElement(L"visual");
+
+        if (m_audio)
+        {
+            writer.StartElement(L"audio");
+            if (m_audio->silent)
+            {
+                writer.EncodedAttribute(L"silent", L"true");
+            }
+            else
+            {
+                writer.Attribute(L"src", m_audio->source);
+            }
+            if (m_audio->loop)
+            {
+                writer.EncodedAttribute(L"loop", *m_audio->loop ? L"true" : L"false");
+            }
+            writer.EndEmptyElement();
+        }
+
+        WriteActions(writer);
+        writer.EndElement(L"toast");
     }
 
     winrt::Microsoft::Windows::AppNotifications::AppNotification AppNotificationBuilder::BuildNotification()
@@ -378,25 +467,17 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
 
         try
         {
-            // Build the actions string and fill m_useButtonStyle
-            std::wstring actions{ GetActions() };
-
-            auto xmlResult{ wil::str_printf<std::wstring>(L"<toast%ls%ls%ls%ls%ls><visual><binding template='ToastGeneric'>%ls%ls%ls%ls</binding></visual>%ls%ls</toast>",
-                m_timeStamp.c_str(),
-                GetDuration().c_str(),
-                GetScenario().c_str(),
-                GetArguments().c_str(),
-                GetButtonStyle().c_str(),
-                GetText().c_str(),
-                m_attributionText.c_str(),
-                GetImages().c_str(),
-                GetProgressBars().c_str(),
-                m_audio.c_str(),
-                actions.c_str()) };
-
-            THROW_HR_IF_MSG(E_FAIL, xmlResult.size() > c_maxAppNotificationPayload, "Maximum payload size exceeded");
-
-            winrt::Microsoft::Windows::AppNotifications::AppNotification appNotification{ xmlResult };
+            // An HSTRING can't grow, so writing the payload straight into one would take a second pass to
+            // find its length first. Instead it's written to a buffer kept for the thread's next build and
+            // copied, so once the buffer's warm the hstring is the only payload-sized allocation.
+            static thread_local std::wstring t_payloadBuffer;
+            AppNotificationXmlWriter writer{ EstimateLength(), std::move(t_payloadBuffer) };
+            WriteXml(writer);
+
+            THROW_HR_IF_MSG(E_FAIL, writer.Size() > c_maxAppNotificationPayload, "Maximum payload size exceeded");
+
+            winrt::Microsoft::Windows::AppNotifications::AppNotification appNotification{ winrt::hstring{ writer.Result() } };
+            t_payloadBuffer = writer.ReleaseBuffer();
             appNotification.Tag(m_tag);
             appNotification.Group(m_group);
 
@@ -408,4 +489,27 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
             throw;
         }
     }
+
+    winrt::Microsoft::Windows::AppNotifications::Builder::AppNotificationTemplate AppNotificationBuilder::BuildTemplate()
+    {
+        HRESULT hr{ S_OK };
+
+        auto logTelemetry{ wil::scope_exit([&]() {
+            AppNotificationBuilderTelemetry::LogBuildTemplate(hr);
+        }) };
+
+        try
+        {
+            AppNotificationXmlWriter writer{ EstimateLength() };
+            writer.RecordSlots();
+            WriteXml(writer);
+
+            return winrt::make<implementation::AppNotificationTemplate>(writer.Result(), writer.Slots(), m_tag, m_group);
+        }
+        catch (...)
+        {
+            hr = wil::ResultFromCaughtException();
+            throw;
+        }
+    }
 }
@@ -3,6 +3,8 @@
 
 #pragma once
 #include "Microsoft.Windows.AppNotifications.Builder.AppNotificationBuilder.g.h"
+#include "AppNotificationXmlWriter.h"
+#include <optional>
 
 namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
 {
@@ -63,36 +65,79 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
 
         winrt::Microsoft::Windows::AppNotifications::AppNotification BuildNotification();
 
+        winrt::Microsoft::Windows::AppNotifications::Builder::AppNotificationTemplate BuildTemplate();
+
         static bool IsUrgentScenarioSupported();
 
+        // Streams the payload into writer.
+        void WriteXml(AppNotificationXmlWriter& writer);
+
     private:
+        // The properties are copied when the line's added, so later changes to them don't affect it.
+        struct TextLine
+        {
+            winrt::hstring text;
+            winrt::hstring language;
+            int maxLines{};
+            bool useCallScenarioAlign{};
+        };
+
+        struct Image
+        {
+            winrt::Windows::Foundation::Uri uri{ nullptr };
+            winrt::hstring alternateText;
+            bool circleCrop{};
+        };
+
+        struct AttributionText
+        {
+            winrt::hstring text;
+            winrt::hstring language;
+        };
+
+        struct Audio
+        {
+            winrt::hstring source;
+            std::optional<bool> loop;
+            bool silent{};
+        };
+
+        struct TextBox
+        {
+            winrt::hstring id;
+            bool hasPlaceHolderTextAndTitle{};
+            winrt::hstring placeHolderText;
+            winrt::hstring title;
+        };
+
         void ThrowIfMaxInputItemsExceeded();
-        std::wstring GetDuration();
-        std::wstring GetScenario();
-        std::wstring GetArguments();
-        std::wstring GetButtonStyle();
-        std::wstring GetText();
-        std::wstring GetImages();
-        std::wstring GetActions();
-        std::wstring GetProgressBars();
+        size_t EstimateLength();
+        PCWSTR GetScenario();
+        bool UseButtonStyle();
+        void WriteImage(AppNotificationXmlWriter& writer, PCWSTR placement, Image const& image);
+        void WriteActions(AppNotificationXmlWriter& writer);
 
         std::wstring m_timeStamp{};
         AppNotificationDuration m_duration{ AppNotificationDuration::Default };
         AppNotificationScenario m_scenario{ AppNotificationScenario::Default };
-        bool m_useButtonStyle{};
-        std::vector<winrt::hstring> m_textLines{};
-        winrt::hstring m_attributionText{};
-        winrt::hstring m_inlineImage{};
-        winrt::hstring m_appLogoOverride{};
-        winrt::hstring m_heroImage{};
-        winrt::hstring m_audio{};
+        std::vector<TextLine> m_textLines{};
+        std::optional<AttributionText> m_attributionText{};
+        Image m_inlineImage{};
+        Image m_appLogoOverride{};
+        Image m_heroImage{};
+        std::optional<Audio> m_audio{};
         winrt::Windows::Foundation::Collections::IMap<winrt::hstring, winrt::hstring> m_arguments{ winrt::single_threaded_map<winrt::hstring, winrt::hstring>() };
         std::vector<AppNotificationButton> m_buttonList{};
         std::vector<AppNotificationProgressBar> m_progressBarList{};
-        std::vector<std::wstring> m_textBoxList{};
+        std::vector<TextBox> m_textBoxList{};
         std::vector<AppNotificationComboBox> m_comboBoxList{};
         winrt::hstring m_tag{};
         winrt::hstring m_group{};
+
+        // For estimating the payload's length, used to size the buffer it's written into.
+        static constexpr size_t c_baseEstimatedLength{ 128 };
+        static constexpr size_t c_estimatedElementLength{ 64 };
+        static constexpr size_t c_estimatedComponentLength{ 256 };
     };
 }
 namespace winrt::Microsoft::Windows::AppNotifications::Builder::factory_implementation
@@ -32,6 +32,22 @@ public:
     }
     CATCH_LOG()
 
+    DEFINE_EVENT_METHOD(LogBuildTemplate)(
+        winrt::hresult hr) noexcept try
+    {
+        if (m_telemetryHelper.ShouldLogEvent())
+        {
+            TraceLoggingClassWriteMeasure(
+                "BuildTemplate",
+                TelemetryPrivacyDataTag(PDT_ProductAndServicePerformance),
+                _GENERIC_PARTB_FIELDS_ENABLED,
+                TraceLoggingHexUInt32(hr, "OperationResult"),
+                TraceLoggingBool(m_telemetryHelper.IsPackagedApp(), "IsAppPackaged"),
+                TraceLoggingWideString(m_telemetryHelper.GetAppName().c_str(), "AppName"));
+        }
+    }
+    CATCH_LOG()
+
     DEFINE_EVENT_METHOD(LogButtonToString)(
         winrt::hresult hr) noexcept try
     {
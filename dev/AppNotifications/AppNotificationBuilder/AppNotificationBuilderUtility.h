@@ -7,11 +7,11 @@
 #include <regex>
 #include <map>
 #include <iostream>
+#include "AppNotificationEscaping.h"
 
 constexpr size_t c_maxAppNotificationPayload{ 5120 };
 constexpr uint8_t c_maxTextElements{ 3 };
 constexpr uint8_t c_maxButtonElements{ 5 };
-constexpr size_t c_maxEncodingSize{ 3 };
 constexpr uint8_t c_maxTextInputElements{ 5 };
 constexpr uint8_t c_maxSelectionElements{ 5 };
 constexpr uint8_t c_offsetIndexValue{ 2 };
@@ -21,24 +21,6 @@ namespace AppNotificationBuilder
     using namespace winrt::Microsoft::Windows::AppNotifications::Builder;
 }
 
-inline std::unordered_map<wchar_t, std::wstring> GetXmlEscapeEncodings()
-{
-    static std::unordered_map<wchar_t, std::wstring> encodings = { { L'&', L"&amp;"}, { L'\"', L"&quot;"}, {L'<', L"&lt;"}, {L'>', L"&gt;"}, {L'\'', L"&apos;"}};
-    return encodings;
-}
-
-inline std::unordered_map<wchar_t, std::wstring> GetPercentEncodings()
-{
-    static std::unordered_map<wchar_t, std::wstring> encodings = {{ L'%', L"%25"}, {L';', L"%3B"}, {L'=', L"%3D"} };
-    return encodings;
-}
-
-inline std::unordered_map<std::wstring, wchar_t> GetPercentEncodingsReverse()
-{
-    static std::unordered_map<std::wstring, wchar_t> encodings = { { L"%25", L'%' }, {L"%3B", L';' }, { L"%3D", L'=' } };
-    return encodings;
-}
-
 inline PCWSTR GetWinSoundEventString(AppNotificationBuilder::AppNotificationSoundEvent soundEvent)
 {
     switch (soundEvent)
@@ -98,70 +80,17 @@ inline PCWSTR GetWinSoundEventString(AppNotificationBuilder::AppNotificationSoun
 
 inline std::wstring EncodeArgument(std::wstring const& value)
 {
-    std::wstring encodedValue{};
-
-    auto percentEncodings{ GetPercentEncodings() };
-    auto xmlEncodings{ GetXmlEscapeEncodings() };
-    for (auto ch : value)
-    {
-        if (percentEncodings.find(ch) != percentEncodings.end())
-        {
-            encodedValue.append(percentEncodings[ch]);
-        }
-        else if (xmlEncodings.find(ch) != xmlEncodings.end())
-        {
-            encodedValue.append(xmlEncodings[ch]);
-        }
-        else
-        {
-            encodedValue.push_back(ch);
-        }
-    }
-
-    return encodedValue;
+    return AppNotificationEscaping::Encode(value, AppNotificationEscaping::c_argumentEscapes);
 }
 
 inline std::wstring EncodeXml(winrt::hstring const& value)
 {
-    std::wstring encodedValue{};
-
-    auto xmlEncodings{ GetXmlEscapeEncodings() };
-    for (auto ch : value)
-    {
-        if (xmlEncodings.find(ch) != xmlEncodings.end())
-        {
-            encodedValue.append(xmlEncodings[ch]);
-        }
-        else
-        {
-            encodedValue.push_back(ch);
-        }
-    }
-
-    return encodedValue;
+    return AppNotificationEscaping::Encode(value, AppNotificationEscaping::c_xmlEscapes);
 }
 
 // Decoding process based off the Windows Community Toolkit:
 // https://github.com/CommunityToolkit/WindowsCommunityToolkit/blob/rel/7.1.0/Microsoft.Toolkit.Uwp.Notifications/Toasts/ToastArguments.cs#L389inline
 inline std::wstring Decode(std::wstring const& value)
 {
-    std::wstring result{};
-    auto percentEncodings{ GetPercentEncodingsReverse() };
-
-    // Need to unescape special characters
-    for (size_t index = 0; index < value.size();)
-    {
-        std::wstring curr{ value.substr(index, c_maxEncodingSize) };
-        if (percentEncodings.find(curr) != percentEncodings.end())
-        {
-            result.push_back(percentEncodings[curr]);
-            index += c_maxEncodingSize;
-        }
-        else
-        {
-            result.push_back(value.at(index));
-            index++;
-        }
-    }
-    return result;
+    return AppNotificationEscaping::DecodeArgument(value);
 }
@@ -39,7 +39,7 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
 
     winrt::Microsoft::Windows::AppNotifications::Builder::AppNotificationButton AppNotificationButton::SetToolTip(winrt::hstring const& value)
     {
-        m_toolTip = EncodeXml(value.c_str()).c_str();
+        m_toolTip = value;
         return *this;
     }
 
@@ -57,7 +57,7 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
 
     winrt::Microsoft::Windows::AppNotifications::Builder::AppNotificationButton AppNotificationButton::SetInputId(winrt::hstring const& value)
     {
-        m_inputId = EncodeXml(value.c_str()).c_str();
+        m_inputId = value;
         return *this;
     }
 
@@ -78,42 +78,54 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
         return *this;
     }
 
-    std::wstring AppNotificationButton::GetActivationArguments()
+    void AppNotificationButton::WriteActivationArguments(AppNotificationXmlWriter& writer)
     {
         if (m_protocolUri)
         {
-            std::wstring protocolTargetPfn{ !m_targetApplicationPfn.empty() ? wil::str_printf<std::wstring>(L" protocolActivationTargetApplicationPfn='%ls'", m_targetApplicationPfn.c_str()) : L"" };
-            return wil::str_printf<std::wstring>(L" arguments='%ws' activationType='protocol'%ls", m_protocolUri.ToString().c_str(), protocolTargetPfn.c_str());
+            writer.Attribute(L"arguments", m_protocolUri.ToString());
+            writer.EncodedAttribute(L"activationType", L"protocol");
+            if (!m_targetApplicationPfn.empty())
+            {
+                writer.Attribute(L"protocolActivationTargetApplicationPfn", m_targetApplicationPfn);
+            }
         }
         else
         {
-            std::wstring arguments;
-            for (auto pair : m_arguments)
-            {
-                if (!pair.Value().empty())
-                {
-                    arguments.append(wil::str_printf<std::wstring>(L"%ls=%ls;", pair.Key().c_str(), pair.Value().c_str()));
-                }
-                else
-                {
-                    arguments.append(wil::str_printf<std::wstring>(L"%ls;", pair.Key().c_str()));
-                }
-            }
-            arguments.pop_back();
-
-            return wil::str_printf<std::wstring>(L" arguments='%ls'", arguments.c_str());
+            writer.ArgumentsAttribute(L"arguments", m_arguments);
         }
     }
 
-    std::wstring AppNotificationButton::GetButtonStyle()
+    PCWSTR AppNotificationButton::GetButtonStyle()
     {
-        if (m_buttonStyle == AppNotificationButtonStyle::Default)
+        return m_buttonStyle == AppNotificationButtonStyle::Success ? L"Success" : L"Critical";
+    }
+
+    void AppNotificationButton::WriteXml(AppNotificationXmlWriter& writer)
+    {
+        writer.StartElement(L"action").Attribute(L"content", m_content);
+        WriteActivationArguments(writer);
+
+        if (m_useContextMenuPlacement)
         {
-            return L"";
+            writer.EncodedAttribute(L"placement", L"contextMenu");
         }
-
-        std::wstring style{ m_buttonStyle == AppNotificationButtonStyle::Success ? L"Success" : L"Critical" };
-        return wil::str_printf<std::wstring>(L" hint-buttonStyle='%ls'", style.c_str());
+        if (m_iconUri)
+        {
+            writer.Attribute(L"imageUri", m_iconUri.ToString());
+        }
+        if (!m_inputId.empty())
+        {
+            writer.Attribute(L"hint-inputId", m_inputId);
+        }
+        if (m_buttonStyle != AppNotificationButtonStyle::Default)
+        {
+            writer.EncodedAttribute(L"hint-buttonStyle", GetButtonStyle());
+        }
+        if (!m_toolTip.empty())
+        {
+            writer.Attribute(L"hint-toolTip", m_toolTip);
+        }
+        writer.EndEmptyElement();
     }
 
     winrt::hstring AppNotificationButton::ToString()
@@ -126,16 +138,9 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
 
         try
         {
-            std::wstring xmlResult{ wil::str_printf<std::wstring>(L"<action content='%ls'%ls%ls%ls%ls%ls%ls/>",
-                m_content.c_str(),
-                GetActivationArguments().c_str(),
-                m_useContextMenuPlacement ? L" placement='contextMenu'" : L"",
-                m_iconUri ? wil::str_printf<std::wstring>(L" imageUri='%ls'", m_iconUri.ToString().c_str()).c_str() : L"",
-                !m_inputId.empty() ? wil::str_printf<std::wstring>(L" hint-inputId='%ls'", m_inputId.c_str()).c_str() : L"",
-                GetButtonStyle().c_str(),
-                !m_toolTip.empty() ? wil::str_printf<std::wstring>(L" hint-toolTip='%ls'", m_toolTip.c_str()).c_str() : L"") };
-
-            return xmlResult.c_str();
+            AppNotificationXmlWriter writer;
+            WriteXml(writer);
+            return winrt::hstring{ writer.Result() };
         }
         catch (...)
         {
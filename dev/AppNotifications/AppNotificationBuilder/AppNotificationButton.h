@@ -3,6 +3,7 @@
 
 #pragma once
 #include "Microsoft.Windows.AppNotifications.Builder.AppNotificationButton.g.h"
+#include "AppNotificationXmlWriter.h"
 
 namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
 {
@@ -60,9 +61,11 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
 
         winrt::hstring ToString();
 
+        void WriteXml(AppNotificationXmlWriter& writer);
+
     private:
-        std::wstring GetActivationArguments();
-        std::wstring GetButtonStyle();
+        void WriteActivationArguments(AppNotificationXmlWriter& writer);
+        PCWSTR GetButtonStyle();
 
         winrt::hstring m_content{};
         winrt::Windows::Foundation::Collections::IMap<winrt::hstring, winrt::hstring> m_arguments { winrt::single_threaded_map<winrt::hstring, winrt::hstring>() };
@@ -12,7 +12,7 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
     AppNotificationComboBox::AppNotificationComboBox(hstring const& id)
     {
         THROW_HR_IF_MSG(E_INVALIDARG, id.empty(), "You must provide an id for the ComboBox");
-        m_id = EncodeXml(id).c_str();
+        m_id = id;
     };
 
     winrt::Microsoft::Windows::AppNotifications::Builder::AppNotificationComboBox AppNotificationComboBox::AddItem(winrt::hstring const& id, winrt::hstring const& content)
@@ -20,14 +20,14 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
         THROW_HR_IF_MSG(E_INVALIDARG, m_items.Size() >= c_maxSelectionElements, "Maximum number of items added");
         THROW_HR_IF_MSG(E_INVALIDARG, id.empty(), "You must provide an id for the item");
 
-        m_items.Insert(EncodeXml(id).c_str(), EncodeXml(content).c_str());
+        m_items.Insert(id, content);
 
         return *this;
     }
 
     winrt::Microsoft::Windows::AppNotifications::Builder::AppNotificationComboBox AppNotificationComboBox::SetTitle(winrt::hstring const& value)
     {
-        m_title = EncodeXml(value).c_str();
+        m_title = value;
 
         return *this;
     }
@@ -36,21 +36,29 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
     {
         THROW_HR_IF_MSG(E_INVALIDARG, id.empty(), "You must provide an id for the selected item");
 
-        m_selectedItem = EncodeXml(id).c_str();
+        m_selectedItem = id;
 
         return *this;
     }
 
-    std::wstring AppNotificationComboBox::GetSelectionItems()
+    void AppNotificationComboBox::WriteXml(AppNotificationXmlWriter& writer)
     {
-        std::wstring items{};
+        writer.StartElement(L"input").Attribute(L"id", m_id).EncodedAttribute(L"type", L"selection");
+        if (!m_title.empty())
+        {
+            writer.Attribute(L"title", m_title);
+        }
+        if (!m_selectedItem.empty())
+        {
+            writer.Attribute(L"defaultInput", m_selectedItem);
+        }
 
+        writer.EndStartTag();
         for (auto pair : m_items)
         {
-            items.append(wil::str_printf<std::wstring>(L"<selection id='%ls' content='%ls'/>", pair.Key().c_str(), pair.Value().c_str()));
+            writer.StartElement(L"selection").Attribute(L"id", pair.Key()).Attribute(L"content", pair.Value()).EndEmptyElement();
         }
-
-        return items;
+        writer.EndElement(L"input");
     }
 
     winrt::hstring AppNotificationComboBox::ToString()
@@ -63,13 +71,9 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
 
         try
         {
-            std::wstring xmlResult{ wil::str_printf<std::wstring>(L"<input id='%ls' type='selection'%ls%ls>%ls</input>",
-                m_id.c_str(),
-                m_title.empty() ? L"" : wil::str_printf<std::wstring>(L" title='%ls'", m_title.c_str()).c_str(),
-                m_selectedItem.empty() ? L"" : wil::str_printf<std::wstring>(L" defaultInput='%ls'", m_selectedItem.c_str()).c_str(),
-                GetSelectionItems().c_str()) };
-
-            return xmlResult.c_str();
+            AppNotificationXmlWriter writer;
+            WriteXml(writer);
+            return winrt::hstring{ writer.Result() };
         }
         catch (...)
         {
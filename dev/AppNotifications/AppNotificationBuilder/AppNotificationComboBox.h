@@ -3,6 +3,7 @@
 
 #pragma once
 #include "Microsoft.Windows.AppNotifications.Builder.AppNotificationComboBox.g.h"
+#include "AppNotificationXmlWriter.h"
 
 namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
 {
@@ -30,13 +31,13 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
         // IStringable
         winrt::hstring ToString();
 
+        void WriteXml(AppNotificationXmlWriter& writer);
+
     private:
         winrt::hstring m_id{};
         winrt::Windows::Foundation::Collections::IMap<winrt::hstring, winrt::hstring> m_items{ winrt::single_threaded_map<winrt::hstring, winrt::hstring>() };
         winrt::hstring m_title{};
         winrt::hstring m_selectedItem{};
-
-        std::wstring GetSelectionItems();
     };
 }
 
@@ -0,0 +1,203 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#pragma once
+#include <array>
+#include <string>
+#include <string_view>
+
+#if defined(_M_IX86) || defined(_M_X64)
+#include <emmintrin.h>
+#include <intrin.h>
+#define APPNOTIFICATION_ESCAPING_SSE2
+#elif defined(_M_ARM64)
+#include <arm_neon.h>
+#define APPNOTIFICATION_ESCAPING_NEON
+#endif
+
+// Escaping engine behind EncodeXml, EncodeArgument, Decode and AppNotificationXmlWriter.
+//
+// Every character that gets escaped is ASCII, so a 128-entry table maps a character to its replacement
+// (empty when it's copied as-is). Runs with nothing to escape are skipped 8 characters at a time with
+// SSE2/NEON and copied in one append; the output length is computed up front so encoding allocates once.
+namespace AppNotificationEscaping
+{
+    constexpr size_t c_tableSize{ 128 };
+
+    struct EscapeTable
+    {
+        std::array<std::wstring_view, c_tableSize> replacements;
+
+        // The characters with a non-empty replacement, compared against in the vector scan.
+        std::wstring_view specials;
+    };
+
+    constexpr std::array<std::wstring_view, c_tableSize> MakeReplacements(bool percentEncode)
+    {
+        std::array<std::wstring_view, c_tableSize> replacements{};
+        replacements[L'&'] = L"&amp;";
+        replacements[L'\"'] = L"&quot;";
+        replacements[L'<'] = L"&lt;";
+        replacements[L'>'] = L"&gt;";
+        replacements[L'\''] = L"&apos;";
+        if (percentEncode)
+        {
+            replacements[L'%'] = L"%25";
+            replacements[L';'] = L"%3B";
+            replacements[L'='] = L"%3D";
+        }
+        return replacements;
+    }
+
+    // Text and attribute values.
+    inline constexpr EscapeTable c_xmlEscapes{ MakeReplacements(false), L"&\"<>'" };
+
+    // Launch argument keys and values: percent-encode the ';' and '=' separators (and '%' itself) and XML escape the rest.
+    inline constexpr EscapeTable c_argumentEscapes{ MakeReplacements(true), L"%;=&\"<>'" };
+
+    inline bool NeedsEscape(wchar_t ch, EscapeTable const& table)
+    {
+        return (static_cast<size_t>(ch) < c_tableSize) && !table.replacements[ch].empty();
+    }
+
+    // Returns the index of the first character at or after start that needs escaping, or value.size() if there is none.
+    inline size_t FindNextEscape(std::wstring_view value, size_t start, EscapeTable const& table)
+    {
+        size_t index{ start };
+
+#if defined(APPNOTIFICATION_ESCAPING_SSE2)
+        static_assert(sizeof(wchar_t) == sizeof(uint16_t));
+        for (; index + 8 <= value.size(); index += 8)
+        {
+            const __m128i chars{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(value.data() + index)) };
+            __m128i matches{ _mm_setzero_si128() };
+            for (auto special : table.specials)
+            {
+                matches = _mm_or_si128(matches, _mm_cmpeq_epi16(chars, _mm_set1_epi16(static_cast<short>(special))));
+            }
+
+            // Two mask bits per character
+            const auto mask{ static_cast<unsigned long>(_mm_movemask_epi8(matches)) };
+            if (mask != 0)
+            {
+                unsigned long bit{};
+                _BitScanForward(&bit, mask);
+                return index + (bit / 2);
+            }
+        }
+#elif defined(APPNOTIFICATION_ESCAPING_NEON)
+        static_assert(sizeof(wchar_t) == sizeof(uint16_t));
+        for (; index + 8 <= value.size(); index += 8)
+        {
+            const uint16x8_t chars{ vld1q_u16(reinterpret_cast<const uint16_t*>(value.data() + index)) };
+            uint16x8_t matches{ vdupq_n_u16(0) };
+            for (auto special : table.specials)
+            {
+                matches = vorrq_u16(matches, vceqq_u16(chars, vdupq_n_u16(static_cast<uint16_t>(special))));
+            }
+
+            if (vmaxvq_u16(matches) != 0)
+            {
+                // The scalar loop below pinpoints it within these 8
+                break;
+            }
+        }
+#endif
+
+        for (; index < value.size(); ++index)
+        {
+            if (NeedsEscape(value[index], table))
+            {
+                return index;
+            }
+        }
+        return value.size();
+    }
+
+    // The exact length of value once encoded.
+    inline size_t EncodedLength(std::wstring_view value, EscapeTable const& table)
+    {
+        size_t length{ value.size() };
+        for (auto index{ FindNextEscape(value, 0, table) }; index < value.size(); index = FindNextEscape(value, index + 1, table))
+        {
+            length += table.replacements[value[index]].size() - 1;
+        }
+        return length;
+    }
+
+    inline void AppendEncoded(std::wstring& result, std::wstring_view value, EscapeTable const& table)
+    {
+        size_t runStart{};
+        for (auto index{ FindNextEscape(value, 0, table) }; index < value.size(); index = FindNextEscape(value, index + 1, table))
+        {
+            result.append(value.substr(runStart, index - runStart));
+            result.append(table.replacements[value[index]]);
+            runStart = index + 1;
+        }
+        result.append(value.substr(runStart));
+    }
+
+    inline std::wstring Encode(std::wstring_view value, EscapeTable const& table)
+    {
+        const auto firstEscape{ FindNextEscape(value, 0, table) };
+        if (firstEscape == value.size())
+        {
+            return std::wstring{ value };
+        }
+
+        std::wstring result;
+        result.reserve(firstEscape + EncodedLength(value.substr(firstEscape), table));
+        result.append(value.substr(0, firstEscape));
+        AppendEncoded(result, value.substr(firstEscape), table);
+        return result;
+    }
+
+    // Reverses the percent-encoding applied by c_argumentEscapes. Only the exact (uppercase) sequences the
+    // encoder emits are decoded; anything else, including a trailing partial sequence, is copied as-is.
+    inline std::wstring DecodeArgument(std::wstring_view value)
+    {
+        auto index{ value.find(L'%') };
+        if (index == std::wstring_view::npos)
+        {
+            return std::wstring{ value };
+        }
+
+        std::wstring result;
+        result.reserve(value.size());
+        size_t runStart{};
+        while (index != std::wstring_view::npos)
+        {
+            wchar_t decoded{};
+            if (index + 2 < value.size())
+            {
+                const auto high{ value[index + 1] };
+                const auto low{ value[index + 2] };
+                if ((high == L'2') && (low == L'5'))
+                {
+                    decoded = L'%';
+                }
+                else if ((high == L'3') && (low == L'B'))
+                {
+                    decoded = L';';
+                }
+                else if ((high == L'3') && (low == L'D'))
+                {
+                    decoded = L'=';
+                }
+            }
+
+            if (decoded == L'\0')
+            {
+                index = value.find(L'%', index + 1);
+                continue;
+            }
+
+            result.append(value.substr(runStart, index - runStart));
+            result.push_back(decoded);
+            runStart = index + 3;
+            index = value.find(L'%', runStart);
+        }
+        result.append(value.substr(runStart));
+        return result;
+    }
+}
@@ -18,13 +18,13 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
 
     void AppNotificationProgressBar::Title(winrt::hstring const& value)
     {
-        m_title = EncodeXml(value).c_str();
+        m_title = value;
         m_titleBindMode = BindMode::Value;
     }
 
     void AppNotificationProgressBar::Status(winrt::hstring const& value)
     {
-        m_status = EncodeXml(value).c_str();
+        m_status = value;
         m_statusBindMode = BindMode::Value;
     }
 
@@ -38,7 +38,7 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
 
     void AppNotificationProgressBar::ValueStringOverride(winrt::hstring const& value)
     {
-        m_valueStringOverride = EncodeXml(value).c_str();
+        m_valueStringOverride = value;
         m_valueStringOverrideBindMode = BindMode::Value;
     }
 
@@ -98,6 +98,34 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
         return *this;
     }
 
+    void AppNotificationProgressBar::WriteXml(AppNotificationXmlWriter& writer)
+    {
+        writer.StartElement(L"progress");
+        if (m_titleBindMode != BindMode::NotSet)
+        {
+            writer.Attribute(L"title", m_titleBindMode == BindMode::Value ? std::wstring_view{ m_title } : L"{progressTitle}");
+        }
+
+        writer.Attribute(L"status", m_statusBindMode == BindMode::Value ? std::wstring_view{ m_status } : L"{progressStatus}");
+
+        if (m_valueBindMode == BindMode::Value)
+        {
+            WCHAR value[32]{};
+            THROW_IF_FAILED(StringCchPrintfW(value, ARRAYSIZE(value), L"%g", m_value));
+            writer.EncodedAttribute(L"value", value);
+        }
+        else
+        {
+            writer.EncodedAttribute(L"value", L"{progressValue}");
+        }
+
+        if (m_valueStringOverrideBindMode != BindMode::NotSet)
+        {
+            writer.Attribute(L"valueStringOverride", m_valueStringOverrideBindMode == BindMode::Value ? std::wstring_view{ m_valueStringOverride } : L"{progressValueString}");
+        }
+        writer.EndEmptyElement();
+    }
+
     winrt::hstring AppNotificationProgressBar::ToString()
     {
         HRESULT hr{ S_OK };
@@ -108,16 +136,9 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
 
         try
         {
-            auto title{ wil::str_printf<std::wstring>(L" title='%ls'", m_titleBindMode == BindMode::Value ? m_title.c_str() : L"{progressTitle}") };
-            auto status{ wil::str_printf<std::wstring>(L" status='%ls'", m_statusBindMode == BindMode::Value ? m_status.c_str() : L"{progressStatus}") };
-            auto value{ wil::str_printf<std::wstring>(L" value='%ls'", m_valueBindMode == BindMode::Value ? wil::str_printf<std::wstring>(L"%g", m_value).c_str() : L"{progressValue}") };
-            auto valueStringOverride{ wil::str_printf < std::wstring>(L" valueStringOverride='%ls'", m_valueStringOverrideBindMode == BindMode::Value ? m_valueStringOverride.c_str() : L"{progressValueString}") };
-
-            return wil::str_printf<std::wstring>(L"<progress%ls%ls%ls%ls/>",
-                m_titleBindMode == BindMode::NotSet ? L"" : title.c_str(),
-                status.c_str(),
-                value.c_str(),
-                m_valueStringOverrideBindMode == BindMode::NotSet ? L"" : valueStringOverride.c_str()).c_str();
+            AppNotificationXmlWriter writer;
+            WriteXml(writer);
+            return winrt::hstring{ writer.Result() };
         }
         catch (...)
         {
@@ -3,6 +3,7 @@
 
 #pragma once
 #include "Microsoft.Windows.AppNotifications.Builder.AppNotificationProgressBar.g.h"
+#include "AppNotificationXmlWriter.h"
 
 namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
 {
@@ -40,6 +41,8 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
         // IStringable
         winrt::hstring ToString();
 
+        void WriteXml(AppNotificationXmlWriter& writer);
+
     private:
         enum class BindMode {NotSet, Bind, Value};
 
@@ -0,0 +1,99 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include "AppNotificationTemplate.h"
+#include "Microsoft.Windows.AppNotifications.Builder.AppNotificationTemplate.g.cpp"
+#include "AppNotificationBuilderUtility.h"
+
+namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
+{
+    static AppNotificationEscaping::EscapeTable const& GetEscapeTable(AppNotificationSlotEscaping escaping)
+    {
+        return (escaping == AppNotificationSlotEscaping::Argument) ? AppNotificationEscaping::c_argumentEscapes : AppNotificationEscaping::c_xmlEscapes;
+    }
+
+    AppNotificationTemplate::AppNotificationTemplate(std::wstring_view payload, std::vector<AppNotificationSlot> const& slots, winrt::hstring const& tag, winrt::hstring const& group) :
+        m_tag(tag),
+        m_group(group)
+    {
+        m_segments.reserve(slots.size() + 1);
+        m_slots.reserve(slots.size());
+
+        size_t segmentStart{};
+        for (auto const& slot : slots)
+        {
+            m_segments.emplace_back(payload.substr(segmentStart, slot.offset - segmentStart));
+            m_literalLength += m_segments.back().size();
+            segmentStart = slot.offset + slot.length;
+
+            const auto name{ std::find(m_slotNames.begin(), m_slotNames.end(), slot.name) };
+            const auto nameIndex{ static_cast<size_t>(name - m_slotNames.begin()) };
+            if (name == m_slotNames.end())
+            {
+                m_slotNames.emplace_back(slot.name);
+            }
+            m_slots.push_back({ nameIndex, slot.escaping, slot.wholeArgumentValue });
+        }
+        m_segments.emplace_back(payload.substr(segmentStart));
+        m_literalLength += m_segments.back().size();
+    }
+
+    winrt::Windows::Foundation::Collections::IVectorView<winrt::hstring> AppNotificationTemplate::SlotNames()
+    {
+        return winrt::single_threaded_vector<winrt::hstring>(std::vector<winrt::hstring>{ m_slotNames }).GetView();
+    }
+
+    std::wstring AppNotificationTemplate::FillSlots(std::vector<std::wstring_view> const& values) const
+    {
+        // Size the payload exactly so it's allocated once
+        size_t length{ m_literalLength };
+        for (auto const& slot : m_slots)
+        {
+            auto const& value{ values[slot.nameIndex] };
+            length += AppNotificationEscaping::EncodedLength(value, GetEscapeTable(slot.escaping));
+            length -= (slot.wholeArgumentValue && value.empty()) ? 1 : 0;
+        }
+
+        std::wstring payload;
+        payload.reserve(length);
+        for (size_t index = 0; index < m_slots.size(); ++index)
+        {
+            auto const& slot{ m_slots[index] };
+            auto const& value{ values[slot.nameIndex] };
+            std::wstring_view segment{ m_segments[index] };
+            if (slot.wholeArgumentValue && value.empty())
+            {
+                // A bare key, as the builder writes it: drop the segment's trailing '='
+                segment.remove_suffix(1);
+            }
+            payload.append(segment);
+            AppNotificationEscaping::AppendEncoded(payload, value, GetEscapeTable(slot.escaping));
+        }
+        payload.append(m_segments.back());
+        return payload;
+    }
+
+    winrt::Microsoft::Windows::AppNotifications::AppNotification AppNotificationTemplate::Instantiate(winrt::Windows::Foundation::Collections::IMapView<winrt::hstring, winrt::hstring> const& values)
+    {
+        THROW_HR_IF_NULL(E_INVALIDARG, values);
+
+        // Keep the looked-up strings alive while the payload is assembled from views of them
+        std::vector<winrt::hstring> slotValues;
+        slotValues.reserve(m_slotNames.size());
+        for (auto const& name : m_slotNames)
+        {
+            THROW_HR_IF_MSG(E_INVALIDARG, !values.HasKey(name), "No value for slot %ls", name.c_str());
+            slotValues.push_back(values.Lookup(name));
+        }
+        const std::vector<std::wstring_view> slotValueViews(slotValues.begin(), slotValues.end());
+
+        const auto payload{ FillSlots(slotValueViews) };
+        THROW_HR_IF_MSG(E_FAIL, payload.size() > c_maxAppNotificationPayload, "Maximum payload size exceeded");
+
+        winrt::Microsoft::Windows::AppNotifications::AppNotification appNotification{ winrt::hstring{ payload } };
+        appNotification.Tag(m_tag);
+        appNotification.Group(m_group);
+        return appNotification;
+    }
+}
@@ -0,0 +1,39 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#pragma once
+#include "Microsoft.Windows.AppNotifications.Builder.AppNotificationTemplate.g.h"
+#include "AppNotificationXmlWriter.h"
+
+namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
+{
+    // An immutable payload split into literal segments around its slots. The segments are already
+    // escaped, so instantiating only copies them and escapes the slot values.
+    struct AppNotificationTemplate : AppNotificationTemplateT<AppNotificationTemplate>
+    {
+        AppNotificationTemplate(std::wstring_view payload, std::vector<AppNotificationSlot> const& slots, winrt::hstring const& tag, winrt::hstring const& group);
+
+        winrt::Windows::Foundation::Collections::IVectorView<winrt::hstring> SlotNames();
+
+        winrt::Microsoft::Windows::AppNotifications::AppNotification Instantiate(winrt::Windows::Foundation::Collections::IMapView<winrt::hstring, winrt::hstring> const& values);
+
+        // The payload with each slot filled in. values[i] is the value for SlotNames()[i].
+        std::wstring FillSlots(std::vector<std::wstring_view> const& values) const;
+
+    private:
+        struct Slot
+        {
+            size_t nameIndex{};
+            AppNotificationSlotEscaping escaping{};
+            bool wholeArgumentValue{};
+        };
+
+        // m_slots.size() + 1 segments: slot i sits between segments i and i + 1.
+        std::vector<std::wstring> m_segments;
+        std::vector<Slot> m_slots;
+        std::vector<winrt::hstring> m_slotNames;
+        size_t m_literalLength{};
+        winrt::hstring m_tag;
+        winrt::hstring m_group;
+    };
+}
@@ -26,6 +26,23 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
         return *this;
     }
 
+    void AppNotificationTextProperties::WriteStartTag(AppNotificationXmlWriter& writer, winrt::hstring const& language, int maxLines, bool useCallScenarioAlign)
+    {
+        writer.StartElement(L"text");
+        if (!language.empty())
+        {
+            writer.Attribute(L"lang", language);
+        }
+        if (maxLines)
+        {
+            writer.EncodedAttribute(L"hint-maxLines", std::to_wstring(maxLines));
+        }
+        if (useCallScenarioAlign)
+        {
+            writer.EncodedAttribute(L"hint-callScenarioCenterAlign", L"true");
+        }
+    }
+
     winrt::hstring AppNotificationTextProperties::ToString()
     {
         HRESULT hr{ S_OK };
@@ -36,11 +53,10 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
 
         try
         {
-            std::wstring language{ !m_language.empty() ? wil::str_printf<std::wstring>(L" lang='%ls'", m_language.c_str()) : L""};
-            std::wstring callScenarioAlign{ m_useCallScenarioAlign ? L" hint-callScenarioCenterAlign='true'" : L""};
-            std::wstring hintMaxLines{ m_maxLines ? wil::str_printf<std::wstring>(L" hint-maxLines='%d'", m_maxLines) : L"" };
-
-            return wil::str_printf<std::wstring>(L"<text%ls%ls%ls>", language.c_str(), hintMaxLines.c_str(), callScenarioAlign.c_str()).c_str();
+            AppNotificationXmlWriter writer;
+            WriteStartTag(writer, m_language, m_maxLines, m_useCallScenarioAlign);
+            writer.EndStartTag();
+            return winrt::hstring{ writer.Result() };
         }
         catch (...)
         {
@@ -3,6 +3,7 @@
 
 #pragma once
 #include "Microsoft.Windows.AppNotifications.Builder.AppNotificationTextProperties.g.h"
+#include "AppNotificationXmlWriter.h"
 
 namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
 {
@@ -30,6 +31,9 @@ namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
         // IStringable
         winrt::hstring ToString();
 
+        // Writes the <text> start tag with the given properties, leaving it open for attributes.
+        static void WriteStartTag(AppNotificationXmlWriter& writer, winrt::hstring const& language, int maxLines, bool useCallScenarioAlign);
+
     private:
         int m_maxLines{ 0 };
         winrt::hstring m_language{};
@@ -0,0 +1,224 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include "AppNotificationEscaping.h"
+
+namespace winrt::Microsoft::Windows::AppNotifications::Builder::implementation
+{
+    enum class AppNotificationSlotEscaping : uint8_t
+    {
+        Xml,        // text and attribute values
+        Argument,   // launch argument keys and values
+    };
+
+    // A {{name}} placeholder found in the payload while building an AppNotificationTemplate.
+    struct AppNotificationSlot
+    {
+        size_t offset{};
+        size_t length{};
+        std::wstring name;
+        AppNotificationSlotEscaping escaping{};
+
+        // The whole value of a launch argument. Filled with "" it takes the '=' before it too, since the
+        // builder writes a bare key for an empty value.
+        bool wholeArgumentValue{};
+    };
+
+    // Streams an app notification payload into a single buffer, escaping text and attribute values as
+    // they're appended. Attributes are single-quoted to match the payloads the builder has always produced.
+    //
+    //     writer.StartElement(L"image").Attribute(L"src", uri).EndEmptyElement();    // <image src='...'/>
+    //     writer.StartElement(L"text").Text(text).EndElement(L"text");               // <text>...</text>
+    class AppNotificationXmlWriter
+    {
+    public:
+        // buffer may be one handed back by ReleaseBuffer, to reuse its capacity.
+        explicit AppNotificationXmlWriter(size_t estimatedLength = 0, std::wstring buffer = {}) :
+            m_buffer{ std::move(buffer) }
+        {
+            m_buffer.clear();
+            m_buffer.reserve(estimatedLength);
+        }
+
+        AppNotificationXmlWriter& StartElement(std::wstring_view name)
+        {
+            EndStartTag();
+            m_buffer.push_back(L'<');
+            m_buffer.append(name);
+            m_startTagOpen = true;
+            return *this;
+        }
+
+        AppNotificationXmlWriter& Attribute(std::wstring_view name, std::wstring_view value)
+        {
+            StartAttribute(name);
+            const auto valueStart{ m_buffer.size() };
+            AppendEncodedXml(value);
+            FindSlots(valueStart, AppNotificationSlotEscaping::Xml);
+            m_buffer.push_back(L'\'');
+            return *this;
+        }
+
+        // For values that are already encoded, e.g. launch arguments.
+        AppNotificationXmlWriter& EncodedAttribute(std::wstring_view name, std::wstring_view value)
+        {
+            StartAttribute(name);
+            m_buffer.append(value);
+            m_buffer.push_back(L'\'');
+            return *this;
+        }
+
+        // Launch arguments: key=value pairs (or a bare key when the value's empty) joined by ';'.
+        // Keys and values are already encoded by EncodeArgument.
+        AppNotificationXmlWriter& ArgumentsAttribute(std::wstring_view name, winrt::Windows::Foundation::Collections::IMap<winrt::hstring, winrt::hstring> const& arguments)
+        {
+            StartAttribute(name);
+            const auto valueStart{ m_buffer.size() };
+            bool first{ true };
+            for (auto pair : arguments)
+            {
+                if (!first)
+                {
+                    m_buffer.push_back(L';');
+                }
+                first = false;
+
+                m_buffer.append(pair.Key());
+                if (!pair.Value().empty())
+                {
+                    m_buffer.push_back(L'=');
+                    m_buffer.append(pair.Value());
+                }
+            }
+            const auto slotCount{ m_slots.size() };
+            FindSlots(valueStart, AppNotificationSlotEscaping::Argument);
+            for (auto slot{ m_slots.begin() + slotCount }; slot != m_slots.end(); ++slot)
+            {
+                // Keys and values can't contain a raw '=' or ';', so these are the pair's own separators.
+                const auto end{ slot->offset + slot->length };
+                slot->wholeArgumentValue = (m_buffer[slot->offset - 1] == L'=') && ((end == m_buffer.size()) || (m_buffer[end] == L';'));
+            }
+            m_buffer.push_back(L'\'');
+            return *this;
+        }
+
+        AppNotificationXmlWriter& Text(std::wstring_view value)
+        {
+            EndStartTag();
+            const auto valueStart{ m_buffer.size() };
+            AppendEncodedXml(value);
+            FindSlots(valueStart, AppNotificationSlotEscaping::Xml);
+            return *this;
+        }
+
+        // Closes the open start tag, if any. Content and EndElement do this implicitly.
+        AppNotificationXmlWriter& EndStartTag()
+        {
+            if (m_startTagOpen)
+            {
+                m_buffer.push_back(L'>');
+                m_startTagOpen = false;
+            }
+            return *this;
+        }
+
+        AppNotificationXmlWriter& EndElement(std::wstring_view name)
+        {
+            EndStartTag();
+            m_buffer.append(L"</");
+            m_buffer.append(name);
+            m_buffer.push_back(L'>');
+            return *this;
+        }
+
+        // Closes the open start tag as an empty element: <name .../>
+        AppNotificationXmlWriter& EndEmptyElement()
+        {
+            m_buffer.append(L"/>");
+            m_startTagOpen = false;
+            return *this;
+        }
+
+        size_t Size() const
+        {
+            return m_buffer.size();
+        }
+
+        std::wstring_view Result() const
+        {
+            return m_buffer;
+        }
+
+        // Hands the buffer back for reuse. Nothing more can be written after this.
+        std::wstring ReleaseBuffer()
+        {
+            return std::move(m_buffer);
+        }
+
+        // Records the {{name}} placeholders in text, attribute and launch argument values from here on.
+        // Names are ASCII letters, digits and '_'; none of those or the braces are ever escaped, so each
+        // placeholder appears verbatim in the payload.
+        void RecordSlots()
+        {
+            m_recordSlots = true;
+        }
+
+        std::vector<AppNotificationSlot> const& Slots() const
+        {
+            return m_slots;
+        }
+
+    private:
+        void StartAttribute(std::wstring_view name)
+        {
+            m_buffer.push_back(L' ');
+            m_buffer.append(name);
+            m_buffer.append(L"='");
+        }
+
+        void AppendEncodedXml(std::wstring_view value)
+        {
+            AppNotificationEscaping::AppendEncoded(m_buffer, value, AppNotificationEscaping::c_xmlEscapes);
+        }
+
+        static bool IsSlotNameCharacter(wchar_t ch)
+        {
+            return ((ch >= L'a') && (ch <= L'z')) || ((ch >= L'A') && (ch <= L'Z')) || ((ch >= L'0') && (ch <= L'9')) || (ch == L'_');
+        }
+
+        // Scans the value just written, from valueStart to the end of the buffer, for placeholders.
+        void FindSlots(size_t valueStart, AppNotificationSlotEscaping escaping)
+        {
+            if (!m_recordSlots)
+            {
+                return;
+            }
+
+            const std::wstring_view payload{ m_buffer };
+            for (auto open{ payload.find(L"{{", valueStart) }; open != std::wstring_view::npos; open = payload.find(L"{{", open + 1))
+            {
+                auto nameEnd{ open + 2 };
+                while ((nameEnd < payload.size()) && IsSlotNameCharacter(payload[nameEnd]))
+                {
+                    ++nameEnd;
+                }
+                if ((nameEnd == open + 2) || (payload.substr(nameEnd, 2) != L"}}"))
+                {
+                    continue;
+                }
+
+                m_slots.push_back({ open, nameEnd + 2 - open, std::wstring{ payload.substr(open + 2, nameEnd - open - 2) }, escaping });
+                open = nameEnd + 1;
+            }
+        }
+
+        std::wstring m_buffer;
+        bool m_startTagOpen{};
+        bool m_recordSlots{};
+        std::vector<AppNotificationSlot> m_slots;
+    };
+}
@@ -511,6 +511,11 @@ namespace winrt::Microsoft::Windows::AppNotifications::implementation
         HRESULT hr{ S_OK };
 
         auto strong = get_strong();
+
+        // Snapshot the data before going async; the caller may reuse it for its next update while this one is pending
+        const auto sequenceNumber{ data.SequenceNumber() };
+        winrt::com_ptr<ToastABI::IToastProgressData> toastProgressData{ winrt::make_self<NotificationProgressData>(data) };
+
         co_await resume_background();
 
         auto logTelemetry{ wil::scope_exit([&]() {
@@ -519,9 +524,44 @@ namespace winrt::Microsoft::Windows::AppNotifications::implementation
 
         try
         {
-            winrt::com_ptr<ToastABI::IToastProgressData> toastProgressData{ winrt::make_self<NotificationProgressData>(data) };
+            auto waiter{ std::make_shared<ProgressUpdateWaiter>() };
+            bool coalesce{};
+            bool dueNow{};
+            {
+                auto lock{ m_progressUpdateLock.lock_exclusive() };
+                coalesce = (m_progressUpdates.Interval() > ProgressUpdateCoalescer::Clock::duration::zero());
+                if (coalesce)
+                {
+                    // Updates that aren't due yet are applied by the manager's timer rather than by the caller that
+                    // opened the window, so any caller can be cancelled without stranding the others folded into it.
+                    CreateProgressUpdateTimerIfNeeded();
+                    const auto now{ ProgressUpdateCoalescer::Clock::now() };
+                    if (const auto due{ m_progressUpdates.Submit({ tag.c_str(), group.c_str() }, sequenceNumber, toastProgressData, waiter, now) })
+                    {
+                        dueNow = (*due <= now);
+                        if (!dueNow)
+                        {
+                            ScheduleProgressUpdateFlush(*due);
+                        }
+                    }
+                }
+            }
+
+            if (!coalesce)
+            {
+                hr = ToastNotifications_UpdateNotificationData(m_appId.c_str(), tag.c_str(), group.c_str(), toastProgressData.get());
+            }
+            else
+            {
+                if (dueNow)
+                {
+                    // Nothing's been applied for this tag and group within the interval, so there's no need to wait
+                    ApplyDueProgressUpdates(ProgressUpdateCoalescer::Clock::now());
+                }
 
-            hr = ToastNotifications_UpdateNotificationData(m_appId.c_str(), tag.c_str(), group.c_str(), toastProgressData.get());
+                co_await winrt::resume_on_signal(waiter->applied.get());
+                hr = waiter->hr;
+            }
 
             if (SUCCEEDED(hr))
             {
@@ -548,6 +588,82 @@ namespace winrt::Microsoft::Windows::AppNotifications::implementation
         co_return co_await UpdateAsync(data, tag, L"");
     }
 
+    void AppNotificationManager::ApplyDueProgressUpdates(ProgressUpdateCoalescer::Clock::time_point now)
+    {
+        std::vector<ProgressUpdateCoalescer::Flush> flushes;
+        {
+            auto lock{ m_progressUpdateLock.lock_exclusive() };
+            flushes = m_progressUpdates.TakeDue(now);
+
+            // Whatever's still pending is due later
+            m_progressUpdateFlushDue.reset();
+            if (const auto next{ m_progressUpdates.NextDue() })
+            {
+                ScheduleProgressUpdateFlush(*next);
+            }
+        }
+
+        for (auto const& flush : flushes)
+        {
+            const HRESULT hr{ ToastNotifications_UpdateNotificationData(m_appId.c_str(), flush.key.first.c_str(), flush.key.second.c_str(), flush.update.get()) };
+            for (auto const& waiter : flush.waiters)
+            {
+                waiter->hr = hr;
+                waiter->applied.SetEvent();
+            }
+        }
+    }
+
+    void AppNotificationManager::CreateProgressUpdateTimerIfNeeded()
+    {
+        if (m_progressUpdateTimer)
+        {
+            return;
+        }
+
+        m_progressUpdateTimer.reset(CreateThreadpoolTimer(
+            [](PTP_CALLBACK_INSTANCE, _Inout_ PVOID appNotificationManagerPtr, _Inout_ PTP_TIMER)
+            {
+                try
+                {
+                    reinterpret_cast<AppNotificationManager*>(appNotificationManagerPtr)->ApplyDueProgressUpdates(ProgressUpdateCoalescer::Clock::now());
+                }
+                CATCH_LOG();
+            },
+            this,
+            nullptr));
+        THROW_LAST_ERROR_IF_NULL(m_progressUpdateTimer);
+    }
+
+    void AppNotificationManager::ScheduleProgressUpdateFlush(ProgressUpdateCoalescer::Clock::time_point due)
+    {
+        if (m_progressUpdateFlushDue && (*m_progressUpdateFlushDue <= due))
+        {
+            return;
+        }
+        m_progressUpdateFlushDue = due;
+
+        // Negative times in SetThreadpoolTimer are relative. Round up so it doesn't fire before the update's due.
+        const auto delay{ (std::max)(due - ProgressUpdateCoalescer::Clock::now(), ProgressUpdateCoalescer::Clock::duration::zero()) };
+        FILETIME dueTime{};
+        *reinterpret_cast<PLONGLONG>(&dueTime) = -static_cast<LONGLONG>(std::chrono::ceil<winrt::TimeSpan>(delay).count());
+        SetThreadpoolTimer(m_progressUpdateTimer.get(), &dueTime, 0, 0);
+    }
+
+    winrt::Windows::Foundation::TimeSpan AppNotificationManager::ProgressUpdateInterval()
+    {
+        auto lock{ m_progressUpdateLock.lock_shared() };
+        return std::chrono::duration_cast<winrt::TimeSpan>(m_progressUpdates.Interval());
+    }
+
+    void AppNotificationManager::ProgressUpdateInterval(winrt::Windows::Foundation::TimeSpan const& value)
+    {
+        THROW_HR_IF_MSG(E_INVALIDARG, value < winrt::TimeSpan::zero(), "ProgressUpdateInterval can't be negative");
+
+        auto lock{ m_progressUpdateLock.lock_exclusive() };
+        m_progressUpdates.Interval(value);
+    }
+
     winrt::Microsoft::Windows::AppNotifications::AppNotificationSetting AppNotificationManager::Setting()
     {
         if (!IsSupported())
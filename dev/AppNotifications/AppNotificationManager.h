@@ -7,6 +7,8 @@
 #include "AppNotificationUtility.h"
 #include "externs.h"
 #include "ShellLocalization.h"
+#include "ProgressUpdateCoalescer.h"
+#include <FrameworkUdk/toastnotificationsrt.h>
 
 constexpr PCWSTR c_appNotificationContractId = L"Windows.Toast";
 
@@ -32,6 +34,8 @@ namespace winrt::Microsoft::Windows::AppNotifications::implementation
         void Show(winrt::Microsoft::Windows::AppNotifications::AppNotification const& notification);
         winrt::Windows::Foundation::IAsyncOperation<winrt::Microsoft::Windows::AppNotifications::AppNotificationProgressResult> UpdateAsync(winrt::Microsoft::Windows::AppNotifications::AppNotificationProgressData const data, hstring const tag, hstring const group);
         winrt::Windows::Foundation::IAsyncOperation<winrt::Microsoft::Windows::AppNotifications::AppNotificationProgressResult> UpdateAsync(winrt::Microsoft::Windows::AppNotifications::AppNotificationProgressData const data, hstring const tag);
+        winrt::Windows::Foundation::TimeSpan ProgressUpdateInterval();
+        void ProgressUpdateInterval(winrt::Windows::Foundation::TimeSpan const& value);
         winrt::Microsoft::Windows::AppNotifications::AppNotificationSetting Setting();
         winrt::Windows::Foundation::IAsyncAction RemoveByIdAsync(uint32_t notificationId);
         winrt::Windows::Foundation::IAsyncAction RemoveByTagAsync(hstring const tag);
@@ -58,6 +62,21 @@ namespace winrt::Microsoft::Windows::AppNotifications::implementation
 
         void UnregisterHelper();
 
+        // A caller waiting for a coalesced progress update to be applied.
+        struct ProgressUpdateWaiter
+        {
+            wil::unique_event applied{ wil::EventOptions::ManualReset };
+            HRESULT hr{ S_OK };
+        };
+        using ProgressUpdateCoalescer = ::Microsoft::Windows::AppNotifications::Helpers::ProgressUpdateCoalescer<
+            winrt::com_ptr<::ABI::Microsoft::Internal::ToastNotifications::IToastProgressData>, std::shared_ptr<ProgressUpdateWaiter>>;
+
+        void ApplyDueProgressUpdates(ProgressUpdateCoalescer::Clock::time_point now);
+
+        // Both called with m_progressUpdateLock held.
+        void CreateProgressUpdateTimerIfNeeded();
+        void ScheduleProgressUpdateFlush(ProgressUpdateCoalescer::Clock::time_point due);
+
         wil::unique_com_class_object_cookie m_notificationComActivatorRegistration;
         wil::srwlock m_lock;
         winrt::event<NotificationActivationEventHandler> m_notificationHandlers;
@@ -67,6 +86,12 @@ namespace winrt::Microsoft::Windows::AppNotifications::implementation
         winrt::Microsoft::Windows::AppNotifications::AppNotificationActivatedEventArgs m_activatedEventArgs{ nullptr };
         std::wstring m_appId;
         bool m_registering{ false };
+        wil::srwlock m_progressUpdateLock;
+        ProgressUpdateCoalescer m_progressUpdates;
+        std::optional<ProgressUpdateCoalescer::Clock::time_point> m_progressUpdateFlushDue;
+
+        // Declared last so it's closed, waiting out any running callback, before the state it flushes goes.
+        wil::unique_threadpool_timer m_progressUpdateTimer;
     };
 
     struct AppNotificationManagerFactory : winrt::implements<AppNotificationManagerFactory, IClassFactory>
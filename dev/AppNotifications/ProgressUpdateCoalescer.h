@@ -0,0 +1,134 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Microsoft::Windows::AppNotifications::Helpers
+{
+    // Rate limits progress updates per (tag, group) so each notification is updated at most once per interval.
+    //
+    // An update for a key that hasn't been flushed within the interval is due immediately. Updates arriving
+    // sooner are held until the interval has passed; only the one with the greatest sequence number is kept,
+    // since the platform would display that one anyway, and every caller whose update was folded into it (its
+    // waiter) gets that flush's result. Nothing here touches the clock: callers pass the time in, so the policy
+    // can be tested against a fake clock.
+    template <typename Update, typename Waiter>
+    class ProgressUpdateCoalescer
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using Key = std::pair<std::wstring, std::wstring>; // tag, group
+
+        struct Flush
+        {
+            Key key;
+            Update update;
+            std::vector<Waiter> waiters;
+        };
+
+        explicit ProgressUpdateCoalescer(Clock::duration interval = Clock::duration::zero()) :
+            m_interval(interval)
+        {
+        }
+
+        Clock::duration Interval() const
+        {
+            return m_interval;
+        }
+
+        // Applies to updates submitted from now on; those already pending keep their due time.
+        void Interval(Clock::duration interval)
+        {
+            m_interval = interval;
+        }
+
+        // Queues an update for key. If this opens a new pending update for the key, returns the time it's due and
+        // the caller is responsible for calling TakeDue at or after that time (NextDue tracks that across keys). Otherwise the update joins the
+        // pending one (replacing it if its sequence number is greater) and std::nullopt is returned.
+        std::optional<Clock::time_point> Submit(Key const& key, uint32_t sequenceNumber, Update update, Waiter waiter, Clock::time_point now)
+        {
+            auto& entry{ m_entries[key] };
+            entry.waiters.push_back(std::move(waiter));
+
+            if (entry.update)
+            {
+                if (sequenceNumber > entry.sequenceNumber)
+                {
+                    entry.sequenceNumber = sequenceNumber;
+                    entry.update = std::move(update);
+                }
+                return std::nullopt;
+            }
+
+            entry.sequenceNumber = sequenceNumber;
+            entry.update = std::move(update);
+            entry.due = (entry.lastFlush && (now < *entry.lastFlush + m_interval)) ? (*entry.lastFlush + m_interval) : now;
+            return entry.due;
+        }
+
+        // Removes and returns the pending updates due by now. Keys with nothing pending that haven't been
+        // flushed within the interval are forgotten, as their next update will be due immediately anyway.
+        std::vector<Flush> TakeDue(Clock::time_point now)
+        {
+            std::vector<Flush> flushes;
+            for (auto entry{ m_entries.begin() }; entry != m_entries.end();)
+            {
+                auto& [key, state] { *entry };
+                if (state.update && (state.due <= now))
+                {
+                    flushes.push_back({ key, std::move(*state.update), std::move(state.waiters) });
+                    state.update.reset();
+                    state.waiters.clear();
+                    state.lastFlush = now;
+                }
+                else if (!state.update && (!state.lastFlush || (*state.lastFlush + m_interval <= now)))
+                {
+                    entry = m_entries.erase(entry);
+                    continue;
+                }
+                ++entry;
+            }
+            return flushes;
+        }
+
+        // The earliest due time of the pending updates, if there are any.
+        std::optional<Clock::time_point> NextDue() const
+        {
+            std::optional<Clock::time_point> next;
+            for (auto const& [key, state] : m_entries)
+            {
+                if (state.update && (!next || (state.due < *next)))
+                {
+                    next = state.due;
+                }
+            }
+            return next;
+        }
+
+        // The number of keys being tracked, with or without a pending update.
+        size_t Size() const
+        {
+            return m_entries.size();
+        }
+
+    private:
+        struct Entry
+        {
+            std::optional<Update> update;
+            uint32_t sequenceNumber{};
+            std::vector<Waiter> waiters;
+            Clock::time_point due{};
+            std::optional<Clock::time_point> lastFlush;
+        };
+
+        Clock::duration m_interval;
+        std::map<Key, Entry> m_entries;
+    };
+}
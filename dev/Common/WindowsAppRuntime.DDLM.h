@@ -0,0 +1,196 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#ifndef __WINDOWSAPPRUNTIME_DDLM_H
+#define __WINDOWSAPPRUNTIME_DDLM_H
+
+#include <appmodel.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <AppModel.Identity.h>
+
+/// Dynamic Dependency Lifetime Manager (DDLM) selection.
+///
+/// Finding a DDLM is split into fetching candidates from the system (AppExtension catalogs,
+/// package enumeration) and selecting among them. Everything here is the selection half:
+/// no I/O, no WinRT calls, just parsing and ordering data the caller already fetched.
+namespace WindowsAppRuntime::DDLM
+{
+/// A DDLM under consideration. index is the candidate's position in the
+/// caller's source collection, for mapping a selection back to its origin.
+struct Candidate
+{
+    PACKAGE_VERSION version{};
+    winrt::Windows::System::ProcessorArchitecture architecture{ winrt::Windows::System::ProcessorArchitecture::Unknown };
+    UINT32 index{};
+};
+
+/// Parse a decimal UINT16 at text, advancing text past the digits.
+inline bool ParseUInt16(PCWSTR& text, UINT16& value)
+{
+    UINT32 number{};
+    PCWSTR digit{ text };
+    for (; (L'0' <= *digit) && (*digit <= L'9'); ++digit)
+    {
+        number = (number * 10) + (*digit - L'0');
+        if (number > MAXUINT16)
+        {
+            return false;
+        }
+    }
+    if (digit == text)
+    {
+        return false;
+    }
+    value = static_cast<UINT16>(number);
+    text = digit;
+    return true;
+}
+
+/// Parse a dotted version "<major>.<minor>.<build>.<revision>" at text, advancing text past it.
+inline bool ParseVersion(PCWSTR& text, PACKAGE_VERSION& version)
+{
+    PCWSTR p{ text };
+    PACKAGE_VERSION parsed{};
+    if (!ParseUInt16(p, parsed.Major) || (*p++ != L'.') ||
+        !ParseUInt16(p, parsed.Minor) || (*p++ != L'.') ||
+        !ParseUInt16(p, parsed.Build) || (*p++ != L'.') ||
+        !ParseUInt16(p, parsed.Revision))
+    {
+        return false;
+    }
+    version = parsed;
+    text = p;
+    return true;
+}
+
+/// Parse a DDLM AppExtension.Id == "ddlm-<major.minor.build.revision>-<architecture>".
+/// An unrecognized architecture parses as ProcessorArchitecture::Unknown.
+inline bool ParseAppExtensionId(PCWSTR id, PACKAGE_VERSION& version, winrt::Windows::System::ProcessorArchitecture& architecture)
+{
+    PCWSTR c_prefix{ L"ddlm-" };
+    const size_t c_prefixLength{ 5 };
+    const size_t c_maxArchitectureLength{ 9 };
+    if (wcsncmp(id, c_prefix, c_prefixLength) != 0)
+    {
+        return false;
+    }
+    PCWSTR p{ id + c_prefixLength };
+    PACKAGE_VERSION parsed{};
+    if (!ParseVersion(p, parsed) || (*p++ != L'-'))
+    {
+        return false;
+    }
+    const auto architectureLength{ wcslen(p) };
+    if ((architectureLength == 0) || (architectureLength > c_maxArchitectureLength))
+    {
+        return false;
+    }
+    version = parsed;
+    architecture = AppModel::Identity::ParseArchitecture(p);
+    return true;
+}
+
+/// Parse the release marker file in a DDLM package, "Microsoft.WindowsAppRuntime.Release!<major>.<minor>".
+inline bool ParseReleaseFilename(PCWSTR filename, UINT16& majorVersion, UINT16& minorVersion)
+{
+    PCWSTR c_prefix{ L"Microsoft.WindowsAppRuntime.Release!" };
+    const int c_prefixLength{ 36 };
+    if ((static_cast<int>(wcsnlen(filename, c_prefixLength)) < c_prefixLength) ||
+        (CompareStringOrdinal(filename, c_prefixLength, c_prefix, c_prefixLength, TRUE) != CSTR_EQUAL))
+    {
+        return false;
+    }
+    PCWSTR p{ filename + c_prefixLength };
+    UINT16 major{};
+    UINT16 minor{};
+    if (!ParseUInt16(p, major) || (*p++ != L'.') || !ParseUInt16(p, minor))
+    {
+        return false;
+    }
+    majorVersion = major;
+    minorVersion = minor;
+    return true;
+}
+
+/// Does the package Name start with prefix and end with suffix (case-insensitive)?
+inline bool IsPackageNameMatch(
+    PCWSTR name,
+    const size_t nameLength,
+    PCWSTR prefix,
+    const size_t prefixLength,
+    PCWSTR suffix,
+    const size_t suffixLength)
+{
+    if (nameLength < prefixLength + suffixLength)
+    {
+        return false;
+    }
+    if (CompareStringOrdinal(name, static_cast<int>(prefixLength), prefix, static_cast<int>(prefixLength), TRUE) != CSTR_EQUAL)
+    {
+        return false;
+    }
+    if (suffixLength > 0)
+    {
+        const auto offsetToSuffix{ nameLength - suffixLength };
+        if (CompareStringOrdinal(name + offsetToSuffix, static_cast<int>(suffixLength), suffix, static_cast<int>(suffixLength), TRUE) != CSTR_EQUAL)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Does the candidate satisfy the minVersion and architecture criteria?
+inline bool IsApplicable(
+    const Candidate& candidate,
+    const PACKAGE_VERSION minVersion,
+    const winrt::Windows::System::ProcessorArchitecture architecture)
+{
+    return (candidate.version.Version >= minVersion.Version) && (candidate.architecture == architecture);
+}
+
+/// Sort candidates by version in descending order. Equal versions keep their source order.
+inline void SortByVersionDescending(std::vector<Candidate>& candidates)
+{
+    std::stable_sort(candidates.begin(), candidates.end(),
+        [](const Candidate& lhs, const Candidate& rhs) { return lhs.version.Version > rhs.version.Version; });
+}
+
+/// Reduce candidates to the applicable ones, best fit first.
+///
+/// The best fit is the highest version meeting the criteria; among equal versions the earliest
+/// in source order wins. Callers needing an extra (expensive) check per candidate walk the result
+/// in order and stop at the first that passes, rather than checking every candidate up front.
+inline void SelectApplicable(
+    std::vector<Candidate>& candidates,
+    const PACKAGE_VERSION minVersion,
+    const winrt::Windows::System::ProcessorArchitecture architecture)
+{
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+        [&](const Candidate& candidate) { return !IsApplicable(candidate, minVersion, architecture); }), candidates.end());
+    SortByVersionDescending(candidates);
+}
+
+/// Return the best fit among candidates (see SelectApplicable) or nullptr if none are applicable.
+inline const Candidate* FindBestFit(
+    const std::vector<Candidate>& candidates,
+    const PACKAGE_VERSION minVersion,
+    const winrt::Windows::System::ProcessorArchitecture architecture)
+{
+    const Candidate* bestFit{};
+    for (const auto& candidate : candidates)
+    {
+        if (IsApplicable(candidate, minVersion, architecture) &&
+            (!bestFit || (bestFit->version.Version < candidate.version.Version)))
+        {
+            bestFit = &candidate;
+        }
+    }
+    return bestFit;
+}
+}
+
+#endif // __WINDOWSAPPRUNTIME_DDLM_H
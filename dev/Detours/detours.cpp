@@ -1158,17 +1158,32 @@ inline ULONG detour_is_code_filler(PBYTE pbCode)
 struct DETOUR_REGION
 {
     ULONG               dwSignature;
+    ULONG               cFree;  // Number of trampolines on pFree.
     DETOUR_REGION *     pNext;  // Next region in list of regions.
     DETOUR_TRAMPOLINE * pFree;  // List of free trampolines in this region.
 };
 typedef DETOUR_REGION * PDETOUR_REGION;
 
+C_ASSERT(sizeof(DETOUR_REGION) <= sizeof(DETOUR_TRAMPOLINE));
+
 const ULONG DETOUR_REGION_SIGNATURE = 'Rrtd';
 const ULONG DETOUR_REGION_SIZE = 0x10000;
 const ULONG DETOUR_TRAMPOLINES_PER_REGION = (DETOUR_REGION_SIZE
                                              / sizeof(DETOUR_TRAMPOLINE)) - 1;
+// The first two trampoline slots of a region are never handed out.
+const ULONG DETOUR_TRAMPOLINES_USABLE_PER_REGION = DETOUR_TRAMPOLINES_PER_REGION - 2;
 static PDETOUR_REGION s_pRegions = NULL;            // List of all regions.
 static PDETOUR_REGION s_pRegion = NULL;             // Default region.
+static ULONG s_cRegions = 0;                        // Number of regions in s_pRegions.
+static ULONG s_cEmptyRegions = 0;                   // Regions with no trampolines in use.
+
+// Regions with at least one free trampoline, sorted by address so that a
+// region within the jump bounds of a target can be found with a binary
+// search rather than a walk of every region.  The index always has room
+// for every region, so adding a region back to it cannot fail.
+static PDETOUR_REGION * s_rpFreeRegions = NULL;
+static ULONG s_cFreeRegions = 0;
+static ULONG s_cFreeRegionsMax = 0;
 
 static DWORD detour_writable_trampoline_regions()
 {
@@ -1374,6 +1389,88 @@ PVOID WINAPI DetourAllocateRegionWithinJumpBounds(_In_ LPCVOID pbTarget,
     return pbNewlyAllocated;
 }
 
+// Returns the position of the first region in the free region index whose
+// address is at or above pbLo.
+static ULONG detour_find_free_region_index(ULONG_PTR pbLo)
+{
+    ULONG nLo = 0;
+    ULONG nHi = s_cFreeRegions;
+    while (nLo < nHi) {
+        ULONG nMid = nLo + (nHi - nLo) / 2;
+        if ((ULONG_PTR)s_rpFreeRegions[nMid] < pbLo) {
+            nLo = nMid + 1;
+        }
+        else {
+            nHi = nMid;
+        }
+    }
+    return nLo;
+}
+
+static void detour_insert_free_region(PDETOUR_REGION pRegion)
+{
+    // Capacity is reserved when the region is allocated.
+    ULONG n = detour_find_free_region_index((ULONG_PTR)pRegion);
+    memmove(&s_rpFreeRegions[n + 1], &s_rpFreeRegions[n],
+            (s_cFreeRegions - n) * sizeof(s_rpFreeRegions[0]));
+    s_rpFreeRegions[n] = pRegion;
+    s_cFreeRegions++;
+}
+
+static void detour_remove_free_region(PDETOUR_REGION pRegion)
+{
+    ULONG n = detour_find_free_region_index((ULONG_PTR)pRegion);
+    if (n < s_cFreeRegions && s_rpFreeRegions[n] == pRegion) {
+        s_cFreeRegions--;
+        memmove(&s_rpFreeRegions[n], &s_rpFreeRegions[n + 1],
+                (s_cFreeRegions - n) * sizeof(s_rpFreeRegions[0]));
+    }
+}
+
+static BOOL detour_reserve_free_regions(ULONG cRegions)
+{
+    if (cRegions <= s_cFreeRegionsMax) {
+        return TRUE;
+    }
+
+    ULONG cMax = s_cFreeRegionsMax ? s_cFreeRegionsMax * 2 : 16;
+    if (cMax < cRegions) {
+        cMax = cRegions;
+    }
+
+    PDETOUR_REGION *rpRegions = new NOTHROW PDETOUR_REGION [cMax];
+    if (rpRegions == NULL) {
+        return FALSE;
+    }
+    if (s_rpFreeRegions != NULL) {
+        memcpy(rpRegions, s_rpFreeRegions, s_cFreeRegions * sizeof(s_rpFreeRegions[0]));
+        delete[] s_rpFreeRegions;
+    }
+    s_rpFreeRegions = rpRegions;
+    s_cFreeRegionsMax = cMax;
+    return TRUE;
+}
+
+static PDETOUR_REGION detour_find_free_region(PDETOUR_TRAMPOLINE pLo,
+                                              PDETOUR_TRAMPOLINE pHi)
+{
+    // A region starting up to one region size below pLo may still have its
+    // free block above pLo, so start the search there.
+    ULONG_PTR pbLo = (ULONG_PTR)pLo;
+    pbLo = (pbLo > DETOUR_REGION_SIZE) ? pbLo - DETOUR_REGION_SIZE : 0;
+
+    for (ULONG n = detour_find_free_region_index(pbLo); n < s_cFreeRegions; n++) {
+        PDETOUR_REGION pRegion = s_rpFreeRegions[n];
+        if ((ULONG_PTR)pRegion > (ULONG_PTR)pHi) {
+            break;
+        }
+        if (pRegion->pFree >= pLo && pRegion->pFree <= pHi) {
+            return pRegion;
+        }
+    }
+    return NULL;
+}
+
 static PDETOUR_TRAMPOLINE detour_alloc_trampoline(PBYTE pbTarget)
 {
     // We have to place trampolines within +/- 2GB of target.
@@ -1386,8 +1483,8 @@ static PDETOUR_TRAMPOLINE detour_alloc_trampoline(PBYTE pbTarget)
     PDETOUR_TRAMPOLINE pTrampoline = NULL;
 
     // Insure that there is a default region.
-    if (s_pRegion == NULL && s_pRegions != NULL) {
-        s_pRegion = s_pRegions;
+    if (s_pRegion == NULL && s_cFreeRegions != 0) {
+        s_pRegion = s_rpFreeRegions[0];
     }
 
     // First check the default region for an valid free block.
@@ -1401,20 +1498,30 @@ static PDETOUR_TRAMPOLINE detour_alloc_trampoline(PBYTE pbTarget)
             return NULL;
         }
         s_pRegion->pFree = (PDETOUR_TRAMPOLINE)pTrampoline->pbRemain;
+        if (s_pRegion->cFree == DETOUR_TRAMPOLINES_USABLE_PER_REGION) {
+            s_cEmptyRegions--;
+        }
+        if (--s_pRegion->cFree == 0) {
+            detour_remove_free_region(s_pRegion);
+        }
         memset(pTrampoline, 0xcc, sizeof(*pTrampoline));
         return pTrampoline;
     }
 
-    // Then check the existing regions for a valid free block.
-    for (s_pRegion = s_pRegions; s_pRegion != NULL; s_pRegion = s_pRegion->pNext) {
-        if (s_pRegion != NULL && s_pRegion->pFree != NULL &&
-            s_pRegion->pFree >= pLo && s_pRegion->pFree <= pHi) {
-            goto found_region;
-        }
+    // Then look up the existing regions with a valid free block.
+    s_pRegion = detour_find_free_region(pLo, pHi);
+    if (s_pRegion != NULL) {
+        goto found_region;
     }
 
     // We need to allocate a new region.
 
+    // Make sure the new region can always be put in the free region index.
+    if (!detour_reserve_free_regions(s_cRegions + 1)) {
+        DETOUR_TRACE(("Couldn't grow the free region index!\n"));
+        return NULL;
+    }
+
     // Round pbTarget down to 64KB block.
     pbTarget = pbTarget - (PtrToUlong(pbTarget) & 0xffff);
 
@@ -1426,6 +1533,7 @@ static PDETOUR_TRAMPOLINE detour_alloc_trampoline(PBYTE pbTarget)
         s_pRegion->pFree = NULL;
         s_pRegion->pNext = s_pRegions;
         s_pRegions = s_pRegion;
+        s_cRegions++;
         DETOUR_TRACE(("  Allocated region %p..%p\n\n",
                       s_pRegion, ((PBYTE)s_pRegion) + DETOUR_REGION_SIZE - 1));
 
@@ -1437,6 +1545,9 @@ static PDETOUR_TRAMPOLINE detour_alloc_trampoline(PBYTE pbTarget)
             pFree = (PBYTE)&pTrampoline[i];
         }
         s_pRegion->pFree = (PDETOUR_TRAMPOLINE)pFree;
+        s_pRegion->cFree = DETOUR_TRAMPOLINES_USABLE_PER_REGION;
+        s_cEmptyRegions++;
+        detour_insert_free_region(s_pRegion);
         goto found_region;
     }
 
@@ -1452,6 +1563,12 @@ static void detour_free_trampoline(PDETOUR_TRAMPOLINE pTrampoline)
     memset(pTrampoline, 0, sizeof(*pTrampoline));
     pTrampoline->pbRemain = (PBYTE)pRegion->pFree;
     pRegion->pFree = pTrampoline;
+    if (pRegion->cFree++ == 0) {
+        detour_insert_free_region(pRegion);
+    }
+    if (pRegion->cFree == DETOUR_TRAMPOLINES_USABLE_PER_REGION) {
+        s_cEmptyRegions++;
+    }
 }
 
 static BOOL detour_is_region_empty(PDETOUR_REGION pRegion)
@@ -1461,25 +1578,17 @@ static BOOL detour_is_region_empty(PDETOUR_REGION pRegion)
         return FALSE;
     }
 
-    PBYTE pbRegionBeg = (PBYTE)pRegion;
-    PBYTE pbRegionLim  = pbRegionBeg + DETOUR_REGION_SIZE;
-
-    // Stop if any of the trampolines aren't free.
-    PDETOUR_TRAMPOLINE pTrampoline = ((PDETOUR_TRAMPOLINE)pRegion) + 1;
-    for (int i = 0; i < DETOUR_TRAMPOLINES_PER_REGION; i++) {
-        if (pTrampoline[i].pbRemain != NULL &&
-            (pTrampoline[i].pbRemain < pbRegionBeg ||
-             pTrampoline[i].pbRemain >= pbRegionLim)) {
-            return FALSE;
-        }
-    }
-
-    // OK, the region is empty.
-    return TRUE;
+    // The region is empty when every usable trampoline is back on the free list.
+    return pRegion->cFree == DETOUR_TRAMPOLINES_USABLE_PER_REGION;
 }
 
 static void detour_free_unused_trampoline_regions()
 {
+    // Skip the walk entirely when no region is empty.
+    if (s_cEmptyRegions == 0) {
+        return;
+    }
+
     PDETOUR_REGION *ppRegionBase = &s_pRegions;
     PDETOUR_REGION pRegion = s_pRegions;
 
@@ -1487,6 +1596,9 @@ static void detour_free_unused_trampoline_regions()
         if (detour_is_region_empty(pRegion)) {
             *ppRegionBase = pRegion->pNext;
 
+            detour_remove_free_region(pRegion);
+            s_cRegions--;
+            s_cEmptyRegions--;
             VirtualFree(pRegion, 0, MEM_RELEASE);
             s_pRegion = NULL;
         }
@@ -1512,7 +1624,12 @@ struct DetourOperation
     PBYTE *             ppbPointer;
     PBYTE               pbTarget;
     PDETOUR_TRAMPOLINE  pTrampoline;
-    ULONG               dwPerm;
+};
+
+struct DetourPendingPage
+{
+    PBYTE               pbPage;
+    DWORD               dwPerm;     // Protection before the transaction.
 };
 
 static BOOL                 s_fIgnoreTooSmall       = FALSE;
@@ -1523,6 +1640,119 @@ static LONG                 s_nPendingError         = NO_ERROR;
 static PVOID *              s_ppPendingError        = NULL;
 static DetourThread *       s_pPendingThreads       = NULL;
 static DetourOperation *    s_pPendingOperations    = NULL;
+static DetourPendingPage *  s_rPendingPages         = NULL; // Sorted by pbPage.
+static ULONG                s_cPendingPages         = 0;
+static ULONG                s_cPendingPagesMax      = 0;
+static ULONG_PTR            s_cbPage                = 0;
+
+//////////////////////////////////////////////////// Pending Page Protection.
+//
+// Each code page written by the pending transaction is made writable once,
+// however many operations patch it.  When the transaction ends, contiguous
+// pages are restored and flushed with one call per run of pages.
+//
+static ULONG detour_find_pending_page(PBYTE pbPage)
+{
+    ULONG nLo = 0;
+    ULONG nHi = s_cPendingPages;
+    while (nLo < nHi) {
+        ULONG nMid = nLo + (nHi - nLo) / 2;
+        if (s_rPendingPages[nMid].pbPage < pbPage) {
+            nLo = nMid + 1;
+        }
+        else {
+            nHi = nMid;
+        }
+    }
+    return nLo;
+}
+
+static LONG detour_writable_pending_pages(PBYTE pbTarget, ULONG cbTarget)
+{
+    if (s_cbPage == 0) {
+        SYSTEM_INFO si;
+        GetSystemInfo(&si);
+        s_cbPage = si.dwPageSize;
+    }
+
+    PBYTE pbLimit = pbTarget + cbTarget;
+    for (PBYTE pbPage = (PBYTE)((ULONG_PTR)pbTarget & ~(s_cbPage - 1));
+         pbPage < pbLimit; pbPage += s_cbPage) {
+
+        ULONG n = detour_find_pending_page(pbPage);
+        if (n < s_cPendingPages && s_rPendingPages[n].pbPage == pbPage) {
+            // Already made writable by an earlier operation.
+            continue;
+        }
+
+        if (s_cPendingPages == s_cPendingPagesMax) {
+            ULONG cMax = s_cPendingPagesMax ? s_cPendingPagesMax * 2 : 16;
+            DetourPendingPage *rPages = new NOTHROW DetourPendingPage [cMax];
+            if (rPages == NULL) {
+                return ERROR_NOT_ENOUGH_MEMORY;
+            }
+            if (s_rPendingPages != NULL) {
+                memcpy(rPages, s_rPendingPages, s_cPendingPages * sizeof(s_rPendingPages[0]));
+                delete[] s_rPendingPages;
+            }
+            s_rPendingPages = rPages;
+            s_cPendingPagesMax = cMax;
+        }
+
+        DWORD dwOld = 0;
+        if (!VirtualProtect(pbPage, s_cbPage, PAGE_EXECUTE_READWRITE, &dwOld)) {
+            return GetLastError();
+        }
+
+        memmove(&s_rPendingPages[n + 1], &s_rPendingPages[n],
+                (s_cPendingPages - n) * sizeof(s_rPendingPages[0]));
+        s_rPendingPages[n].pbPage = pbPage;
+        s_rPendingPages[n].dwPerm = dwOld;
+        s_cPendingPages++;
+    }
+    return NO_ERROR;
+}
+
+static void detour_restore_pending_pages(BOOL fFlush)
+{
+    HANDLE hProcess = GetCurrentProcess();
+
+    for (ULONG n = 0; n < s_cPendingPages;) {
+        // Find the run of contiguous pages that had the same protection.
+        ULONG m = n + 1;
+        while (m < s_cPendingPages &&
+               s_rPendingPages[m].pbPage == s_rPendingPages[m - 1].pbPage + s_cbPage &&
+               s_rPendingPages[m].dwPerm == s_rPendingPages[n].dwPerm) {
+            m++;
+        }
+
+        // We don't care if this fails, because the code is still accessible.
+        // A run can span two allocations, which VirtualProtect rejects, so
+        // fall back to restoring those pages one at a time.
+        PBYTE pbRun = s_rPendingPages[n].pbPage;
+        SIZE_T cbRun = (m - n) * s_cbPage;
+        DWORD dwOld;
+        if (VirtualProtect(pbRun, cbRun, s_rPendingPages[n].dwPerm, &dwOld)) {
+            if (fFlush) {
+                FlushInstructionCache(hProcess, pbRun, cbRun);
+            }
+        }
+        else {
+            for (ULONG i = n; i < m; i++) {
+                VirtualProtect(s_rPendingPages[i].pbPage, s_cbPage, s_rPendingPages[i].dwPerm, &dwOld);
+                if (fFlush) {
+                    FlushInstructionCache(hProcess, s_rPendingPages[i].pbPage, s_cbPage);
+                }
+            }
+        }
+        n = m;
+    }
+
+    delete[] s_rPendingPages;
+    s_rPendingPages = NULL;
+    s_cPendingPages = 0;
+    s_cPendingPagesMax = 0;
+}
 
 //////////////////////////////////////////////////////////////////////////////
 //
@@ -1593,12 +1823,9 @@ LONG WINAPI DetourTransactionAbort()
     }
 
     // Restore all of the page permissions.
-    for (DetourOperation *o = s_pPendingOperations; o != NULL;) {
-        // We don't care if this fails, because the code is still accessible.
-        DWORD dwOld;
-        VirtualProtect(o->pbTarget, o->pTrampoline->cbRestore,
-                       o->dwPerm, &dwOld);
+    detour_restore_pending_pages(FALSE);
 
+    for (DetourOperation *o = s_pPendingOperations; o != NULL;) {
         if (!o->fIsRemove) {
             if (o->pTrampoline) {
                 detour_free_trampoline(o->pTrampoline);
@@ -1878,13 +2105,9 @@ typedef ULONG_PTR DETOURS_EIP_TYPE;
     }
 
     // Restore all of the page permissions and flush the icache.
-    HANDLE hProcess = GetCurrentProcess();
-    for (o = s_pPendingOperations; o != NULL;) {
-        // We don't care if this fails, because the code is still accessible.
-        DWORD dwOld;
-        VirtualProtect(o->pbTarget, o->pTrampoline->cbRestore, o->dwPerm, &dwOld);
-        FlushInstructionCache(hProcess, o->pbTarget, o->pTrampoline->cbRestore);
+    detour_restore_pending_pages(TRUE);
 
+    for (o = s_pPendingOperations; o != NULL;) {
         if (o->fIsRemove && o->pTrampoline) {
             detour_free_trampoline(o->pTrampoline);
             o->pTrampoline = NULL;
@@ -2289,9 +2512,8 @@ LONG WINAPI DetourAttachEx(_Inout_ PVOID *ppPointer,
 
     (void)pbTrampoline;
 
-    DWORD dwOld = 0;
-    if (!VirtualProtect(pbTarget, cbTarget, PAGE_EXECUTE_READWRITE, &dwOld)) {
-        error = GetLastError();
+    error = detour_writable_pending_pages(pbTarget, cbTarget);
+    if (error != NO_ERROR) {
         DETOUR_BREAK();
         goto fail;
     }
@@ -2320,7 +2542,6 @@ LONG WINAPI DetourAttachEx(_Inout_ PVOID *ppPointer,
     o->ppbPointer = (PBYTE*)ppPointer;
     o->pTrampoline = pTrampoline;
     o->pbTarget = pbTarget;
-    o->dwPerm = dwOld;
     o->pNext = s_pPendingOperations;
     s_pPendingOperations = o;
 
@@ -2447,10 +2668,8 @@ LONG WINAPI DetourDetach(_Inout_ PVOID *ppPointer,
         }
     }
 
-    DWORD dwOld = 0;
-    if (!VirtualProtect(pbTarget, cbTarget,
-                        PAGE_EXECUTE_READWRITE, &dwOld)) {
-        error = GetLastError();
+    error = detour_writable_pending_pages(pbTarget, cbTarget);
+    if (error != NO_ERROR) {
         DETOUR_BREAK();
         goto fail;
     }
@@ -2459,7 +2678,6 @@ LONG WINAPI DetourDetach(_Inout_ PVOID *ppPointer,
     o->ppbPointer = (PBYTE*)ppPointer;
     o->pTrampoline = pTrampoline;
     o->pbTarget = pbTarget;
-    o->dwPerm = dwOld;
     o->pNext = s_pPendingOperations;
     s_pPendingOperations = o;
 
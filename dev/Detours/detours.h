@@ -421,6 +421,30 @@ typedef struct _DETOUR_CLR_HEADER
     // Followed by the rest of the IMAGE_COR20_HEADER
 } DETOUR_CLR_HEADER, *PDETOUR_CLR_HEADER;
 
+// Output of DetourDecodeInstructions; one record per decoded instruction.
+typedef struct _DETOUR_INSTRUCTION
+{
+    PVOID       pTarget;            // As ppTarget of DetourCopyInstruction, but never read from memory.
+    ULONG       cbInstruction;      // Length in bytes, including prefixes.
+    ULONG       obDisplacement;     // Offset of the relative displacement, or 0 if none.
+    ULONG       cbDisplacement;     // Size in bytes of the relative displacement.
+    ULONG       fFlags;             // DETOUR_INSTRUCTION_FLAG_*.
+} DETOUR_INSTRUCTION, *PDETOUR_INSTRUCTION;
+
+#define DETOUR_INSTRUCTION_FLAG_INVALID         0x00000001  // Not a valid instruction; cbInstruction is 1 past the prefixes.
+#define DETOUR_INSTRUCTION_FLAG_ENLARGE         0x00000002  // Short jump that DetourCopyInstruction enlarges.
+#define DETOUR_INSTRUCTION_FLAG_NOENLARGE       0x00000004  // Short branch that can't be enlarged (loop, jcxz).
+#define DETOUR_INSTRUCTION_FLAG_DATA            0x00000008  // Displacement addresses data, not code (x64 RIP-relative).
+
+// Output of DetourFindExport and DetourFindExportByOrdinal.  Strings point into the image.
+typedef struct _DETOUR_EXPORT
+{
+    ULONG       nOrdinal;
+    DWORD       nRva;               // 0 for forwarders and unused ordinals.
+    LPCSTR      pszName;            // NULL if exported only by ordinal.
+    LPCSTR      pszForwarder;       // "Module.Function" or "Module.#Ordinal", or NULL.
+} DETOUR_EXPORT, *PDETOUR_EXPORT;
+
 typedef struct _DETOUR_EXE_RESTORE
 {
     DWORD               cb;
@@ -538,6 +562,7 @@ typedef BOOL (CALLBACK *PF_DETOUR_IMPORT_FUNC_CALLBACK_EX)(_In_opt_ PVOID pConte
 
 typedef VOID * PDETOUR_BINARY;
 typedef VOID * PDETOUR_LOADED_BINARY;
+typedef VOID * PDETOUR_EXPORT_INDEX;
 
 //////////////////////////////////////////////////////////// Transaction APIs.
 //
@@ -578,6 +603,11 @@ PVOID WINAPI DetourCopyInstruction(_In_opt_ PVOID pDst,
                                    _Out_opt_ LONG *plExtra);
 BOOL WINAPI DetourSetCodeModule(_In_ HMODULE hModule,
                                 _In_ BOOL fLimitReferencesToModule);
+ULONG WINAPI DetourGetInstructionLength(_In_ PVOID pSrc);
+ULONG WINAPI DetourDecodeInstructions(_In_ PVOID pSrc,
+                                      _In_ ULONG cbMinimum,
+                                      _Out_writes_to_(cInstructions, return) PDETOUR_INSTRUCTION pInstructions,
+                                      _In_ ULONG cInstructions);
 PVOID WINAPI DetourAllocateRegionWithinJumpBounds(_In_ LPCVOID pbTarget,
                                                   _Out_ PDWORD pcbAllocatedSize);
 
@@ -590,6 +620,16 @@ ULONG WINAPI DetourGetModuleSize(_In_opt_ HMODULE hModule);
 BOOL WINAPI DetourEnumerateExports(_In_ HMODULE hModule,
                                    _In_opt_ PVOID pContext,
                                    _In_ PF_DETOUR_ENUMERATE_EXPORT_CALLBACK pfExport);
+PDETOUR_EXPORT_INDEX WINAPI DetourCreateExportIndex(_In_reads_bytes_(cbImage) PVOID pvImage,
+                                                    _In_ SIZE_T cbImage,
+                                                    _In_ BOOL fMapped);
+VOID WINAPI DetourFreeExportIndex(_In_ PDETOUR_EXPORT_INDEX pIndex);
+BOOL WINAPI DetourFindExport(_In_ PDETOUR_EXPORT_INDEX pIndex,
+                             _In_ LPCSTR pszName,
+                             _Out_ PDETOUR_EXPORT pExport);
+BOOL WINAPI DetourFindExportByOrdinal(_In_ PDETOUR_EXPORT_INDEX pIndex,
+                                      _In_ ULONG nOrdinal,
+                                      _Out_ PDETOUR_EXPORT pExport);
 BOOL WINAPI DetourEnumerateImports(_In_opt_ HMODULE hModule,
                                    _In_opt_ PVOID pContext,
                                    _In_opt_ PF_DETOUR_IMPORT_FILE_CALLBACK pfImportFile,
@@ -1088,6 +1128,14 @@ PVOID WINAPI DetourCopyInstruction##x(_In_opt_ PVOID pDst,              \
                                                                         \
 BOOL WINAPI DetourSetCodeModule##x(_In_ HMODULE hModule,                \
                                    _In_ BOOL fLimitReferencesToModule); \
+                                                                        \
+ULONG WINAPI DetourGetInstructionLength##x(_In_ PVOID pSrc);            \
+                                                                        \
+ULONG WINAPI DetourDecodeInstructions##x(_In_ PVOID pSrc,               \
+                                         _In_ ULONG cbMinimum,          \
+                                         _Out_writes_to_(cInstructions, return) \
+                                         PDETOUR_INSTRUCTION pInstructions, \
+                                         _In_ ULONG cInstructions);     \
 
 DETOUR_OFFLINE_LIBRARY(X86)
 DETOUR_OFFLINE_LIBRARY(X64)
@@ -42,6 +42,8 @@
 
 #define DetourCopyInstruction   DetourCopyInstructionX86
 #define DetourSetCodeModule     DetourSetCodeModuleX86
+#define DetourGetInstructionLength DetourGetInstructionLengthX86
+#define DetourDecodeInstructions DetourDecodeInstructionsX86
 #define CDetourDis              CDetourDisX86
 #define DETOURS_X86
 
@@ -54,6 +56,8 @@
 
 #define DetourCopyInstruction   DetourCopyInstructionX64
 #define DetourSetCodeModule     DetourSetCodeModuleX64
+#define DetourGetInstructionLength DetourGetInstructionLengthX64
+#define DetourDecodeInstructions DetourDecodeInstructionsX64
 #define CDetourDis              CDetourDisX64
 #define DETOURS_X64
 
@@ -61,6 +65,8 @@
 
 #define DetourCopyInstruction   DetourCopyInstructionARM
 #define DetourSetCodeModule     DetourSetCodeModuleARM
+#define DetourGetInstructionLength DetourGetInstructionLengthARM
+#define DetourDecodeInstructions DetourDecodeInstructionsARM
 #define CDetourDis              CDetourDisARM
 #define DETOURS_ARM
 
@@ -68,6 +74,8 @@
 
 #define DetourCopyInstruction   DetourCopyInstructionARM64
 #define DetourSetCodeModule     DetourSetCodeModuleARM64
+#define DetourGetInstructionLength DetourGetInstructionLengthARM64
+#define DetourDecodeInstructions DetourDecodeInstructionsARM64
 #define CDetourDis              CDetourDisARM64
 #define DETOURS_ARM64
 
@@ -75,6 +83,8 @@
 
 #define DetourCopyInstruction   DetourCopyInstructionIA64
 #define DetourSetCodeModule     DetourSetCodeModuleIA64
+#define DetourGetInstructionLength DetourGetInstructionLengthIA64
+#define DetourDecodeInstructions DetourDecodeInstructionsIA64
 #define DETOURS_IA64
 
 #else
@@ -162,6 +172,7 @@ class CDetourDis
     PBYTE   CopyInstruction(PBYTE pbDst, PBYTE pbSrc);
     static BOOL SanityCheckSystem();
     static BOOL SetCodeModule(PBYTE pbBeg, PBYTE pbEnd, BOOL fLimitReferencesToModule);
+    static ULONG DecodeInstruction(PBYTE pbSrc, PDETOUR_INSTRUCTION pInstruction);
 
   public:
     struct COPYENTRY;
@@ -285,6 +296,56 @@ class CDetourDis
     PBYTE CopyEvex(REFCOPYENTRY pEntry, PBYTE pbDst, PBYTE pbSrc);
     PBYTE CopyXop(REFCOPYENTRY pEntry, PBYTE pbDst, PBYTE pbSrc);
 
+  protected:
+    // DecodeInstruction walks packed copies of the COPYENTRY tables.  Each
+    // ULONG holds nFixedSize, nFixedSize16, nModOffset, nRelOffset and
+    // nFlagBits in 4 bits apiece, then a DECODE_* kind naming pfCopy, so
+    // measuring an instruction needs no object, no destination buffer and
+    // no indirect calls.
+    enum {
+        DECODE_BYTES        = 0,
+        DECODE_PREFIX,
+        DECODE_SEGMENT,
+        DECODE_RAX,
+        DECODE_JUMP,
+        DECODE_INVALID,
+        DECODE_0F,
+        DECODE_0F78,
+        DECODE_0F00,
+        DECODE_0FB8,
+        DECODE_66,
+        DECODE_67,
+        DECODE_F2,
+        DECODE_F3,
+        DECODE_F6,
+        DECODE_F7,
+        DECODE_FF,
+        DECODE_VEX2,
+        DECODE_VEX3,
+        DECODE_EVEX,
+        DECODE_XOP,
+    };
+
+    // Packed forms of the COPYENTRYs the Copy* handlers choose between.
+    enum {
+        DECODE_ENTRY_2MOD   = 0,
+        DECODE_ENTRY_2MOD_DYNAMIC,
+        DECODE_ENTRY_2MOD1,
+        DECODE_ENTRY_2MOD_OPERAND,
+        DECODE_ENTRY_4,
+        DECODE_ENTRY_3OR5_DYNAMIC,
+        DECODE_ENTRY_XOP,
+        DECODE_ENTRY_XOP1,
+        DECODE_ENTRY_XOP4,
+        DECODE_ENTRY_COUNT,
+    };
+
+    static ULONG PackEntry(REFCOPYENTRY pEntry);
+    static BOOL CALLBACK InitDecodeTables(PINIT_ONCE pInitOnce, PVOID pvParameter, PVOID *ppvContext);
+    static ULONG DecodeBytes(ULONG nEntry, PBYTE pbSrc, PBYTE pbOp,
+                             BOOL fOperand, BOOL fAddress, BOOL fRax,
+                             PDETOUR_INSTRUCTION pInstruction);
+
   protected:
     static const COPYENTRY  s_rceCopyTable[257];
     static const COPYENTRY  s_rceCopyTable0F[257];
@@ -292,6 +353,10 @@ class CDetourDis
     static PBYTE            s_pbModuleBeg;
     static PBYTE            s_pbModuleEnd;
     static BOOL             s_fLimitReferencesToModule;
+    static ULONG            s_rnDecodeTable[256];
+    static ULONG            s_rnDecodeTable0F[256];
+    static ULONG            s_rnDecodeEntries[DECODE_ENTRY_COUNT];
+    static INIT_ONCE        s_ioDecodeTables;
 
   protected:
     BOOL                m_bOperandOverride;
@@ -1630,6 +1695,411 @@ BOOL CDetourDis::SanityCheckSystem()
 
     return TRUE;
 }
+
+///////////////////////////////////////////////////////// Instruction Decoder.
+//
+#define DECODE_FIXED(n)         ((n) & 0xf)
+#define DECODE_FIXED16(n)       (((n) >> 4) & 0xf)
+#define DECODE_MOD(n)           (((n) >> 8) & 0xf)
+#define DECODE_REL(n)           (((n) >> 12) & 0xf)
+#define DECODE_FLAGS(n)         (((n) >> 16) & 0xf)
+#define DECODE_KIND(n)          (((n) >> 20) & 0x1f)
+
+ULONG CDetourDis::s_rnDecodeTable[256];
+ULONG CDetourDis::s_rnDecodeTable0F[256];
+ULONG CDetourDis::s_rnDecodeEntries[DECODE_ENTRY_COUNT];
+INIT_ONCE CDetourDis::s_ioDecodeTables = INIT_ONCE_STATIC_INIT;
+
+ULONG CDetourDis::PackEntry(REFCOPYENTRY pEntry)
+{
+    static const struct {
+        COPYFUNC    pfCopy;
+        ULONG       nKind;
+    } s_rKinds[] = {
+        { &CDetourDis::CopyBytesPrefix,     DECODE_PREFIX },
+        { &CDetourDis::CopyBytesSegment,    DECODE_SEGMENT },
+        { &CDetourDis::CopyBytesRax,        DECODE_RAX },
+        { &CDetourDis::CopyBytesJump,       DECODE_JUMP },
+        { &CDetourDis::Invalid,             DECODE_INVALID },
+        { &CDetourDis::Copy0F,              DECODE_0F },
+        { &CDetourDis::Copy0F78,            DECODE_0F78 },
+        { &CDetourDis::Copy0F00,            DECODE_0F00 },
+        { &CDetourDis::Copy0FB8,            DECODE_0FB8 },
+        { &CDetourDis::Copy66,              DECODE_66 },
+        { &CDetourDis::Copy67,              DECODE_67 },
+        { &CDetourDis::CopyF2,              DECODE_F2 },
+        { &CDetourDis::CopyF3,              DECODE_F3 },
+        { &CDetourDis::CopyF6,              DECODE_F6 },
+        { &CDetourDis::CopyF7,              DECODE_F7 },
+        { &CDetourDis::CopyFF,              DECODE_FF },
+        { &CDetourDis::CopyVex2,            DECODE_VEX2 },
+        { &CDetourDis::CopyVex3,            DECODE_VEX3 },
+        { &CDetourDis::CopyEvex,            DECODE_EVEX },
+        { &CDetourDis::CopyXop,             DECODE_XOP },
+    };
+
+    ULONG nKind = DECODE_INVALID;
+    if (pEntry->pfCopy == &CDetourDis::CopyBytes) {
+        nKind = DECODE_BYTES;
+    }
+    else {
+        for (ULONG n = 0; n < ARRAYSIZE(s_rKinds); n++) {
+            if (pEntry->pfCopy == s_rKinds[n].pfCopy) {
+                nKind = s_rKinds[n].nKind;
+                break;
+            }
+        }
+    }
+
+    return ((ULONG)pEntry->nFixedSize |
+            ((ULONG)pEntry->nFixedSize16 << 4) |
+            ((ULONG)pEntry->nModOffset << 8) |
+            ((ULONG)pEntry->nRelOffset << 12) |
+            ((ULONG)pEntry->nFlagBits << 16) |
+            (nKind << 20));
+}
+
+BOOL CALLBACK CDetourDis::InitDecodeTables(PINIT_ONCE pInitOnce, PVOID pvParameter, PVOID *ppvContext)
+{
+    (void)pInitOnce;
+    (void)pvParameter;
+    (void)ppvContext;
+
+    // The same entries Copy0F78, Copy0F00, Copy0FB8, CopyF6, CopyF7, CopyFF,
+    // CopyVexEvexCommon and CopyXop pass to CopyBytes.
+    static const COPYENTRY s_rceEntries[DECODE_ENTRY_COUNT] = {
+        { 0, ENTRY_CopyBytes2Mod },                     // DECODE_ENTRY_2MOD
+        { 0, ENTRY_CopyBytes2ModDynamic },              // DECODE_ENTRY_2MOD_DYNAMIC
+        { 0, ENTRY_CopyBytes2Mod1 },                    // DECODE_ENTRY_2MOD1
+        { 0, ENTRY_CopyBytes2ModOperand },              // DECODE_ENTRY_2MOD_OPERAND
+        { 0, ENTRY_CopyBytes4 },                        // DECODE_ENTRY_4
+        { 0, ENTRY_CopyBytes3Or5Dynamic },              // DECODE_ENTRY_3OR5_DYNAMIC
+        { 0, ENTRY_CopyBytesXop },                      // DECODE_ENTRY_XOP
+        { 0, ENTRY_CopyBytesXop1 },                     // DECODE_ENTRY_XOP1
+        { 0, ENTRY_CopyBytesXop4 },                     // DECODE_ENTRY_XOP4
+    };
+
+    for (ULONG n = 0; n < 256; n++) {
+        s_rnDecodeTable[n] = PackEntry(&s_rceCopyTable[n]);
+        s_rnDecodeTable0F[n] = PackEntry(&s_rceCopyTable0F[n]);
+    }
+    for (ULONG n = 0; n < DECODE_ENTRY_COUNT; n++) {
+        s_rnDecodeEntries[n] = PackEntry(&s_rceEntries[n]);
+    }
+    return TRUE;
+}
+
+ULONG CDetourDis::DecodeBytes(ULONG nEntry, PBYTE pbSrc, PBYTE pbOp,
+                              BOOL fOperand, BOOL fAddress, BOOL fRax,
+                              PDETOUR_INSTRUCTION pInstruction)
+{
+    // Mirrors CopyBytes; pbOp is where CopyBytes would have been called.
+    UINT const nModOffset = DECODE_MOD(nEntry);
+    UINT const nFlagBits = DECODE_FLAGS(nEntry);
+    UINT const nFixedSize = DECODE_FIXED(nEntry);
+    UINT const nFixedSize16 = DECODE_FIXED16(nEntry);
+    UINT nBytesFixed;
+
+#ifndef DETOURS_X64
+    (void)fRax;
+#endif
+
+    if (nFlagBits & ADDRESS) {
+        nBytesFixed = fAddress ? nFixedSize16 : nFixedSize;
+    }
+#ifdef DETOURS_X64
+    else if (fRax) {
+        nBytesFixed = nFixedSize + ((nFlagBits & RAX) ? 4 : 0);
+    }
+#endif
+    else {
+        nBytesFixed = fOperand ? nFixedSize16 : nFixedSize;
+    }
+
+    UINT nBytes = nBytesFixed;
+    UINT nRelOffset = DECODE_REL(nEntry);
+    UINT cbTarget = nBytes - nRelOffset;
+    BOOL fData = FALSE;
+    if (nModOffset > 0) {
+        BYTE const bModRm = pbOp[nModOffset];
+        BYTE const bFlags = s_rbModRm[bModRm];
+
+        nBytes += bFlags & NOTSIB;
+
+        if (bFlags & SIB) {
+            BYTE const bSib = pbOp[nModOffset + 1];
+
+            if ((bSib & 0x07) == 0x05) {
+                if ((bModRm & 0xc0) == 0x00) {
+                    nBytes += 4;
+                }
+                else if ((bModRm & 0xc0) == 0x40) {
+                    nBytes += 1;
+                }
+                else if ((bModRm & 0xc0) == 0x80) {
+                    nBytes += 4;
+                }
+            }
+            cbTarget = nBytes - nRelOffset;
+        }
+#ifdef DETOURS_X64
+        else if (bFlags & RIP) {
+            nRelOffset = nModOffset + 1;
+            cbTarget = 4;
+            fData = TRUE;
+        }
+#endif
+    }
+
+    ULONG const obOp = (ULONG)(pbOp - pbSrc);
+    pInstruction->cbInstruction = obOp + nBytes;
+
+    if (nRelOffset) {
+        PBYTE const pbDisplacement = pbOp + nRelOffset;
+        LONG_PTR nOffset;
+
+        switch (cbTarget) {
+          case 1:
+            nOffset = *(signed char *)pbDisplacement;
+            break;
+          case 2:
+            nOffset = *(UNALIGNED SHORT *)pbDisplacement;
+            break;
+          case 4:
+            nOffset = *(UNALIGNED LONG *)pbDisplacement;
+            break;
+          default:
+            nOffset = 0;
+            break;
+        }
+
+        pInstruction->obDisplacement = obOp + nRelOffset;
+        pInstruction->cbDisplacement = cbTarget;
+        if (fData) {
+            // This is a data target, not a code target, so we shouldn't return it.
+            pInstruction->fFlags |= DETOUR_INSTRUCTION_FLAG_DATA;
+        }
+        else {
+            pInstruction->pTarget = pbOp + nBytes + nOffset;
+        }
+    }
+    if (nFlagBits & NOENLARGE) {
+        pInstruction->fFlags |= DETOUR_INSTRUCTION_FLAG_NOENLARGE;
+    }
+    if (nFlagBits & DYNAMIC) {
+        pInstruction->pTarget = DETOUR_INSTRUCTION_TARGET_DYNAMIC;
+    }
+    return pInstruction->cbInstruction;
+}
+
+ULONG CDetourDis::DecodeInstruction(PBYTE pbSrc, PDETOUR_INSTRUCTION pInstruction)
+{
+    InitOnceExecuteOnce(&s_ioDecodeTables, InitDecodeTables, NULL, NULL);
+
+    ZeroMemory(pInstruction, sizeof(*pInstruction));
+    pInstruction->pTarget = DETOUR_INSTRUCTION_TARGET_NONE;
+
+    // Prefixes are consumed in a loop rather than by recursion; each case
+    // follows the matching Copy* handler.
+    const ULONG *pnTable = s_rnDecodeTable;
+    PBYTE pbOp = pbSrc;
+    BOOL fOperand = FALSE;
+    BOOL fAddress = FALSE;
+    BOOL fRax = FALSE;
+    BOOL fF2 = FALSE;
+    BOOL fF3 = FALSE;
+    BYTE bVexM = 0;
+    BYTE bVexP = 0;
+
+    for (;;) {
+        ULONG const nEntry = pnTable[pbOp[0]];
+        pnTable = s_rnDecodeTable;
+
+        switch (DECODE_KIND(nEntry)) {
+          case DECODE_BYTES:
+            return DecodeBytes(nEntry, pbSrc, pbOp, fOperand, fAddress, fRax, pInstruction);
+
+          case DECODE_RAX:
+            if (pbOp[0] & 0x8) {
+                fRax = TRUE;
+            }
+            pbOp++;
+            continue;
+
+          case DECODE_66:
+            fOperand = TRUE;
+            pbOp++;
+            continue;
+
+          case DECODE_67:
+            fAddress = TRUE;
+            pbOp++;
+            continue;
+
+          case DECODE_F2:
+            fF2 = TRUE;
+            pbOp++;
+            continue;
+
+          case DECODE_F3:
+            fF3 = TRUE;
+            pbOp++;
+            continue;
+
+          case DECODE_PREFIX:
+          case DECODE_SEGMENT:
+            pbOp++;
+            continue;
+
+          case DECODE_0F:
+            pbOp++;
+            pnTable = s_rnDecodeTable0F;
+            continue;
+
+          case DECODE_JUMP:
+            pInstruction->cbInstruction = (ULONG)(pbOp - pbSrc) + 2;
+            pInstruction->obDisplacement = (ULONG)(pbOp - pbSrc) + 1;
+            pInstruction->cbDisplacement = 1;
+            pInstruction->pTarget = pbOp + 2 + *(signed char *)&pbOp[1];
+            pInstruction->fFlags |= DETOUR_INSTRUCTION_FLAG_ENLARGE;
+            return pInstruction->cbInstruction;
+
+          case DECODE_0F78:
+            return DecodeBytes(s_rnDecodeEntries[(fF2 || fOperand) ? DECODE_ENTRY_4 : DECODE_ENTRY_2MOD],
+                               pbSrc, pbOp, fOperand, fAddress, fRax, pInstruction);
+
+          case DECODE_0F00:
+            return DecodeBytes(s_rnDecodeEntries[((6 << 3) == ((7 << 3) & pbOp[1]))
+                                                 ? DECODE_ENTRY_2MOD_DYNAMIC : DECODE_ENTRY_2MOD],
+                               pbSrc, pbOp, fOperand, fAddress, fRax, pInstruction);
+
+          case DECODE_0FB8:
+            return DecodeBytes(s_rnDecodeEntries[fF3 ? DECODE_ENTRY_2MOD : DECODE_ENTRY_3OR5_DYNAMIC],
+                               pbSrc, pbOp, fOperand, fAddress, fRax, pInstruction);
+
+          case DECODE_F6:
+            return DecodeBytes(s_rnDecodeEntries[(0x00 == (0x38 & pbOp[1])) ? DECODE_ENTRY_2MOD1 : DECODE_ENTRY_2MOD],
+                               pbSrc, pbOp, fOperand, fAddress, fRax, pInstruction);
+
+          case DECODE_F7:
+            return DecodeBytes(s_rnDecodeEntries[(0x00 == (0x38 & pbOp[1])) ? DECODE_ENTRY_2MOD_OPERAND : DECODE_ENTRY_2MOD],
+                               pbSrc, pbOp, fOperand, fAddress, fRax, pInstruction);
+
+          case DECODE_FF:
+            DecodeBytes(s_rnDecodeEntries[DECODE_ENTRY_2MOD],
+                        pbSrc, pbOp, fOperand, fAddress, fRax, pInstruction);
+            // CALL /2 /3 and JMP /4 /5.  Unlike CopyFF, CALL [] and JMP []
+            // are not followed through memory; the target is dynamic.
+            if (0x10 == (0x30 & pbOp[1]) || 0x20 == (0x30 & pbOp[1])) {
+                pInstruction->pTarget = DETOUR_INSTRUCTION_TARGET_DYNAMIC;
+            }
+            return pInstruction->cbInstruction;
+
+          case DECODE_VEX3:
+#ifdef DETOURS_X86
+            if ((pbOp[1] & 0xC0) != 0xC0) {
+                return DecodeBytes(s_rnDecodeEntries[DECODE_ENTRY_2MOD],
+                                   pbSrc, pbOp, fOperand, fAddress, fRax, pInstruction);
+            }
+#endif
+#ifdef DETOURS_X64
+            fRax |= !!(pbOp[2] & 0x80);
+#endif
+            bVexM = (BYTE)(pbOp[1] & 0x1F);
+            bVexP = (BYTE)(pbOp[2] & 3);
+            pbOp += 3;
+            break;
+
+          case DECODE_VEX2:
+#ifdef DETOURS_X86
+            if ((pbOp[1] & 0xC0) != 0xC0) {
+                return DecodeBytes(s_rnDecodeEntries[DECODE_ENTRY_2MOD],
+                                   pbSrc, pbOp, fOperand, fAddress, fRax, pInstruction);
+            }
+#endif
+            bVexM = 1;
+            bVexP = (BYTE)(pbOp[1] & 3);
+            pbOp += 2;
+            break;
+
+          case DECODE_EVEX:
+#ifdef DETOURS_X86
+            if ((pbOp[1] & 0xC0) != 0xC0) {
+                return DecodeBytes(s_rnDecodeEntries[DECODE_ENTRY_2MOD],
+                                   pbSrc, pbOp, fOperand, fAddress, fRax, pInstruction);
+            }
+#endif
+            if ((pbOp[1] & 0x0C) != 0 || (pbOp[2] & 0x04) != 0x04) {
+                goto invalid;
+            }
+#ifdef DETOURS_X64
+            fRax |= !!(pbOp[2] & 0x80);
+#endif
+            bVexM = (BYTE)(pbOp[1] & 3);
+            bVexP = (BYTE)(pbOp[2] & 3);
+            pbOp += 4;
+            break;
+
+          case DECODE_XOP: {
+            ULONG nXop;
+            switch (pbOp[1] & 0x1F) {
+              case 8:
+                nXop = DECODE_ENTRY_XOP1;
+                break;
+              case 9:
+                nXop = DECODE_ENTRY_XOP;
+                break;
+              case 10:
+                nXop = DECODE_ENTRY_XOP4;
+                break;
+              default:
+                nXop = DECODE_ENTRY_2MOD;
+                break;
+            }
+            return DecodeBytes(s_rnDecodeEntries[nXop],
+                               pbSrc, pbOp, fOperand, fAddress, fRax, pInstruction);
+          }
+
+          case DECODE_INVALID:
+          default:
+            goto invalid;
+        }
+
+        // VEX and EVEX, as CopyVexEvexCommon.
+        switch (bVexP) {
+          case 1: fOperand = TRUE; break;
+          case 2: fF3 = TRUE; break;
+          case 3: fF2 = TRUE; break;
+        }
+
+        switch (bVexM) {
+          case 1:
+            pnTable = s_rnDecodeTable0F;
+            continue;
+          case 2:
+            return DecodeBytes(s_rnDecodeEntries[DECODE_ENTRY_2MOD],
+                               pbSrc, pbOp, fOperand, fAddress, fRax, pInstruction);
+          case 3:
+            return DecodeBytes(s_rnDecodeEntries[DECODE_ENTRY_2MOD1],
+                               pbSrc, pbOp, fOperand, fAddress, fRax, pInstruction);
+          default:
+            goto invalid;
+        }
+    }
+
+  invalid:
+    pInstruction->cbInstruction = (ULONG)(pbOp - pbSrc) + 1;
+    pInstruction->fFlags |= DETOUR_INSTRUCTION_FLAG_INVALID;
+    return pInstruction->cbInstruction;
+}
+
+#undef DECODE_FIXED
+#undef DECODE_FIXED16
+#undef DECODE_MOD
+#undef DECODE_REL
+#undef DECODE_FLAGS
+#undef DECODE_KIND
+
 #endif // defined(DETOURS_X64) || defined(DETOURS_X86)
 
 /////////////////////////////////////////////////////////// IA64 Disassembler.
@@ -4327,5 +4797,90 @@ BOOL WINAPI DetourSetCodeModule(_In_ HMODULE hModule,
 #endif
 }
 
+//  Purpose:
+//      Measure consecutive instructions without copying them, for scanning
+//      many prologues at once.
+//
+//  Arguments:
+//      pSrc:
+//          Source address of the first instruction.
+//      cbMinimum:
+//          Stop once the decoded instructions cover at least this many
+//          bytes.  0 decodes cInstructions instructions.
+//      pInstructions:
+//          Receives one DETOUR_INSTRUCTION per decoded instruction.
+//      cInstructions:
+//          Capacity of pInstructions.
+//
+//  Returns:
+//      The number of instructions decoded.  Decoding also stops after an
+//      instruction flagged DETOUR_INSTRUCTION_FLAG_INVALID.  Returns 0 and
+//      sets ERROR_NOT_SUPPORTED on architectures without a table-driven
+//      decoder (arm, arm64, ia64).
+//
+//  Comments:
+//      Lengths and targets match DetourCopyInstruction with a NULL pDst,
+//      except that CALL [] and JMP [] report DETOUR_INSTRUCTION_TARGET_DYNAMIC
+//      instead of reading the target from memory.
+//
+ULONG WINAPI DetourDecodeInstructions(_In_ PVOID pSrc,
+                                      _In_ ULONG cbMinimum,
+                                      _Out_writes_to_(cInstructions, return) PDETOUR_INSTRUCTION pInstructions,
+                                      _In_ ULONG cInstructions)
+{
+#if defined(DETOURS_X64) || defined(DETOURS_X86)
+    if (pSrc == NULL || (pInstructions == NULL && cInstructions != 0)) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return 0;
+    }
+
+    PBYTE pbSrc = (PBYTE)pSrc;
+    ULONG cbDecoded = 0;
+    ULONG nDecoded = 0;
+
+    while (nDecoded < cInstructions) {
+        PDETOUR_INSTRUCTION pInstruction = &pInstructions[nDecoded++];
+
+        cbDecoded += CDetourDis::DecodeInstruction(pbSrc + cbDecoded, pInstruction);
+        if ((pInstruction->fFlags & DETOUR_INSTRUCTION_FLAG_INVALID) ||
+            (cbMinimum != 0 && cbDecoded >= cbMinimum)) {
+            break;
+        }
+    }
+    return nDecoded;
+#elif defined(DETOURS_ARM) || defined(DETOURS_ARM64) || defined(DETOURS_IA64)
+    (void)pSrc;
+    (void)cbMinimum;
+    (void)pInstructions;
+    (void)cInstructions;
+    SetLastError(ERROR_NOT_SUPPORTED);
+    return 0;
+#else
+#error unknown architecture (x86, x64, arm, arm64, ia64)
+#endif
+}
+
+//  Purpose:
+//      Measure one instruction.
+//
+//  Returns:
+//      The length of the instruction in bytes, including prefixes.  Returns
+//      0 and sets ERROR_INVALID_DATA if the bytes don't encode a valid
+//      instruction, or ERROR_NOT_SUPPORTED as DetourDecodeInstructions.
+//
+ULONG WINAPI DetourGetInstructionLength(_In_ PVOID pSrc)
+{
+    DETOUR_INSTRUCTION instruction;
+
+    if (DetourDecodeInstructions(pSrc, 0, &instruction, 1) == 0) {
+        return 0;
+    }
+    if (instruction.fFlags & DETOUR_INSTRUCTION_FLAG_INVALID) {
+        SetLastError(ERROR_INVALID_DATA);
+        return 0;
+    }
+    return instruction.cbInstruction;
+}
+
 //
 ///////////////////////////////////////////////////////////////// End of File.
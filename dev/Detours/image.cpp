@@ -188,6 +188,49 @@ public:
     LPCSTR      m_pszName;
 };
 
+class CImageWritePlan
+{
+public:
+    CImageWritePlan();
+    ~CImageWritePlan();
+
+public:
+    BOOL                    Copy(DWORD nFileAddr, PBYTE pbData, DWORD cbData);
+    BOOL                    Zero(DWORD nFileAddr, DWORD cbData);
+    PBYTE                   Patch(DWORD nFileAddr, DWORD cbData);
+
+    BOOL                    Emit(HANDLE hFile);
+
+protected:
+    struct CExtent
+    {
+        DWORD               nFileAddr;
+        DWORD               cbData;
+        PBYTE               pbData;                     // NULL for a zero fill.
+        BOOL                fOwned;
+    };
+
+    CExtent *               AddExtent(DWORD nFileAddr, DWORD cbData);
+    BOOL                    Stage(HANDLE hFile, DWORD nFileAddr, PBYTE pbData, DWORD cbData);
+    BOOL                    Flush(HANDLE hFile);
+    BOOL                    WriteAt(HANDLE hFile, DWORD nFileAddr, PBYTE pbData, DWORD cbData);
+
+protected:
+    CExtent *               m_pExtents;
+    DWORD                   m_nExtents;
+    DWORD                   m_nExtentsAlloc;
+
+    PBYTE                   m_pbStage;
+    DWORD                   m_cbStage;
+    DWORD                   m_nStageFileAddr;
+    DWORD                   m_nFilePointer;
+
+private:
+    enum {
+        STAGE_SIZE = 65536,
+    };
+};
+
 class CImage
 {
     friend class CImageThunks;
@@ -220,13 +263,11 @@ public:                                                 // Manipulation Function
                                         PF_DETOUR_BINARY_COMMIT_CALLBACK pfCommitCallback);
 
 protected:
-    BOOL                    WriteFile(HANDLE hFile,
-                                      LPCVOID lpBuffer,
-                                      DWORD nNumberOfBytesToWrite,
-                                      LPDWORD lpNumberOfBytesWritten);
-    BOOL                    CopyFileData(HANDLE hFile, DWORD nOldPos, DWORD cbData);
-    BOOL                    ZeroFileData(HANDLE hFile, DWORD cbData);
-    BOOL                    AlignFileData(HANDLE hFile);
+    BOOL                    CopyFileData(CImageWritePlan *pPlan,
+                                         DWORD nNewPos,
+                                         DWORD nOldPos,
+                                         DWORD cbData);
+    BOOL                    AlignFileData(CImageWritePlan *pPlan);
 
     BOOL                    SizeOutputBuffer(DWORD cbData);
     PBYTE                   AllocateOutput(DWORD cbData, DWORD *pnVirtAddr);
@@ -753,6 +794,283 @@ public:
     }
 };
 
+//////////////////////////////////////////////////////////////////////////////
+//
+// The write plan records the output file as a list of extents: copies from
+// the mapped input view or from in-memory headers, zero fills, and small
+// patched blocks.  Extents are added in the order CImage::Write produces them
+// and a later extent replaces an earlier one wherever the two overlap.
+// Emit() resolves the overlaps, merges extents that are adjacent in both the
+// file and memory, gathers small runs into a staging buffer, and issues one
+// WriteFile per large run.  Bytes not covered by any extent are not written.
+//
+CImageWritePlan::CImageWritePlan()
+{
+    m_pExtents = NULL;
+    m_nExtents = 0;
+    m_nExtentsAlloc = 0;
+
+    m_pbStage = NULL;
+    m_cbStage = 0;
+    m_nStageFileAddr = 0;
+    m_nFilePointer = ~0u;
+}
+
+CImageWritePlan::~CImageWritePlan()
+{
+    if (m_pExtents) {
+        for (DWORD n = 0; n < m_nExtents; n++) {
+            if (m_pExtents[n].fOwned) {
+                delete[] m_pExtents[n].pbData;
+            }
+        }
+        delete[] m_pExtents;
+        m_pExtents = NULL;
+    }
+    if (m_pbStage) {
+        delete[] m_pbStage;
+        m_pbStage = NULL;
+    }
+    m_nExtents = 0;
+    m_nExtentsAlloc = 0;
+}
+
+CImageWritePlan::CExtent * CImageWritePlan::AddExtent(DWORD nFileAddr, DWORD cbData)
+{
+    if (nFileAddr + cbData < nFileAddr) {
+        SetLastError(ERROR_ARITHMETIC_OVERFLOW);
+        return NULL;
+    }
+
+    if (m_nExtents >= m_nExtentsAlloc) {
+        DWORD nAlloc = m_nExtentsAlloc ? m_nExtentsAlloc * 2 : 32;
+
+        CExtent *pExtents = new NOTHROW CExtent [nAlloc];
+        if (pExtents == NULL) {
+            SetLastError(ERROR_OUTOFMEMORY);
+            return NULL;
+        }
+        if (m_pExtents) {
+            CopyMemory(pExtents, m_pExtents, sizeof(CExtent) * m_nExtents);
+            delete[] m_pExtents;
+        }
+        m_pExtents = pExtents;
+        m_nExtentsAlloc = nAlloc;
+    }
+
+    CExtent *pExtent = &m_pExtents[m_nExtents++];
+    pExtent->nFileAddr = nFileAddr;
+    pExtent->cbData = cbData;
+    pExtent->pbData = NULL;
+    pExtent->fOwned = FALSE;
+    return pExtent;
+}
+
+BOOL CImageWritePlan::Copy(DWORD nFileAddr, PBYTE pbData, DWORD cbData)
+{
+    CExtent *pExtent = AddExtent(nFileAddr, cbData);
+    if (pExtent == NULL) {
+        return FALSE;
+    }
+    pExtent->pbData = pbData;
+    return TRUE;
+}
+
+BOOL CImageWritePlan::Zero(DWORD nFileAddr, DWORD cbData)
+{
+    return AddExtent(nFileAddr, cbData) != NULL;
+}
+
+PBYTE CImageWritePlan::Patch(DWORD nFileAddr, DWORD cbData)
+{
+    PBYTE pbData = new NOTHROW BYTE [cbData ? cbData : 1];
+    if (pbData == NULL) {
+        SetLastError(ERROR_OUTOFMEMORY);
+        return NULL;
+    }
+
+    CExtent *pExtent = AddExtent(nFileAddr, cbData);
+    if (pExtent == NULL) {
+        delete[] pbData;
+        return NULL;
+    }
+    pExtent->pbData = pbData;
+    pExtent->fOwned = TRUE;
+    return pbData;
+}
+
+BOOL CImageWritePlan::WriteAt(HANDLE hFile, DWORD nFileAddr, PBYTE pbData, DWORD cbData)
+{
+    if (nFileAddr != m_nFilePointer) {
+        if (SetFilePointer(hFile, nFileAddr, NULL, FILE_BEGIN) == ~0u) {
+            return FALSE;
+        }
+    }
+
+    DWORD cbDone = 0;
+    if (!::WriteFile(hFile, pbData, cbData, &cbDone, NULL)) {
+        return FALSE;
+    }
+    if (cbDone != cbData) {
+        SetLastError(ERROR_WRITE_FAULT);
+        return FALSE;
+    }
+    m_nFilePointer = nFileAddr + cbData;
+    return TRUE;
+}
+
+BOOL CImageWritePlan::Flush(HANDLE hFile)
+{
+    if (m_cbStage == 0) {
+        return TRUE;
+    }
+
+    DWORD cbStage = m_cbStage;
+    m_cbStage = 0;
+    return WriteAt(hFile, m_nStageFileAddr, m_pbStage, cbStage);
+}
+
+BOOL CImageWritePlan::Stage(HANDLE hFile, DWORD nFileAddr, PBYTE pbData, DWORD cbData)
+{
+    if (m_cbStage != 0 && m_nStageFileAddr + m_cbStage != nFileAddr) {
+        if (!Flush(hFile)) {
+            return FALSE;
+        }
+    }
+
+    // Small runs (headers, patches, alignment padding) are gathered so that
+    // a contiguous stretch of them costs a single write.
+    if (cbData <= STAGE_SIZE - m_cbStage) {
+        if (m_cbStage == 0) {
+            m_nStageFileAddr = nFileAddr;
+        }
+        if (pbData) {
+            CopyMemory(m_pbStage + m_cbStage, pbData, cbData);
+        }
+        else {
+            ZeroMemory(m_pbStage + m_cbStage, cbData);
+        }
+        m_cbStage += cbData;
+        return TRUE;
+    }
+
+    if (!Flush(hFile)) {
+        return FALSE;
+    }
+
+    if (pbData) {
+        return WriteAt(hFile, nFileAddr, pbData, cbData);
+    }
+
+    ZeroMemory(m_pbStage, STAGE_SIZE);
+    while (cbData > 0) {
+        DWORD cbStep = cbData > STAGE_SIZE ? (DWORD)STAGE_SIZE : cbData;
+        if (!WriteAt(hFile, nFileAddr, m_pbStage, cbStep)) {
+            return FALSE;
+        }
+        nFileAddr += cbStep;
+        cbData -= cbStep;
+    }
+    return TRUE;
+}
+
+BOOL CImageWritePlan::Emit(HANDLE hFile)
+{
+    if (m_nExtents == 0) {
+        return TRUE;
+    }
+
+    if (m_pbStage == NULL) {
+        m_pbStage = new NOTHROW BYTE [STAGE_SIZE];
+        if (m_pbStage == NULL) {
+            SetLastError(ERROR_OUTOFMEMORY);
+            return FALSE;
+        }
+    }
+
+    DWORD *pnPoints = new NOTHROW DWORD [m_nExtents * 2];
+    if (pnPoints == NULL) {
+        SetLastError(ERROR_OUTOFMEMORY);
+        return FALSE;
+    }
+
+    // Every extent boundary, sorted and unique, splits the file into pieces
+    // that are each covered entirely by the same set of extents.
+    DWORD nPoints = 0;
+    DWORD n = 0;
+    for (n = 0; n < m_nExtents; n++) {
+        if (m_pExtents[n].cbData != 0) {
+            pnPoints[nPoints++] = m_pExtents[n].nFileAddr;
+            pnPoints[nPoints++] = m_pExtents[n].nFileAddr + m_pExtents[n].cbData;
+        }
+    }
+    for (n = 1; n < nPoints; n++) {
+        DWORD nPoint = pnPoints[n];
+        DWORD m = n;
+        for (; m > 0 && pnPoints[m - 1] > nPoint; m--) {
+            pnPoints[m] = pnPoints[m - 1];
+        }
+        pnPoints[m] = nPoint;
+    }
+
+    BOOL fGood = TRUE;
+    DWORD nRunFileAddr = 0;
+    DWORD cbRun = 0;
+    PBYTE pbRun = NULL;
+
+    for (n = 0; fGood && n + 1 < nPoints; n++) {
+        DWORD nBeg = pnPoints[n];
+        DWORD nEnd = pnPoints[n + 1];
+        if (nBeg == nEnd) {
+            continue;
+        }
+
+        // The most recently added extent covering the piece supplies its bytes.
+        CExtent *pExtent = NULL;
+        for (DWORD e = m_nExtents; e > 0; e--) {
+            CExtent *pCheck = &m_pExtents[e - 1];
+            if (pCheck->cbData != 0 &&
+                pCheck->nFileAddr <= nBeg &&
+                nEnd <= pCheck->nFileAddr + pCheck->cbData) {
+                pExtent = pCheck;
+                break;
+            }
+        }
+        if (pExtent == NULL) {
+            continue;
+        }
+
+        PBYTE pbPiece = NULL;
+        if (pExtent->pbData) {
+            pbPiece = pExtent->pbData + (nBeg - pExtent->nFileAddr);
+        }
+
+        if (cbRun != 0 &&
+            nRunFileAddr + cbRun == nBeg &&
+            (pbRun == NULL ? pbPiece == NULL : pbPiece == pbRun + cbRun)) {
+            cbRun += nEnd - nBeg;
+            continue;
+        }
+
+        if (cbRun != 0) {
+            fGood = Stage(hFile, nRunFileAddr, pbRun, cbRun);
+        }
+        nRunFileAddr = nBeg;
+        pbRun = pbPiece;
+        cbRun = nEnd - nBeg;
+    }
+
+    if (fGood && cbRun != 0) {
+        fGood = Stage(hFile, nRunFileAddr, pbRun, cbRun);
+    }
+    if (fGood) {
+        fGood = Flush(hFile);
+    }
+
+    delete[] pnPoints;
+    return fGood;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //
 CImage * CImage::IsValid(PDETOUR_BINARY pBinary)
@@ -968,62 +1286,36 @@ DWORD CImage::RvaToFileOffset(DWORD nRva)
 
 //////////////////////////////////////////////////////////////////////////////
 //
-BOOL CImage::WriteFile(HANDLE hFile, LPCVOID lpBuffer, DWORD nNumberOfBytesToWrite,
-                       LPDWORD lpNumberOfBytesWritten)
+BOOL CImage::CopyFileData(CImageWritePlan *pPlan, DWORD nNewPos, DWORD nOldPos, DWORD cbData)
 {
-    return ::WriteFile(hFile,
-                       lpBuffer,
-                       nNumberOfBytesToWrite,
-                       lpNumberOfBytesWritten,
-                       NULL);
-}
-
-
-BOOL CImage::CopyFileData(HANDLE hFile, DWORD nOldPos, DWORD cbData)
-{
-    DWORD cbDone = 0;
-    return WriteFile(hFile, m_pMap + nOldPos, cbData, &cbDone);
-}
+    // Bytes past the end of the input file are written as zeros, as they
+    // would read from the tail of the mapped view.
+    DWORD cbCopy = 0;
+    if (nOldPos < m_nFileSize) {
+        cbCopy = m_nFileSize - nOldPos;
+        if (cbCopy > cbData) {
+            cbCopy = cbData;
+        }
+    }
 
-BOOL CImage::ZeroFileData(HANDLE hFile, DWORD cbData)
-{
-    if (!SizeOutputBuffer(4096)) {
+    if (cbCopy != 0 && !pPlan->Copy(nNewPos, m_pMap + nOldPos, cbCopy)) {
         return FALSE;
     }
-
-    ZeroMemory(m_pbOutputBuffer, 4096);
-
-    for (DWORD cbLeft = cbData; cbLeft > 0;) {
-        DWORD cbStep = cbLeft > sizeof(m_pbOutputBuffer)
-            ? sizeof(m_pbOutputBuffer) : cbLeft;
-        DWORD cbDone = 0;
-
-        if (!WriteFile(hFile, m_pbOutputBuffer, cbStep, &cbDone)) {
-            return FALSE;
-        }
-        if (cbDone == 0) {
-            break;
-        }
-
-        cbLeft -= cbDone;
+    if (cbData > cbCopy && !pPlan->Zero(nNewPos + cbCopy, cbData - cbCopy)) {
+        return FALSE;
     }
     return TRUE;
 }
 
-BOOL CImage::AlignFileData(HANDLE hFile)
+BOOL CImage::AlignFileData(CImageWritePlan *pPlan)
 {
     DWORD nLastFileAddr = m_nNextFileAddr;
 
     m_nNextFileAddr = FileAlign(m_nNextFileAddr);
     m_nNextVirtAddr = SectionAlign(m_nNextVirtAddr);
 
-    if (hFile != INVALID_HANDLE_VALUE) {
-        if (m_nNextFileAddr > nLastFileAddr) {
-            if (SetFilePointer(hFile, nLastFileAddr, NULL, FILE_BEGIN) == ~0u) {
-                return FALSE;
-            }
-            return ZeroFileData(hFile, m_nNextFileAddr - nLastFileAddr);
-        }
+    if (pPlan != NULL && m_nNextFileAddr > nLastFileAddr) {
+        return pPlan->Zero(nLastFileAddr, m_nNextFileAddr - nLastFileAddr);
     }
     return TRUE;
 }
@@ -1098,6 +1390,13 @@ BOOL CImage::Read(HANDLE hFile)
         SetLastError(ERROR_EXE_MARKED_INVALID);
         return FALSE;
     }
+    if (m_nSectionsOffset > m_nFileSize ||
+        sizeof(m_SectionHeaders[0]) * m_NtHeader.FileHeader.NumberOfSections
+        > m_nFileSize - m_nSectionsOffset) {
+
+        SetLastError(ERROR_BAD_EXE_FORMAT);
+        return FALSE;
+    }
     CopyMemory(&m_SectionHeaders,
                m_pMap + m_nSectionsOffset,
                sizeof(m_SectionHeaders[0]) * m_NtHeader.FileHeader.NumberOfSections);
@@ -1605,7 +1904,7 @@ BOOL CImage::EditImports(PVOID pContext,
 
 BOOL CImage::Write(HANDLE hFile)
 {
-    DWORD cbDone;
+    CImageWritePlan plan;
 
     if (hFile == INVALID_HANDLE_VALUE) {
         SetLastError(ERROR_INVALID_HANDLE);
@@ -1622,10 +1921,7 @@ BOOL CImage::Write(HANDLE hFile)
 
     //////////////////////////////////////////////////////////// Copy Headers.
     //
-    if (SetFilePointer(hFile, 0, NULL, FILE_BEGIN) == ~0u) {
-        return FALSE;
-    }
-    if (!CopyFileData(hFile, 0, m_NtHeader.OptionalHeader.SizeOfHeaders)) {
+    if (!CopyFileData(&plan, 0, 0, m_NtHeader.OptionalHeader.SizeOfHeaders)) {
         return FALSE;
     }
 
@@ -1638,13 +1934,10 @@ BOOL CImage::Write(HANDLE hFile)
             + m_NtHeader.FileHeader.SizeOfOptionalHeader;
         m_DosHeader.e_lfanew = m_nPeOffset;
 
-        if (SetFilePointer(hFile, 0, NULL, FILE_BEGIN) == ~0u) {
-            return FALSE;
-        }
-        if (!WriteFile(hFile, &m_DosHeader, sizeof(m_DosHeader), &cbDone)) {
+        if (!plan.Copy(0, (PBYTE)&m_DosHeader, sizeof(m_DosHeader))) {
             return FALSE;
         }
-        if (!WriteFile(hFile, &s_rbDosCode, sizeof(s_rbDosCode), &cbDone)) {
+        if (!plan.Copy(sizeof(m_DosHeader), s_rbDosCode, sizeof(s_rbDosCode))) {
             return FALSE;
         }
     }
@@ -1659,10 +1952,7 @@ BOOL CImage::Write(HANDLE hFile)
             m_DosHeader.e_lfanew = m_nPeOffset;
 
 
-            if (SetFilePointer(hFile, 0, NULL, FILE_BEGIN) == ~0u) {
-                return FALSE;
-            }
-            if (!CopyFileData(hFile, m_nPrePE, m_cbPrePE)) {
+            if (!CopyFileData(&plan, 0, m_nPrePE, m_cbPrePE)) {
                 return FALSE;
             }
         }
@@ -1670,7 +1960,7 @@ BOOL CImage::Write(HANDLE hFile)
 
     m_nNextFileAddr = m_NtHeader.OptionalHeader.SizeOfHeaders;
     m_nNextVirtAddr = 0;
-    if (!AlignFileData(hFile)) {
+    if (!AlignFileData(&plan)) {
         return FALSE;
     }
 
@@ -1679,12 +1969,8 @@ BOOL CImage::Write(HANDLE hFile)
     DWORD n = 0;
     for (; n < m_NtHeader.FileHeader.NumberOfSections; n++) {
         if (m_SectionHeaders[n].SizeOfRawData) {
-            if (SetFilePointer(hFile,
-                               m_SectionHeaders[n].PointerToRawData,
-                               NULL, FILE_BEGIN) == ~0u) {
-                return FALSE;
-            }
-            if (!CopyFileData(hFile,
+            if (!CopyFileData(&plan,
+                              m_SectionHeaders[n].PointerToRawData,
                               m_SectionHeaders[n].PointerToRawData,
                               m_SectionHeaders[n].SizeOfRawData)) {
                 return FALSE;
@@ -1703,7 +1989,7 @@ BOOL CImage::Write(HANDLE hFile)
 
         m_nExtraOffset = Max(m_nNextFileAddr, m_nExtraOffset);
 
-        if (!AlignFileData(hFile)) {
+        if (!AlignFileData(&plan)) {
             return FALSE;
         }
     }
@@ -1881,7 +2167,7 @@ BOOL CImage::Write(HANDLE hFile)
         m_nNextVirtAddr += m_nOutputVirtSize;
         m_nNextFileAddr += FileAlign(m_nOutputVirtSize);
 
-        if (!AlignFileData(hFile)) {
+        if (!AlignFileData(&plan)) {
             return FALSE;
         }
 
@@ -1906,12 +2192,9 @@ BOOL CImage::Write(HANDLE hFile)
 
         //////////////////////////////////////////////////////////////////////////
         //
-        if (SetFilePointer(hFile, m_SectionHeaders[nSection].PointerToRawData,
-                           NULL, FILE_BEGIN) == ~0u) {
-            return FALSE;
-        }
-        if (!WriteFile(hFile, m_pbOutputBuffer, m_SectionHeaders[nSection].SizeOfRawData,
-                       &cbDone)) {
+        if (!plan.Copy(m_SectionHeaders[nSection].PointerToRawData,
+                       m_pbOutputBuffer,
+                       m_SectionHeaders[nSection].SizeOfRawData)) {
             return FALSE;
         }
     }
@@ -1945,9 +2228,6 @@ BOOL CImage::Write(HANDLE hFile)
         .DataDirectory[IMAGE_DIRECTORY_ENTRY_DEBUG].Size;
     if (debugAddr && debugSize) {
         DWORD nFileOffset = RvaToFileOffset(debugAddr);
-        if (SetFilePointer(hFile, nFileOffset, NULL, FILE_BEGIN) == ~0u) {
-            return FALSE;
-        }
 
         PIMAGE_DEBUG_DIRECTORY pDir = (PIMAGE_DEBUG_DIRECTORY)RvaToVa(debugAddr);
         if (pDir == NULL) {
@@ -1955,14 +2235,16 @@ BOOL CImage::Write(HANDLE hFile)
         }
 
         DWORD nEntries = debugSize / sizeof(*pDir);
+        PIMAGE_DEBUG_DIRECTORY pDirDst = (PIMAGE_DEBUG_DIRECTORY)
+            plan.Patch(nFileOffset, nEntries * sizeof(*pDir));
+        if (pDirDst == NULL) {
+            return FALSE;
+        }
         for (n = 0; n < nEntries; n++) {
-            IMAGE_DEBUG_DIRECTORY dir = pDir[n];
+            pDirDst[n] = pDir[n];
 
-            if (dir.PointerToRawData > m_nExtraOffset) {
-                dir.PointerToRawData += nExtraAdjust;
-            }
-            if (!WriteFile(hFile, &dir, sizeof(dir), &cbDone)) {
-                return FALSE;
+            if (pDirDst[n].PointerToRawData > m_nExtraOffset) {
+                pDirDst[n].PointerToRawData += nExtraAdjust;
             }
         }
     }
@@ -1975,31 +2257,28 @@ BOOL CImage::Write(HANDLE hFile)
         .DataDirectory[IMAGE_DIRECTORY_ENTRY_COM_DESCRIPTOR].Size;
     if (clrAddr && clrSize && fNeedDetourSection) {
         DWORD nFileOffset = RvaToFileOffset(clrAddr);
-        if (SetFilePointer(hFile, nFileOffset, NULL, FILE_BEGIN) == ~0u) {
-            return FALSE;
-        }
 
         PDETOUR_CLR_HEADER pHdr = (PDETOUR_CLR_HEADER)RvaToVa(clrAddr);
         if (pHdr == NULL) {
             return FALSE;
         }
 
-        DETOUR_CLR_HEADER hdr;
-        hdr = *pHdr;
-        hdr.Flags &= 0xfffffffe;    // Clear the IL_ONLY flag.
-
-        if (!WriteFile(hFile, &hdr, sizeof(hdr), &cbDone)) {
+        PDETOUR_CLR_HEADER pHdrDst = (PDETOUR_CLR_HEADER)
+            plan.Patch(nFileOffset, sizeof(*pHdrDst));
+        if (pHdrDst == NULL) {
             return FALSE;
         }
+        *pHdrDst = *pHdr;
+        pHdrDst->Flags &= 0xfffffffe;   // Clear the IL_ONLY flag.
     }
 
     ///////////////////////////////////////////////// Copy Left-over Data.
     //
     if (m_nFileSize > m_nExtraOffset) {
-        if (SetFilePointer(hFile, m_nNextFileAddr, NULL, FILE_BEGIN) == ~0u) {
-            return FALSE;
-        }
-        if (!CopyFileData(hFile, m_nExtraOffset, m_nFileSize - m_nExtraOffset)) {
+        if (!CopyFileData(&plan,
+                          m_nNextFileAddr,
+                          m_nExtraOffset,
+                          m_nFileSize - m_nExtraOffset)) {
             return FALSE;
         }
     }
@@ -2008,29 +2287,31 @@ BOOL CImage::Write(HANDLE hFile)
     //////////////////////////////////////////////////// Finalize Headers.
     //
 
-    if (SetFilePointer(hFile, m_nPeOffset, NULL, FILE_BEGIN) == ~0u) {
+    DWORD cbSectionHeaders = sizeof(m_SectionHeaders[0])
+        * m_NtHeader.FileHeader.NumberOfSections;
+
+    if (!plan.Copy(m_nPeOffset, (PBYTE)&m_NtHeader, sizeof(m_NtHeader))) {
         return FALSE;
     }
-    if (!WriteFile(hFile, &m_NtHeader, sizeof(m_NtHeader), &cbDone)) {
+    if (!plan.Copy(m_nSectionsOffset, (PBYTE)&m_SectionHeaders, cbSectionHeaders)) {
         return FALSE;
     }
 
-    if (SetFilePointer(hFile, m_nSectionsOffset, NULL, FILE_BEGIN) == ~0u) {
-        return FALSE;
-    }
-    if (!WriteFile(hFile, &m_SectionHeaders,
-                   sizeof(m_SectionHeaders[0])
-                   * m_NtHeader.FileHeader.NumberOfSections,
-                   &cbDone)) {
+    m_cbPostPE = m_NtHeader.OptionalHeader.SizeOfHeaders
+        - (m_nSectionsOffset + cbSectionHeaders);
+
+    ////////////////////////////////////////////////////// Emit Write Plan.
+    //
+    if (!plan.Emit(hFile)) {
         return FALSE;
     }
 
-    m_cbPostPE = SetFilePointer(hFile, 0, NULL, FILE_CURRENT);
-    if (m_cbPostPE == ~0u) {
+    // Leave the file pointer just past the section headers, as callers of
+    // earlier versions could observe.
+    if (SetFilePointer(hFile, m_nSectionsOffset + cbSectionHeaders,
+                       NULL, FILE_BEGIN) == ~0u) {
         return FALSE;
     }
-    m_cbPostPE = m_NtHeader.OptionalHeader.SizeOfHeaders - m_cbPostPE;
-
     return TRUE;
 }
 
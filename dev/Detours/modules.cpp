@@ -139,10 +139,14 @@ PDETOUR_SYM_INFO DetourLoadImageHlp(VOID)
     return pSymInfo;
 }
 
+static PBYTE detour_find_module_export(_In_ HMODULE hModule,
+                                       _In_ LPCSTR pszFunction,
+                                       _In_ ULONG nDepth);
+
 PVOID WINAPI DetourFindFunction(_In_ LPCSTR pszModule,
                                 _In_ LPCSTR pszFunction)
 {
-    /////////////////////////////////////////////// First, try GetProcAddress.
+    ////////////////////////////////// First, try the module's export index.
     //
 #pragma prefast(suppress:28752, "We don't do the unicode conversion for LoadLibraryExA.")
     HMODULE hModule = LoadLibraryExA(pszModule, NULL, 0);
@@ -150,7 +154,21 @@ PVOID WINAPI DetourFindFunction(_In_ LPCSTR pszModule,
         return NULL;
     }
 
-    PBYTE pbCode = (PBYTE)GetProcAddress(hModule, pszFunction);
+    PBYTE pbCode = NULL;
+    __try {
+        pbCode = detour_find_module_export(hModule, pszFunction, 0);
+    }
+    __except(GetExceptionCode() == EXCEPTION_ACCESS_VIOLATION ?
+             EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH) {
+        pbCode = NULL;
+    }
+    if (pbCode) {
+        return pbCode;
+    }
+
+    /////////////////////////////////////////////// Then, try GetProcAddress.
+    //
+    pbCode = (PBYTE)GetProcAddress(hModule, pszFunction);
     if (pbCode) {
         return pbCode;
     }
@@ -452,70 +470,488 @@ static inline PBYTE RvaAdjust(_Pre_notnull_ PIMAGE_DOS_HEADER pDosHeader, _In_ D
     return NULL;
 }
 
-BOOL WINAPI DetourEnumerateExports(_In_ HMODULE hModule,
-                                   _In_opt_ PVOID pContext,
-                                   _In_ PF_DETOUR_ENUMERATE_EXPORT_CALLBACK pfExport)
+///////////////////////////////////////////////////////////// Export Indexes.
+//
+//  An export index is built once from the export directory of an image and
+//  answers name and ordinal lookups without walking the directory.  Names
+//  are found through an open-addressed hash table; ordinals index an array.
+//  The image may be a loaded module (fMapped) or the raw bytes of a file,
+//  in which case RVAs are translated through the section headers.  Every
+//  RVA is bounds checked against the buffer, so the parser doesn't need
+//  SEH to survive a malformed image.
+//
+struct _DETOUR_EXPORT_INDEX
 {
-    PIMAGE_DOS_HEADER pDosHeader = (PIMAGE_DOS_HEADER)hModule;
-    if (hModule == NULL) {
-        pDosHeader = (PIMAGE_DOS_HEADER)GetModuleHandleW(NULL);
+    _DETOUR_EXPORT_INDEX *  pNext;          // Next cached index of a loaded module.
+    HMODULE                 hModule;        // Loaded module, or NULL.
+    DWORD                   nTimeDateStamp;
+    DWORD                   nSizeOfImage;
+
+    PBYTE                   pbImage;
+    SIZE_T                  cbImage;
+    BOOL                    fMapped;
+    DWORD                   cbHeaders;
+    PIMAGE_SECTION_HEADER   pSections;
+    ULONG                   cSections;
+
+    DWORD                   nExportRva;
+    DWORD                   cbExport;
+    ULONG                   nBase;
+    ULONG                   cFunctions;
+    PDWORD                  pdwFunctions;
+    ULONG                   cNames;
+    PWORD                   pwOrdinals;     // [cNames] function index of each name.
+    LPCSTR *                rpszNames;      // [cNames] validated names.
+    LPCSTR *                rpszFunctionNames; // [cFunctions] first name of each function.
+    ULONG                   nBucketMask;
+    PULONG                  rnBuckets;      // [nBucketMask + 1] name index + 1, or 0.
+};
+
+typedef struct _DETOUR_EXPORT_INDEX DETOUR_EXPORT_INDEX_IMPL, *PDETOUR_EXPORT_INDEX_IMPL;
+
+const ULONG DETOUR_EXPORT_INDEX_MAX_ENTRIES = 0x100000;
+const ULONG DETOUR_EXPORT_FORWARDER_MAX_DEPTH = 8;
+
+static ULONG detour_export_hash(_In_ LPCSTR pszName)
+{
+    // FNV-1a
+    ULONG nHash = 2166136261u;
+    for (; *pszName; pszName++) {
+        nHash = (nHash ^ (BYTE)*pszName) * 16777619u;
     }
+    return nHash;
+}
 
-    __try {
-#pragma warning(suppress:6011) // GetModuleHandleW(NULL) never returns NULL.
-        if (pDosHeader->e_magic != IMAGE_DOS_SIGNATURE) {
-            SetLastError(ERROR_BAD_EXE_FORMAT);
+// Returns a pointer to cb bytes at nRva, or NULL if they aren't all in the image.
+static PBYTE detour_export_rva(_In_ PDETOUR_EXPORT_INDEX_IMPL pIndex,
+                               _In_ DWORD nRva,
+                               _In_ SIZE_T cb,
+                               _Out_opt_ SIZE_T *pcbAvailable)
+{
+    ULONGLONG nOffset = nRva;
+    ULONGLONG nLimit = pIndex->cbImage;
+
+    if (!pIndex->fMapped && nRva >= pIndex->cbHeaders) {
+        PIMAGE_SECTION_HEADER pSection = NULL;
+        for (ULONG n = 0; n < pIndex->cSections; n++) {
+            PIMAGE_SECTION_HEADER pCheck = &pIndex->pSections[n];
+            if (nRva >= pCheck->VirtualAddress &&
+                nRva - pCheck->VirtualAddress < pCheck->SizeOfRawData) {
+                pSection = pCheck;
+                break;
+            }
+        }
+        if (pSection == NULL) {
             return NULL;
         }
-
-        PIMAGE_NT_HEADERS pNtHeader = (PIMAGE_NT_HEADERS)((PBYTE)pDosHeader +
-                                                          pDosHeader->e_lfanew);
-        if (pNtHeader->Signature != IMAGE_NT_SIGNATURE) {
-            SetLastError(ERROR_INVALID_EXE_SIGNATURE);
-            return FALSE;
+        nOffset = (ULONGLONG)pSection->PointerToRawData + (nRva - pSection->VirtualAddress);
+        nLimit = (ULONGLONG)pSection->PointerToRawData + pSection->SizeOfRawData;
+        if (nLimit > pIndex->cbImage) {
+            nLimit = pIndex->cbImage;
         }
-        if (pNtHeader->FileHeader.SizeOfOptionalHeader == 0) {
+    }
+    else if (!pIndex->fMapped && pIndex->cbHeaders < nLimit) {
+        nLimit = pIndex->cbHeaders;
+    }
+
+    if (nOffset > nLimit || cb > nLimit - nOffset) {
+        return NULL;
+    }
+    if (pcbAvailable != NULL) {
+        *pcbAvailable = (SIZE_T)(nLimit - nOffset);
+    }
+    return pIndex->pbImage + nOffset;
+}
+
+// Returns the NUL terminated string at nRva, or NULL if it runs off the image.
+static LPCSTR detour_export_string(_In_ PDETOUR_EXPORT_INDEX_IMPL pIndex, _In_ DWORD nRva)
+{
+    SIZE_T cbAvailable = 0;
+    PBYTE pbString = detour_export_rva(pIndex, nRva, 1, &cbAvailable);
+    if (pbString == NULL || memchr(pbString, 0, cbAvailable) == NULL) {
+        return NULL;
+    }
+    return (LPCSTR)pbString;
+}
+
+static BOOL detour_export_from_index(_In_ PDETOUR_EXPORT_INDEX_IMPL pIndex,
+                                     _In_ ULONG nFunction,
+                                     _In_opt_ LPCSTR pszName,
+                                     _Out_ PDETOUR_EXPORT pExport)
+{
+    DWORD nRva = pIndex->pdwFunctions[nFunction];
+
+    pExport->nOrdinal = pIndex->nBase + nFunction;
+    pExport->nRva = nRva;
+    pExport->pszName = pszName ? pszName : pIndex->rpszFunctionNames[nFunction];
+    pExport->pszForwarder = NULL;
+
+    // if the RVA is in the export region, then it is a forwarder.
+    if (nRva > pIndex->nExportRva && nRva - pIndex->nExportRva < pIndex->cbExport) {
+        pExport->nRva = 0;
+        pExport->pszForwarder = detour_export_string(pIndex, nRva);
+        if (pExport->pszForwarder == NULL) {
             SetLastError(ERROR_EXE_MARKED_INVALID);
             return FALSE;
         }
+    }
+    return TRUE;
+}
 
-        PIMAGE_EXPORT_DIRECTORY pExportDir
-            = (PIMAGE_EXPORT_DIRECTORY)
-            RvaAdjust(pDosHeader,
-                      pNtHeader->OptionalHeader
-                      .DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT].VirtualAddress);
+PDETOUR_EXPORT_INDEX WINAPI DetourCreateExportIndex(_In_reads_bytes_(cbImage) PVOID pvImage,
+                                                    _In_ SIZE_T cbImage,
+                                                    _In_ BOOL fMapped)
+{
+    DETOUR_EXPORT_INDEX_IMPL index;
+    ZeroMemory(&index, sizeof(index));
+    index.pbImage = (PBYTE)pvImage;
+    index.cbImage = cbImage;
+    index.fMapped = fMapped;
+
+    if (pvImage == NULL || cbImage < sizeof(IMAGE_DOS_HEADER)) {
+        SetLastError(ERROR_BAD_EXE_FORMAT);
+        return NULL;
+    }
+
+    PIMAGE_DOS_HEADER pDosHeader = (PIMAGE_DOS_HEADER)pvImage;
+    if (pDosHeader->e_magic != IMAGE_DOS_SIGNATURE) {
+        SetLastError(ERROR_BAD_EXE_FORMAT);
+        return NULL;
+    }
+
+    // The NT headers are read in place; headers always map at offset 0.
+    SIZE_T cbNtPrefix = FIELD_OFFSET(IMAGE_NT_HEADERS32, OptionalHeader);
+    if (pDosHeader->e_lfanew < 0 ||
+        (SIZE_T)pDosHeader->e_lfanew > cbImage ||
+        cbImage - pDosHeader->e_lfanew < cbNtPrefix + sizeof(WORD)) {
+        SetLastError(ERROR_INVALID_EXE_SIGNATURE);
+        return NULL;
+    }
+
+    PIMAGE_NT_HEADERS32 pNtHeader32 = (PIMAGE_NT_HEADERS32)((PBYTE)pvImage + pDosHeader->e_lfanew);
+    PIMAGE_NT_HEADERS64 pNtHeader64 = (PIMAGE_NT_HEADERS64)pNtHeader32;
+    if (pNtHeader32->Signature != IMAGE_NT_SIGNATURE) {
+        SetLastError(ERROR_INVALID_EXE_SIGNATURE);
+        return NULL;
+    }
+
+    SIZE_T cbOptional = pNtHeader32->FileHeader.SizeOfOptionalHeader;
+    SIZE_T cbAfterNt = cbImage - pDosHeader->e_lfanew - cbNtPrefix;
+    if (cbOptional == 0 || cbOptional > cbAfterNt) {
+        SetLastError(ERROR_EXE_MARKED_INVALID);
+        return NULL;
+    }
+
+    PIMAGE_DATA_DIRECTORY pExportDirectory;
+    if (pNtHeader32->OptionalHeader.Magic == IMAGE_NT_OPTIONAL_HDR32_MAGIC &&
+        cbOptional >= FIELD_OFFSET(IMAGE_OPTIONAL_HEADER32, DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT + 1]) &&
+        pNtHeader32->OptionalHeader.NumberOfRvaAndSizes > IMAGE_DIRECTORY_ENTRY_EXPORT) {
+
+        pExportDirectory = &pNtHeader32->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+        index.cbHeaders = pNtHeader32->OptionalHeader.SizeOfHeaders;
+    }
+    else if (pNtHeader64->OptionalHeader.Magic == IMAGE_NT_OPTIONAL_HDR64_MAGIC &&
+             cbOptional >= FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT + 1]) &&
+             pNtHeader64->OptionalHeader.NumberOfRvaAndSizes > IMAGE_DIRECTORY_ENTRY_EXPORT) {
+
+        pExportDirectory = &pNtHeader64->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+        index.cbHeaders = pNtHeader64->OptionalHeader.SizeOfHeaders;
+    }
+    else {
+        SetLastError(ERROR_EXE_MARKED_INVALID);
+        return NULL;
+    }
+
+    index.cSections = pNtHeader32->FileHeader.NumberOfSections;
+    index.pSections = (PIMAGE_SECTION_HEADER)((PBYTE)&pNtHeader32->OptionalHeader + cbOptional);
+    if ((ULONGLONG)index.cSections * sizeof(IMAGE_SECTION_HEADER) > cbAfterNt - cbOptional) {
+        SetLastError(ERROR_EXE_MARKED_INVALID);
+        return NULL;
+    }
+
+    index.nExportRva = pExportDirectory->VirtualAddress;
+    index.cbExport = pExportDirectory->Size;
+
+    PIMAGE_EXPORT_DIRECTORY pExportDir = (PIMAGE_EXPORT_DIRECTORY)
+        detour_export_rva(&index, index.nExportRva, sizeof(IMAGE_EXPORT_DIRECTORY), NULL);
+    if (index.nExportRva == 0 || pExportDir == NULL ||
+        pExportDir->NumberOfFunctions > DETOUR_EXPORT_INDEX_MAX_ENTRIES ||
+        pExportDir->NumberOfNames > DETOUR_EXPORT_INDEX_MAX_ENTRIES) {
+        SetLastError(ERROR_EXE_MARKED_INVALID);
+        return NULL;
+    }
+
+    index.nBase = pExportDir->Base;
+    index.cFunctions = pExportDir->NumberOfFunctions;
+    index.cNames = pExportDir->NumberOfNames;
+    index.pdwFunctions = (PDWORD)detour_export_rva(&index, pExportDir->AddressOfFunctions,
+                                                   index.cFunctions * sizeof(DWORD), NULL);
+    PDWORD pdwNames = (PDWORD)detour_export_rva(&index, pExportDir->AddressOfNames,
+                                                index.cNames * sizeof(DWORD), NULL);
+    index.pwOrdinals = (PWORD)detour_export_rva(&index, pExportDir->AddressOfNameOrdinals,
+                                                index.cNames * sizeof(WORD), NULL);
+    if ((index.cFunctions != 0 && index.pdwFunctions == NULL) ||
+        (index.cNames != 0 && (pdwNames == NULL || index.pwOrdinals == NULL))) {
+        SetLastError(ERROR_EXE_MARKED_INVALID);
+        return NULL;
+    }
+
+    ULONG cBuckets = 0;
+    if (index.cNames != 0) {
+        for (cBuckets = 16; cBuckets < index.cNames * 2; cBuckets <<= 1) {
+        }
+    }
 
-        if (pExportDir == NULL) {
+    // One allocation holds the index, the name tables and the hash buckets.
+    SIZE_T cbIndex = sizeof(DETOUR_EXPORT_INDEX_IMPL) +
+        (index.cNames + index.cFunctions) * sizeof(LPCSTR) +
+        cBuckets * sizeof(ULONG);
+    PBYTE pbIndex = new NOTHROW BYTE [cbIndex];
+    if (pbIndex == NULL) {
+        SetLastError(ERROR_OUTOFMEMORY);
+        return NULL;
+    }
+    ZeroMemory(pbIndex, cbIndex);
+
+    PDETOUR_EXPORT_INDEX_IMPL pIndex = (PDETOUR_EXPORT_INDEX_IMPL)pbIndex;
+    *pIndex = index;
+    pIndex->rpszNames = (LPCSTR *)(pIndex + 1);
+    pIndex->rpszFunctionNames = pIndex->rpszNames + index.cNames;
+    pIndex->rnBuckets = (PULONG)(pIndex->rpszFunctionNames + index.cFunctions);
+    pIndex->nBucketMask = cBuckets - 1;
+
+    for (ULONG n = 0; n < index.cNames; n++) {
+        LPCSTR pszName = detour_export_string(pIndex, pdwNames[n]);
+        WORD nFunction = index.pwOrdinals[n];
+        if (pszName == NULL || nFunction >= index.cFunctions) {
+            delete[] pbIndex;
             SetLastError(ERROR_EXE_MARKED_INVALID);
-            return FALSE;
+            return NULL;
         }
 
-        PBYTE pExportDirEnd = (PBYTE)pExportDir + pNtHeader->OptionalHeader
-            .DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT].Size;
-        PDWORD pdwFunctions = (PDWORD)RvaAdjust(pDosHeader, pExportDir->AddressOfFunctions);
-        PDWORD pdwNames = (PDWORD)RvaAdjust(pDosHeader, pExportDir->AddressOfNames);
-        PWORD pwOrdinals = (PWORD)RvaAdjust(pDosHeader, pExportDir->AddressOfNameOrdinals);
+        pIndex->rpszNames[n] = pszName;
+        if (pIndex->rpszFunctionNames[nFunction] == NULL) {
+            pIndex->rpszFunctionNames[nFunction] = pszName;
+        }
+
+        ULONG nBucket = detour_export_hash(pszName) & pIndex->nBucketMask;
+        while (pIndex->rnBuckets[nBucket] != 0) {
+            nBucket = (nBucket + 1) & pIndex->nBucketMask;
+        }
+        pIndex->rnBuckets[nBucket] = n + 1;
+    }
+
+    SetLastError(NO_ERROR);
+    return (PDETOUR_EXPORT_INDEX)pIndex;
+}
+
+VOID WINAPI DetourFreeExportIndex(_In_ PDETOUR_EXPORT_INDEX pIndex)
+{
+    // Indexes cached for loaded modules live as long as the process.
+    if (pIndex != NULL && ((PDETOUR_EXPORT_INDEX_IMPL)pIndex)->hModule == NULL) {
+        delete[] (PBYTE)pIndex;
+    }
+}
+
+BOOL WINAPI DetourFindExport(_In_ PDETOUR_EXPORT_INDEX pIndex,
+                             _In_ LPCSTR pszName,
+                             _Out_ PDETOUR_EXPORT pExport)
+{
+    PDETOUR_EXPORT_INDEX_IMPL pImpl = (PDETOUR_EXPORT_INDEX_IMPL)pIndex;
 
-        for (DWORD nFunc = 0; nFunc < pExportDir->NumberOfFunctions; nFunc++) {
-            PBYTE pbCode = (pdwFunctions != NULL)
-                ? (PBYTE)RvaAdjust(pDosHeader, pdwFunctions[nFunc]) : NULL;
-            PCHAR pszName = NULL;
+    if (pImpl == NULL || pszName == NULL) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if (pImpl->cNames != 0) {
+        ULONG nBucket = detour_export_hash(pszName) & pImpl->nBucketMask;
+        for (ULONG nName; (nName = pImpl->rnBuckets[nBucket]) != 0;
+             nBucket = (nBucket + 1) & pImpl->nBucketMask) {
 
-            // if the pointer is in the export region, then it is a forwarder.
-            if (pbCode > (PBYTE)pExportDir && pbCode < pExportDirEnd) {
-                pbCode = NULL;
+            if (strcmp(pImpl->rpszNames[nName - 1], pszName) == 0) {
+                return detour_export_from_index(pImpl, pImpl->pwOrdinals[nName - 1],
+                                                pImpl->rpszNames[nName - 1], pExport);
             }
+        }
+    }
 
-            for (DWORD n = 0; n < pExportDir->NumberOfNames; n++) {
-                if (pwOrdinals[n] == nFunc) {
-                    pszName = (pdwNames != NULL)
-                        ? (PCHAR)RvaAdjust(pDosHeader, pdwNames[n]) : NULL;
-                    break;
-                }
+    SetLastError(ERROR_PROC_NOT_FOUND);
+    return FALSE;
+}
+
+BOOL WINAPI DetourFindExportByOrdinal(_In_ PDETOUR_EXPORT_INDEX pIndex,
+                                      _In_ ULONG nOrdinal,
+                                      _Out_ PDETOUR_EXPORT pExport)
+{
+    PDETOUR_EXPORT_INDEX_IMPL pImpl = (PDETOUR_EXPORT_INDEX_IMPL)pIndex;
+
+    if (pImpl == NULL) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+    if (nOrdinal < pImpl->nBase || nOrdinal - pImpl->nBase >= pImpl->cFunctions) {
+        SetLastError(ERROR_PROC_NOT_FOUND);
+        return FALSE;
+    }
+    return detour_export_from_index(pImpl, nOrdinal - pImpl->nBase, NULL, pExport);
+}
+
+static SRWLOCK s_srwExportIndexes = SRWLOCK_INIT;
+static PDETOUR_EXPORT_INDEX_IMPL s_pExportIndexes = NULL;
+
+// Returns the cached export index of a loaded module, building it on first use.
+// A module unloaded and replaced at the same address is detected by its
+// timestamp and size; stale indexes are never freed because other threads may
+// still be reading them.  The caller must guard against access violations.
+static PDETOUR_EXPORT_INDEX_IMPL detour_module_export_index(_In_ HMODULE hModule)
+{
+    PIMAGE_DOS_HEADER pDosHeader = (PIMAGE_DOS_HEADER)hModule;
+    if (pDosHeader->e_magic != IMAGE_DOS_SIGNATURE) {
+        SetLastError(ERROR_BAD_EXE_FORMAT);
+        return NULL;
+    }
+    PIMAGE_NT_HEADERS pNtHeader = (PIMAGE_NT_HEADERS)((PBYTE)pDosHeader + pDosHeader->e_lfanew);
+    if (pNtHeader->Signature != IMAGE_NT_SIGNATURE) {
+        SetLastError(ERROR_INVALID_EXE_SIGNATURE);
+        return NULL;
+    }
+    DWORD nTimeDateStamp = pNtHeader->FileHeader.TimeDateStamp;
+    DWORD nSizeOfImage = pNtHeader->OptionalHeader.SizeOfImage;
+
+    PDETOUR_EXPORT_INDEX_IMPL pIndex;
+
+    AcquireSRWLockShared(&s_srwExportIndexes);
+    for (pIndex = s_pExportIndexes; pIndex != NULL; pIndex = pIndex->pNext) {
+        if (pIndex->hModule == hModule &&
+            pIndex->nTimeDateStamp == nTimeDateStamp &&
+            pIndex->nSizeOfImage == nSizeOfImage) {
+            break;
+        }
+    }
+    ReleaseSRWLockShared(&s_srwExportIndexes);
+
+    if (pIndex != NULL) {
+        return pIndex;
+    }
+
+    pIndex = (PDETOUR_EXPORT_INDEX_IMPL)DetourCreateExportIndex(hModule, nSizeOfImage, TRUE);
+    if (pIndex == NULL) {
+        return NULL;
+    }
+    pIndex->hModule = hModule;
+    pIndex->nTimeDateStamp = nTimeDateStamp;
+    pIndex->nSizeOfImage = nSizeOfImage;
+
+    AcquireSRWLockExclusive(&s_srwExportIndexes);
+    for (PDETOUR_EXPORT_INDEX_IMPL pOther = s_pExportIndexes; pOther != NULL; pOther = pOther->pNext) {
+        if (pOther->hModule == hModule &&
+            pOther->nTimeDateStamp == nTimeDateStamp &&
+            pOther->nSizeOfImage == nSizeOfImage) {
+
+            // Another thread indexed the module first.
+            ReleaseSRWLockExclusive(&s_srwExportIndexes);
+            delete[] (PBYTE)pIndex;
+            return pOther;
+        }
+    }
+    pIndex->pNext = s_pExportIndexes;
+    s_pExportIndexes = pIndex;
+    ReleaseSRWLockExclusive(&s_srwExportIndexes);
+
+    return pIndex;
+}
+
+// Finds an export of a loaded module by name or by ordinal (IS_INTRESOURCE),
+// following forwarders to the modules they name.
+static PBYTE detour_find_module_export(_In_ HMODULE hModule,
+                                       _In_ LPCSTR pszFunction,
+                                       _In_ ULONG nDepth)
+{
+    PDETOUR_EXPORT_INDEX_IMPL pIndex = detour_module_export_index(hModule);
+    if (pIndex == NULL) {
+        return NULL;
+    }
+
+    DETOUR_EXPORT found;
+    if (IS_INTRESOURCE(pszFunction)) {
+        if (!DetourFindExportByOrdinal(pIndex, (ULONG)(ULONG_PTR)pszFunction, &found)) {
+            return NULL;
+        }
+    }
+    else if (!DetourFindExport(pIndex, pszFunction, &found)) {
+        return NULL;
+    }
+
+    if (found.pszForwarder == NULL) {
+        return (found.nRva != 0) ? (PBYTE)hModule + found.nRva : NULL;
+    }
+    if (nDepth >= DETOUR_EXPORT_FORWARDER_MAX_DEPTH) {
+        return NULL;
+    }
+
+    // "Module.Function" or "Module.#Ordinal"; module names may contain dots.
+    LPCSTR pszDot = strrchr(found.pszForwarder, '.');
+    if (pszDot == NULL || pszDot == found.pszForwarder || pszDot[1] == '\0') {
+        return NULL;
+    }
+
+    // Like the loader, always add ".dll"; otherwise LoadLibrary would take the last
+    // component of a dotted module name such as "Foo.Bar" as its extension.
+    CHAR szModule[MAX_PATH];
+    SIZE_T cchModule = pszDot - found.pszForwarder;
+    if (cchModule + sizeof(".dll") > ARRAYSIZE(szModule)) {
+        return NULL;
+    }
+    CopyMemory(szModule, found.pszForwarder, cchModule);
+    CopyMemory(szModule + cchModule, ".dll", sizeof(".dll"));
+
+#pragma prefast(suppress:28752, "We don't do the unicode conversion for LoadLibraryExA.")
+    HMODULE hTarget = LoadLibraryExA(szModule, NULL, 0);
+    if (hTarget == NULL) {
+        return NULL;
+    }
+
+    LPCSTR pszTarget = pszDot + 1;
+    if (pszTarget[0] == '#') {
+        ULONG nOrdinal = 0;
+        for (LPCSTR psz = pszTarget + 1; *psz; psz++) {
+            if (*psz < '0' || *psz > '9' || nOrdinal > 0xffff) {
+                return NULL;
+            }
+            nOrdinal = nOrdinal * 10 + (*psz - '0');
+        }
+        if (nOrdinal == 0 || !IS_INTRESOURCE(nOrdinal)) {
+            return NULL;
+        }
+        pszTarget = (LPCSTR)(ULONG_PTR)nOrdinal;
+    }
+    return detour_find_module_export(hTarget, pszTarget, nDepth + 1);
+}
+
+BOOL WINAPI DetourEnumerateExports(_In_ HMODULE hModule,
+                                   _In_opt_ PVOID pContext,
+                                   _In_ PF_DETOUR_ENUMERATE_EXPORT_CALLBACK pfExport)
+{
+    if (hModule == NULL) {
+        hModule = GetModuleHandleW(NULL);
+    }
+
+    __try {
+#pragma warning(suppress:6387) // GetModuleHandleW(NULL) never returns NULL.
+        PDETOUR_EXPORT_INDEX_IMPL pIndex = detour_module_export_index(hModule);
+        if (pIndex == NULL) {
+            return FALSE;
+        }
+
+        for (ULONG nFunc = 0; nFunc < pIndex->cFunctions; nFunc++) {
+            DETOUR_EXPORT entry;
+            if (!detour_export_from_index(pIndex, nFunc, NULL, &entry)) {
+                return FALSE;
             }
-            ULONG nOrdinal = pExportDir->Base + nFunc;
 
-            if (!pfExport(pContext, nOrdinal, pszName, pbCode)) {
+            PBYTE pbCode = (entry.nRva != 0) ? (PBYTE)hModule + entry.nRva : NULL;
+            if (!pfExport(pContext, entry.nOrdinal, entry.pszName, pbCode)) {
                 break;
             }
         }
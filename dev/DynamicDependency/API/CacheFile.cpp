@@ -0,0 +1,117 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "CacheFile.h"
+
+bool MddCore::CacheFile::Open(
+    const std::filesystem::path& filename,
+    const size_t minSize,
+    const UINT64 maxSize)
+{
+    Close();
+
+    wil::unique_hfile file{ ::CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+    if (!file)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize{};
+    THROW_IF_WIN32_BOOL_FALSE(::GetFileSizeEx(file.get(), &fileSize));
+    if ((fileSize.QuadPart < static_cast<LONGLONG>(minSize)) || (static_cast<UINT64>(fileSize.QuadPart) > maxSize))
+    {
+        return false;
+    }
+
+    // One mapped read of the whole file
+    wil::unique_handle mapping{ ::CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr) };
+    THROW_LAST_ERROR_IF_NULL(mapping);
+    wil::unique_mapview_ptr<BYTE> view{ reinterpret_cast<BYTE*>(::MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, 0)) };
+    THROW_LAST_ERROR_IF_NULL(view);
+
+    m_file = std::move(file);
+    m_mapping = std::move(mapping);
+    m_view = std::move(view);
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void MddCore::CacheFile::Close() noexcept
+{
+    m_view.reset();
+    m_mapping.reset();
+    m_file.reset();
+    m_size = 0;
+}
+
+UINT32 MddCore::CacheFile::Checksum(const BYTE* data, const size_t dataSize)
+{
+    UINT32 hash{ 2166136261u };
+    for (size_t index=0; index < dataSize; ++index)
+    {
+        hash ^= data[index];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+UINT32 MddCore::CacheFile::AppendString(std::wstring& strings, const std::wstring& string)
+{
+    const auto offset{ strings.length() };
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_BUFFER_OVERFLOW), (offset + string.length()) > UINT32_MAX);
+    strings += string;
+    return static_cast<UINT32>(offset);
+}
+
+void MddCore::CacheFile::Save(
+    const std::filesystem::path& filename,
+    const std::vector<BYTE>& data)
+{
+    // Process-unique so concurrent writers (e.g. other processes starting up) don't collide
+    auto temporaryFilename{ filename };
+    temporaryFilename += L"." + std::to_wstring(::GetCurrentProcessId()) + L".tmp";
+    {
+        wil::unique_hfile file{ ::CreateFileW(temporaryFilename.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        if (!file)
+        {
+            THROW_LAST_ERROR_MSG("%ls", temporaryFilename.c_str());
+        }
+
+        DWORD bytesWritten{};
+        if (!::WriteFile(file.get(), data.data(), static_cast<DWORD>(data.size()), &bytesWritten, nullptr) || (bytesWritten != data.size()))
+        {
+            const auto lastError{ GetLastError() };
+            file.reset();
+            ::DeleteFileW(temporaryFilename.c_str());
+            THROW_WIN32_MSG(lastError == ERROR_SUCCESS ? ERROR_WRITE_FAULT : lastError, "%ls", temporaryFilename.c_str());
+        }
+    }
+    if (!::MoveFileExW(temporaryFilename.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING))
+    {
+        // Another process may have the current file mapped. Theirs is as good as ours
+        const auto lastError{ GetLastError() };
+        ::DeleteFileW(temporaryFilename.c_str());
+        THROW_WIN32_MSG(lastError, "%ls", filename.c_str());
+    }
+}
+
+bool MddCore::CacheFile::GetFileStamp(
+    const std::filesystem::path& filename,
+    FileStamp& fileStamp)
+{
+    WIN32_FILE_ATTRIBUTE_DATA attributes{};
+    if (!::GetFileAttributesExW(filename.c_str(), GetFileExInfoStandard, &attributes))
+    {
+        const auto lastError{ GetLastError() };
+        if ((lastError == ERROR_FILE_NOT_FOUND) || (lastError == ERROR_PATH_NOT_FOUND))
+        {
+            return false;
+        }
+        THROW_WIN32_MSG(lastError, "%ls", filename.c_str());
+    }
+    fileStamp.size = (static_cast<UINT64>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+    fileStamp.lastWriteTime = (static_cast<UINT64>(attributes.ftLastWriteTime.dwHighDateTime) << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+    return true;
+}
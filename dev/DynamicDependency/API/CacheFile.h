@@ -0,0 +1,113 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#pragma once
+
+namespace MddCore
+{
+/// Read-only mapped view of a binary cache file (DataStoreIndex, WinRTPackageCache) plus the
+/// helpers shared by their writers.
+///
+/// Cache files start with a fixed-size header whose `checksum` member covers everything after it.
+/// Files are written to a temporary file and renamed into place so readers never see a partial file.
+class CacheFile
+{
+public:
+    CacheFile() = default;
+    ~CacheFile() = default;
+
+    CacheFile(const CacheFile&) = delete;
+    CacheFile& operator=(const CacheFile&) = delete;
+
+public:
+    struct FileStamp
+    {
+        UINT64 size{};
+        UINT64 lastWriteTime{};
+
+        bool operator==(const FileStamp& other) const
+        {
+            return (size == other.size) && (lastWriteTime == other.lastWriteTime);
+        }
+
+        bool operator!=(const FileStamp& other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    /// Map the file. Returns false if it doesn't exist or its size is outside [minSize, maxSize]
+    bool Open(
+        const std::filesystem::path& filename,
+        const size_t minSize,
+        const UINT64 maxSize);
+
+    void Close() noexcept;
+
+    const BYTE* Data() const
+    {
+        return m_view.get();
+    }
+
+    size_t Size() const
+    {
+        return m_size;
+    }
+
+    /// Copy the header out of the view (it's only WCHAR aligned at best)
+    template <typename THeader>
+    THeader Header() const
+    {
+        THeader header{};
+        memcpy(&header, m_view.get(), sizeof(header));
+        return header;
+    }
+
+    /// @return true if the file is exactly expectedSize bytes and header.checksum matches the data after the header
+    template <typename THeader>
+    bool IsValid(
+        const THeader& header,
+        const UINT64 expectedSize) const
+    {
+        return (expectedSize == m_size) && (Checksum(m_view.get() + sizeof(THeader), m_size - sizeof(THeader)) == header.checksum);
+    }
+
+public:
+    /// FNV-1a. Catches torn or truncated writes, not tampering
+    static UINT32 Checksum(const BYTE* data, const size_t dataSize);
+
+    /// Append string to the string table and return its offset (in WCHARs)
+    static UINT32 AppendString(std::wstring& strings, const std::wstring& string);
+
+    template <typename T>
+    static void AppendBytes(std::vector<BYTE>& buffer, const T* data, const size_t count)
+    {
+        const auto bytes{ reinterpret_cast<const BYTE*>(data) };
+        buffer.insert(buffer.end(), bytes, bytes + (count * sizeof(T)));
+    }
+
+    /// Set header.checksum for the data after the header and write the header to the start of data
+    template <typename THeader>
+    static void SetHeader(std::vector<BYTE>& data, THeader& header)
+    {
+        header.checksum = Checksum(data.data() + sizeof(THeader), data.size() - sizeof(THeader));
+        memcpy(data.data(), &header, sizeof(header));
+    }
+
+    /// Write to a process-unique temporary file and rename it into place
+    static void Save(
+        const std::filesystem::path& filename,
+        const std::vector<BYTE>& data);
+
+    /// @return false if the file (or folder) doesn't exist
+    static bool GetFileStamp(
+        const std::filesystem::path& filename,
+        FileStamp& fileStamp);
+
+private:
+    wil::unique_hfile m_file;
+    wil::unique_handle m_mapping;
+    wil::unique_mapview_ptr<BYTE> m_view;
+    size_t m_size{};
+};
+}
@@ -5,6 +5,8 @@
 
 #include "DataStore.h"
 
+#include "DataStoreIndex.h"
+
 #include "DynamicDependencyDataStore_h.h"
 #include "winrt_msixdynamicdependency.h"
 
@@ -12,24 +14,49 @@
 
 #include <shlobj.h>
 
+static MddCore::DataStoreIndex g_userDataStoreIndex;
+static MddCore::DataStoreIndex g_systemDataStoreIndex;
+
 MddCore::PackageDependency MddCore::DataStore::Load(PCWSTR packageDependencyId)
 {
-    std::filesystem::path relativeFilename{ L"DynamicDependency" };
-    relativeFilename /= std::wstring(packageDependencyId) + DataStore::fileExtension;
+    auto packageDependency{ Load(g_userDataStoreIndex, GetDataStorePathForUser(), packageDependencyId) };
+    if (!packageDependency)
+    {
+        packageDependency = Load(g_systemDataStoreIndex, GetDataStorePathForSystem(), packageDependencyId);
+    }
+    return packageDependency;
+}
 
-    auto filename{ GetDataStorePathForUser() };
-    filename /= relativeFilename;
+MddCore::PackageDependency MddCore::DataStore::Load(
+    MddCore::DataStoreIndex& dataStoreIndex,
+    const std::filesystem::path& dataStorePath,
+    PCWSTR packageDependencyId)
+{
+    auto path{ dataStorePath / L"DynamicDependency" };
+
+    // The index usually knows the answer without touching the package dependency's file
+    MddCore::PackageDependency packageDependency;
+    switch (dataStoreIndex.Find(path, packageDependencyId, packageDependency))
+    {
+    case MddCore::DataStoreIndex::FindResult::Found:
+        return packageDependency;
+    case MddCore::DataStoreIndex::FindResult::NotFound:
+        return PackageDependency();
+    case MddCore::DataStoreIndex::FindResult::Unknown:
+        break;
+    }
+
+    path /= std::wstring(packageDependencyId) + DataStore::fileExtension;
+    return LoadFile(path);
+}
+
+MddCore::PackageDependency MddCore::DataStore::LoadFile(const std::filesystem::path& filename)
+{
     wil::unique_hfile file{ OpenFileIfExists(filename.c_str()) };
     if (!file)
     {
-        filename = GetDataStorePathForSystem();
-        filename /= relativeFilename;
-        file.reset(OpenFileIfExists(filename.c_str()));
-        if (!file)
-        {
-            // Not found
-            return PackageDependency();
-        }
+        // Not found
+        return PackageDependency();
     }
 
     LARGE_INTEGER fileSize{};
@@ -54,7 +81,10 @@ MddCore::PackageDependency MddCore::DataStore::Load(PCWSTR packageDependencyId)
     bufferUtf8[bytesRead] = '\0';
     auto json{ bufferUtf8.get() };
 
-    return MddCore::PackageDependency::FromJSON(json);
+    // The filename is the id
+    auto packageDependency{ MddCore::PackageDependency::FromJSON(json) };
+    packageDependency.Id(filename.stem().wstring());
+    return packageDependency;
 }
 
 void MddCore::DataStore::Save(
@@ -100,6 +130,15 @@ void MddCore::DataStore::Delete(PCWSTR packageDependencyId)
     }
 }
 
+std::filesystem::path MddCore::DataStore::GetWinRTPackageCachePath()
+{
+    // Parsed appxmanifest data is per-user (the cache is keyed by package full name, not who registered it)
+    auto path{ GetDataStorePathForUser() };
+    path /= L"DynamicDependency";
+    path /= L"WinRT";
+    return path;
+}
+
 bool MddCore::DataStore::DeleteFileIfExists(PCWSTR filename)
 {
     if (!::DeleteFileW(filename))
@@ -7,6 +7,8 @@
 
 namespace MddCore
 {
+    class DataStoreIndex;
+
     class DataStore
     {
     public:
@@ -18,13 +20,23 @@ namespace MddCore
 
         static MddCore::PackageDependency Load(PCWSTR packageDependencyId);
 
+        /// Load a package dependency's .mdd file. Returns an empty PackageDependency if not found.
+        static MddCore::PackageDependency LoadFile(const std::filesystem::path& filename);
+
         static void Save(
                 const MddCore::PackageDependency& packageDependency,
                 const MddCreatePackageDependencyOptions options);
 
         static void Delete(PCWSTR packageDependencyId);
 
+        static std::filesystem::path GetWinRTPackageCachePath();
+
     private:
+        static MddCore::PackageDependency Load(
+            MddCore::DataStoreIndex& dataStoreIndex,
+            const std::filesystem::path& dataStorePath,
+            PCWSTR packageDependencyId);
+
         static bool DeleteFileIfExists(PCWSTR filename);
 
         static HANDLE OpenFileIfExists(PCWSTR filename);
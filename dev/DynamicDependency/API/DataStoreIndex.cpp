@@ -0,0 +1,333 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "DataStoreIndex.h"
+
+#include "DataStore.h"
+
+/// Index file layout (string offsets and lengths are in WCHARs):
+/// ~~~~~
+/// Header
+/// Record[header.count]
+/// WCHAR[header.stringsLength]
+/// ~~~~~
+/// Strings are not NUL-terminated. header.checksum covers everything after the header.
+namespace
+{
+    constexpr UINT32 c_magic{ 0x58444D4D };     // 'MMDX'
+    constexpr UINT32 c_version{ 2 };
+    constexpr UINT64 c_maxFileSize{ 16 * 1024 * 1024 };
+
+    struct Header
+    {
+        UINT32 magic;
+        UINT32 version;
+        UINT64 folderLastWriteTime;
+        UINT32 count;
+        UINT32 stringsLength;
+        UINT32 checksum;
+        UINT32 reserved;
+    };
+    static_assert(sizeof(Header) == 32);
+
+    struct Record
+    {
+        UINT64 minVersion;
+        UINT64 fileSize;
+        UINT64 fileLastWriteTime;
+        UINT32 idOffset;
+        UINT32 idLength;
+        UINT32 packageFamilyNameOffset;
+        UINT32 packageFamilyNameLength;
+        UINT32 lifetimeArtifactOffset;
+        UINT32 lifetimeArtifactLength;
+        UINT32 architectures;
+        UINT32 lifetimeKind;
+        UINT32 options;
+        UINT32 reserved;
+    };
+    static_assert(sizeof(Record) == 64);
+}
+
+MddCore::DataStoreIndex::FindResult MddCore::DataStoreIndex::Find(
+    const std::filesystem::path& path,
+    PCWSTR packageDependencyId,
+    MddCore::PackageDependency& packageDependency)
+{
+    auto lock{ std::unique_lock<std::mutex>(m_lock) };
+
+    try
+    {
+        Refresh(path);
+
+        auto iterator{ m_packageDependencies.find(MddCore::PackageDependency::ToKey(packageDependencyId)) };
+        if (iterator == m_packageDependencies.end())
+        {
+            return m_isComplete ? FindResult::NotFound : FindResult::Unknown;
+        }
+        if (!Revalidate(path, iterator->second))
+        {
+            // Gone since we indexed it. Let the caller look for itself
+            m_packageDependencies.erase(iterator);
+            return FindResult::Unknown;
+        }
+        packageDependency = iterator->second.packageDependency;
+        return FindResult::Found;
+    }
+    catch (...)
+    {
+        // Can't trust what we have. Let the caller go the long way around
+        LOG_CAUGHT_EXCEPTION();
+        m_isLoaded = false;
+        m_packageDependencies.clear();
+        return FindResult::Unknown;
+    }
+}
+
+void MddCore::DataStoreIndex::Refresh(const std::filesystem::path& path)
+{
+    // One stat of the folder per lookup. If nothing was added or deleted since we last looked we're good
+    MddCore::CacheFile::FileStamp folderStamp;
+    if (!MddCore::CacheFile::GetFileStamp(path, folderStamp))
+    {
+        // No folder = no package dependencies
+        m_path = path;
+        m_folderLastWriteTime = 0;
+        m_packageDependencies.clear();
+        m_isLoaded = true;
+        m_isComplete = true;
+        return;
+    }
+    const auto folderLastWriteTime{ folderStamp.lastWriteTime };
+    if (m_isLoaded && (m_folderLastWriteTime == folderLastWriteTime) && (m_path == path))
+    {
+        return;
+    }
+
+    m_path = path;
+    m_isLoaded = false;
+    m_packageDependencies.clear();
+
+    const auto filename{ GetIndexFilename(path) };
+    if (!Load(filename, folderLastWriteTime))
+    {
+        Rebuild(path);
+        try
+        {
+            Save(filename, folderLastWriteTime);
+        }
+        catch (...)
+        {
+            // Best effort e.g. the system data store is read-only to non-admins. We'll still use the in-memory index
+            LOG_CAUGHT_EXCEPTION();
+        }
+    }
+    m_folderLastWriteTime = folderLastWriteTime;
+    m_isLoaded = true;
+}
+
+bool MddCore::DataStoreIndex::Revalidate(
+    const std::filesystem::path& path,
+    Entry& entry)
+{
+    // One stat of the package dependency's file. Rewriting it in place doesn't change the folder
+    const auto filename{ path / (entry.packageDependency.Id() + MddCore::DataStore::fileExtension) };
+    MddCore::CacheFile::FileStamp fileStamp;
+    if (!MddCore::CacheFile::GetFileStamp(filename, fileStamp))
+    {
+        return false;
+    }
+    if (fileStamp == entry.fileStamp)
+    {
+        return true;
+    }
+
+    if (!LoadEntry(filename, entry))
+    {
+        return false;
+    }
+    try
+    {
+        Save(GetIndexFilename(path), m_folderLastWriteTime);
+    }
+    catch (...)
+    {
+        // Best effort. Other processes reload it on their next lookup too
+        LOG_CAUGHT_EXCEPTION();
+    }
+    return true;
+}
+
+bool MddCore::DataStoreIndex::LoadEntry(
+    const std::filesystem::path& filename,
+    Entry& entry)
+{
+    // Stamp it before reading so a rewrite while we read makes the next lookup reload it again
+    MddCore::CacheFile::FileStamp fileStamp;
+    if (!MddCore::CacheFile::GetFileStamp(filename, fileStamp))
+    {
+        return false;
+    }
+    auto packageDependency{ MddCore::DataStore::LoadFile(filename) };
+    if (!packageDependency)
+    {
+        // Deleted (or found invalid and deleted) while we looked
+        return false;
+    }
+    entry.packageDependency = std::move(packageDependency);
+    entry.fileStamp = fileStamp;
+    return true;
+}
+
+bool MddCore::DataStoreIndex::Load(
+    const std::filesystem::path& filename,
+    const UINT64 folderLastWriteTime)
+{
+    MddCore::CacheFile cacheFile;
+    if (!cacheFile.Open(filename, sizeof(Header), c_maxFileSize))
+    {
+        return false;
+    }
+
+    const auto header{ cacheFile.Header<Header>() };
+    if ((header.magic != c_magic) || (header.version != c_version) || (header.folderLastWriteTime != folderLastWriteTime))
+    {
+        return false;
+    }
+    const UINT64 expectedSize{ sizeof(Header) +
+                               (static_cast<UINT64>(header.count) * sizeof(Record)) +
+                               (static_cast<UINT64>(header.stringsLength) * sizeof(WCHAR)) };
+    if (!cacheFile.IsValid(header, expectedSize))
+    {
+        return false;
+    }
+    const BYTE* data{ cacheFile.Data() };
+
+    std::vector<Record> records(header.count);
+    memcpy(records.data(), data + sizeof(Header), records.size() * sizeof(Record));
+    std::wstring strings(header.stringsLength, L'\0');
+    memcpy(strings.data(), data + sizeof(Header) + (records.size() * sizeof(Record)), strings.length() * sizeof(WCHAR));
+    cacheFile.Close();
+
+    std::unordered_map<std::wstring, Entry> packageDependencies;
+    for (const auto& record : records)
+    {
+        if (((static_cast<UINT64>(record.idOffset) + record.idLength) > strings.length()) ||
+            ((static_cast<UINT64>(record.packageFamilyNameOffset) + record.packageFamilyNameLength) > strings.length()) ||
+            ((static_cast<UINT64>(record.lifetimeArtifactOffset) + record.lifetimeArtifactLength) > strings.length()) ||
+            (record.idLength == 0) ||
+            (record.lifetimeKind > static_cast<UINT32>(MddPackageDependencyLifetimeKind::RegistryKey)))
+        {
+            return false;
+        }
+
+        MddCore::PackageDependency packageDependency(nullptr,
+            strings.substr(record.packageFamilyNameOffset, record.packageFamilyNameLength),
+            PACKAGE_VERSION{ record.minVersion },
+            static_cast<MddPackageDependencyProcessorArchitectures>(record.architectures),
+            static_cast<MddPackageDependencyLifetimeKind>(record.lifetimeKind),
+            strings.substr(record.lifetimeArtifactOffset, record.lifetimeArtifactLength),
+            static_cast<MddCreatePackageDependencyOptions>(record.options));
+        packageDependency.Id(strings.substr(record.idOffset, record.idLength));
+
+        Entry entry;
+        entry.fileStamp.size = record.fileSize;
+        entry.fileStamp.lastWriteTime = record.fileLastWriteTime;
+        entry.packageDependency = std::move(packageDependency);
+        packageDependencies[MddCore::PackageDependency::ToKey(entry.packageDependency.Id().c_str())] = std::move(entry);
+    }
+
+    m_packageDependencies = std::move(packageDependencies);
+    m_isComplete = true;
+    return true;
+}
+
+void MddCore::DataStoreIndex::Rebuild(const std::filesystem::path& path)
+{
+    // Our caller took the folder's stamp before we enumerate so anything added
+    // or deleted while we work makes the next Refresh() rebuild again
+    m_isComplete = true;
+    for (const auto& entry : std::filesystem::directory_iterator(path))
+    {
+        const auto& filename{ entry.path() };
+        if (!entry.is_regular_file() || (CompareStringOrdinal(filename.extension().c_str(), -1, MddCore::DataStore::fileExtension, -1, TRUE) != CSTR_EQUAL))
+        {
+            continue;
+        }
+
+        try
+        {
+            Entry entry;
+            if (!LoadEntry(filename, entry))
+            {
+                // Deleted (or found invalid and deleted) while we looked. Nothing to index
+                continue;
+            }
+            m_packageDependencies[MddCore::PackageDependency::ToKey(entry.packageDependency.Id().c_str())] = std::move(entry);
+        }
+        catch (...)
+        {
+            // Unreadable right now. Don't claim it doesn't exist; misses go to the data store instead
+            LOG_CAUGHT_EXCEPTION();
+            m_isComplete = false;
+        }
+    }
+}
+
+void MddCore::DataStoreIndex::Save(
+    const std::filesystem::path& filename,
+    const UINT64 folderLastWriteTime) const
+{
+    // An incomplete index would turn unreadable entries into not-found for other processes
+    if (!m_isComplete)
+    {
+        return;
+    }
+
+    std::wstring strings;
+    std::vector<Record> records;
+    records.reserve(m_packageDependencies.size());
+    for (const auto& [key, entry] : m_packageDependencies)
+    {
+        const auto& packageDependency{ entry.packageDependency };
+        Record record{};
+        record.minVersion = packageDependency.MinVersion().Version;
+        record.fileSize = entry.fileStamp.size;
+        record.fileLastWriteTime = entry.fileStamp.lastWriteTime;
+        record.idOffset = MddCore::CacheFile::AppendString(strings, packageDependency.Id());
+        record.idLength = static_cast<UINT32>(packageDependency.Id().length());
+        record.packageFamilyNameOffset = MddCore::CacheFile::AppendString(strings, packageDependency.PackageFamilyName());
+        record.packageFamilyNameLength = static_cast<UINT32>(packageDependency.PackageFamilyName().length());
+        record.lifetimeArtifactOffset = MddCore::CacheFile::AppendString(strings, packageDependency.LifetimeArtifact());
+        record.lifetimeArtifactLength = static_cast<UINT32>(packageDependency.LifetimeArtifact().length());
+        record.architectures = static_cast<UINT32>(packageDependency.Architectures());
+        record.lifetimeKind = static_cast<UINT32>(packageDependency.LifetimeKind());
+        record.options = static_cast<UINT32>(packageDependency.Options());
+        records.push_back(record);
+    }
+
+    Header header{};
+    header.magic = c_magic;
+    header.version = c_version;
+    header.folderLastWriteTime = folderLastWriteTime;
+    header.count = static_cast<UINT32>(records.size());
+    header.stringsLength = static_cast<UINT32>(strings.length());
+
+    std::vector<BYTE> data(sizeof(Header) + (records.size() * sizeof(Record)) + (strings.length() * sizeof(WCHAR)));
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_BUFFER_OVERFLOW), data.size() > c_maxFileSize);
+    memcpy(data.data() + sizeof(Header), records.data(), records.size() * sizeof(Record));
+    memcpy(data.data() + sizeof(Header) + (records.size() * sizeof(Record)), strings.data(), strings.length() * sizeof(WCHAR));
+    MddCore::CacheFile::SetHeader(data, header);
+
+    MddCore::CacheFile::Save(filename, data);
+}
+
+std::filesystem::path MddCore::DataStoreIndex::GetIndexFilename(const std::filesystem::path& path)
+{
+    // <datastore>\DynamicDependency -> <datastore>\DynamicDependency.index
+    auto filename{ path };
+    filename += DataStoreIndex::fileExtension;
+    return filename;
+}
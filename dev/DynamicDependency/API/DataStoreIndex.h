@@ -0,0 +1,90 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "PackageDependency.h"
+#include "CacheFile.h"
+
+namespace MddCore
+{
+/// Index of the package dependencies persisted in a data store's DynamicDependency folder.
+///
+/// The index is saved as DynamicDependency.index beside the folder (not in it, so writing the index
+/// doesn't change the folder) and records the folder's last write time. Creating or deleting a .mdd
+/// file updates that time, so a matching stamp means the index still describes the folder and one
+/// mapped read replaces a file open and JSON parse per package dependency. A mismatch rebuilds it.
+///
+/// Rewriting a .mdd file in place doesn't change the folder so each entry also records its file's
+/// size and last write time. A found entry is only returned if they still match, otherwise it's
+/// reloaded from its file (and the index saved again).
+///
+/// @note All methods are thread safe.
+class DataStoreIndex
+{
+public:
+    DataStoreIndex() = default;
+    ~DataStoreIndex() = default;
+
+    DataStoreIndex(const DataStoreIndex&) = delete;
+    DataStoreIndex& operator=(const DataStoreIndex&) = delete;
+
+public:
+    static constexpr PCWSTR fileExtension{ L".index" };
+
+    enum class FindResult
+    {
+        /// The index is unavailable (or incomplete) so the caller must look at the data store itself
+        Unknown,
+
+        /// packageDependency is the definition in the data store
+        Found,
+
+        /// The package dependency isn't in the data store
+        NotFound,
+    };
+
+    /// @param path the data store's DynamicDependency folder
+    FindResult Find(
+        const std::filesystem::path& path,
+        PCWSTR packageDependencyId,
+        MddCore::PackageDependency& packageDependency);
+
+private:
+    struct Entry
+    {
+        MddCore::PackageDependency packageDependency;
+        MddCore::CacheFile::FileStamp fileStamp;
+    };
+
+    void Refresh(const std::filesystem::path& path);
+
+    bool Revalidate(
+        const std::filesystem::path& path,
+        Entry& entry);
+
+    bool LoadEntry(
+        const std::filesystem::path& filename,
+        Entry& entry);
+
+    bool Load(
+        const std::filesystem::path& filename,
+        const UINT64 folderLastWriteTime);
+
+    void Rebuild(const std::filesystem::path& path);
+
+    void Save(
+        const std::filesystem::path& filename,
+        const UINT64 folderLastWriteTime) const;
+
+    static std::filesystem::path GetIndexFilename(const std::filesystem::path& path);
+
+private:
+    std::mutex m_lock;
+    std::filesystem::path m_path;
+    UINT64 m_folderLastWriteTime{};
+    bool m_isLoaded{};
+    bool m_isComplete{};
+    std::unordered_map<std::wstring, Entry> m_packageDependencies;  // Key=PackageDependency::ToKey(id)
+};
+}
@@ -25,59 +25,36 @@ STDAPI MddLifetimeManagementTestInitialize(
 
 namespace MddCore::LifetimeManagement
 {
-class DDLMPackage
-{
-public:
-    DDLMPackage(
-        const std::wstring& packageFullName,
-        PACKAGE_VERSION version) :
-        m_packageFullName(packageFullName),
-        m_version(version)
-    {
-    }
-
-    constexpr bool operator>(const DDLMPackage& rhs) const
-    {
-        return m_version.Version > rhs.m_version.Version;
-    }
-
-    const std::wstring& PackageFullName() const
-    {
-        return m_packageFullName;
-    }
+using DDLMCandidate = ::WindowsAppRuntime::DDLM::Candidate;
 
-    void RemovePackage(
-        const winrt::Windows::Management::Deployment::PackageManager& packageManager) const
+void RemovePackage(
+    const winrt::Windows::Management::Deployment::PackageManager& packageManager,
+    PCWSTR packageFullName)
+{
+    try
     {
-        try
+        auto deploymentResult{ packageManager.RemovePackageAsync(packageFullName).get() };
+        if (!deploymentResult)
         {
-            auto deploymentResult{ packageManager.RemovePackageAsync(m_packageFullName.c_str()).get() };
-            if (!deploymentResult)
+            const HRESULT hr{ deploymentResult.ExtendedErrorCode() };
+            if (hr == HRESULT_FROM_WIN32(ERROR_PACKAGES_IN_USE))
             {
-                const HRESULT hr{ deploymentResult.ExtendedErrorCode() };
-                if (hr == HRESULT_FROM_WIN32(ERROR_PACKAGES_IN_USE))
-                {
-                    (void) LOG_HR_MSG(deploymentResult.ExtendedErrorCode(), "RemovePackage('%ls') = 0x%0X %ls. Will try again later", m_packageFullName.c_str(), deploymentResult.ExtendedErrorCode().value, deploymentResult.ErrorText().c_str());
-                }
-                else
-                {
-                    (void) LOG_HR_MSG(deploymentResult.ExtendedErrorCode(), "RemovePackage('%ls') = 0x%0X %ls", m_packageFullName.c_str(), deploymentResult.ExtendedErrorCode().value, deploymentResult.ErrorText().c_str());
-                }
+                (void) LOG_HR_MSG(deploymentResult.ExtendedErrorCode(), "RemovePackage('%ls') = 0x%0X %ls. Will try again later", packageFullName, deploymentResult.ExtendedErrorCode().value, deploymentResult.ErrorText().c_str());
+            }
+            else
+            {
+                (void) LOG_HR_MSG(deploymentResult.ExtendedErrorCode(), "RemovePackage('%ls') = 0x%0X %ls", packageFullName, deploymentResult.ExtendedErrorCode().value, deploymentResult.ErrorText().c_str());
             }
-        }
-        catch (...)
-        {
-            const auto e{ winrt::hresult_error(winrt::to_hresult(), winrt::take_ownership_from_abi) };
-            const auto hr{ e.code() };
-            const auto message { e.message() };
-            (void) LOG_HR_MSG(hr, "%ls PackageFullName:%ls", message.c_str(), m_packageFullName.c_str());
         }
     }
-
-private:
-    std::wstring m_packageFullName;
-    PACKAGE_VERSION m_version{};
-};
+    catch (...)
+    {
+        const auto e{ winrt::hresult_error(winrt::to_hresult(), winrt::take_ownership_from_abi) };
+        const auto hr{ e.code() };
+        const auto message { e.message() };
+        (void) LOG_HR_MSG(hr, "%ls PackageFullName:%ls", message.c_str(), packageFullName);
+    }
+}
 }
 
 STDAPI MddLifetimeManagementGC() noexcept try
@@ -94,13 +71,15 @@ STDAPI MddLifetimeManagementGC() noexcept try
     // Treat that as a non-error.
     //
     // We have no direct way to determine all DDLM packages so we'll enumerate each possible MAJOR version
-    // up to a reasonable maximum. This is a maintenance type API not needed in hot paths so the minor cost
-    // to ask for a few potential future versions with no matches isn't a performance concern.
+    // up to a reasonable maximum. The catalog queries are independent so we issue them all at once and
+    // then process the results, rather than waiting on each in turn.
 
     // Create a PackageManager instance for use across all calls
     winrt::Windows::Management::Deployment::PackageManager packageManager;
     winrt::hstring currentUser;
 
+    std::vector<winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Foundation::Collections::IVectorView<winrt::Windows::ApplicationModel::AppExtensions::AppExtension>>> catalogQueries;
+
     const UINT16 c_majorMinorVersions[][3]{ // [n] = { Major, minMinor, maxMinor }
         { 0, 8, 9 },
         { 1, 0, 2 }
@@ -115,77 +94,87 @@ STDAPI MddLifetimeManagementGC() noexcept try
             PCWSTR c_shortArchitectures[]{ L"x6", L"x8", L"a6" };
             for (auto shortArchitecture : c_shortArchitectures)
             {
-                // Build the list of DDLMs
-                std::vector<MddCore::LifetimeManagement::DDLMPackage> ddlmPackages;
-
                 // Look for windows.appExtension with name="microsoft.winappruntime.ddlm-<majorversion>.<minorversion>-<shortarchitecture>[-shorttag]"
                 // NOTE: We don't support VersionTag (i.e. we only support 'Stable' versions)
                 WCHAR appExtensionName[100]{};
                 wsprintf(appExtensionName, L"microsoft.winappruntime.ddlm-%hu.%hu-%s", majorVersion, minorVersion, shortArchitecture);
 
                 auto catalog{ winrt::Windows::ApplicationModel::AppExtensions::AppExtensionCatalog::Open(appExtensionName) };
-                auto appExtensions{ catalog.FindAllAsync().get() };
-                for (auto appExtension : appExtensions)
-                {
-                    // Check the package identity against the package identity test qualifiers (if any)
-                    if (!g_test_ddlmPackageNamePrefix.empty())
-                    {
-                        const auto packageId{ appExtension.Package().Id() };
-                        std::wstring name{ packageId.Name().c_str() };
-                        if ((name.rfind(g_test_ddlmPackageNamePrefix.c_str(), 0) != 0) ||
-                            (CompareStringOrdinal(packageId.PublisherId().c_str(), -1, g_test_ddlmPackagePublisherId.c_str(), -1, TRUE) != CSTR_EQUAL))
-                        {
-                            // The package's Name prefix or PublisherId don't match the expected value. Skip it
-                            continue;
-                        }
-                    }
-
-                    // appExtension.Id == "ddlm-<major.minor.build.revision>-<architecture>"
-                    const auto id{ appExtension.Id() };
-                    PACKAGE_VERSION version{};
-                    WCHAR architectureAsString[9 + 1]{};
-                    const auto maxIdLength{ ARRAYSIZE(L"ddlm-12345.12345.12345.12345-abcdefghi") - 1 }; // -1 for length not counting null-terminator
-                    if ((id.size() >= maxIdLength) ||
-                        (swscanf_s(id.c_str(), L"ddlm-%hu.%hu.%hu.%hu-%9s", &version.Major, &version.Minor, &version.Build, &version.Revision, architectureAsString, static_cast<unsigned>(ARRAYSIZE(architectureAsString))) != 5))
-                    {
-                        (void)LOG_WIN32_MSG(ERROR_INVALID_DATA, "%ls", id.c_str());
-                        continue;
-                    }
-
-                    // Found one
-                    auto packageFullName{ appExtension.Package().Id().FullName().c_str() };
-                    ddlmPackages.push_back(MddCore::LifetimeManagement::DDLMPackage(packageFullName, version));
-                }
+                catalogQueries.push_back(catalog.FindAllAsync());
+            }
+        }
+    }
+
+    for (auto& catalogQuery : catalogQueries)
+    {
+        // Build the list of DDLMs
+        std::vector<winrt::hstring> packageFullNames;
+        std::vector<MddCore::LifetimeManagement::DDLMCandidate> ddlmPackages;
 
-                // Did we find more than one?
-                if (ddlmPackages.size() <= 1)
+        auto appExtensions{ catalogQuery.get() };
+        for (auto appExtension : appExtensions)
+        {
+            // Check the package identity against the package identity test qualifiers (if any)
+            const auto packageId{ appExtension.Package().Id() };
+            if (!g_test_ddlmPackageNamePrefix.empty())
+            {
+                std::wstring name{ packageId.Name().c_str() };
+                if ((name.rfind(g_test_ddlmPackageNamePrefix.c_str(), 0) != 0) ||
+                    (CompareStringOrdinal(packageId.PublisherId().c_str(), -1, g_test_ddlmPackagePublisherId.c_str(), -1, TRUE) != CSTR_EQUAL))
                 {
-                    // Nothing to remove
+                    // The package's Name prefix or PublisherId don't match the expected value. Skip it
                     continue;
                 }
+            }
 
-                // Sort the list by version in descending order to simplify using it
-                std::sort(ddlmPackages.begin(), ddlmPackages.end(), std::greater<MddCore::LifetimeManagement::DDLMPackage>());
+            // appExtension.Id == "ddlm-<major.minor.build.revision>-<architecture>"
+            const auto id{ appExtension.Id() };
+            MddCore::LifetimeManagement::DDLMCandidate candidate{};
+            if (!::WindowsAppRuntime::DDLM::ParseAppExtensionId(id.c_str(), candidate.version, candidate.architecture))
+            {
+                (void)LOG_WIN32_MSG(ERROR_INVALID_DATA, "%ls", id.c_str());
+                continue;
+            }
 
-                // What's the highest version with a healthy status
-                auto keeper{ ddlmPackages.begin() };
-                for (; keeper != ddlmPackages.end(); ++keeper)
-                {
-                    auto package{ packageManager.FindPackageForUser(currentUser, keeper->PackageFullName()) };
-                    auto status{ package.Status() };
-                    if (status.VerifyIsOK())
-                    {
-                        break;
-                    }
-                }
+            // Found one
+            candidate.index = static_cast<UINT32>(packageFullNames.size());
+            packageFullNames.push_back(packageId.FullName());
+            ddlmPackages.push_back(candidate);
+        }
 
-                // Remove all older packages (best effort)
-                for (++keeper; keeper != ddlmPackages.end(); ++keeper)
-                {
-                    keeper->RemovePackage(packageManager);
-                }
+        // Did we find more than one?
+        if (ddlmPackages.size() <= 1)
+        {
+            // Nothing to remove
+            continue;
+        }
+
+        // Sort the list by version in descending order to simplify using it
+        ::WindowsAppRuntime::DDLM::SortByVersionDescending(ddlmPackages);
+
+        // What's the highest version with a healthy status
+        auto keeper{ ddlmPackages.begin() };
+        for (; keeper != ddlmPackages.end(); ++keeper)
+        {
+            auto package{ packageManager.FindPackageForUser(currentUser, packageFullNames[keeper->index]) };
+            auto status{ package.Status() };
+            if (status.VerifyIsOK())
+            {
+                break;
             }
         }
+
+        if (keeper == ddlmPackages.end())
+        {
+            // None are healthy so there's no 'best match' to keep. Leave them all
+            continue;
+        }
+
+        // Remove all older packages (best effort)
+        for (++keeper; keeper != ddlmPackages.end(); ++keeper)
+        {
+            MddCore::LifetimeManagement::RemovePackage(packageManager, packageFullNames[keeper->index].c_str());
+        }
     }
     return S_OK;
 }
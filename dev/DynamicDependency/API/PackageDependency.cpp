@@ -85,6 +85,19 @@ MddCore::PackageDependency MddCore::PackageDependency::FromJSON(PCSTR jsonUtf8)
     return FromJSON(Microsoft::Utf8::ToHString(jsonUtf8));
 }
 
+std::wstring MddCore::PackageDependency::ToKey(PCWSTR packageDependencyId)
+{
+    // Uppercasing via the invariant locale is the hashable equivalent of an ordinal ignore-case compare
+    const auto length{ static_cast<int>(wcslen(packageDependencyId)) };
+    if (length == 0)
+    {
+        return std::wstring();
+    }
+    std::wstring key(length, L'\0');
+    THROW_LAST_ERROR_IF(::LCMapStringEx(LOCALE_NAME_INVARIANT, LCMAP_UPPERCASE, packageDependencyId, length, key.data(), length, nullptr, nullptr, 0) == 0);
+    return key;
+}
+
 bool MddCore::PackageDependency::IsExpired() const
 {
     switch (m_lifetimeKind)
@@ -258,6 +258,10 @@ public:
     static PackageDependency FromJSON(const winrt::hstring& json);
     static PackageDependency FromJSON(PCSTR jsonUtf8);
 
+    /// Return a hashable key for a package dependency id.
+    /// Keys are equal when ids are equal per CompareStringOrdinal(...ignoreCase=TRUE).
+    static std::wstring ToKey(PCWSTR packageDependencyId);
+
     bool IsExpired() const;
 
 private:
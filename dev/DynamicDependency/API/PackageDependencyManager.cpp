@@ -9,7 +9,9 @@
 #include "PackageGraph.h"
 
 static std::recursive_mutex g_lock;
-std::vector<MddCore::PackageDependency> g_packageDependencies;
+
+// Key=PackageDependency::ToKey(id). Values are heap allocated so pointers handed out by GetPackageDependency() stay valid as the map grows
+static std::unordered_map<std::wstring, std::unique_ptr<MddCore::PackageDependency>> g_packageDependencies;
 
 bool MddCore::PackageDependencyManager::ExistsPackageDependency(
     PSID user,
@@ -56,7 +58,7 @@ void MddCore::PackageDependencyManager::CreatePackageDependency(
 
     auto lock{ std::unique_lock<std::recursive_mutex>(g_lock) };
 
-    g_packageDependencies.push_back(packageDependency);
+    g_packageDependencies[MddCore::PackageDependency::ToKey(packageDependency.Id().c_str())] = std::make_unique<MddCore::PackageDependency>(packageDependency);
 
     auto id{ wil::make_process_heap_string(packageDependency.Id().c_str()) };
     *packageDependencyId = id.release();
@@ -83,15 +85,7 @@ void MddCore::PackageDependencyManager::DeletePackageDependency(
 
     auto lock{ std::unique_lock<std::recursive_mutex>(g_lock) };
 
-    for (size_t index=0; index < g_packageDependencies.size(); ++index)
-    {
-        const auto& packageDependency{ g_packageDependencies[index] };
-        if (CompareStringOrdinal(packageDependency.Id().c_str(), -1, packageDependencyId, -1, TRUE) == CSTR_EQUAL)
-        {
-            g_packageDependencies.erase(g_packageDependencies.begin() + index);
-            break;
-        }
-    }
+    g_packageDependencies.erase(MddCore::PackageDependency::ToKey(packageDependencyId));
 
     MddCore::DataStore::Delete(packageDependencyId);
 }
@@ -112,14 +106,11 @@ const MddCore::PackageDependency* MddCore::PackageDependencyManager::GetPackageD
     _In_ PCWSTR packageDependencyId)
 {
     // Check the in-memory list
-    for (size_t index=0; index < g_packageDependencies.size(); ++index)
+    auto iterator{ g_packageDependencies.find(MddCore::PackageDependency::ToKey(packageDependencyId)) };
+    if (iterator != g_packageDependencies.end())
     {
-        const auto& packageDependency{ g_packageDependencies[index] };
-        if (CompareStringOrdinal(packageDependency.Id().c_str(), -1, packageDependencyId, -1, TRUE) == CSTR_EQUAL)
-        {
-            // Gotcha!
-            return &packageDependency;
-        }
+        // Gotcha!
+        return iterator->second.get();
     }
 
     // Not found
@@ -147,10 +138,11 @@ const MddCore::PackageDependency* MddCore::PackageDependencyManager::GetPackageD
     }
 
     // Add it to the in-memory list
-    g_packageDependencies.push_back(packageDependency);
+    auto& cachedPackageDependency{ g_packageDependencies[MddCore::PackageDependency::ToKey(packageDependencyId)] };
+    cachedPackageDependency = std::make_unique<MddCore::PackageDependency>(std::move(packageDependency));
 
     // Gotcha!
-    return &g_packageDependencies.back();
+    return cachedPackageDependency.get();
 }
 
 void MddCore::PackageDependencyManager::Verify(
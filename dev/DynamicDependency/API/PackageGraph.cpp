@@ -47,62 +47,19 @@ HRESULT MddCore::PackageGraph::Add(
     std::shared_ptr<MddCore::WinRTPackage> winrtPackage{ packageGraphNode.CreateWinRTPackage() };
     winrtPackage->ParseAppxManifest();
 
-    // Find the insertion point where to add the new package graph node to the package graph
-    size_t index{};
-    for (; index < m_packageGraphNodes.size(); ++index)
-    {
-        auto& node{ m_packageGraphNodes[index] };
-        if (node.Rank() < rank)
-        {
-            // Too soon. Keep looking
-            continue;
-        }
-        else if (rank < node.Rank())
-        {
-            // Gotcha!
-            break;
-        }
-
-        if (node.Rank() == rank)
-        {
-            // Match! Insert before items of the same rank?
-            if (WI_IsFlagSet(options, MddAddPackageDependencyOptions::PrependIfRankCollision))
-            {
-                // Gotcha!
-                break;
-            }
-            else
-            {
-                // Append to items of this rank
-                for (size_t nextIndex=index+1; nextIndex < m_packageGraphNodes.size(); ++nextIndex)
-                {
-                    auto& nextNode{ m_packageGraphNodes[nextIndex] };
-                    if (nextNode.Rank() > rank)
-                    {
-                        // Gotcha!
-                        break;
-                    }
-                }
-            }
-        }
-    }
-
-    // Add the new node to the package graph
-    if (index < m_packageGraphNodes.size())
-    {
-        m_packageGraphNodes.insert(m_packageGraphNodes.begin() + index, std::move(packageGraphNode));
-    }
-    else
-    {
-        m_packageGraphNodes.push_back(std::move(packageGraphNode));
-    }
+    // Add the new node to the package graph, after (or before) any others of the same rank.
+    // That's the order the linear insertion scan this replaced produced; only finding the spot got cheaper
+    const MddCore::PackageGraphNodeOrder order{ rank, WI_IsFlagSet(options, MddAddPackageDependencyOptions::PrependIfRankCollision) ? --m_lastPrependSequence : ++m_lastAppendSequence };
+    auto iterator{ m_packageGraphNodes.emplace(order, std::move(packageGraphNode)).first };
+    auto& node{ iterator->second };
+    m_packageGraphNodeOrders[node.Context()] = order;
 
     // Add the package's WinRT information
-    MddCore::WinRTModuleManager::Insert(index, winrtPackage);
+    MddCore::WinRTModuleManager::Insert(order, winrtPackage);
     winrtPackage.reset();
 
     // The DLL Search Order must be updated when we update the package graph
-    auto& node{ m_packageGraphNodes[index] };
+    InsertIntoPathList(iterator);
     AddToDllSearchOrder(node);
 
     context = node.Context();
@@ -200,38 +157,36 @@ HRESULT MddCore::PackageGraph::ResolvePackageDependency(
 HRESULT MddCore::PackageGraph::Remove(
     MDD_PACKAGEDEPENDENCY_CONTEXT context)
 {
-    for (size_t index=0; index < m_packageGraphNodes.size(); ++index)
-    {
-        auto& node{ m_packageGraphNodes[index] };
-        if (node.Context() == context)
-        {
-            // Detach the node from the package graph before updating the DLL Search Order
-            auto detachedNode{ std::move(node) };
-            m_packageGraphNodes.erase(m_packageGraphNodes.begin() + index);
+    auto packageGraphNodeOrder{ m_packageGraphNodeOrders.find(context) };
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_HANDLE), packageGraphNodeOrder == m_packageGraphNodeOrders.end());
+    const auto order{ packageGraphNodeOrder->second };
+    auto iterator{ m_packageGraphNodes.find(order) };
+    FAIL_FAST_HR_IF(E_UNEXPECTED, iterator == m_packageGraphNodes.end());
 
-            // The DLL Search Order must be updated when we update the package graph
-            RemoveFromDllSearchOrder(detachedNode);
+    // Detach the node from the package graph before updating the DLL Search Order
+    RemoveFromPathList(iterator);
+    auto detachedNode{ std::move(iterator->second) };
+    m_packageGraphNodes.erase(iterator);
+    m_packageGraphNodeOrders.erase(packageGraphNodeOrder);
 
-            return S_OK;
-        }
-    }
-    RETURN_WIN32(ERROR_INVALID_HANDLE);
+    // Remove the package's WinRT information
+    MddCore::WinRTModuleManager::Remove(order);
+
+    // The DLL Search Order must be updated when we update the package graph
+    RemoveFromDllSearchOrder(detachedNode);
+
+    return S_OK;
 }
 
 HRESULT MddCore::PackageGraph::GetPackageDependencyForContext(
     _In_ MDD_PACKAGEDEPENDENCY_CONTEXT context,
     wil::unique_process_heap_string& packageDependencyId)
 {
-    for (size_t index=0; index < m_packageGraphNodes.size(); ++index)
-    {
-        auto& node{ m_packageGraphNodes[index] };
-        if (node.Context() == context)
-        {
-            packageDependencyId = wil::make_process_heap_string(node.Id().c_str());
-            return S_OK;
-        }
-    }
-    RETURN_WIN32(ERROR_INVALID_HANDLE);
+    auto packageGraphNodeOrder{ m_packageGraphNodeOrders.find(context) };
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_HANDLE), packageGraphNodeOrder == m_packageGraphNodeOrders.end());
+    const auto& node{ m_packageGraphNodes.at(packageGraphNodeOrder->second) };
+    packageDependencyId = wil::make_process_heap_string(node.Id().c_str());
+    return S_OK;
 }
 
 bool MddCore::PackageGraph::IsPackageABetterFitPerArchitecture(
@@ -292,8 +247,8 @@ void MddCore::PackageGraph::UpdatePath()
     // If it's not an unmodified block the app's done something unexpected
     // and we can't reliably predict exactly what's up or how to respond.
 
-    // Build the package graph path list (semi-colon delimited)
-    std::wstring pathList{ BuildPathList() };
+    // The package graph path list (semi-colon delimited) is kept up to date as nodes are added and removed
+    const auto& pathList{ m_pathList };
 
     // Build the new PATH
     std::wstring newPath;
@@ -380,13 +335,68 @@ void MddCore::PackageGraph::RemoveFromDllSearchOrder(PackageGraphNode& package)
     UpdatePath();
 }
 
+void MddCore::PackageGraph::InsertIntoPathList(PackageGraphNodeMap::const_iterator node)
+{
+    // Adding to the end of the package graph (the common case: default rank, appended) only appends to the path list.
+    // Anywhere else we rebuild it once, in one allocation.
+    const auto& pathList{ node->second.PathList() };
+    if (std::next(node) == m_packageGraphNodes.cend())
+    {
+        if (!m_pathList.empty())
+        {
+            m_pathList += L';';
+        }
+        m_pathList += pathList;
+    }
+    else
+    {
+        m_pathList = BuildPathList();
+    }
+}
+
+void MddCore::PackageGraph::RemoveFromPathList(PackageGraphNodeMap::const_iterator node)
+{
+    // NOTE: The node is still in the package graph
+    const auto& pathList{ node->second.PathList() };
+    if ((std::next(node) == m_packageGraphNodes.cend()) && (m_pathList.length() >= pathList.length()))
+    {
+        // Remove the trailing "[;]<pathlist>"
+        const auto length{ m_pathList.length() - pathList.length() };
+        m_pathList.resize(length > 0 ? length - 1 : 0);
+    }
+    else
+    {
+        std::wstring newPathList;
+        newPathList.reserve(m_pathList.length());
+        for (auto iterator{ m_packageGraphNodes.cbegin() }; iterator != m_packageGraphNodes.cend(); ++iterator)
+        {
+            if (iterator == node)
+            {
+                continue;
+            }
+            if (!newPathList.empty())
+            {
+                newPathList += L';';
+            }
+            newPathList += iterator->second.PathList();
+        }
+        m_pathList = std::move(newPathList);
+    }
+}
+
 std::wstring MddCore::PackageGraph::BuildPathList()
 {
+    size_t length{};
+    for (const auto& [order, node] : m_packageGraphNodes)
+    {
+        length += node.PathList().length() + 1;
+    }
+
     std::wstring pathlist;
-    for (size_t index=0; index < m_packageGraphNodes.size(); ++index)
+    pathlist.reserve(length);
+    for (const auto& [order, node] : m_packageGraphNodes)
     {
-        const auto& node{ m_packageGraphNodes[index] };
-        if (index > 0)
+        if (!pathlist.empty())
         {
             pathlist += L';';
         }
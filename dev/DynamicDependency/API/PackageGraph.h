@@ -4,6 +4,8 @@
 #if !defined(PACKAGEGRAPH_H)
 #define PACKAGEGRAPH_H
 
+#include <map>
+
 #include "MsixDynamicDependency.h"
 
 #include "PackageId.h"
@@ -63,6 +65,14 @@ private:
 
     void RemoveFromDllSearchOrder(PackageGraphNode& package);
 
+public:
+    typedef std::map<MddCore::PackageGraphNodeOrder, MddCore::PackageGraphNode> PackageGraphNodeMap;
+
+private:
+    void InsertIntoPathList(PackageGraphNodeMap::const_iterator node);
+
+    void RemoveFromPathList(PackageGraphNodeMap::const_iterator node);
+
     inline static MddCore::Architecture GetCurrentArchitecture()
     {
 #if defined(_M_ARM)
@@ -83,13 +93,18 @@ private:
     std::wstring BuildPathList();
 
 public:
-    const std::vector<MddCore::PackageGraphNode>& PackageGraphNodes() const
+    /// Package graph nodes in package graph order
+    const PackageGraphNodeMap& PackageGraphNodes() const
     {
         return m_packageGraphNodes;
     }
 
 private:
-    std::vector<MddCore::PackageGraphNode> m_packageGraphNodes;
+    PackageGraphNodeMap m_packageGraphNodes;
+    std::unordered_map<MDD_PACKAGEDEPENDENCY_CONTEXT, MddCore::PackageGraphNodeOrder> m_packageGraphNodeOrders;
+    INT64 m_lastAppendSequence{};
+    INT64 m_lastPrependSequence{};
+    std::wstring m_pathList;
     std::wstring m_pathListLastAddedToPath;
 };
 }
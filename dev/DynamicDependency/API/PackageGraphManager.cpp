@@ -7,9 +7,13 @@
 
 #include "MddDetourPackageGraph.h"
 
+#include <../UndockedRegFreeWinRT/factorycache.h>
+
 std::recursive_mutex MddCore::PackageGraphManager::s_lock;
 MddCore::PackageGraph MddCore::PackageGraphManager::s_packageGraph;
 volatile ULONG MddCore::PackageGraphManager::s_packageGraphRevisionId{};
+wil::srwlock MddCore::PackageGraphManager::s_serializedPackageInfoLock;
+std::vector<MddCore::PackageGraphManager::SerializedPackageInfo> MddCore::PackageGraphManager::s_serializedPackageInfo;
 
 UINT32 MddCore::PackageGraphManager::GetPackageGraphRevisionId()
 {
@@ -43,11 +47,16 @@ HRESULT MddCore::PackageGraphManager::AddToPackageGraph(
     _Out_ MDD_PACKAGEDEPENDENCY_CONTEXT* context,
     _Outptr_opt_result_maybenull_ PWSTR* packageFullName)
 {
-    std::unique_lock<std::recursive_mutex> lock(s_lock);
+    {
+        std::unique_lock<std::recursive_mutex> lock(s_lock);
+
+        RETURN_IF_FAILED(s_packageGraph.Add(packageDependencyId, rank, options, *context, packageFullName));
 
-    RETURN_IF_FAILED(s_packageGraph.Add(packageDependencyId, rank, options, *context, packageFullName));
+        IncrementPackageGraphRevisionId();
+    }
 
-    IncrementPackageGraphRevisionId();
+    // A higher ranked package may now define classes we've cached factories for
+    UndockedRegFreeWinRT::FactoryCache::Purge();
     return S_OK;
 }
 
@@ -59,11 +68,16 @@ void MddCore::PackageGraphManager::RemoveFromPackageGraph(
         return;
     }
 
-    std::unique_lock<std::recursive_mutex> lock(s_lock);
+    {
+        std::unique_lock<std::recursive_mutex> lock(s_lock);
+
+        (void) LOG_IF_FAILED(s_packageGraph.Remove(context));
 
-    (void) LOG_IF_FAILED(s_packageGraph.Remove(context));
+        IncrementPackageGraphRevisionId();
+    }
 
-    IncrementPackageGraphRevisionId();
+    // Release the removed package's cached factories now rather than on the next activation
+    UndockedRegFreeWinRT::FactoryCache::Purge();
 }
 
 HRESULT MddCore::PackageGraphManager::GetPackageDependencyForContext(
@@ -102,6 +116,14 @@ HRESULT MddCore::PackageGraphManager::GetCurrentPackageInfo3(
         *count = 0;
     }
 
+    // Callers typically ask twice (size, then fill) and ask often. If we've already answered this
+    // question at the current package graph revision the answer is a copy of what we said last time
+    HRESULT cachedHr{};
+    if (CopyCachedPackageInfo(flags, packageInfoType, bufferLength, buffer, count, cachedHr))
+    {
+        return cachedHr;
+    }
+
     std::unique_lock<std::recursive_mutex> lock(s_lock);
 
     // Do we need Static and/or Dynamic items? NOTE: If neither are specified we need both
@@ -163,7 +185,7 @@ HRESULT MddCore::PackageGraphManager::GetCurrentPackageInfo3(
 
     std::vector<const MddCore::PackageGraphNode*> matchingPackageInfo;
 
-    for (auto& packageGraphNode : s_packageGraph.PackageGraphNodes())
+    for (const auto& [order, packageGraphNode] : s_packageGraph.PackageGraphNodes())
     {
         // Does the node have any matching packages?
         const auto countMatchingPackages{ packageGraphNode.CountMatchingPackages(flags, packageInfoType) };
@@ -174,12 +196,15 @@ HRESULT MddCore::PackageGraphManager::GetCurrentPackageInfo3(
         }
     }
 
-    // Update the total 'count' (if any)
+    // The result is cached (and copied out to the caller) as of this revision.
+    // It can't change while we hold s_lock.
+    SerializedPackageInfo serializedPackageInfo;
+    serializedPackageInfo.revisionId = GetPackageGraphRevisionId();
+    serializedPackageInfo.flags = flags;
+    serializedPackageInfo.packageInfoType = packageInfoType;
+
     const auto totalPackagesCount{ staticPackagesCount + dynamicPackagesCount };
-    if (count)
-    {
-        *count = totalPackagesCount;
-    }
+    serializedPackageInfo.count = totalPackagesCount;
 
     // Return code needs special handling if we match zero packages (i.e. #Static=0, #Dynamic=0, *bufferLength=0):
     //
@@ -198,26 +223,121 @@ HRESULT MddCore::PackageGraphManager::GetCurrentPackageInfo3(
     // Preserve these behaviors.
     if (totalPackagesCount == 0)
     {
-        // No matches!
-        *bufferLength = 0;
+        // No matches! Do we need to tell our caller AppmodelErrorNoPackage?
+        serializedPackageInfo.hr = (filterStatic && !filterDynamic) ? HRESULT_FROM_WIN32(APPMODEL_ERROR_NO_PACKAGE) : S_OK;
+    }
+    else
+    {
+        // Compute the buffer length needed, then serialize into a buffer of our own
+        const auto bufferNeeded{ SerializePackageInfoToBuffer(flags, packageInfoType, 0, nullptr, matchingPackageInfo, dynamicPackagesCount, staticPackageInfo, staticPackagesCount) };
+        serializedPackageInfo.buffer.resize(bufferNeeded);
+        const auto bufferUsed{ SerializePackageInfoToBuffer(flags, packageInfoType, bufferNeeded, serializedPackageInfo.buffer.data(), matchingPackageInfo, dynamicPackagesCount, staticPackageInfo, staticPackagesCount) };
+        FAIL_FAST_HR_IF(E_UNEXPECTED, bufferUsed != bufferNeeded);
+        RebasePackageInfo(serializedPackageInfo.buffer.data(), totalPackagesCount, reinterpret_cast<UINT_PTR>(serializedPackageInfo.buffer.data()), 0);
+    }
+
+    const auto hr{ CopySerializedPackageInfo(serializedPackageInfo, bufferLength, buffer, count) };
+    CachePackageInfo(std::move(serializedPackageInfo));
+    return hr;
+}
+CATCH_RETURN();
 
-        // Do we need to tell our caller AppmodelErrorNoPackage?
-        if (filterStatic && !filterDynamic)
+bool MddCore::PackageGraphManager::CopyCachedPackageInfo(
+    const UINT32 flags,
+    PackageInfoType packageInfoType,
+    UINT32* bufferLength,
+    void* buffer,
+    UINT32* count,
+    HRESULT& hr)
+{
+    const auto revisionId{ GetPackageGraphRevisionId() };
+
+    auto lock{ s_serializedPackageInfoLock.lock_shared() };
+    for (const auto& serializedPackageInfo : s_serializedPackageInfo)
+    {
+        if ((serializedPackageInfo.revisionId == revisionId) &&
+            (serializedPackageInfo.flags == flags) &&
+            (serializedPackageInfo.packageInfoType == packageInfoType))
         {
-            return HRESULT_FROM_WIN32(APPMODEL_ERROR_NO_PACKAGE);
+            hr = CopySerializedPackageInfo(serializedPackageInfo, bufferLength, buffer, count);
+            return true;
         }
-        return S_OK;
+    }
+    return false;
+}
+
+void MddCore::PackageGraphManager::CachePackageInfo(
+    SerializedPackageInfo&& serializedPackageInfo)
+{
+    // Only results for the current revision are useful. A handful of (flags, packageInfoType)
+    // combinations are used in practice so a short list beats anything fancier
+    auto lock{ s_serializedPackageInfoLock.lock_exclusive() };
+    auto isStale{ [&](const SerializedPackageInfo& cached) {
+        return (cached.revisionId != serializedPackageInfo.revisionId) ||
+               ((cached.flags == serializedPackageInfo.flags) && (cached.packageInfoType == serializedPackageInfo.packageInfoType));
+    } };
+    s_serializedPackageInfo.erase(std::remove_if(s_serializedPackageInfo.begin(), s_serializedPackageInfo.end(), isStale), s_serializedPackageInfo.end());
+    s_serializedPackageInfo.push_back(std::move(serializedPackageInfo));
+}
+
+HRESULT MddCore::PackageGraphManager::CopySerializedPackageInfo(
+    const SerializedPackageInfo& serializedPackageInfo,
+    UINT32* bufferLength,
+    void* buffer,
+    UINT32* count)
+{
+    // Update the total 'count' (if any)
+    if (count)
+    {
+        *count = serializedPackageInfo.count;
+    }
+
+    const auto bufferNeeded{ static_cast<UINT32>(serializedPackageInfo.buffer.size()) };
+    if (serializedPackageInfo.count == 0)
+    {
+        *bufferLength = 0;
+        return serializedPackageInfo.hr;
     }
 
-    // Compute the buffer length used/needed and fill buffer (if we can)
-    auto bufferNeeded{ SerializePackageInfoToBuffer(flags, packageInfoType, *bufferLength, buffer, matchingPackageInfo, dynamicPackagesCount, staticPackageInfo, staticPackagesCount) };
     const auto isInsufficientBuffer{ *bufferLength < bufferNeeded };
     *bufferLength = bufferNeeded;
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER), isInsufficientBuffer);
 
-    return S_OK;
+    memcpy(buffer, serializedPackageInfo.buffer.data(), bufferNeeded);
+    RebasePackageInfo(buffer, serializedPackageInfo.count, 0, reinterpret_cast<UINT_PTR>(buffer));
+    return serializedPackageInfo.hr;
+}
+
+void MddCore::PackageGraphManager::RebasePackageInfo(
+    void* buffer,
+    const UINT32 count,
+    const UINT_PTR from,
+    const UINT_PTR to)
+{
+    auto packageInfo{ reinterpret_cast<PACKAGE_INFO*>(buffer) };
+    for (UINT32 index=0; index < count; ++index, ++packageInfo)
+    {
+        RebaseString(packageInfo->path, from, to);
+        RebaseString(packageInfo->packageFullName, from, to);
+        RebaseString(packageInfo->packageFamilyName, from, to);
+        RebaseString(packageInfo->packageId.name, from, to);
+        RebaseString(packageInfo->packageId.publisher, from, to);
+        RebaseString(packageInfo->packageId.resourceId, from, to);
+        RebaseString(packageInfo->packageId.publisherId, from, to);
+    }
+}
+
+void MddCore::PackageGraphManager::RebaseString(
+    PWSTR& string,
+    const UINT_PTR from,
+    const UINT_PTR to)
+{
+    // Strings always follow the PACKAGE_INFO[] so a non-null string is never at offset 0
+    if (string)
+    {
+        string = reinterpret_cast<PWSTR>(reinterpret_cast<UINT_PTR>(string) - from + to);
+    }
 }
-CATCH_RETURN();
 
 UINT32 MddCore::PackageGraphManager::SerializePackageInfoToBuffer(
     const UINT32 flags,
@@ -55,6 +55,46 @@ public:
         UINT32* count) noexcept;
 
 private:
+    // GetCurrentPackageInfo3's result for a (flags, packageInfoType) at a package graph revision.
+    // PWSTRs in the PACKAGE_INFO[] are stored as offsets from the start of buffer (or null).
+    struct SerializedPackageInfo
+    {
+        UINT32 revisionId{};
+        UINT32 flags{};
+        PackageInfoType packageInfoType{};
+        HRESULT hr{};
+        UINT32 count{};
+        std::vector<BYTE> buffer;
+    };
+
+    static bool CopyCachedPackageInfo(
+        const UINT32 flags,
+        PackageInfoType packageInfoType,
+        UINT32* bufferLength,
+        void* buffer,
+        UINT32* count,
+        HRESULT& hr);
+
+    static void CachePackageInfo(
+        SerializedPackageInfo&& serializedPackageInfo);
+
+    static HRESULT CopySerializedPackageInfo(
+        const SerializedPackageInfo& serializedPackageInfo,
+        UINT32* bufferLength,
+        void* buffer,
+        UINT32* count);
+
+    static void RebasePackageInfo(
+        void* buffer,
+        const UINT32 count,
+        const UINT_PTR from,
+        const UINT_PTR to);
+
+    static void RebaseString(
+        PWSTR& string,
+        const UINT_PTR from,
+        const UINT_PTR to);
+
     static UINT32 SerializePackageInfoToBuffer(
         const UINT32 flags,
         const PackageInfoType packageInfoType,
@@ -81,6 +121,9 @@ private:
     static std::recursive_mutex s_lock;
     static MddCore::PackageGraph s_packageGraph;
     static volatile ULONG s_packageGraphRevisionId;
+
+    static wil::srwlock s_serializedPackageInfoLock;
+    static std::vector<SerializedPackageInfo> s_serializedPackageInfo;
 };
 }
 
@@ -125,5 +125,5 @@ std::shared_ptr<MddCore::WinRTPackage> MddCore::PackageGraphNode::CreateWinRTPac
 {
     const auto& package{ m_packageInfo.Package(0) };
 
-    return std::make_shared<MddCore::WinRTPackage>(m_context, package.path);
+    return std::make_shared<MddCore::WinRTPackage>(m_context, package.packageFullName, package.path);
 }
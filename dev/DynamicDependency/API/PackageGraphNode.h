@@ -16,6 +16,20 @@
 
 namespace MddCore
 {
+/// A package graph node's position in the package graph: by rank then, within a rank, by sequence.
+/// Appends take ever increasing sequences and prepends (PrependIfRankCollision) ever decreasing ones
+/// so a node lands after (or before) every node already in the package graph with the same rank.
+struct PackageGraphNodeOrder
+{
+    INT32 rank{};
+    INT64 sequence{};
+
+    bool operator<(const PackageGraphNodeOrder& other) const
+    {
+        return (rank < other.rank) || ((rank == other.rank) && (sequence < other.sequence));
+    }
+};
+
 class PackageGraphNode
 {
 public:
@@ -6,15 +6,15 @@
 #include "WinRTModuleManager.h"
 
 std::recursive_mutex MddCore::WinRTModuleManager::s_lock;
-std::vector<std::shared_ptr<MddCore::WinRTPackage>> MddCore::WinRTModuleManager::s_winrtPackages;
+std::map<MddCore::PackageGraphNodeOrder, std::shared_ptr<MddCore::WinRTPackage>> MddCore::WinRTModuleManager::s_winrtPackages;
+std::vector<std::shared_ptr<MddCore::WinRTPackage>> MddCore::WinRTModuleManager::s_removedWinrtPackages;
+std::shared_ptr<const MddCore::WinRTModuleManager::ActivatableClassIndex> MddCore::WinRTModuleManager::s_index;
 
 bool MddCore::WinRTModuleManager::GetThreadingType(
     HSTRING className,
     ABI::Windows::Foundation::ThreadingType& threadingType)
 {
-    auto lock{ std::unique_lock<std::recursive_mutex>(s_lock) };
-
-    auto threadingModel{ MddCore::WinRTModuleManager::GetThreadingModel(className) };
+    auto threadingModel{ MddCore::WinRTModuleManager::GetThreadingModel(ToStringView(className)) };
     if (threadingModel == MddCore::WinRT::ThreadingModel::Unknown)
     {
         return false;
@@ -26,18 +26,15 @@ bool MddCore::WinRTModuleManager::GetThreadingType(
 }
 
 MddCore::WinRT::ThreadingModel MddCore::WinRTModuleManager::GetThreadingModel(
-    HSTRING className)
+    std::wstring_view activatableClassId)
 {
-    if (!s_winrtPackages.empty())
+    auto index{ GetIndex() };
+    if (index)
     {
-        std::wstring activatableClassId{ WindowsGetStringRawBuffer(className, nullptr) };
-        for (auto& winrtPackage : s_winrtPackages)
+        auto activatableClass{ Find(*index, activatableClassId) };
+        if (activatableClass)
         {
-            auto threadingModel{ winrtPackage->GetThreadingModel(activatableClassId) };
-            if (threadingModel != MddCore::WinRT::ThreadingModel::Unknown)
-            {
-                return threadingModel;
-            }
+            return activatableClass->threadingModel;
         }
     }
     return MddCore::WinRT::ThreadingModel::Unknown;
@@ -47,35 +44,101 @@ void* MddCore::WinRTModuleManager::GetActivationFactory(
     HSTRING className,
     REFIID iid)
 {
-    auto lock{ std::unique_lock<std::recursive_mutex>(s_lock) };
-
-    if (!s_winrtPackages.empty())
+    // The snapshot keeps the module alive while we call into it, even if the
+    // package is removed from the package graph meanwhile
+    auto index{ GetIndex() };
+    if (index)
     {
-        std::wstring activatableClassId{ WindowsGetStringRawBuffer(className, nullptr) };
-        for (auto& winrtPackage : s_winrtPackages)
+        auto activatableClass{ Find(*index, ToStringView(className)) };
+        if (activatableClass)
         {
-            auto factory{ winrtPackage->GetActivationFactory(className, activatableClassId, iid) };
-            if (factory)
-            {
-                return factory;
-            }
+            return activatableClass->inprocModule->GetActivationFactory(className, *activatableClass->activatableClassId, iid);
         }
     }
     return nullptr;
 }
 
 void MddCore::WinRTModuleManager::Insert(
-    size_t index,
+    const MddCore::PackageGraphNodeOrder& order,
     std::shared_ptr<MddCore::WinRTPackage>& winrtPackage)
 {
     auto lock{ std::unique_lock<std::recursive_mutex>(s_lock) };
 
-    if (index < s_winrtPackages.size())
+    s_winrtPackages[order] = std::move(winrtPackage);
+
+    PublishIndex();
+}
+
+void MddCore::WinRTModuleManager::Remove(
+    const MddCore::PackageGraphNodeOrder& order)
+{
+    auto lock{ std::unique_lock<std::recursive_mutex>(s_lock) };
+
+    auto iterator{ s_winrtPackages.find(order) };
+    if (iterator != s_winrtPackages.end())
+    {
+        // Stop activating the package's classes but keep its modules loaded. Objects and factories
+        // already handed out may still be alive and we can't tell when they're released, so
+        // unloading the DLLs here could pull the code out from under them
+        s_removedWinrtPackages.push_back(std::move(iterator->second));
+        s_winrtPackages.erase(iterator);
+
+        PublishIndex();
+    }
+}
+
+std::shared_ptr<const MddCore::WinRTModuleManager::ActivatableClassIndex> MddCore::WinRTModuleManager::GetIndex()
+{
+    // Readers don't take the writer lock (s_lock), so activation never waits behind a package graph
+    // update. They grab the current snapshot, which is never modified after it's published. This isn't
+    // lock-free: MSVC's atomic_load/atomic_store for shared_ptr briefly hold an internal spinlock
+    return std::atomic_load_explicit(&s_index, std::memory_order_acquire);
+}
+
+const MddCore::WinRTModuleManager::ActivatableClass* MddCore::WinRTModuleManager::Find(
+    const ActivatableClassIndex& index,
+    std::wstring_view activatableClassId)
+{
+    auto iterator{ index.activatableClasses.find(activatableClassId) };
+    if (iterator != index.activatableClasses.end())
+    {
+        return &iterator->second;
+    }
+    return nullptr;
+}
+
+std::wstring_view MddCore::WinRTModuleManager::ToStringView(
+    HSTRING className)
+{
+    UINT32 length{};
+    PCWSTR buffer{ WindowsGetStringRawBuffer(className, &length) };
+    return std::wstring_view{ buffer, length };
+}
+
+void MddCore::WinRTModuleManager::PublishIndex()
+{
+    // Caller must hold s_lock
+
+    // Packages are in rank order and modules in manifest order, so the first
+    // definition of an activatable class wins as it would in a sequential search
+    auto index{ std::make_shared<ActivatableClassIndex>() };
+    index->winrtPackages.reserve(s_winrtPackages.size());
+    for (const auto& [order, winrtPackage] : s_winrtPackages)
     {
-        s_winrtPackages.insert(s_winrtPackages.begin() + index, std::move(winrtPackage));
+        index->winrtPackages.push_back(winrtPackage);
     }
-    else
+    for (auto& winrtPackage : index->winrtPackages)
     {
-        s_winrtPackages.push_back(std::move(winrtPackage));
+        for (auto& inprocModule : winrtPackage->InprocModules())
+        {
+            for (const auto& [activatableClassId, threadingModel] : inprocModule.InprocServers())
+            {
+                ActivatableClass activatableClass{ &inprocModule, &activatableClassId, threadingModel };
+                index->activatableClasses.try_emplace(std::wstring_view{ activatableClassId }, activatableClass);
+            }
+        }
     }
+
+    std::shared_ptr<const ActivatableClassIndex> publishedIndex{ std::move(index) };
+    std::atomic_store_explicit(&s_index, std::move(publishedIndex), std::memory_order_release);
 }
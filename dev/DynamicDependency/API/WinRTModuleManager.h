@@ -4,7 +4,10 @@
 #if !defined(WINRTMODULEMANAGER_H)
 #define WINRTMODULEMANAGER_H
 
+#include <map>
+
 #include "WinRTPackage.h"
+#include "PackageGraphNode.h"
 
 namespace MddCore
 {
@@ -15,9 +18,8 @@ public:
         HSTRING className,
         ABI::Windows::Foundation::ThreadingType& threadingType);
 
-private:
     static MddCore::WinRT::ThreadingModel GetThreadingModel(
-        HSTRING className);
+        std::wstring_view activatableClassId);
 
 public:
     static void* GetActivationFactory(
@@ -25,12 +27,47 @@ public:
         REFIID iid);
 
     static void Insert(
-        size_t index,
+        const MddCore::PackageGraphNodeOrder& order,
         std::shared_ptr<MddCore::WinRTPackage>& winrtPackage);
 
+    static void Remove(
+        const MddCore::PackageGraphNodeOrder& order);
+
+private:
+    struct ActivatableClass
+    {
+        MddCore::WinRTInprocModule* inprocModule{};
+        const std::wstring* activatableClassId{};
+        MddCore::WinRT::ThreadingModel threadingModel{};
+    };
+
+    /// Immutable snapshot of every activatable class in the package graph.
+    /// The snapshot holds references to its packages so the modules it points
+    /// to outlive any reader still using it after a newer snapshot is published.
+    struct ActivatableClassIndex
+    {
+        std::vector<std::shared_ptr<MddCore::WinRTPackage>> winrtPackages;
+        std::unordered_map<std::wstring_view, ActivatableClass> activatableClasses;
+    };
+
+    static std::shared_ptr<const ActivatableClassIndex> GetIndex();
+
+    static const ActivatableClass* Find(
+        const ActivatableClassIndex& index,
+        std::wstring_view activatableClassId);
+
+    static std::wstring_view ToStringView(
+        HSTRING className);
+
+    static void PublishIndex();
+
 private:
     static std::recursive_mutex s_lock;
-    static std::vector<std::shared_ptr<MddCore::WinRTPackage>> s_winrtPackages;
+    static std::map<MddCore::PackageGraphNodeOrder, std::shared_ptr<MddCore::WinRTPackage>> s_winrtPackages;
+
+    /// Packages removed from the package graph. Their modules stay loaded for the life of the process.
+    static std::vector<std::shared_ptr<MddCore::WinRTPackage>> s_removedWinrtPackages;
+    static std::shared_ptr<const ActivatableClassIndex> s_index;
 };
 }
 
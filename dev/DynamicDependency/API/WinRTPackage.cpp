@@ -5,54 +5,7 @@
 
 #include "WinRTPackage.h"
 
-MddCore::WinRT::ThreadingModel MddCore::WinRTPackage::GetThreadingModel(
-    const std::wstring& activatableClassId)
-{
-    // Find the activation factory
-    if (!m_inprocModules.empty())
-    {
-        for (size_t index = 0; index < m_inprocModules.size(); ++index)
-        {
-            auto& inprocModule{ m_inprocModules[index] };
-
-            auto threadingModel{ inprocModule.Find(activatableClassId) };
-            if (threadingModel != MddCore::WinRT::ThreadingModel::Unknown)
-            {
-                return threadingModel;
-            }
-        }
-    }
-
-    // Not found
-    return MddCore::WinRT::ThreadingModel::Unknown;
-}
-
-void* MddCore::WinRTPackage::GetActivationFactory(
-    HSTRING className,
-    const std::wstring& activatableClassId,
-    REFIID iid)
-{
-    // Find the activation factory
-    if (!m_inprocModules.empty())
-    {
-        for (size_t index = 0; index < m_inprocModules.size(); ++index)
-        {
-            auto& inprocModule{ m_inprocModules[index] };
-
-            auto threadingModel{ inprocModule.Find(activatableClassId) };
-            if (threadingModel != MddCore::WinRT::ThreadingModel::Unknown)
-            {
-                //TODO change to return shared_ptr<inprocModule> rather than void*factory
-                //     so the object (and its DLL) isn't destroyed while upstack is calling the factory*.
-                //     Or perhaps caller's changed to return shared_ptr<winrtPackage>? TBD
-                return inprocModule.GetActivationFactory(className, activatableClassId, iid);
-            }
-        }
-    }
-
-    // Not found
-    return nullptr;
-}
+#include "WinRTPackageCache.h"
 
 /// Parse a package's appxmanifest for WinRT inproc server definitions e.g.
 /// ~~~~~
@@ -73,10 +26,28 @@ void* MddCore::WinRTPackage::GetActivationFactory(
 /// <ActivatableClass>'s attributes:
 ///   * ActivatableClassId=string
 ///   * ThreadingModel = "both" | "STA" | "MTA"
+///
+/// The parsed result is cached (see WinRTPackageCache) so we only walk the XML when the package
+/// is new to the user or its manifest changed since the last time we saw it.
 void MddCore::WinRTPackage::ParseAppxManifest()
 {
     std::filesystem::path filename{ m_packagePath };
     filename /= L"appxmanifest.xml";
+
+    const auto manifestStamp{ MddCore::WinRTPackageCache::GetManifestStamp(filename) };
+    if (MddCore::WinRTPackageCache::Load(m_packageFullName, m_packagePath, manifestStamp, m_inprocModules))
+    {
+        return;
+    }
+
+    ParseAppxManifestXml(filename);
+
+    MddCore::WinRTPackageCache::Save(m_packageFullName, m_packagePath, manifestStamp, m_inprocModules);
+}
+
+void MddCore::WinRTPackage::ParseAppxManifestXml(
+    const std::filesystem::path& filename)
+{
     wil::com_ptr<IStream> appxManifestStream;
     THROW_IF_FAILED_MSG(SHCreateStreamOnFileEx(filename.c_str(), STGM_READ, FILE_ATTRIBUTE_NORMAL, FALSE, nullptr, appxManifestStream.addressof()), "Error in SHCreateSreamOnFileEx(%ls)", filename.c_str());
 
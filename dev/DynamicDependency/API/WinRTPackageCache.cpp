@@ -0,0 +1,295 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "WinRTPackageCache.h"
+
+#include "DataStore.h"
+
+/// Cache file layout (all offsets and lengths in the string table are in WCHARs):
+/// ~~~~~
+/// Header
+/// Module[header.moduleCount]
+/// ActivatableClass[header.activatableClassCount]
+/// WCHAR[header.stringsLength]
+/// ~~~~~
+/// Strings are not NUL-terminated. header.checksum covers everything after the header.
+namespace
+{
+    constexpr UINT32 c_magic{ 0x5752444D };     // 'MDRW'
+    constexpr UINT32 c_version{ 1 };
+    constexpr UINT64 c_maxFileSize{ 64 * 1024 * 1024 };
+
+    struct Header
+    {
+        UINT32 magic;
+        UINT32 version;
+        UINT64 manifestSize;
+        UINT64 manifestLastWriteTime;
+        UINT32 packagePathOffset;
+        UINT32 packagePathLength;
+        UINT32 moduleCount;
+        UINT32 activatableClassCount;
+        UINT32 stringsLength;
+        UINT32 checksum;
+    };
+    static_assert(sizeof(Header) == 48);
+
+    struct Module
+    {
+        UINT32 pathOffset;
+        UINT32 pathLength;
+        UINT32 firstActivatableClass;
+        UINT32 activatableClassCount;
+    };
+    static_assert(sizeof(Module) == 16);
+
+    struct ActivatableClass
+    {
+        UINT32 activatableClassIdOffset;
+        UINT32 activatableClassIdLength;
+        UINT32 threadingModel;
+    };
+    static_assert(sizeof(ActivatableClass) == 12);
+}
+
+MddCore::WinRTPackageCache::ManifestStamp MddCore::WinRTPackageCache::GetManifestStamp(const std::filesystem::path& filename)
+{
+    ManifestStamp manifestStamp;
+    THROW_WIN32_IF_MSG(ERROR_FILE_NOT_FOUND, !MddCore::CacheFile::GetFileStamp(filename, manifestStamp), "%ls", filename.c_str());
+    return manifestStamp;
+}
+
+bool MddCore::WinRTPackageCache::Load(
+    const std::wstring& packageFullName,
+    const std::wstring& packagePath,
+    const ManifestStamp& manifestStamp,
+    std::vector<WinRTInprocModule>& inprocModules) noexcept try
+{
+    if (packageFullName.empty() || GetCachePath().empty())
+    {
+        return false;
+    }
+
+    MddCore::CacheFile cacheFile;
+    if (!cacheFile.Open(GetFilename(packageFullName), sizeof(Header), c_maxFileSize))
+    {
+        // Not cached (yet)
+        return false;
+    }
+
+    // The view is released before the modules are handed back
+    std::vector<WinRTInprocModule> modules;
+    if (!Parse(cacheFile, packagePath, manifestStamp, modules))
+    {
+        return false;
+    }
+    cacheFile.Close();
+
+    inprocModules.clear();
+    for (auto& module : modules)
+    {
+        inprocModules.push_back(std::move(module));
+    }
+    return true;
+}
+catch (...)
+{
+    // A stale or damaged entry is just a cache miss. The caller falls back to parsing the manifest
+    LOG_CAUGHT_EXCEPTION();
+    return false;
+}
+
+void MddCore::WinRTPackageCache::Save(
+    const std::wstring& packageFullName,
+    const std::wstring& packagePath,
+    const ManifestStamp& manifestStamp,
+    const std::vector<WinRTInprocModule>& inprocModules) noexcept try
+{
+    if (packageFullName.empty() || GetCachePath().empty())
+    {
+        return;
+    }
+
+    const auto data{ Serialize(packagePath, manifestStamp, inprocModules) };
+
+    std::error_code errorCode;
+    std::filesystem::create_directories(GetCachePath(), errorCode);
+
+    MddCore::CacheFile::Save(GetFilename(packageFullName), data);
+}
+CATCH_LOG();
+
+const std::filesystem::path& MddCore::WinRTPackageCache::GetCachePath()
+{
+    // Resolve the data store once per process. If it's not available (e.g. the Main package isn't
+    // registered for the user) the cache is disabled for the process rather than retried on every Add
+    static const std::filesystem::path s_path{ []() -> std::filesystem::path {
+        try
+        {
+            return MddCore::DataStore::GetWinRTPackageCachePath();
+        }
+        catch (...)
+        {
+            LOG_CAUGHT_EXCEPTION();
+            return {};
+        }
+    }() };
+    return s_path;
+}
+
+std::filesystem::path MddCore::WinRTPackageCache::GetFilename(const std::wstring& packageFullName)
+{
+    return GetCachePath() / (packageFullName + WinRTPackageCache::fileExtension);
+}
+
+bool MddCore::WinRTPackageCache::Parse(
+    const MddCore::CacheFile& cacheFile,
+    const std::wstring& packagePath,
+    const ManifestStamp& manifestStamp,
+    std::vector<WinRTInprocModule>& inprocModules)
+{
+    const auto invalidData{ HRESULT_FROM_WIN32(ERROR_INVALID_DATA) };
+
+    const auto header{ cacheFile.Header<Header>() };
+    if ((header.magic != c_magic) || (header.version != c_version))
+    {
+        THROW_HR_MSG(invalidData, "Unsupported WinRT package cache format 0x%08X v%u", header.magic, header.version);
+    }
+    if ((header.manifestSize != manifestStamp.size) || (header.manifestLastWriteTime != manifestStamp.lastWriteTime))
+    {
+        // The manifest changed (e.g. the package was re-registered or serviced in place). Stale
+        return false;
+    }
+
+    const UINT64 expectedSize{ sizeof(Header) +
+                               (static_cast<UINT64>(header.moduleCount) * sizeof(Module)) +
+                               (static_cast<UINT64>(header.activatableClassCount) * sizeof(ActivatableClass)) +
+                               (static_cast<UINT64>(header.stringsLength) * sizeof(WCHAR)) };
+    THROW_HR_IF(invalidData, !cacheFile.IsValid(header, expectedSize));
+
+    const auto payload{ cacheFile.Data() + sizeof(Header) };
+
+    // The entry's verified. Copy the tables out of the view (it's only WCHAR aligned at best)
+    std::vector<Module> modules(header.moduleCount);
+    memcpy(modules.data(), payload, modules.size() * sizeof(Module));
+    std::vector<ActivatableClass> activatableClasses(header.activatableClassCount);
+    memcpy(activatableClasses.data(), payload + (modules.size() * sizeof(Module)), activatableClasses.size() * sizeof(ActivatableClass));
+    std::wstring strings(header.stringsLength, L'\0');
+    memcpy(strings.data(), payload + (modules.size() * sizeof(Module)) + (activatableClasses.size() * sizeof(ActivatableClass)), strings.length() * sizeof(WCHAR));
+
+    auto getString{ [&](UINT32 offset, UINT32 length) -> std::wstring_view {
+        THROW_HR_IF(invalidData, (static_cast<UINT64>(offset) + length) > strings.length());
+        return std::wstring_view(strings.data() + offset, length);
+    } };
+
+    // Same package full name but installed elsewhere (e.g. moved to another volume)? Stale
+    const auto cachedPackagePath{ getString(header.packagePathOffset, header.packagePathLength) };
+    if (CompareStringOrdinal(cachedPackagePath.data(), static_cast<int>(cachedPackagePath.length()), packagePath.c_str(), static_cast<int>(packagePath.length()), TRUE) != CSTR_EQUAL)
+    {
+        return false;
+    }
+
+    inprocModules.reserve(modules.size());
+    for (const auto& module : modules)
+    {
+        THROW_HR_IF(invalidData, (module.pathLength == 0) || (module.activatableClassCount == 0));
+        THROW_HR_IF(invalidData, (static_cast<UINT64>(module.firstActivatableClass) + module.activatableClassCount) > activatableClasses.size());
+
+        // The entry lives in a user-writable folder so never let it name a DLL outside the package
+        const auto path{ getString(module.pathOffset, module.pathLength) };
+        THROW_HR_IF(invalidData, !IsInPackage(path, packagePath));
+
+        MddCore::WinRTInprocModule inprocModule;
+        inprocModule.Path(std::filesystem::path(path));
+        for (UINT32 index=0; index < module.activatableClassCount; ++index)
+        {
+            const auto& activatableClass{ activatableClasses[module.firstActivatableClass + index] };
+            const auto threadingModel{ static_cast<MddCore::WinRT::ThreadingModel>(activatableClass.threadingModel) };
+            THROW_HR_IF(invalidData, (threadingModel != MddCore::WinRT::ThreadingModel::Both) &&
+                                     (threadingModel != MddCore::WinRT::ThreadingModel::STA) &&
+                                     (threadingModel != MddCore::WinRT::ThreadingModel::MTA));
+            const auto activatableClassId{ getString(activatableClass.activatableClassIdOffset, activatableClass.activatableClassIdLength) };
+            THROW_HR_IF(invalidData, activatableClassId.empty());
+            inprocModule.AddInprocServer(std::wstring(activatableClassId), threadingModel);
+        }
+        inprocModules.push_back(std::move(inprocModule));
+    }
+    return true;
+}
+
+std::vector<BYTE> MddCore::WinRTPackageCache::Serialize(
+    const std::wstring& packagePath,
+    const ManifestStamp& manifestStamp,
+    const std::vector<WinRTInprocModule>& inprocModules)
+{
+    std::wstring strings;
+    std::vector<Module> modules;
+    modules.reserve(inprocModules.size());
+    std::vector<ActivatableClass> activatableClasses;
+
+    Header header{};
+    header.magic = c_magic;
+    header.version = c_version;
+    header.manifestSize = manifestStamp.size;
+    header.manifestLastWriteTime = manifestStamp.lastWriteTime;
+    header.packagePathOffset = MddCore::CacheFile::AppendString(strings, packagePath);
+    header.packagePathLength = static_cast<UINT32>(packagePath.length());
+
+    for (const auto& inprocModule : inprocModules)
+    {
+        // Load() would reject it so don't bother caching the package
+        THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED), !IsInPackage(inprocModule.Path(), packagePath), "%ls", inprocModule.Path().c_str());
+
+        Module module{};
+        module.pathOffset = MddCore::CacheFile::AppendString(strings, inprocModule.Path());
+        module.pathLength = static_cast<UINT32>(inprocModule.Path().length());
+        module.firstActivatableClass = static_cast<UINT32>(activatableClasses.size());
+        module.activatableClassCount = static_cast<UINT32>(inprocModule.InprocServers().size());
+        for (const auto& [activatableClassId, threadingModel] : inprocModule.InprocServers())
+        {
+            ActivatableClass activatableClass{};
+            activatableClass.activatableClassIdOffset = MddCore::CacheFile::AppendString(strings, activatableClassId);
+            activatableClass.activatableClassIdLength = static_cast<UINT32>(activatableClassId.length());
+            activatableClass.threadingModel = static_cast<UINT32>(threadingModel);
+            activatableClasses.push_back(activatableClass);
+        }
+        modules.push_back(module);
+    }
+    header.moduleCount = static_cast<UINT32>(modules.size());
+    header.activatableClassCount = static_cast<UINT32>(activatableClasses.size());
+    header.stringsLength = static_cast<UINT32>(strings.length());
+
+    std::vector<BYTE> data;
+    data.reserve(sizeof(Header) + (modules.size() * sizeof(Module)) + (activatableClasses.size() * sizeof(ActivatableClass)) + (strings.length() * sizeof(WCHAR)));
+    MddCore::CacheFile::AppendBytes(data, &header, 1);
+    MddCore::CacheFile::AppendBytes(data, modules.data(), modules.size());
+    MddCore::CacheFile::AppendBytes(data, activatableClasses.data(), activatableClasses.size());
+    MddCore::CacheFile::AppendBytes(data, strings.data(), strings.length());
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_BUFFER_OVERFLOW), data.size() > c_maxFileSize);
+
+    MddCore::CacheFile::SetHeader(data, header);
+    return data;
+}
+
+bool MddCore::WinRTPackageCache::IsInPackage(
+    const std::wstring_view& path,
+    const std::wstring& packagePath)
+{
+    // path must be <packagePath>\<something> with no relative components to climb back out
+    auto packagePathLength{ packagePath.length() };
+    if ((packagePathLength > 0) && (packagePath[packagePathLength - 1] == L'\\'))
+    {
+        --packagePathLength;
+    }
+    if ((path.length() <= packagePathLength + 1) || (path[packagePathLength] != L'\\'))
+    {
+        return false;
+    }
+    if (CompareStringOrdinal(path.data(), static_cast<int>(packagePathLength), packagePath.c_str(), static_cast<int>(packagePathLength), TRUE) != CSTR_EQUAL)
+    {
+        return false;
+    }
+    return path.find(L"..", packagePathLength) == std::wstring_view::npos;
+}
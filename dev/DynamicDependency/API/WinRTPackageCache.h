@@ -0,0 +1,64 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#if !defined(WINRTPACKAGECACHE_H)
+#define WINRTPACKAGECACHE_H
+
+#include "WinRTInprocModule.h"
+#include "CacheFile.h"
+
+namespace MddCore
+{
+/// Binary cache of the WinRT inproc server registrations parsed from a package's appxmanifest.xml.
+///
+/// Entries are stored in the DynamicDependency data store as WinRT\<packageFullName>.winrt and
+/// are only trusted while the manifest's size and last write time match the values recorded
+/// when the entry was saved. Any mismatch or malformed entry is treated as a cache miss.
+class WinRTPackageCache
+{
+public:
+    WinRTPackageCache() = delete;
+    ~WinRTPackageCache() = delete;
+
+public:
+    static constexpr PCWSTR fileExtension{ L".winrt" };
+
+    using ManifestStamp = MddCore::CacheFile::FileStamp;
+
+    static ManifestStamp GetManifestStamp(const std::filesystem::path& filename);
+
+    static bool Load(
+        const std::wstring& packageFullName,
+        const std::wstring& packagePath,
+        const ManifestStamp& manifestStamp,
+        std::vector<WinRTInprocModule>& inprocModules) noexcept;
+
+    static void Save(
+        const std::wstring& packageFullName,
+        const std::wstring& packagePath,
+        const ManifestStamp& manifestStamp,
+        const std::vector<WinRTInprocModule>& inprocModules) noexcept;
+
+private:
+    static const std::filesystem::path& GetCachePath();
+
+    static std::filesystem::path GetFilename(const std::wstring& packageFullName);
+
+    static bool Parse(
+        const MddCore::CacheFile& cacheFile,
+        const std::wstring& packagePath,
+        const ManifestStamp& manifestStamp,
+        std::vector<WinRTInprocModule>& inprocModules);
+
+    static std::vector<BYTE> Serialize(
+        const std::wstring& packagePath,
+        const ManifestStamp& manifestStamp,
+        const std::vector<WinRTInprocModule>& inprocModules);
+
+    static bool IsInPackage(
+        const std::wstring_view& path,
+        const std::wstring& packagePath);
+};
+}
+
+#endif // WINRTPACKAGECACHE_H
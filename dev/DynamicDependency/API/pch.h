@@ -43,3 +43,4 @@
 #include <microsoft.utf8.h>
 #include <security.integritylevel.h>
 #include <windowsappruntime.versioninfo.h>
+#include <windowsappruntime.ddlm.h>
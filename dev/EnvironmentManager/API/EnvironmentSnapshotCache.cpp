@@ -0,0 +1,168 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include "EnvironmentSnapshotCache.h"
+#include "Microsoft.Windows.System.EnvironmentSnapshot.h"
+
+namespace winrt::Microsoft::Windows::System::implementation
+{
+    EnvironmentSnapshotCache::EnvironmentSnapshotCache(EnvironmentManager::Scope scope)
+        : m_scope(scope)
+    {
+    }
+
+    EnvironmentSnapshotCache& EnvironmentSnapshotCache::ForScope(EnvironmentManager::Scope scope)
+    {
+        static EnvironmentSnapshotCache s_processCache{ EnvironmentManager::Scope::Process };
+        static EnvironmentSnapshotCache s_userCache{ EnvironmentManager::Scope::User };
+        static EnvironmentSnapshotCache s_machineCache{ EnvironmentManager::Scope::Machine };
+
+        switch (scope)
+        {
+        case EnvironmentManager::Scope::Process:
+            return s_processCache;
+        case EnvironmentManager::Scope::User:
+            return s_userCache;
+        case EnvironmentManager::Scope::Machine:
+            return s_machineCache;
+        }
+        FAIL_FAST_HR(E_INVALIDARG);
+    }
+
+    Microsoft::Windows::System::EnvironmentSnapshot EnvironmentSnapshotCache::Get()
+    {
+        if (m_scope == EnvironmentManager::Scope::Process)
+        {
+            return GetForProcess();
+        }
+        return GetForUserOrMachine();
+    }
+
+    void EnvironmentSnapshotCache::Invalidate() noexcept
+    {
+        m_invalidated = true;
+    }
+
+    Microsoft::Windows::System::EnvironmentSnapshot EnvironmentSnapshotCache::GetForProcess()
+    {
+        wil::unique_environstrings_ptr environmentBlock{ GetEnvironmentStringsW() };
+        THROW_HR_IF_NULL(E_POINTER, environmentBlock);
+        const auto environmentBlockEnd{ environmentBlock.get() + EnvironmentVariableSnapshot::EnvironmentBlockLength(environmentBlock.get()) };
+
+        auto lock{ m_lock.lock_exclusive() };
+        const bool invalidated{ m_invalidated.exchange(false) };
+        if (m_snapshot && !invalidated &&
+            std::equal(m_environmentBlock.begin(), m_environmentBlock.end(), environmentBlock.get(), environmentBlockEnd))
+        {
+            return m_snapshot;
+        }
+
+        m_environmentBlock.assign(environmentBlock.get(), environmentBlockEnd);
+        Update(EnvironmentVariableSnapshot::ParseEnvironmentBlock(environmentBlock.get()));
+        return m_snapshot;
+    }
+
+    Microsoft::Windows::System::EnvironmentSnapshot EnvironmentSnapshotCache::GetForUserOrMachine()
+    {
+        {
+            auto lock{ m_lock.lock_shared() };
+            if (IsCurrent())
+            {
+                return m_snapshot;
+            }
+        }
+
+        auto lock{ m_lock.lock_exclusive() };
+        if (!m_environmentVariablesHKey)
+        {
+            const auto rootHKey{ (m_scope == EnvironmentManager::Scope::User) ? HKEY_CURRENT_USER : HKEY_LOCAL_MACHINE };
+            const auto subKey{ (m_scope == EnvironmentManager::Scope::User) ? EnvironmentManager::c_UserEvRegLocation : EnvironmentManager::c_MachineEvRegLocation };
+            wil::unique_hkey environmentVariablesHKey;
+            THROW_IF_WIN32_ERROR(RegOpenKeyEx(rootHKey, subKey, 0, KEY_READ, environmentVariablesHKey.addressof()));
+            m_environmentVariablesChanged.create(wil::EventOptions::ManualReset);
+            m_environmentVariablesHKey = std::move(environmentVariablesHKey);
+        }
+        else if (IsCurrent())
+        {
+            // Another thread refreshed it while we waited for the lock
+            return m_snapshot;
+        }
+
+        // The notification is one-shot. Re-arm it before reading so a change made during the read
+        // is seen on the next call. If the read fails the snapshot stays stale.
+        m_invalidated = false;
+        auto markStale{ wil::scope_exit([&]() { m_invalidated = true; }) };
+        m_environmentVariablesChanged.ResetEvent();
+        THROW_IF_WIN32_ERROR(RegNotifyChangeKeyValue(m_environmentVariablesHKey.get(), FALSE,
+            REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET | REG_NOTIFY_THREAD_AGNOSTIC,
+            m_environmentVariablesChanged.get(), TRUE));
+
+        Update(ReadVariables(m_environmentVariablesHKey.get()));
+        markStale.release();
+        return m_snapshot;
+    }
+
+    bool EnvironmentSnapshotCache::IsCurrent() const
+    {
+        return m_snapshot && !m_invalidated && !m_environmentVariablesChanged.is_signaled();
+    }
+
+    void EnvironmentSnapshotCache::Update(std::vector<EnvironmentVariableSnapshot::Variable>&& variables)
+    {
+        EnvironmentVariableSnapshot snapshot{ std::move(variables), m_version + 1 };
+        if (m_snapshot && snapshot.HasSameVariables(winrt::get_self<EnvironmentSnapshot>(m_snapshot)->Snapshot()))
+        {
+            // Something was rewritten with the same contents. Keep the version callers already have.
+            return;
+        }
+
+        ++m_version;
+        m_snapshot = winrt::make<EnvironmentSnapshot>(std::move(snapshot));
+    }
+
+    std::vector<EnvironmentVariableSnapshot::Variable> EnvironmentSnapshotCache::ReadVariables(HKEY environmentVariablesHKey)
+    {
+        DWORD numberOfValues{};
+        DWORD sizeOfLongestNameInCharacters{};
+        DWORD sizeOfLongestValueInBytes{};
+        THROW_IF_WIN32_ERROR(RegQueryInfoKeyW(environmentVariablesHKey,
+            nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+            &numberOfValues, &sizeOfLongestNameInCharacters,
+            &sizeOfLongestValueInBytes, nullptr, nullptr));
+
+        // +1 for the null character, which the name length never includes and a value might not have
+        std::vector<wchar_t> name(sizeOfLongestNameInCharacters + 1);
+        std::vector<wchar_t> value(sizeOfLongestValueInBytes / sizeof(wchar_t) + 1);
+
+        std::vector<EnvironmentVariableSnapshot::Variable> variables;
+        variables.reserve(numberOfValues);
+        for (DWORD valueIndex = 0; valueIndex < numberOfValues; valueIndex++)
+        {
+            DWORD nameLength{ static_cast<DWORD>(name.size()) };
+            DWORD valueSize{ static_cast<DWORD>((value.size() - 1) * sizeof(wchar_t)) };
+            const LSTATUS enumerationStatus{ RegEnumValueW(environmentVariablesHKey,
+                valueIndex, name.data(), &nameLength,
+                nullptr, nullptr, reinterpret_cast<BYTE*>(value.data()),
+                &valueSize) };
+
+            // Values deleted since RegQueryInfoKeyW. The change notification covers them.
+            if (enumerationStatus == ERROR_NO_MORE_ITEMS)
+            {
+                break;
+            }
+            THROW_IF_WIN32_ERROR(enumerationStatus);
+
+            // An empty name indicates the default value.
+            if (nameLength == 0)
+            {
+                continue;
+            }
+
+            // A value is read as the string up to its first null.
+            const std::wstring_view valueString{ value.data(), valueSize / sizeof(wchar_t) };
+            variables.push_back({ std::wstring{ name.data(), nameLength }, std::wstring{ valueString.substr(0, valueString.find(L'\0')) } });
+        }
+        return variables;
+    }
+}
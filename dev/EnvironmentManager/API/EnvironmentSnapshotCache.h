@@ -0,0 +1,53 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#pragma once
+#include "Microsoft.Windows.System.EnvironmentManager.h"
+#include "EnvironmentVariableSnapshot.h"
+#include <atomic>
+
+namespace winrt::Microsoft::Windows::System::implementation
+{
+    // The latest EnvironmentSnapshot of a scope, shared by every EnvironmentManager for that scope.
+    //
+    // User and machine snapshots are re-read only after the scope's Environment registry key signals
+    // a change or this process writes to it. Nothing signals changes to the process environment, which
+    // can be changed with ::SetEnvironmentVariable directly, so that snapshot is re-parsed only when the
+    // environment block differs from the one it was parsed from.
+    //
+    // A snapshot's version only changes when its variables do.
+    class EnvironmentSnapshotCache
+    {
+    public:
+        static EnvironmentSnapshotCache& ForScope(EnvironmentManager::Scope scope);
+
+        Microsoft::Windows::System::EnvironmentSnapshot Get();
+
+        // Called after this process changes the scope's variables.
+        void Invalidate() noexcept;
+
+    private:
+        explicit EnvironmentSnapshotCache(EnvironmentManager::Scope scope);
+
+        Microsoft::Windows::System::EnvironmentSnapshot GetForProcess();
+        Microsoft::Windows::System::EnvironmentSnapshot GetForUserOrMachine();
+        bool IsCurrent() const;
+        void Update(std::vector<EnvironmentVariableSnapshot::Variable>&& variables);
+
+        static std::vector<EnvironmentVariableSnapshot::Variable> ReadVariables(HKEY environmentVariablesHKey);
+
+        const EnvironmentManager::Scope m_scope{};
+
+        wil::srwlock m_lock;
+        Microsoft::Windows::System::EnvironmentSnapshot m_snapshot{ nullptr };
+        uint64_t m_version{};
+        std::atomic<bool> m_invalidated{};
+
+        // Process scope: the environment block m_snapshot was parsed from.
+        std::vector<wchar_t> m_environmentBlock;
+
+        // User and machine scope: the Environment key, and the event signaled when its values change.
+        wil::unique_hkey m_environmentVariablesHKey;
+        wil::unique_event m_environmentVariablesChanged;
+    };
+}
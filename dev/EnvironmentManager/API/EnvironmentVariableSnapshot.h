@@ -0,0 +1,185 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#pragma once
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace winrt::Microsoft::Windows::System::implementation
+{
+    // An immutable copy of one scope's environment variables. Variables are kept sorted by name,
+    // ignoring case as Windows does, so a lookup is a binary search and two snapshots can be diffed
+    // in a single merge pass. The version identifies the contents: the cache that produces snapshots
+    // only assigns a new version when the variables actually change.
+    class EnvironmentVariableSnapshot
+    {
+    public:
+        struct Variable
+        {
+            std::wstring name;
+            std::wstring value;
+        };
+
+        enum class ChangeKind
+        {
+            Added,
+            Changed,
+            Removed
+        };
+
+        // Views refer into the two snapshots that were diffed.
+        struct Change
+        {
+            ChangeKind kind{};
+            std::wstring_view name;
+            std::wstring_view oldValue;
+            std::wstring_view newValue;
+        };
+
+        EnvironmentVariableSnapshot() = default;
+
+        // If a name appears more than once (ignoring case) the last one wins, like repeated inserts would.
+        EnvironmentVariableSnapshot(std::vector<Variable> variables, uint64_t version) :
+            m_variables(std::move(variables)),
+            m_version(version)
+        {
+            std::stable_sort(m_variables.begin(), m_variables.end(),
+                [](Variable const& left, Variable const& right) { return CompareNames(left.name, right.name) < 0; });
+
+            auto last{ m_variables.begin() };
+            for (auto current{ m_variables.begin() }; current != m_variables.end(); ++current)
+            {
+                const auto next{ current + 1 };
+                if ((next != m_variables.end()) && (CompareNames(current->name, next->name) == 0))
+                {
+                    continue;
+                }
+                if (last != current)
+                {
+                    *last = std::move(*current);
+                }
+                ++last;
+            }
+            m_variables.erase(last, m_variables.end());
+        }
+
+        // Parses a double null terminated block as returned by GetEnvironmentStrings. Entries are split
+        // at their first '=', so the per-drive "=C:=C:\..." entries share the empty name.
+        static std::vector<Variable> ParseEnvironmentBlock(PCWSTR block)
+        {
+            std::vector<Variable> variables;
+            for (auto entry{ block }; *entry; )
+            {
+                const std::wstring_view text{ entry };
+                const auto delimiter{ text.find(L'=') };
+                FAIL_FAST_HR_IF(E_UNEXPECTED, delimiter == std::wstring_view::npos);
+                variables.push_back({ std::wstring{ text.substr(0, delimiter) }, std::wstring{ text.substr(delimiter + 1) } });
+                entry += text.size() + 1;
+            }
+            return variables;
+        }
+
+        // Length in characters of a double null terminated block, including both terminators.
+        static size_t EnvironmentBlockLength(PCWSTR block)
+        {
+            auto end{ block };
+            while (*end)
+            {
+                end += std::char_traits<wchar_t>::length(end) + 1;
+            }
+            return static_cast<size_t>(end - block) + 1;
+        }
+
+        static EnvironmentVariableSnapshot FromEnvironmentBlock(PCWSTR block, uint64_t version)
+        {
+            return EnvironmentVariableSnapshot{ ParseEnvironmentBlock(block), version };
+        }
+
+        static int CompareNames(std::wstring_view left, std::wstring_view right)
+        {
+            // 0 means the comparison failed, not that the names are equal.
+            const auto result{ CompareStringOrdinal(left.data(), static_cast<int>(left.size()), right.data(), static_cast<int>(right.size()), TRUE) };
+            THROW_LAST_ERROR_IF(result == 0);
+            return result - CSTR_EQUAL;
+        }
+
+        uint64_t Version() const
+        {
+            return m_version;
+        }
+
+        size_t Size() const
+        {
+            return m_variables.size();
+        }
+
+        std::vector<Variable> const& Variables() const
+        {
+            return m_variables;
+        }
+
+        // The variable with this name ignoring case, or nullptr if it isn't set.
+        Variable const* Find(std::wstring_view name) const
+        {
+            const auto found{ std::lower_bound(m_variables.begin(), m_variables.end(), name,
+                [](Variable const& variable, std::wstring_view name) { return CompareNames(variable.name, name) < 0; }) };
+            if ((found == m_variables.end()) || (CompareNames(found->name, name) != 0))
+            {
+                return nullptr;
+            }
+            return &*found;
+        }
+
+        bool HasSameVariables(EnvironmentVariableSnapshot const& other) const
+        {
+            return std::equal(m_variables.begin(), m_variables.end(), other.m_variables.begin(), other.m_variables.end(),
+                [](Variable const& left, Variable const& right) { return (left.name == right.name) && (left.value == right.value); });
+        }
+
+        // What changed from older to this snapshot, ordered by name. A variable whose name only changed
+        // case is the same variable, and is reported only if its value changed too.
+        std::vector<Change> ChangesSince(EnvironmentVariableSnapshot const& older) const
+        {
+            std::vector<Change> changes;
+            if (&older == this)
+            {
+                return changes;
+            }
+
+            auto before{ older.m_variables.begin() };
+            auto after{ m_variables.begin() };
+            while ((before != older.m_variables.end()) || (after != m_variables.end()))
+            {
+                const auto order{ (before == older.m_variables.end()) ? 1 :
+                                  (after == m_variables.end()) ? -1 :
+                                  CompareNames(before->name, after->name) };
+                if (order < 0)
+                {
+                    changes.push_back({ ChangeKind::Removed, before->name, before->value, {} });
+                    ++before;
+                }
+                else if (order > 0)
+                {
+                    changes.push_back({ ChangeKind::Added, after->name, {}, after->value });
+                    ++after;
+                }
+                else
+                {
+                    if (before->value != after->value)
+                    {
+                        changes.push_back({ ChangeKind::Changed, after->name, before->value, after->value });
+                    }
+                    ++before;
+                    ++after;
+                }
+            }
+            return changes;
+        }
+
+    private:
+        std::vector<Variable> m_variables;
+        uint64_t m_version{};
+    };
+}
@@ -51,6 +51,14 @@ class EnvironmentManagerInsights : public wil::TraceLoggingProvider
             TraceLoggingWideString(ScopeToString(scope), "Scope"));
     }
 
+    DEFINE_EVENT_METHOD(LogGetSnapshot)(winrt::Microsoft::Windows::System::implementation::EnvironmentManager::Scope scope) {
+        TraceLoggingClassWriteMeasure(
+            "LogGetSnapshot",
+            TelemetryPrivacyDataTag(PDT_ProductAndServicePerformance),
+            _GENERIC_PARTB_FIELDS_ENABLED,
+            TraceLoggingWideString(ScopeToString(scope), "Scope"));
+    }
+
     DEFINE_EVENT_METHOD(LogSetEnvironmentVariable)(winrt::Microsoft::Windows::System::implementation::EnvironmentManager::Scope scope) {
         TraceLoggingClassWriteMeasure(
             "LogSetEnvironmentVariables",
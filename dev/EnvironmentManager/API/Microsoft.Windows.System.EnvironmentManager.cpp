@@ -5,6 +5,7 @@
 #include "Microsoft.Windows.System.EnvironmentManager.h"
 #include "Microsoft.Windows.System.EnvironmentManager.g.cpp"
 #include "Microsoft.Windows.System.EnvironmentManager.Insights.h"
+#include "EnvironmentSnapshotCache.h"
 #include <EnvironmentVariableChangeTracker.h>
 #include <EnvironmentVariableChangeTrackerHelper.h>
 #include <PathChangeTracker.h>
@@ -67,23 +68,14 @@ namespace winrt::Microsoft::Windows::System::implementation
     IMapView<hstring, hstring> EnvironmentManager::GetEnvironmentVariables()
     {
         EnvironmentManagerInsights::LogGetEnvironmentVariables(m_Scope);
-        StringMap environmentVariables;
 
         if (!IsSupported())
         {
+            StringMap environmentVariables;
             return environmentVariables.GetView();
         }
 
-        if (m_Scope == Scope::Process)
-        {
-            environmentVariables = GetProcessEnvironmentVariables();
-        }
-        else
-        {
-            environmentVariables = GetUserOrMachineEnvironmentVariables();
-        }
-
-        return environmentVariables.GetView();
+        return EnvironmentSnapshotCache::ForScope(m_Scope).Get().Variables();
     }
 
     hstring EnvironmentManager::GetEnvironmentVariable(hstring const& variableName)
@@ -109,10 +101,17 @@ namespace winrt::Microsoft::Windows::System::implementation
         }
         else
         {
-            return hstring{ GetUserOrMachineEnvironmentVariable(std::wstring{variableName}) };
+            return EnvironmentSnapshotCache::ForScope(m_Scope).Get().GetEnvironmentVariable(variableName);
         }
     }
 
+    Microsoft::Windows::System::EnvironmentSnapshot EnvironmentManager::GetSnapshot()
+    {
+        EnvironmentManagerInsights::LogGetSnapshot(m_Scope);
+
+        return EnvironmentSnapshotCache::ForScope(m_Scope).Get();
+    }
+
     void EnvironmentManager::SetEnvironmentVariable(hstring const& name, hstring const& value)
     {
         EnvironmentManagerInsights::LogSetEnvironmentVariable(m_Scope);
@@ -188,6 +187,7 @@ namespace winrt::Microsoft::Windows::System::implementation
         EnvironmentVariableChangeTracker changeTracker(std::wstring(name), std::wstring(value), m_Scope);
 
         THROW_IF_FAILED(changeTracker.TrackChange(setEV));
+        EnvironmentSnapshotCache::ForScope(m_Scope).Invalidate();
     }
 
     void EnvironmentManager::AppendToPath(hstring const& path)
@@ -256,6 +256,7 @@ namespace winrt::Microsoft::Windows::System::implementation
         PathChangeTracker changeTracker(std::wstring(path), m_Scope, IChangeTracker::PathOperation::Append);
 
         THROW_IF_FAILED(changeTracker.TrackChange(setPath));
+        EnvironmentSnapshotCache::ForScope(m_Scope).Invalidate();
     }
 
     void EnvironmentManager::RemoveFromPath(hstring const& path)
@@ -357,6 +358,7 @@ namespace winrt::Microsoft::Windows::System::implementation
             PathChangeTracker changeTracker(std::wstring(path), m_Scope, IChangeTracker::PathOperation::Remove);
 
             THROW_IF_FAILED(changeTracker.TrackChange(removeFromPath));
+            EnvironmentSnapshotCache::ForScope(m_Scope).Invalidate();
         }
     }
 
@@ -426,6 +428,7 @@ namespace winrt::Microsoft::Windows::System::implementation
         PathExtChangeTracker changeTracker(std::wstring(pathExt), m_Scope, IChangeTracker::PathOperation::Append);
 
         THROW_IF_FAILED(changeTracker.TrackChange(setPathExt));
+        EnvironmentSnapshotCache::ForScope(m_Scope).Invalidate();
     }
 
     void EnvironmentManager::RemoveExecutableFileExtension(hstring const& pathExt)
@@ -522,6 +525,7 @@ namespace winrt::Microsoft::Windows::System::implementation
             PathExtChangeTracker changeTracker(std::wstring(pathExt), m_Scope, IChangeTracker::PathOperation::Remove);
 
             THROW_IF_FAILED(changeTracker.TrackChange(removeFromPathExt));
+            EnvironmentSnapshotCache::ForScope(m_Scope).Invalidate();
         }
     }
 
@@ -603,86 +607,6 @@ namespace winrt::Microsoft::Windows::System::implementation
         return pathExt;
     }
 
-    StringMap EnvironmentManager::GetProcessEnvironmentVariables() const
-    {
-        //Get the pointer to the process block
-        PWSTR environmentVariablesString{ GetEnvironmentStrings() };
-        THROW_HR_IF_NULL(E_POINTER, environmentVariablesString);
-
-        StringMap environmentVariables;
-        for (auto environmentVariableOffset = environmentVariablesString; *environmentVariableOffset; environmentVariableOffset += wcslen(environmentVariableOffset) + 1)
-        {
-            auto delimiter{ wcschr(environmentVariableOffset, L'=') };
-            FAIL_FAST_HR_IF_NULL(E_UNEXPECTED, delimiter);
-            std::wstring variableName(environmentVariableOffset, 0, delimiter - environmentVariableOffset);
-            auto variableValue{ delimiter + 1 };
-            environmentVariables.Insert(variableName, variableValue);
-        }
-
-        THROW_IF_WIN32_BOOL_FALSE(FreeEnvironmentStrings(environmentVariablesString));
-
-        return environmentVariables;
-    }
-
-    StringMap EnvironmentManager::GetUserOrMachineEnvironmentVariables() const
-    {
-        StringMap environmentVariables;
-        wil::unique_hkey environmentVariablesHKey{ GetRegHKeyForEVUserAndMachineScope() };
-
-        // While this way of calculating the max size of the names,
-        // values, and total number of entries includes two calls
-        // to the registry, I believe this is superior to
-        // using a do/while or a while with a prime
-        // because there is no chance of the loop iterating more than
-        // is needed AND the size of the name and value arrays are
-        // only as big as the biggest name or value.
-
-        DWORD sizeOfLongestNameInCharacters;
-        DWORD sizeOfLongestValueInCharacters;
-        DWORD numberOfValues;
-
-        THROW_IF_WIN32_ERROR(RegQueryInfoKeyW(environmentVariablesHKey.get(),
-            nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
-            &numberOfValues, &sizeOfLongestNameInCharacters,
-            &sizeOfLongestValueInCharacters, nullptr, nullptr));
-
-        // +1 for null character
-        const DWORD c_nameLength{ sizeOfLongestNameInCharacters + 1 };
-        const DWORD c_valueSizeInBytes{ static_cast<DWORD>(sizeOfLongestValueInCharacters * sizeof(WCHAR)) };
-
-        std::unique_ptr<wchar_t[]> environmentVariableName(new wchar_t[c_nameLength]);
-        std::unique_ptr<BYTE[]> environmentVariableValue(new BYTE[c_valueSizeInBytes]);
-
-        for (DWORD valueIndex = 0; valueIndex < numberOfValues; valueIndex++)
-        {
-            DWORD nameLength{ c_nameLength };
-            DWORD valueSize{ c_valueSizeInBytes };
-            LSTATUS enumerationStatus{ RegEnumValueW(environmentVariablesHKey.get(),
-                valueIndex, environmentVariableName.get(), &nameLength,
-                nullptr, nullptr, environmentVariableValue.get(),
-                &valueSize) };
-
-            // An empty name indicates the default value.
-            if (nameLength == 0)
-            {
-                continue;
-            }
-
-            // If there was an error getting the value
-            if (enumerationStatus != ERROR_SUCCESS && enumerationStatus != ERROR_NO_MORE_ITEMS)
-            {
-                THROW_WIN32(enumerationStatus);
-            }
-            environmentVariableValue.get()[valueSize] = L'\0';
-            environmentVariables.Insert(environmentVariableName.get(), reinterpret_cast<PWSTR>(environmentVariableValue.get()));
-
-            environmentVariableName.get()[0] = L'\0';
-            environmentVariableValue.reset(new BYTE[c_valueSizeInBytes]);
-        }
-
-        return environmentVariables;
-    }
-
     std::wstring EnvironmentManager::GetProcessEnvironmentVariable(const std::wstring variableName) const
     {
         // Get the size of the buffer.
@@ -740,31 +664,6 @@ namespace winrt::Microsoft::Windows::System::implementation
         return environmentVariablesHKey;
     }
 
-    std::wstring EnvironmentManager::GetUserOrMachineEnvironmentVariable(const std::wstring variableName) const
-    {
-        wil::unique_hkey environmentVariableHKey{ GetRegHKeyForEVUserAndMachineScope() };
-
-        DWORD sizeOfEnvironmentValue;
-
-        // See how big we need the buffer to be
-        LSTATUS queryResult{ RegQueryValueEx(environmentVariableHKey.get(), variableName.c_str(), 0, nullptr, nullptr, &sizeOfEnvironmentValue) };
-
-        if (queryResult != ERROR_SUCCESS)
-        {
-            if (queryResult == ERROR_FILE_NOT_FOUND)
-            {
-                return L"";
-            }
-
-            THROW_WIN32(queryResult);
-        }
-
-        std::unique_ptr<wchar_t[]> environmentValue{ new wchar_t[sizeOfEnvironmentValue] };
-        THROW_IF_WIN32_ERROR(RegQueryValueEx(environmentVariableHKey.get(), variableName.c_str(), 0, nullptr, (LPBYTE)environmentValue.get(), &sizeOfEnvironmentValue));
-
-        return std::wstring(environmentValue.get());
-    }
-
     void EnvironmentManager::DeleteEnvironmentVariableIfExists(const HKEY hkey, const std::wstring name) const
     {
         const auto deleteResult{ RegDeleteValue(hkey, name.c_str()) };
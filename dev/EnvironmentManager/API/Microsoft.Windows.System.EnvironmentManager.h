@@ -32,24 +32,23 @@ namespace winrt::Microsoft::Windows::System::implementation
         void RemoveFromPath(hstring const& path);
         void AddExecutableFileExtension(hstring const& pathExt);
         void RemoveExecutableFileExtension(hstring const& pathExt);
+        Microsoft::Windows::System::EnvironmentSnapshot GetSnapshot();
 
     private:
+        friend class EnvironmentSnapshotCache;
+
         Scope m_Scope{};
         std::optional<bool> m_willChangesBeTracked{};
 
-        PCWSTR c_UserEvRegLocation{ L"Environment" };
-        PCWSTR c_MachineEvRegLocation{ L"SYSTEM\\CurrentControlSet\\Control\\Session Manager\\Environment" };
+        static constexpr PCWSTR c_UserEvRegLocation{ L"Environment" };
+        static constexpr PCWSTR c_MachineEvRegLocation{ L"SYSTEM\\CurrentControlSet\\Control\\Session Manager\\Environment" };
         PCWSTR c_PathName{ L"PATH" };
         PCWSTR c_PathExtName{ L"PATHEXT" };
 
         static bool s_HasCheckedIsSupported;
         static bool s_IsSupported;
 
-        StringMap GetProcessEnvironmentVariables() const;
-        StringMap GetUserOrMachineEnvironmentVariables() const;
-
         std::wstring GetProcessEnvironmentVariable(const std::wstring variableName) const;
-        std::wstring GetUserOrMachineEnvironmentVariable(const std::wstring variableName) const;
 
         wil::unique_hkey GetRegHKeyForEVUserAndMachineScope(bool needsWriteAccess = false) const;
 
@@ -0,0 +1,62 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include "Microsoft.Windows.System.EnvironmentSnapshot.h"
+#include "Microsoft.Windows.System.EnvironmentSnapshot.g.cpp"
+
+namespace winrt::Microsoft::Windows::System::implementation
+{
+    EnvironmentSnapshot::EnvironmentSnapshot(EnvironmentVariableSnapshot&& snapshot)
+        : m_snapshot(std::move(snapshot))
+    {
+    }
+
+    uint64_t EnvironmentSnapshot::Version()
+    {
+        return m_snapshot.Version();
+    }
+
+    winrt::Windows::Foundation::Collections::IMapView<hstring, hstring> EnvironmentSnapshot::Variables()
+    {
+        {
+            auto lock{ m_lock.lock_shared() };
+            if (m_variables)
+            {
+                return m_variables;
+            }
+        }
+
+        winrt::Windows::Foundation::Collections::StringMap environmentVariables;
+        for (auto const& variable : m_snapshot.Variables())
+        {
+            environmentVariables.Insert(variable.name, variable.value);
+        }
+
+        auto lock{ m_lock.lock_exclusive() };
+        if (!m_variables)
+        {
+            m_variables = environmentVariables.GetView();
+        }
+        return m_variables;
+    }
+
+    hstring EnvironmentSnapshot::GetEnvironmentVariable(hstring const& name)
+    {
+        const auto variable{ m_snapshot.Find(name) };
+        return variable ? hstring{ variable->value } : hstring{};
+    }
+
+    winrt::Windows::Foundation::Collections::IVectorView<Microsoft::Windows::System::EnvironmentVariableChange> EnvironmentSnapshot::GetChangesSince(Microsoft::Windows::System::EnvironmentSnapshot const& older)
+    {
+        THROW_HR_IF_NULL(E_INVALIDARG, older);
+
+        std::vector<Microsoft::Windows::System::EnvironmentVariableChange> changes;
+        for (auto const& change : m_snapshot.ChangesSince(winrt::get_self<EnvironmentSnapshot>(older)->Snapshot()))
+        {
+            changes.push_back({ static_cast<Microsoft::Windows::System::EnvironmentVariableChangeKind>(change.kind),
+                                hstring{ change.name }, hstring{ change.oldValue }, hstring{ change.newValue } });
+        }
+        return winrt::single_threaded_vector(std::move(changes)).GetView();
+    }
+}
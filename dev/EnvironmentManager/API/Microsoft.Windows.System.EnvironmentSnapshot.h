@@ -0,0 +1,31 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#pragma once
+#include "Microsoft.Windows.System.EnvironmentSnapshot.g.h"
+#include "EnvironmentVariableSnapshot.h"
+
+namespace winrt::Microsoft::Windows::System::implementation
+{
+    struct EnvironmentSnapshot : EnvironmentSnapshotT<EnvironmentSnapshot>
+    {
+        EnvironmentSnapshot(EnvironmentVariableSnapshot&& snapshot);
+
+        uint64_t Version();
+        winrt::Windows::Foundation::Collections::IMapView<hstring, hstring> Variables();
+        hstring GetEnvironmentVariable(hstring const& name);
+        winrt::Windows::Foundation::Collections::IVectorView<Microsoft::Windows::System::EnvironmentVariableChange> GetChangesSince(Microsoft::Windows::System::EnvironmentSnapshot const& older);
+
+        EnvironmentVariableSnapshot const& Snapshot() const
+        {
+            return m_snapshot;
+        }
+
+    private:
+        const EnvironmentVariableSnapshot m_snapshot;
+
+        // Built on first use and shared by every caller of this snapshot.
+        wil::srwlock m_lock;
+        winrt::Windows::Foundation::Collections::IMapView<hstring, hstring> m_variables{ nullptr };
+    };
+}
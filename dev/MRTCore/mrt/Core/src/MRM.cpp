@@ -12,6 +12,7 @@
 #include "mrm/readers/MrmManagers.h"
 
 #include "mrm/common/MrmTraceLogging.h"
+#include "mrm/common/MrmPerfCounters.h"
 
 #include "MRM.h"
 
@@ -25,6 +26,7 @@ typedef struct _MrmObjects
     UnifiedResourceView* unifiedView = nullptr;
     const PriFile* priFile = nullptr;
     ProviderResolver* resolver = nullptr;
+    MrmPerfCounterSet* perfCounters = nullptr;
 } MrmObjects;
 
 constexpr wchar_t ResourceUriPrefix[] = L"ms-resource://";
@@ -43,6 +45,7 @@ static HRESULT StringResultReleaseOwnershipBuffer(_Inout_ StringResult& result,
     // Release the ownership
     RETURN_IF_FAILED(result.ReleaseContents(buffer, &localStringLength));
 
+    MrmPerfCounterSet::Increment(MrmPerfCounter::BytesCopied, localStringLength * sizeof(wchar_t));
     return S_OK;
 }
 
@@ -59,6 +62,8 @@ static HRESULT BlobResultReleaseOwnershipBuffer(
     size_t sizeInBytes;
     RETURN_IF_FAILED(result.ReleaseContents(releasedBuffer, &sizeInBytes));
     *releasedBufferSizeInBytes = static_cast<UINT32>(sizeInBytes);
+
+    MrmPerfCounterSet::Increment(MrmPerfCounter::BytesCopied, sizeInBytes);
     return S_OK;
 }
 
@@ -152,6 +157,30 @@ static HRESULT GetQualifierInfoFromCandidate(
     return hr;
 }
 
+static HRESULT ResolveNamedResource(
+    _In_ const ProviderResolver* resolver,
+    _In_ const NamedResourceResult* namedResource,
+    _Out_ ResourceCandidateResult* resourceCandidate)
+{
+    DecisionResult decision;
+    RETURN_IF_FAILED(namedResource->GetDecision(&decision));
+
+    QualifierSetResult qualifierSet;
+    int resultIndex;
+    RETURN_IF_FAILED(resolver->EvaluateDecision(&decision, &resultIndex, &qualifierSet));
+
+    bool isMatch, isDefault, isMatchAsDefault;
+    RETURN_IF_FAILED(resolver->EvaluateQualifierSet(&qualifierSet, &isMatch, &isDefault, &isMatchAsDefault, nullptr));
+
+    if (!isMatch && !isDefault)
+    {
+        return HRESULT_FROM_WIN32(ERROR_MRM_NO_MATCH_OR_DEFAULT_CANDIDATE);
+    }
+
+    RETURN_IF_FAILED(namedResource->GetCandidate(resultIndex, resourceCandidate));
+    return S_OK;
+}
+
 static HRESULT LoadResourceCandidate(
     _In_ void* resourceManager,
     _In_opt_ void* resourceContext,
@@ -189,6 +218,9 @@ static HRESULT LoadResourceCandidate(
 
     MrmObjects* resourceManagerObjects = reinterpret_cast<MrmObjects*>(resourceManager);
 
+    MrmPerfCounterSet::Increment(MrmPerfCounter::Lookups);
+    MrmPerfCounterTimer resolutionTimer(MrmPerfCounter::PathResolutionTicks);
+
     ProviderResolver* resolver;
     if (resourceContext == nullptr)
     {
@@ -294,22 +326,7 @@ static HRESULT LoadResourceCandidate(
         }
     }
 
-    DecisionResult decision;
-    RETURN_IF_FAILED(namedResource.GetDecision(&decision));
-
-    QualifierSetResult qualifierSet;
-    int resultIndex;
-    RETURN_IF_FAILED(resolver->EvaluateDecision(&decision, &resultIndex, &qualifierSet));
-
-    bool isMatch, isDefault, isMatchAsDefault;
-    RETURN_IF_FAILED(resolver->EvaluateQualifierSet(&qualifierSet, &isMatch, &isDefault, &isMatchAsDefault, nullptr));
-
-    if (!isMatch && !isDefault)
-    {
-        return HRESULT_FROM_WIN32(ERROR_MRM_NO_MATCH_OR_DEFAULT_CANDIDATE);
-    }
-
-    RETURN_IF_FAILED(namedResource.GetCandidate(resultIndex, resourceCandidate));
+    RETURN_IF_FAILED(ResolveNamedResource(resolver, &namedResource, resourceCandidate));
 
     if ((qualifierCount != nullptr) && (qualifierNames != nullptr) && (qualifierValues != nullptr))
     {
@@ -335,6 +352,8 @@ static HRESULT LoadStringResource(
     _In_opt_ PCWSTR resourceIdOrUri,
     _Outptr_ PWSTR* resourceString)
 {
+    MrmPerfCounterScope perfCounterScope(reinterpret_cast<MrmObjects*>(resourceManager)->perfCounters);
+
     ResourceCandidateResult candidate;
     RETURN_IF_FAILED_WITH_EXPECTED(LoadResourceCandidate(resourceManager, resourceContext, resourceMap, index, resourceIdOrUri, &candidate, nullptr, nullptr, nullptr, nullptr),
         HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND));
@@ -359,6 +378,8 @@ static HRESULT LoadEmbeddedResource(
     _In_opt_ PCWSTR resourceIdOrUri,
     _Out_ MrmResourceData* data)
 {
+    MrmPerfCounterScope perfCounterScope(reinterpret_cast<MrmObjects*>(resourceManager)->perfCounters);
+
     data->data = nullptr;
     data->size = 0;
 
@@ -378,46 +399,19 @@ static HRESULT LoadEmbeddedResource(
     return S_OK;
 }
 
-static HRESULT LoadStringOrEmbeddedResource(
-    _In_ void* resourceManager,
-    _In_opt_ void* resourceContext,
-    _In_opt_ void* resourceMap,
-    int index,
-    _In_opt_ PCWSTR resourceIdOrUri,
+static HRESULT GetStringOrEmbeddedValue(
+    _In_ const ResourceCandidateResult* candidate,
     _Out_ MrmType* resourceType,
     _Outptr_result_maybenull_ PWSTR* resourceString,
-    _Out_ MrmResourceData* data,
-    _Outptr_opt_result_maybenull_ PWSTR* resourceName,
-    _Out_opt_ UINT32* qualifierCount,
-    _Outptr_opt_result_buffer_(*qualifierCount) PWSTR** qualifierNames,
-    _Outptr_opt_result_buffer_(*qualifierCount) PWSTR** qualifierValues)
+    _Out_ MrmResourceData* data)
 {
-    data->data = nullptr;
-    data->size = 0;
-
-    ResourceCandidateResult candidate;
-    PWSTR localName = nullptr;
-    RETURN_IF_FAILED_WITH_EXPECTED(LoadResourceCandidate(
-        resourceManager,
-        resourceContext,
-        resourceMap,
-        index,
-        resourceIdOrUri,
-        &candidate,
-        &localName,
-        qualifierCount,
-        qualifierNames,
-        qualifierValues),
-        HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND));
-    std::unique_ptr<wchar_t[], decltype(&MrmFreeResource)> name(localName, MrmFreeResource);
-
     MrmEnvironment::ResourceValueType internalResourceType;
-    RETURN_IF_FAILED(candidate.GetResourceValueType(&internalResourceType));
+    RETURN_IF_FAILED(candidate->GetResourceValueType(&internalResourceType));
 
     if (MrmEnvironment::IsBinaryResourceValueType(internalResourceType))
     {
         BlobResult blobResult;
-        if (!candidate.TryGetBlobValue(&blobResult))
+        if (!candidate->TryGetBlobValue(&blobResult))
         {
             return E_UNEXPECTED;
         }
@@ -431,7 +425,7 @@ static HRESULT LoadStringOrEmbeddedResource(
     else
     {
         StringResult stringResult;
-        if (!candidate.TryGetStringValue(&stringResult))
+        if (!candidate->TryGetStringValue(&stringResult))
         {
             return E_UNEXPECTED;
         }
@@ -453,6 +447,46 @@ static HRESULT LoadStringOrEmbeddedResource(
         }
     }
 
+    return S_OK;
+}
+
+static HRESULT LoadStringOrEmbeddedResource(
+    _In_ void* resourceManager,
+    _In_opt_ void* resourceContext,
+    _In_opt_ void* resourceMap,
+    int index,
+    _In_opt_ PCWSTR resourceIdOrUri,
+    _Out_ MrmType* resourceType,
+    _Outptr_result_maybenull_ PWSTR* resourceString,
+    _Out_ MrmResourceData* data,
+    _Outptr_opt_result_maybenull_ PWSTR* resourceName,
+    _Out_opt_ UINT32* qualifierCount,
+    _Outptr_opt_result_buffer_(*qualifierCount) PWSTR** qualifierNames,
+    _Outptr_opt_result_buffer_(*qualifierCount) PWSTR** qualifierValues)
+{
+    MrmPerfCounterScope perfCounterScope(reinterpret_cast<MrmObjects*>(resourceManager)->perfCounters);
+
+    data->data = nullptr;
+    data->size = 0;
+
+    ResourceCandidateResult candidate;
+    PWSTR localName = nullptr;
+    RETURN_IF_FAILED_WITH_EXPECTED(LoadResourceCandidate(
+        resourceManager,
+        resourceContext,
+        resourceMap,
+        index,
+        resourceIdOrUri,
+        &candidate,
+        &localName,
+        qualifierCount,
+        qualifierNames,
+        qualifierValues),
+        HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND));
+    std::unique_ptr<wchar_t[], decltype(&MrmFreeResource)> name(localName, MrmFreeResource);
+
+    RETURN_IF_FAILED(GetStringOrEmbeddedValue(&candidate, resourceType, resourceString, data));
+
     if (resourceName != nullptr)
     {
         *resourceName = name.release();
@@ -483,6 +517,12 @@ static void DestroyResourceManager(_In_ void* resourceManager)
         resourceManagerObjects->resolver = nullptr;
     }
 
+    if (resourceManagerObjects->perfCounters != nullptr)
+    {
+        delete resourceManagerObjects->perfCounters;
+        resourceManagerObjects->perfCounters = nullptr;
+    }
+
     delete resourceManagerObjects;
 
     return;
@@ -500,6 +540,12 @@ STDAPI MrmCreateResourceManager(_In_ PCWSTR priFileName, _Out_ MrmManagerHandle*
         new (std::nothrow) MrmObjects(), &DestroyResourceManager);
     RETURN_IF_NULL_ALLOC(resourceManagerObjects);
 
+    RETURN_IF_FAILED(MrmPerfCounterSet::CreateInstance(&resourceManagerObjects->perfCounters));
+
+    // Loading the PRI file faults in the sections every later lookup depends on. Count them even
+    // though counters start disabled, so they show up once the caller enables counters.
+    MrmPerfCounterScope perfCounterScope(resourceManagerObjects->perfCounters, true);
+
     RETURN_IF_FAILED(CoreProfile::ChooseDefaultProfile(&resourceManagerObjects->profile));
     RETURN_IF_FAILED(UnifiedResourceView::CreateInstance(resourceManagerObjects->profile, &resourceManagerObjects->unifiedView));
 
@@ -545,19 +591,33 @@ STDAPI_(void) MrmDestroyResourceManager(MrmManagerHandle resourceManager)
 
 STDAPI MrmCreateResourceContext(_In_ MrmManagerHandle resourceManager, _Out_ MrmContextHandle* resourceContext)
 {
+    return MrmCreateResourceContextEx(resourceManager, MrmResourceContextOptions_None, resourceContext);
+}
+
+STDAPI MrmCreateResourceContextEx(_In_ MrmManagerHandle resourceManager, UINT32 options, _Out_ MrmContextHandle* resourceContext)
+{
+    *resourceContext = nullptr;
+    RETURN_HR_IF(E_INVALIDARG, (options & ~MrmResourceContextOptions_ThreadLocalCache) != 0);
+
     MrmObjects* resourceManagerObjects = reinterpret_cast<MrmObjects*>(resourceManager);
+    MrmPerfCounterScope perfCounterScope(resourceManagerObjects->perfCounters);
 
     const IResourceMapBase* primaryMap;
     RETURN_IF_FAILED(resourceManagerObjects->priFile->GetPrimaryResourceMap(&primaryMap));
 
-    ProviderResolver* resolver;
+    AutoDeletePtr<ProviderResolver> resolver;
     RETURN_IF_FAILED(ProviderResolver::CreateInstance(
         resourceManagerObjects->profile,
         resourceManagerObjects->priFile->GetUnifiedEnvironment(),
         primaryMap->GetDecisionInfo(),
         &resolver));
 
-    *resourceContext = reinterpret_cast<MrmContextHandle>(resolver);
+    if ((options & MrmResourceContextOptions_ThreadLocalCache) != 0)
+    {
+        RETURN_IF_FAILED(resolver->EnableThreadLocalResolvers());
+    }
+
+    *resourceContext = reinterpret_cast<MrmContextHandle>(resolver.Detach());
     return S_OK;
 }
 
@@ -854,6 +914,156 @@ STDAPI MrmLoadStringOrEmbeddedResourceByIndexWithQualifierValues(
     return S_OK;
 }
 
+static HRESULT LoadStringOrEmbeddedResourcesByIndexRange(
+    _In_ void* resourceManager,
+    _In_opt_ void* resourceContext,
+    _In_opt_ void* resourceMap,
+    UINT32 startIndex,
+    UINT32 count,
+    _Out_writes_(count) MrmIndexedResource* resources)
+{
+    MrmObjects* resourceManagerObjects = reinterpret_cast<MrmObjects*>(resourceManager);
+    MrmPerfCounterScope perfCounterScope(resourceManagerObjects->perfCounters);
+
+    ProviderResolver* resolver;
+    if (resourceContext == nullptr)
+    {
+        resolver = resourceManagerObjects->resolver;
+    }
+    else
+    {
+        resolver = reinterpret_cast<ProviderResolver*>(resourceContext);
+    }
+
+    const ResourceMapSubtree* mapSubtree;
+    if (resourceMap == nullptr)
+    {
+        // The primary resource map is the default.
+        const IResourceMapBase* internalResourceMap;
+        RETURN_IF_FAILED(resourceManagerObjects->priFile->GetPrimaryResourceMap(&internalResourceMap));
+        mapSubtree = internalResourceMap->GetRootSubtree();
+    }
+    else
+    {
+        mapSubtree = reinterpret_cast<ResourceMapSubtree*>(resourceMap);
+    }
+
+    int numResources = mapSubtree->GetNumDescendentResources();
+    RETURN_HR_IF(
+        HRESULT_FROM_WIN32(ERROR_RANGE_NOT_FOUND),
+        (numResources < 0) || (startIndex > static_cast<UINT32>(numResources)) || (count > static_cast<UINT32>(numResources) - startIndex));
+
+    AutoDeletePtr<DescendentResourceEnumerator> enumerator;
+    RETURN_IF_FAILED(mapSubtree->CreateDescendentResourceEnumerator(&enumerator));
+    RETURN_IF_FAILED(enumerator->Skip(static_cast<int>(startIndex)));
+
+    for (UINT32 i = 0; i < count; i++)
+    {
+        MrmPerfCounterSet::Increment(MrmPerfCounter::Lookups);
+        MrmPerfCounterTimer resolutionTimer(MrmPerfCounter::PathResolutionTicks);
+
+        bool hasCurrent;
+        RETURN_IF_FAILED(enumerator->MoveNext(&hasCurrent));
+        RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_RANGE_NOT_FOUND), !hasCurrent);
+
+        MrmIndexedResource* resource = &resources[i];
+        resource->index = startIndex + i;
+
+        NamedResourceResult namedResource;
+        RETURN_IF_FAILED(enumerator->GetCurrentResource(&namedResource));
+
+        ResourceCandidateResult candidate;
+        RETURN_IF_FAILED(ResolveNamedResource(resolver, &namedResource, &candidate));
+        RETURN_IF_FAILED(GetStringOrEmbeddedValue(&candidate, &resource->resourceType, &resource->resourceString, &resource->data));
+
+        // The enumerator reuses its name buffer, so the caller gets a copy.
+        PCWSTR name = enumerator->GetCurrentName();
+        size_t nameSize = (wcslen(name) + 1) * sizeof(wchar_t);
+        resource->resourceName = reinterpret_cast<PWSTR>(MrmAllocateBuffer(nameSize));
+        RETURN_IF_NULL_ALLOC(resource->resourceName);
+        memcpy(resource->resourceName, name, nameSize);
+
+        MrmPerfCounterSet::Increment(MrmPerfCounter::BytesCopied, nameSize);
+    }
+
+    return S_OK;
+}
+
+STDAPI MrmLoadStringOrEmbeddedResourcesByIndexRange(
+    _In_ MrmManagerHandle resourceManager,
+    _In_opt_ MrmContextHandle resourceContext,
+    _In_opt_ MrmMapHandle resourceMap,
+    UINT32 startIndex,
+    UINT32 count,
+    _Out_writes_(count) MrmIndexedResource* resources)
+{
+    RETURN_HR_IF_NULL(E_INVALIDARG, resourceManager);
+    RETURN_HR_IF(E_INVALIDARG, (resources == nullptr) && (count > 0));
+
+    if (count > 0)
+    {
+        ZeroMemory(resources, count * sizeof(*resources));
+    }
+
+    HRESULT hr = LoadStringOrEmbeddedResourcesByIndexRange(resourceManager, resourceContext, resourceMap, startIndex, count, resources);
+    if (FAILED(hr))
+    {
+        MrmFreeIndexedResources(count, resources);
+    }
+    RETURN_IF_FAILED(hr);
+    return S_OK;
+}
+
+STDAPI_(void) MrmFreeIndexedResources(UINT32 count, _Inout_updates_(count) MrmIndexedResource* resources)
+{
+    if (resources == nullptr)
+    {
+        return;
+    }
+
+    for (UINT32 i = 0; i < count; i++)
+    {
+        MrmFreeResource(resources[i].resourceName);
+        MrmFreeResource(resources[i].resourceString);
+        MrmFreeResource(resources[i].data.data);
+        ZeroMemory(&resources[i], sizeof(resources[i]));
+    }
+}
+
+STDAPI MrmSetPerformanceCountersEnabled(_In_ MrmManagerHandle resourceManager, BOOL enabled)
+{
+    RETURN_HR_IF_NULL(E_INVALIDARG, resourceManager);
+
+    reinterpret_cast<MrmObjects*>(resourceManager)->perfCounters->SetEnabled(enabled != FALSE);
+    return S_OK;
+}
+
+STDAPI MrmGetPerformanceCounters(_In_ MrmManagerHandle resourceManager, _Out_ MrmPerformanceCounters* counters)
+{
+    RETURN_HR_IF_NULL(E_INVALIDARG, counters);
+    ZeroMemory(counters, sizeof(*counters));
+
+    RETURN_HR_IF_NULL(E_INVALIDARG, resourceManager);
+
+    UINT64 values[static_cast<UINT32>(MrmPerfCounter::Count)];
+    reinterpret_cast<MrmObjects*>(resourceManager)->perfCounters->Aggregate(values, ARRAYSIZE(values));
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+
+    counters->lookups = values[static_cast<UINT32>(MrmPerfCounter::Lookups)];
+    counters->pathResolutionTicks = values[static_cast<UINT32>(MrmPerfCounter::PathResolutionTicks)];
+    counters->ticksPerSecond = static_cast<UINT64>(frequency.QuadPart);
+    counters->decisionCacheHits = values[static_cast<UINT32>(MrmPerfCounter::DecisionCacheHits)];
+    counters->decisionCacheMisses = values[static_cast<UINT32>(MrmPerfCounter::DecisionCacheMisses)];
+    counters->qualifierEvaluations = values[static_cast<UINT32>(MrmPerfCounter::QualifierEvaluations)];
+    counters->bytesCopied = values[static_cast<UINT32>(MrmPerfCounter::BytesCopied)];
+    counters->sectionsFaultedIn = values[static_cast<UINT32>(MrmPerfCounter::SectionsFaultedIn)];
+    counters->stringAllocations = values[static_cast<UINT32>(MrmPerfCounter::StringAllocations)];
+
+    return S_OK;
+}
+
 STDAPI_(void*) MrmAllocateBuffer(size_t size) { return Def_Alloc(size); }
 
 STDAPI_(void) MrmFreeResource(_In_opt_ void* resource)
@@ -30,6 +30,17 @@ extern "C"
     STDAPI_(void) MrmDestroyResourceManager(_In_opt_ MrmManagerHandle resourceManager);
 
     STDAPI MrmCreateResourceContext(_In_ MrmManagerHandle resourceManager, _Out_ MrmContextHandle* resourceContext);
+
+    // Options for MrmCreateResourceContextEx. ThreadLocalCache gives each thread that loads
+    // resources with the context its own resolution cache, so lookups from many threads don't
+    // contend. Memory is bounded; threads beyond the limit share the context's own cache.
+    enum MrmResourceContextOptions
+    {
+        MrmResourceContextOptions_None = 0x0,
+        MrmResourceContextOptions_ThreadLocalCache = 0x1
+    };
+
+    STDAPI MrmCreateResourceContextEx(_In_ MrmManagerHandle resourceManager, UINT32 options, _Out_ MrmContextHandle* resourceContext);
     STDAPI_(void) MrmFreeQualifierNamesOrValues(UINT32 size, _In_reads_(size) PWSTR* names);
     STDAPI MrmGetAllQualifierNames(_In_ MrmContextHandle resourceContext, _Out_ UINT32* size, _Outptr_result_buffer_(*size) PWSTR** names);
     STDAPI MrmGetQualifier(_In_ MrmContextHandle resourceContext, _In_ PCWSTR qualifierName, _Outptr_ PWSTR* qualifierValue);
@@ -123,6 +134,50 @@ extern "C"
         _Outptr_result_buffer_(*qualifierCount) PWSTR** qualifierNames,
         _Outptr_result_buffer_(*qualifierCount) PWSTR** qualifierValues);
 
+    // One resource loaded by MrmLoadStringOrEmbeddedResourcesByIndexRange. The name, string and
+    // data are owned by the caller; MrmFreeIndexedResources frees them.
+    struct MrmIndexedResource
+    {
+        UINT32 index;
+        MrmType resourceType;
+        PWSTR resourceName;
+        PWSTR resourceString;
+        MrmResourceData data;
+    };
+
+    // Loads the resources at indexes [startIndex, startIndex + count), with the same results as calling
+    // MrmLoadStringOrEmbeddedResourceByIndex for each one. The names are built in a single pass over the
+    // resource map, which makes this much cheaper than per-index calls when enumerating a whole map.
+    STDAPI MrmLoadStringOrEmbeddedResourcesByIndexRange(
+        _In_ MrmManagerHandle resourceManager,
+        _In_opt_ MrmContextHandle resourceContext,
+        _In_opt_ MrmMapHandle resourceMap,
+        UINT32 startIndex,
+        UINT32 count,
+        _Out_writes_(count) MrmIndexedResource* resources);
+
+    STDAPI_(void) MrmFreeIndexedResources(UINT32 count, _Inout_updates_(count) MrmIndexedResource* resources);
+
+    // Opt-in diagnostics for a resource manager. Counters are collected per thread and summed
+    // when read, and only cover calls made while counters are enabled. The exception is
+    // MrmCreateResourceManager itself, which is always counted (before counters could have been
+    // enabled), so that sectionsFaultedIn includes the sections loaded when the PRI file is opened.
+    struct MrmPerformanceCounters
+    {
+        UINT64 lookups;
+        UINT64 pathResolutionTicks;
+        UINT64 ticksPerSecond;
+        UINT64 decisionCacheHits;
+        UINT64 decisionCacheMisses;
+        UINT64 qualifierEvaluations;
+        UINT64 bytesCopied;
+        UINT64 sectionsFaultedIn;
+        UINT64 stringAllocations;
+    };
+
+    STDAPI MrmSetPerformanceCountersEnabled(_In_ MrmManagerHandle resourceManager, BOOL enabled);
+    STDAPI MrmGetPerformanceCounters(_In_ MrmManagerHandle resourceManager, _Out_ MrmPerformanceCounters* counters);
+
     STDAPI_(void*) MrmAllocateBuffer(size_t size);
     STDAPI_(void) MrmFreeResource(_In_opt_ void* resource);
 
@@ -500,6 +500,73 @@ public:
         MrmDestroyResourceManager(resourceManager);
     }
 
+    TEST_METHOD(EnumerateResourceMapByIndexRange)
+    {
+        MrmManagerHandle resourceManager;
+        VERIFY_ARE_EQUAL(MrmCreateResourceManager(L".\\resources.pri", &resourceManager), S_OK);
+
+        MrmMapHandle childResourceMap;
+        VERIFY_ARE_EQUAL(MrmGetChildResourceMap(resourceManager, nullptr, L"Microsoft.UI.Xaml", &childResourceMap), S_OK);
+
+        MrmMapHandle childChildResourceMap;
+        VERIFY_ARE_EQUAL(MrmGetChildResourceMap(resourceManager, childResourceMap, L"Resources", &childChildResourceMap), S_OK);
+
+        UINT32 count;
+        VERIFY_ARE_EQUAL(MrmGetResourceCount(resourceManager, childChildResourceMap, &count), S_OK);
+        VERIFY_ARE_EQUAL(count, 78u);
+
+        // The whole map in one call must match the per-index results.
+        MrmIndexedResource resources[78] {};
+        VERIFY_ARE_EQUAL(MrmLoadStringOrEmbeddedResourcesByIndexRange(resourceManager, nullptr, childChildResourceMap, 0, count, resources), S_OK);
+
+        MrmType resourceType;
+        wchar_t* resourceString = nullptr;
+        wchar_t* resourceName = nullptr;
+        MrmResourceData resourceData {};
+        for (UINT32 i = 0; i < count; i++)
+        {
+            VERIFY_ARE_EQUAL(MrmLoadStringOrEmbeddedResourceByIndex(resourceManager, nullptr, childChildResourceMap, i, &resourceType, &resourceName, &resourceString, &resourceData), S_OK);
+
+            VERIFY_ARE_EQUAL(resources[i].index, i);
+            VERIFY_IS_TRUE(resources[i].resourceType == resourceType);
+            VerifyStringEqual(resources[i].resourceName, resourceName);
+            VerifyStringEqual(resources[i].resourceString, resourceString);
+
+            MrmFreeResource(resourceString);
+            MrmFreeResource(resourceName);
+            resourceString = nullptr;
+            resourceName = nullptr;
+        }
+
+        MrmFreeIndexedResources(count, resources);
+        VERIFY_IS_NULL(resources[0].resourceName);
+
+        // A range starting part way through skips to the right item.
+        VERIFY_ARE_EQUAL(MrmLoadStringOrEmbeddedResourcesByIndexRange(resourceManager, nullptr, childChildResourceMap, 76, 2, resources), S_OK);
+        VERIFY_ARE_EQUAL(resources[0].index, 76u);
+        VERIFY_ARE_EQUAL(resources[1].index, 77u);
+        VerifyStringEqual(resources[1].resourceName, L"ValueStringValueSliderWithoutColorName");
+        VerifyStringEqual(resources[1].resourceString, L"%1!u!");
+        MrmFreeIndexedResources(2, resources);
+
+        // A range running past the end fails without returning anything.
+        VERIFY_ARE_EQUAL(MrmLoadStringOrEmbeddedResourcesByIndexRange(resourceManager, nullptr, childChildResourceMap, 77, 2, resources), HRESULT_FROM_WIN32(ERROR_RANGE_NOT_FOUND));
+        VERIFY_IS_NULL(resources[0].resourceName);
+
+        // Embedded data comes back the same way.
+        VERIFY_ARE_EQUAL(MrmGetChildResourceMap(resourceManager, nullptr, L"Files", &childResourceMap), S_OK);
+        VERIFY_ARE_EQUAL(MrmGetChildResourceMap(resourceManager, childResourceMap, L"Controls", &childChildResourceMap), S_OK);
+        VERIFY_ARE_EQUAL(MrmLoadStringOrEmbeddedResourcesByIndexRange(resourceManager, nullptr, childChildResourceMap, 27, 1, resources), S_OK);
+        VERIFY_IS_TRUE(resources[0].resourceType == MrmType_Embedded);
+        VerifyStringEqual(resources[0].resourceName, L"TrackMetadataEditDialog.xbf");
+        VERIFY_IS_NULL(resources[0].resourceString);
+        VERIFY_IS_NOT_NULL(resources[0].data.data);
+        VERIFY_IS_TRUE(resources[0].data.size != 0);
+        MrmFreeIndexedResources(1, resources);
+
+        MrmDestroyResourceManager(resourceManager);
+    }
+
     TEST_METHOD(ReadResourceStringWithQualifierValue)
     {
         MrmManagerHandle resourceManager;
@@ -616,7 +683,170 @@ public:
         MrmFreeResource(path);
     }
 
+    TEST_METHOD(PerformanceCounters)
+    {
+        MrmManagerHandle resourceManager;
+        VERIFY_ARE_EQUAL(MrmCreateResourceManager(L".\\resources.pri", &resourceManager), S_OK);
+
+        // Counters are off by default.
+        wchar_t* resourceString;
+        VERIFY_ARE_EQUAL(MrmLoadStringResource(resourceManager, nullptr, nullptr, L"resources/IDS_MANIFEST_MUSIC_APP_NAME", &resourceString), S_OK);
+        MrmFreeResource(resourceString);
+
+        MrmPerformanceCounters counters;
+        VERIFY_ARE_EQUAL(MrmGetPerformanceCounters(resourceManager, &counters), S_OK);
+        VERIFY_ARE_EQUAL(counters.lookups, 0ull);
+        VERIFY_ARE_EQUAL(counters.bytesCopied, 0ull);
+
+        // Except for the sections loaded while creating the manager, which are always counted.
+        VERIFY_IS_GREATER_THAN(counters.sectionsFaultedIn, 0ull);
+        VERIFY_ARE_EQUAL(counters.stringAllocations, 0ull);
+
+        VERIFY_ARE_EQUAL(MrmSetPerformanceCountersEnabled(resourceManager, TRUE), S_OK);
+
+        // The first lookup after creating the manager populated the decision cache, so these are hits.
+        for (int i = 0; i < 3; i++)
+        {
+            VERIFY_ARE_EQUAL(MrmLoadStringResource(resourceManager, nullptr, nullptr, L"resources/IDS_MANIFEST_MUSIC_APP_NAME", &resourceString), S_OK);
+            MrmFreeResource(resourceString);
+        }
+
+        MrmResourceData resourceData {};
+        VERIFY_ARE_EQUAL(MrmLoadEmbeddedResource(resourceManager, nullptr, nullptr, L"Files/Controls/AlbumBasicInfoControl.xbf", &resourceData), S_OK);
+        VERIFY_ARE_EQUAL(resourceData.size, 15002u);
+        MrmFreeResource(resourceData.data);
+
+        VERIFY_ARE_EQUAL(MrmGetPerformanceCounters(resourceManager, &counters), S_OK);
+        VERIFY_ARE_EQUAL(counters.lookups, 4ull);
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(counters.decisionCacheHits, 3ull);
+        VERIFY_IS_GREATER_THAN(counters.ticksPerSecond, 0ull);
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(counters.bytesCopied, (3ull * wcslen(L"Groove Music") * sizeof(wchar_t)) + 15002ull);
+
+        VERIFY_ARE_EQUAL(MrmSetPerformanceCountersEnabled(resourceManager, FALSE), S_OK);
+        VERIFY_ARE_EQUAL(MrmLoadStringResource(resourceManager, nullptr, nullptr, L"resources/IDS_MANIFEST_MUSIC_APP_NAME", &resourceString), S_OK);
+        MrmFreeResource(resourceString);
+
+        MrmPerformanceCounters countersAfterDisable;
+        VERIFY_ARE_EQUAL(MrmGetPerformanceCounters(resourceManager, &countersAfterDisable), S_OK);
+        VERIFY_ARE_EQUAL(countersAfterDisable.lookups, counters.lookups);
+
+        MrmDestroyResourceManager(resourceManager);
+    }
+
+    TEST_METHOD(ThreadLocalResourceContext)
+    {
+        MrmManagerHandle resourceManager;
+        VERIFY_ARE_EQUAL(MrmCreateResourceManager(L".\\resources.pri", &resourceManager), S_OK);
+
+        MrmContextHandle resourceContext;
+        VERIFY_ARE_EQUAL(MrmCreateResourceContextEx(resourceManager, 0x80000000, &resourceContext), E_INVALIDARG);
+        VERIFY_ARE_EQUAL(MrmCreateResourceContextEx(resourceManager, MrmResourceContextOptions_ThreadLocalCache, &resourceContext), S_OK);
+
+        ThreadLookupParams params = { resourceManager, resourceContext, 100, 0 };
+        HANDLE threads[8];
+        for (int i = 0; i < ARRAYSIZE(threads); i++)
+        {
+            threads[i] = CreateThread(nullptr, 0, ThreadLookupProc, &params, 0, nullptr);
+            VERIFY_IS_NOT_NULL(threads[i]);
+        }
+
+        VERIFY_ARE_EQUAL(WaitForMultipleObjects(ARRAYSIZE(threads), threads, TRUE, INFINITE), WAIT_OBJECT_0);
+        for (int i = 0; i < ARRAYSIZE(threads); i++)
+        {
+            CloseHandle(threads[i]);
+        }
+        VERIFY_ARE_EQUAL(static_cast<LONG>(params.failures), 0L);
+
+        // Changing a qualifier has to be seen by the per-thread caches.
+        wchar_t* resourceString;
+        VERIFY_ARE_EQUAL(MrmSetQualifier(resourceContext, L"Language", L"en-US"), S_OK);
+        VERIFY_ARE_EQUAL(MrmLoadStringResource(resourceManager, resourceContext, nullptr, L"resources/IDS_WHATS_NEW_1710_2_EQUALIZER_TITLE", &resourceString), S_OK);
+        VerifyStringEqual(resourceString, L"Equalizer");
+        MrmFreeResource(resourceString);
+
+        VERIFY_ARE_EQUAL(MrmSetQualifier(resourceContext, L"Language", L"en-GB"), S_OK);
+        VERIFY_ARE_EQUAL(MrmLoadStringResource(resourceManager, resourceContext, nullptr, L"resources/IDS_WHATS_NEW_1710_2_EQUALIZER_TITLE", &resourceString), S_OK);
+        VerifyStringEqual(resourceString, L"Equaliser");
+        MrmFreeResource(resourceString);
+
+        MrmDestroyResourceContext(resourceContext);
+        MrmDestroyResourceManager(resourceManager);
+    }
+
+    TEST_METHOD(ThreadLocalResourceContextCacheHits)
+    {
+        MrmManagerHandle resourceManager;
+        VERIFY_ARE_EQUAL(MrmCreateResourceManager(L".\\resources.pri", &resourceManager), S_OK);
+
+        MrmContextHandle resourceContext;
+        VERIFY_ARE_EQUAL(MrmCreateResourceContextEx(resourceManager, MrmResourceContextOptions_ThreadLocalCache, &resourceContext), S_OK);
+        VERIFY_ARE_EQUAL(MrmSetPerformanceCountersEnabled(resourceManager, TRUE), S_OK);
+
+        // The first lookup on this thread fills its own cache.
+        wchar_t* resourceString;
+        VERIFY_ARE_EQUAL(MrmLoadStringResource(resourceManager, resourceContext, nullptr, L"resources/IDS_MANIFEST_MUSIC_APP_NAME", &resourceString), S_OK);
+        MrmFreeResource(resourceString);
+
+        MrmPerformanceCounters cold;
+        VERIFY_ARE_EQUAL(MrmGetPerformanceCounters(resourceManager, &cold), S_OK);
+        VERIFY_IS_GREATER_THAN(cold.decisionCacheMisses, 0ull);
+
+        // The second one is served from it.
+        VERIFY_ARE_EQUAL(MrmLoadStringResource(resourceManager, resourceContext, nullptr, L"resources/IDS_MANIFEST_MUSIC_APP_NAME", &resourceString), S_OK);
+        MrmFreeResource(resourceString);
+
+        MrmPerformanceCounters warm;
+        VERIFY_ARE_EQUAL(MrmGetPerformanceCounters(resourceManager, &warm), S_OK);
+        VERIFY_ARE_EQUAL(warm.decisionCacheMisses, cold.decisionCacheMisses);
+        VERIFY_IS_GREATER_THAN(warm.decisionCacheHits, cold.decisionCacheHits);
+
+        // Another thread starts with a cache of its own (too small a cache for a snapshot to have been
+        // published), so it misses the same decisions again. A shared cache would have hit them.
+        ThreadLookupParams params = { resourceManager, resourceContext, 1, 0 };
+        HANDLE thread = CreateThread(nullptr, 0, ThreadLookupProc, &params, 0, nullptr);
+        VERIFY_IS_NOT_NULL(thread);
+        VERIFY_ARE_EQUAL(WaitForSingleObject(thread, INFINITE), WAIT_OBJECT_0);
+        CloseHandle(thread);
+        VERIFY_ARE_EQUAL(static_cast<LONG>(params.failures), 0L);
+
+        MrmPerformanceCounters otherThread;
+        VERIFY_ARE_EQUAL(MrmGetPerformanceCounters(resourceManager, &otherThread), S_OK);
+        VERIFY_ARE_EQUAL(otherThread.decisionCacheMisses, 2 * cold.decisionCacheMisses);
+
+        MrmDestroyResourceContext(resourceContext);
+        MrmDestroyResourceManager(resourceManager);
+    }
+
 private:
+    struct ThreadLookupParams
+    {
+        MrmManagerHandle resourceManager;
+        MrmContextHandle resourceContext;
+        int lookups;
+        volatile LONG failures;
+    };
+
+    static DWORD WINAPI ThreadLookupProc(_In_ void* context)
+    {
+        ThreadLookupParams* params = static_cast<ThreadLookupParams*>(context);
+        for (int i = 0; i < params->lookups; i++)
+        {
+            wchar_t* resourceString;
+            if (FAILED(MrmLoadStringResource(params->resourceManager, params->resourceContext, nullptr, L"resources/IDS_MANIFEST_MUSIC_APP_NAME", &resourceString)))
+            {
+                InterlockedIncrement(&params->failures);
+                continue;
+            }
+
+            if (wcscmp(resourceString, L"Groove Music") != 0)
+            {
+                InterlockedIncrement(&params->failures);
+            }
+            MrmFreeResource(resourceString);
+        }
+        return 0;
+    }
+
     void VerifyQualifierValue(UINT32 qualifierCount, PWSTR* qualifierNames, PWSTR* qualifierValues, PCWSTR name, PCWSTR expectedValue)
     {
         VERIFY_IS_GREATER_THAN(qualifierCount, 0u);
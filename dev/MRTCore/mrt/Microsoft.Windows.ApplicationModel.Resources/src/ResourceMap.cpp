@@ -166,51 +166,30 @@ Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate ResourceMap::
     return GetValueImpl(&context, resource, true);
 }
 
-IKeyValuePair<hstring, Resources::ResourceCandidate> ResourceMap::GetValueByIndexImpl(
-    const Resources::ResourceContext* context,
-    uint32_t index)
+IKeyValuePair<hstring, Resources::ResourceCandidate> ResourceMap::MakeValueByIndex(
+    Resources::ResourceContext const& resourceContext,
+    uint32_t index,
+    MrmType resourceType,
+    PCWSTR resourceName,
+    PCWSTR resourceString,
+    MrmResourceData const& resourceData)
 {
-    // Always use a context as we override the languages.
-    Microsoft::Windows::ApplicationModel::Resources::ResourceContext resourceContext =
-        (context != nullptr) ? *context : m_resourceManager.CreateResourceContext();
-
-    resourceContext.as<Resources::implementation::ResourceContext>()->Apply();
-
-    MrmType resourceType;
-    wchar_t* resourceName;
-    wchar_t* resourceString;
-    MrmResourceData resourceData {};
-
-    winrt::check_hresult(MrmLoadStringOrEmbeddedResourceByIndex(
-        m_resourceManagerHandle,
-        resourceContext.as<Resources::implementation::ResourceContext>()->GetContextHandle(),
-        m_resourceMapHandle,
-        index,
-        &resourceType,
-        &resourceName,
-        &resourceString,
-        &resourceData));
-
-    string_resoure_ptr resourceNameContainter(resourceName);
-
     switch (resourceType)
     {
     case MrmType_Embedded:
     {
-        embedded_resoure_ptr resourceContainer(resourceData.data);
         Resources::ResourceCandidate candidate = winrt::make<ResourceCandidate>(
             m_resourceManagerHandle,
             resourceContext,
             m_resourceMapHandle,
             index,
             hstring(),
-            winrt::array_view<uint8_t>(reinterpret_cast<byte*>(resourceContainer.get()), reinterpret_cast<byte*>(resourceContainer.get()) + resourceData.size));
+            winrt::array_view<uint8_t>(reinterpret_cast<byte*>(resourceData.data), reinterpret_cast<byte*>(resourceData.data) + resourceData.size));
 
         return winrt::make<winrt::impl::key_value_pair<IKeyValuePair<hstring, Resources::ResourceCandidate>>>(resourceName, candidate);
     }
     case MrmType_String:
     {
-        string_resoure_ptr resourceContainer(resourceString);
         Resources::ResourceCandidate candidate =
             winrt::make<ResourceCandidate>(
                 m_resourceManagerHandle,
@@ -219,13 +198,12 @@ IKeyValuePair<hstring, Resources::ResourceCandidate> ResourceMap::GetValueByInde
                 index,
                 hstring(),
                 ResourceCandidateKind::String, 
-                winrt::to_hstring(resourceContainer.get()));
+                winrt::to_hstring(resourceString));
 
         return winrt::make<winrt::impl::key_value_pair<IKeyValuePair<hstring, Resources::ResourceCandidate>>>(resourceName, candidate);
     }
     case MrmType_Path:
     {
-        string_resoure_ptr resourceContainer(resourceString);
         Resources::ResourceCandidate candidate =
             winrt::make<ResourceCandidate>(
                 m_resourceManagerHandle,
@@ -234,7 +212,7 @@ IKeyValuePair<hstring, Resources::ResourceCandidate> ResourceMap::GetValueByInde
                 index,
                 hstring(),
                 ResourceCandidateKind::FilePath, 
-                winrt::to_hstring(resourceContainer.get()));
+                winrt::to_hstring(resourceString));
 
         return winrt::make<winrt::impl::key_value_pair<
             winrt::Windows::Foundation::Collections::IKeyValuePair<hstring, Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate>>>(
@@ -245,6 +223,76 @@ IKeyValuePair<hstring, Resources::ResourceCandidate> ResourceMap::GetValueByInde
     winrt::throw_hresult(E_UNEXPECTED);
 }
 
+IKeyValuePair<hstring, Resources::ResourceCandidate> ResourceMap::GetValueByIndexImpl(
+    const Resources::ResourceContext* context,
+    uint32_t index)
+{
+    // Always use a context as we override the languages.
+    Microsoft::Windows::ApplicationModel::Resources::ResourceContext resourceContext =
+        (context != nullptr) ? *context : m_resourceManager.CreateResourceContext();
+
+    resourceContext.as<Resources::implementation::ResourceContext>()->Apply();
+
+    MrmType resourceType;
+    wchar_t* resourceName;
+    wchar_t* resourceString;
+    MrmResourceData resourceData {};
+
+    winrt::check_hresult(MrmLoadStringOrEmbeddedResourceByIndex(
+        m_resourceManagerHandle,
+        resourceContext.as<Resources::implementation::ResourceContext>()->GetContextHandle(),
+        m_resourceMapHandle,
+        index,
+        &resourceType,
+        &resourceName,
+        &resourceString,
+        &resourceData));
+
+    string_resoure_ptr resourceNameContainter(resourceName);
+    string_resoure_ptr resourceStringContainer(resourceString);
+    embedded_resoure_ptr resourceDataContainer(resourceData.data);
+
+    return MakeValueByIndex(resourceContext, index, resourceType, resourceName, resourceString, resourceData);
+}
+
+IVectorView<IKeyValuePair<hstring, Resources::ResourceCandidate>> ResourceMap::GetValuesByIndexRangeImpl(
+    const Resources::ResourceContext* context,
+    uint32_t startIndex,
+    uint32_t count)
+{
+    std::vector<IKeyValuePair<hstring, Resources::ResourceCandidate>> values;
+    if (count == 0)
+    {
+        return winrt::single_threaded_vector(std::move(values)).GetView();
+    }
+
+    // Always use a context as we override the languages.
+    Microsoft::Windows::ApplicationModel::Resources::ResourceContext resourceContext =
+        (context != nullptr) ? *context : m_resourceManager.CreateResourceContext();
+
+    resourceContext.as<Resources::implementation::ResourceContext>()->Apply();
+
+    // One call loads the whole range, so the map is walked once rather than once per resource.
+    std::vector<MrmIndexedResource> resources(count);
+    winrt::check_hresult(MrmLoadStringOrEmbeddedResourcesByIndexRange(
+        m_resourceManagerHandle,
+        resourceContext.as<Resources::implementation::ResourceContext>()->GetContextHandle(),
+        m_resourceMapHandle,
+        startIndex,
+        count,
+        resources.data()));
+    indexed_resources_ptr resourcesContainer(resources.data(), IndexedResourcesFreer{ count });
+
+    values.reserve(count);
+    for (const MrmIndexedResource& resource : resources)
+    {
+        values.push_back(MakeValueByIndex(
+            resourceContext, resource.index, resource.resourceType, resource.resourceName, resource.resourceString, resource.data));
+    }
+
+    return winrt::single_threaded_vector(std::move(values)).GetView();
+}
+
 IKeyValuePair<hstring, Resources::ResourceCandidate> ResourceMap::GetValueByIndex(uint32_t index)
 {
     return GetValueByIndexImpl(nullptr, index);
@@ -254,4 +302,17 @@ IKeyValuePair<hstring, Resources::ResourceCandidate> ResourceMap::GetValueByInde
 {
     return GetValueByIndexImpl(&context, index);
 }
+
+IVectorView<IKeyValuePair<hstring, Resources::ResourceCandidate>> ResourceMap::GetValuesByIndexRange(uint32_t startIndex, uint32_t count)
+{
+    return GetValuesByIndexRangeImpl(nullptr, startIndex, count);
+}
+
+IVectorView<IKeyValuePair<hstring, Resources::ResourceCandidate>> ResourceMap::GetValuesByIndexRange(
+    uint32_t startIndex,
+    uint32_t count,
+    Resources::ResourceContext const& context)
+{
+    return GetValuesByIndexRangeImpl(&context, startIndex, count);
+}
 } // namespace winrt::Microsoft::Windows::ApplicationModel::Resources::implementation
@@ -38,6 +38,14 @@ struct ResourceMap : ResourceMapT<ResourceMap>
         uint32_t index,
         Microsoft::Windows::ApplicationModel::Resources::ResourceContext const& context);
 
+    winrt::Windows::Foundation::Collections::IVectorView<
+        winrt::Windows::Foundation::Collections::IKeyValuePair<hstring, Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate>>
+    GetValuesByIndexRange(uint32_t startIndex, uint32_t count);
+
+    winrt::Windows::Foundation::Collections::IVectorView<
+        winrt::Windows::Foundation::Collections::IKeyValuePair<hstring, Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate>>
+    GetValuesByIndexRange(uint32_t startIndex, uint32_t count, Microsoft::Windows::ApplicationModel::Resources::ResourceContext const& context);
+
     Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate TryGetValue(hstring const& resource);
     Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate TryGetValue(hstring const& resource, Microsoft::Windows::ApplicationModel::Resources::ResourceContext const& context);
 
@@ -53,6 +61,21 @@ private:
         const Microsoft::Windows::ApplicationModel::Resources::ResourceContext* context,
         uint32_t index);
 
+    winrt::Windows::Foundation::Collections::IVectorView<
+        winrt::Windows::Foundation::Collections::IKeyValuePair<hstring, Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate>>
+    GetValuesByIndexRangeImpl(
+        const Microsoft::Windows::ApplicationModel::Resources::ResourceContext* context,
+        uint32_t startIndex,
+        uint32_t count);
+
+    winrt::Windows::Foundation::Collections::IKeyValuePair<hstring, Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate> MakeValueByIndex(
+        Microsoft::Windows::ApplicationModel::Resources::ResourceContext const& resourceContext,
+        uint32_t index,
+        MrmType resourceType,
+        PCWSTR resourceName,
+        PCWSTR resourceString,
+        MrmResourceData const& resourceData);
+
     Microsoft::Windows::ApplicationModel::Resources::ResourceManager m_resourceManager = nullptr;
     MrmManagerHandle m_resourceManagerHandle = nullptr;
     MrmMapHandle m_resourceMapHandle = nullptr;
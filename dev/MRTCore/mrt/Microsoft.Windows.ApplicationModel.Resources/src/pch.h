@@ -17,5 +17,12 @@ struct EmbeddedResourceFreer
     void operator()(void* resource) { MrmFreeResource(resource); }
 };
 
+struct IndexedResourcesFreer
+{
+    UINT32 count;
+    void operator()(MrmIndexedResource* resources) { MrmFreeIndexedResources(count, resources); }
+};
+
 using string_resoure_ptr = std::unique_ptr<wchar_t, StringResourceFreer>;
 using embedded_resoure_ptr = std::unique_ptr<void, EmbeddedResourceFreer>;
+using indexed_resources_ptr = std::unique_ptr<MrmIndexedResource, IndexedResourcesFreer>;
@@ -0,0 +1,574 @@
+// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "StdAfx.h"
+#include <psapi.h>
+#include "Helpers.h"
+#include "TestFileUtils.h"
+#include "mrm/build/Base.h"
+
+#include "mrm/readers/MrmReaders.h"
+#include "mrm/readers/MrmManagers.h"
+#include "mrm/build/MrmBuilders.h"
+
+#include "..\..\Core\src\MRM.h"
+
+#include "wil/resource.h"
+
+#include <WindowsAppRuntime.Test.Benchmark.h>
+
+#include <string>
+#include <vector>
+
+using namespace WEX::Common;
+using namespace WEX::TestExecution;
+using namespace WEX::Logging;
+
+using namespace Microsoft::Resources;
+using namespace Microsoft::Resources::Build;
+
+namespace TB = ::Test::Benchmark;
+
+// Throughput and latency benchmarks for PRI generation, PRI open and resource lookup.
+//
+// The suite builds one synthetic PRI per run. Its shape and the amount of work done are
+// controlled with TAEF runtime parameters, for example:
+//
+//   te MrmBenchmarks.dll /p:Resources=20000 /p:Languages=8 /p:Scales=4 /p:Depth=3 /p:Threads=8
+//
+//   Resources       Number of named string resources (default 2000).
+//   Languages       Number of language candidates per resource, at most 16 (default 4).
+//   Scales          Number of scale candidates per resource, at most 7 (default 3).
+//   Depth           Number of folder levels above each resource name (default 2).
+//   Lookups         Lookups per thread in each lookup benchmark (default 200000).
+//   Threads         Highest thread count for the multi-threaded benchmark (default: number of processors, at most 16).
+//   WarmOpens       Number of open/close cycles averaged for the warm open time (default 20).
+//   BenchmarkResults  Path of the results file (default: <output>\MrmBenchmarks\MrmBenchmarks.json).
+//
+// Every measurement is written as one JSON object per line so results can be collected and
+// compared across releases. Each record carries the PRI shape it was measured against.
+
+namespace UnitTests
+{
+
+static PCWSTR const c_benchmarkLanguages[] = {L"en-US",
+                                              L"fr-FR",
+                                              L"de-DE",
+                                              L"ja-JP",
+                                              L"es-ES",
+                                              L"it-IT",
+                                              L"ko-KR",
+                                              L"zh-CN",
+                                              L"pt-BR",
+                                              L"ru-RU",
+                                              L"nl-NL",
+                                              L"sv-SE",
+                                              L"pl-PL",
+                                              L"tr-TR",
+                                              L"ar-SA",
+                                              L"he-IL"};
+
+static PCWSTR const c_benchmarkScales[] = {L"100", L"125", L"150", L"200", L"250", L"300", L"400"};
+
+static const int c_languagePriority = 700;
+static const int c_scalePriority = 500;
+static const UINT32 c_folderFanout = 10;
+static const UINT32 c_maxBenchmarkThreads = 16;
+
+struct SyntheticPriShape
+{
+    UINT32 numResources;
+    UINT32 numLanguages;
+    UINT32 numScales;
+    UINT32 depth;
+};
+
+// Resource names are spread over a tree of folders, c_folderFanout wide at each level, so deeper
+// shapes exercise the hierarchical name lookup rather than one flat scope.
+static void GetSyntheticResourceName(_In_ UINT32 index, _In_ UINT32 depth, _Inout_ std::wstring& name)
+{
+    name = L"Resources/";
+
+    UINT32 remaining = index;
+    for (UINT32 level = 0; level < depth; level++)
+    {
+        name += L"Folder";
+        name += std::to_wstring(remaining % c_folderFanout);
+        name += L"/";
+        remaining /= c_folderFanout;
+    }
+
+    name += L"String";
+    name += std::to_wstring(index);
+}
+
+static HRESULT BuildSyntheticPri(
+    _In_ CoreProfile* profile,
+    _In_ const SyntheticPriShape& shape,
+    _In_ const std::vector<std::wstring>& names,
+    _In_ PCWSTR priPath)
+{
+    AutoDeletePtr<PriFileBuilder> priBuilder;
+    RETURN_IF_FAILED(PriFileBuilder::CreateInstance(profile, &priBuilder));
+
+    PriSectionBuilder* sectionBuilder = priBuilder->GetDescriptor();
+
+    AutoDeletePtr<DecisionInfoQualifierSetBuilder> qualifierSetBuilder;
+    RETURN_IF_FAILED(sectionBuilder->GetQualifierSetBuilder(&qualifierSetBuilder));
+
+    WCHAR value[128];
+    for (UINT32 i = 0; i < shape.numResources; i++)
+    {
+        for (UINT32 language = 0; language < shape.numLanguages; language++)
+        {
+            for (UINT32 scale = 0; scale < shape.numScales; scale++)
+            {
+                // The first language and scale are the defaults, so every resource resolves
+                // whatever the language and scale of the machine running the benchmark.
+                qualifierSetBuilder->Reset();
+                RETURN_IF_FAILED(qualifierSetBuilder->AddQualifier(
+                    CoreEnvironment::Qualifier_Language, c_benchmarkLanguages[language], c_languagePriority, (language == 0) ? 1.0 : 0.0));
+                RETURN_IF_FAILED(qualifierSetBuilder->AddQualifier(
+                    CoreEnvironment::Qualifier_Scale, c_benchmarkScales[scale], c_scalePriority, (scale == 0) ? 1.0 : 0.0));
+
+                RETURN_IF_FAILED(StringCchPrintfW(
+                    value, ARRAYSIZE(value), L"String %u (%s, scale-%s)", i, c_benchmarkLanguages[language], c_benchmarkScales[scale]));
+
+                RETURN_IF_FAILED(sectionBuilder->AddCandidateWithString(
+                    nullptr, names[i].c_str(), MrmEnvironment::ResourceValueType_Utf16String, value, qualifierSetBuilder));
+            }
+        }
+    }
+
+    return priBuilder->WriteToFile(priPath);
+}
+
+// Visits resources in a scrambled but reproducible order so lookups do not simply walk the
+// name tables front to back.
+static UINT32 NextLookupIndex(_Inout_ UINT32* state, _In_ UINT32 count)
+{
+    *state = (*state * 1664525) + 1013904223;
+    return (*state >> 8) % count;
+}
+
+static HRESULT RunStringResourceLookups(
+    _In_ MrmManagerHandle manager,
+    _In_opt_ MrmContextHandle context,
+    _In_ const std::vector<std::wstring>& names,
+    _In_ UINT32 numLookups,
+    _In_ UINT32 seed)
+{
+    UINT32 state = seed;
+    for (UINT32 i = 0; i < numLookups; i++)
+    {
+        const std::wstring& name = names[NextLookupIndex(&state, static_cast<UINT32>(names.size()))];
+
+        PWSTR value;
+        RETURN_IF_FAILED(MrmLoadStringResource(manager, context, nullptr, name.c_str(), &value));
+        MrmFreeResource(value);
+    }
+
+    return S_OK;
+}
+
+struct LookupThreadContext
+{
+    MrmManagerHandle manager;
+    const std::vector<std::wstring>* names;
+    UINT32 numLookups;
+    UINT32 seed;
+    HANDLE startEvent;
+    HRESULT hr;
+};
+
+static DWORD WINAPI LookupThreadProc(_In_ LPVOID parameter)
+{
+    LookupThreadContext* context = reinterpret_cast<LookupThreadContext*>(parameter);
+
+    // All threads are released together so that the measured interval covers contended lookups only.
+    WaitForSingleObject(context->startEvent, INFINITE);
+    context->hr = RunStringResourceLookups(context->manager, nullptr, *context->names, context->numLookups, context->seed);
+    return 0;
+}
+
+class MrmBenchmarks : public WEX::TestClass<MrmBenchmarks>, public FileBasedTest
+{
+public:
+    TEST_CLASS(MrmBenchmarks);
+
+    TEST_CLASS_SETUP(ClassSetup);
+    TEST_CLASS_CLEANUP(ClassCleanup);
+
+    TEST_METHOD(OpenBenchmark);
+    TEST_METHOD(ResourceMapLookupBenchmark);
+    TEST_METHOD(LoadStringResourceBenchmark);
+    TEST_METHOD(MultiThreadedLoadStringResourceBenchmark);
+    TEST_METHOD(AllocationsPerLookupBenchmark);
+    TEST_METHOD(MemoryFootprintBenchmark);
+
+    MrmBenchmarks() : m_results(INVALID_HANDLE_VALUE) {}
+
+private:
+    SyntheticPriShape m_shape;
+    UINT32 m_numLookups;
+    UINT32 m_maxThreads;
+    UINT32 m_numWarmOpens;
+
+    std::vector<std::wstring> m_names;
+    String m_priPath;
+    HANDLE m_results;
+
+    void Report(_In_ PCWSTR benchmark, _In_ PCWSTR metric, _In_ double value, _In_ PCWSTR unit, _In_ UINT32 threads = 1);
+};
+
+bool MrmBenchmarks::ClassSetup()
+{
+    if (!SetupClassFolders(L"MrmBenchmarks"))
+    {
+        Log::Error(L"Unable to set up output folder for MrmBenchmarks");
+        return false;
+    }
+
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+
+    m_shape.numResources = TB::GetUIntParameter(L"Resources", 2000, 1, 10000000);
+    m_shape.numLanguages = TB::GetUIntParameter(L"Languages", 4, 1, ARRAYSIZE(c_benchmarkLanguages));
+    m_shape.numScales = TB::GetUIntParameter(L"Scales", 3, 1, ARRAYSIZE(c_benchmarkScales));
+    m_shape.depth = TB::GetUIntParameter(L"Depth", 2, 0, 8);
+    m_numLookups = TB::GetUIntParameter(L"Lookups", 200000, 1, MAXUINT32);
+    m_maxThreads = TB::GetUIntParameter(L"Threads", systemInfo.dwNumberOfProcessors, 1, c_maxBenchmarkThreads);
+    m_numWarmOpens = TB::GetUIntParameter(L"WarmOpens", 20, 1, 10000);
+
+    String resultsPath;
+    if (FAILED(RuntimeParameters::TryGetValue(L"BenchmarkResults", resultsPath)) || resultsPath.IsEmpty())
+    {
+        GetOutputFilePath(L"MrmBenchmarks.json", resultsPath);
+    }
+
+    // Results are appended so that repeated runs with different shapes land in one file.
+    m_results = CreateFileW(static_cast<PCWSTR>(resultsPath), FILE_APPEND_DATA, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_results == INVALID_HANDLE_VALUE)
+    {
+        Log::Error(String().Format(L"Unable to open benchmark results file %s (%d)", static_cast<PCWSTR>(resultsPath), GetLastError()));
+        return false;
+    }
+    Log::Comment(String().Format(L"[ Writing benchmark results to %s ]", static_cast<PCWSTR>(resultsPath)));
+
+    m_names.resize(m_shape.numResources);
+    for (UINT32 i = 0; i < m_shape.numResources; i++)
+    {
+        GetSyntheticResourceName(i, m_shape.depth, m_names[i]);
+    }
+
+    GetOutputFilePath(L"synthetic.pri", m_priPath);
+
+    AutoDeletePtr<CoreProfile> profile;
+    if (FAILED(CoreProfile::ChooseDefaultProfile(&profile)))
+    {
+        Log::Error(L"Unable to choose default profile");
+        return false;
+    }
+
+    TB::Stopwatch stopwatch;
+    HRESULT hr = BuildSyntheticPri(profile, m_shape, m_names, static_cast<PCWSTR>(m_priPath));
+    double buildTime = stopwatch.ElapsedMilliseconds();
+
+    if (FAILED(hr))
+    {
+        Log::Error(String().Format(L"Unable to build synthetic PRI %s (0x%08x)", static_cast<PCWSTR>(m_priPath), hr));
+        return false;
+    }
+
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExW(static_cast<PCWSTR>(m_priPath), GetFileExInfoStandard, &attributes))
+    {
+        Log::Error(L"Unable to query synthetic PRI size");
+        return false;
+    }
+
+    Report(L"PriFileBuilder", L"buildTime", buildTime, L"ms");
+    Report(L"PriFileBuilder", L"fileSize", static_cast<double>(attributes.nFileSizeLow), L"bytes");
+    return true;
+}
+
+bool MrmBenchmarks::ClassCleanup()
+{
+    if (m_results != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_results);
+        m_results = INVALID_HANDLE_VALUE;
+    }
+
+    DeleteFileW(static_cast<PCWSTR>(m_priPath));
+    return true;
+}
+
+void MrmBenchmarks::Report(_In_ PCWSTR benchmark, _In_ PCWSTR metric, _In_ double value, _In_ PCWSTR unit, _In_ UINT32 threads)
+{
+    WCHAR line[512];
+    VERIFY_SUCCEEDED(StringCchPrintfW(
+        line,
+        ARRAYSIZE(line),
+        L"{\"suite\":\"MrmBenchmarks\",\"benchmark\":\"%s\",\"metric\":\"%s\",\"value\":%.3f,\"unit\":\"%s\",\"threads\":%u,"
+        L"\"resources\":%u,\"languages\":%u,\"scales\":%u,\"depth\":%u}",
+        benchmark,
+        metric,
+        value,
+        unit,
+        threads,
+        m_shape.numResources,
+        m_shape.numLanguages,
+        m_shape.numScales,
+        m_shape.depth));
+
+    Log::Comment(line);
+
+    // The line is plain ASCII apart from the caller-supplied names, so UTF-8 is a straight conversion.
+    char utf8Line[1024];
+    int cbLine = WideCharToMultiByte(CP_UTF8, 0, line, -1, utf8Line, ARRAYSIZE(utf8Line) - 1, nullptr, nullptr);
+    VERIFY_IS_TRUE(cbLine > 0);
+
+    // cbLine includes the terminating null, which is replaced by the line break.
+    utf8Line[cbLine - 1] = '\n';
+
+    DWORD cbWritten;
+    VERIFY_WIN32_BOOL_SUCCEEDED(WriteFile(m_results, utf8Line, static_cast<DWORD>(cbLine), &cbWritten, nullptr));
+}
+
+void MrmBenchmarks::OpenBenchmark()
+{
+    // "Cold" is the first open of the file in this process. The file was just written, so it is
+    // most likely still in the system cache; the number tracks MRM's own start-up cost rather
+    // than disk latency.
+    TB::Stopwatch stopwatch;
+
+    MrmManagerHandle manager;
+    VERIFY_SUCCEEDED(MrmCreateResourceManager(static_cast<PCWSTR>(m_priPath), &manager));
+
+    PWSTR value;
+    VERIFY_SUCCEEDED(MrmLoadStringResource(manager, nullptr, nullptr, m_names[0].c_str(), &value));
+    MrmFreeResource(value);
+    MrmDestroyResourceManager(manager);
+
+    Report(L"Open", L"coldOpenAndFirstLookup", stopwatch.ElapsedMilliseconds(), L"ms");
+
+    double totalOpen = 0.0;
+    double totalFirstLookup = 0.0;
+    for (UINT32 i = 0; i < m_numWarmOpens; i++)
+    {
+        stopwatch.Restart();
+        VERIFY_SUCCEEDED(MrmCreateResourceManager(static_cast<PCWSTR>(m_priPath), &manager));
+        totalOpen += stopwatch.ElapsedMilliseconds();
+
+        stopwatch.Restart();
+        VERIFY_SUCCEEDED(MrmLoadStringResource(manager, nullptr, nullptr, m_names[i % m_names.size()].c_str(), &value));
+        totalFirstLookup += stopwatch.ElapsedMilliseconds();
+
+        MrmFreeResource(value);
+        MrmDestroyResourceManager(manager);
+    }
+
+    Report(L"Open", L"warmOpen", totalOpen / m_numWarmOpens, L"ms");
+    Report(L"Open", L"warmFirstLookup", totalFirstLookup / m_numWarmOpens, L"ms");
+}
+
+void MrmBenchmarks::ResourceMapLookupBenchmark()
+{
+    // Resolves through the reader and resolver classes directly, without the copies the flat C
+    // API makes, to separate lookup cost from marshaling cost.
+    AutoDeletePtr<CoreProfile> profile;
+    VERIFY_SUCCEEDED(CoreProfile::ChooseDefaultProfile(&profile));
+
+    AutoDeletePtr<UnifiedResourceView> unifiedView;
+    VERIFY_SUCCEEDED(UnifiedResourceView::CreateInstance(profile, &unifiedView));
+
+    const PriFile* priFile;
+    VERIFY_SUCCEEDED(unifiedView->SetApplicationPriFile(static_cast<PCWSTR>(m_priPath), nullptr, &priFile));
+
+    const IResourceMapBase* primaryMap;
+    VERIFY_SUCCEEDED(priFile->GetPrimaryResourceMap(&primaryMap));
+
+    AutoDeletePtr<ProviderResolver> resolver;
+    VERIFY_SUCCEEDED(ProviderResolver::CreateInstance(profile, priFile->GetUnifiedEnvironment(), primaryMap->GetDecisionInfo(), &resolver));
+
+    UINT32 state = 1;
+    UINT32 numFailures = 0;
+
+    TB::Stopwatch stopwatch;
+
+    for (UINT32 i = 0; i < m_numLookups; i++)
+    {
+        const std::wstring& name = m_names[NextLookupIndex(&state, static_cast<UINT32>(m_names.size()))];
+
+        NamedResourceResult namedResource;
+        DecisionResult decision;
+        QualifierSetResult qualifierSet;
+        ResourceCandidateResult candidate;
+        StringResult stringValue;
+        int candidateIndex;
+
+        if (FAILED(primaryMap->GetResource(name.c_str(), &namedResource)) || FAILED(namedResource.GetDecision(&decision)) ||
+            FAILED(resolver->EvaluateDecision(&decision, &candidateIndex, &qualifierSet)) ||
+            FAILED(namedResource.GetCandidate(candidateIndex, &candidate)) || !candidate.TryGetStringValue(&stringValue))
+        {
+            numFailures++;
+        }
+    }
+
+    double elapsed = stopwatch.ElapsedMilliseconds();
+    VERIFY_ARE_EQUAL(0u, numFailures);
+
+    Report(L"ResourceMapLookup", L"lookupsPerSecond", (m_numLookups * 1000.0) / elapsed, L"ops/s");
+    Report(L"ResourceMapLookup", L"meanLatency", (elapsed * 1000.0) / m_numLookups, L"us");
+}
+
+void MrmBenchmarks::LoadStringResourceBenchmark()
+{
+    MrmManagerHandle manager;
+    VERIFY_SUCCEEDED(MrmCreateResourceManager(static_cast<PCWSTR>(m_priPath), &manager));
+    auto destroyManager = wil::scope_exit([&] { MrmDestroyResourceManager(manager); });
+
+    // One untimed pass so the measured run is not dominated by first-touch costs, which
+    // OpenBenchmark reports separately.
+    VERIFY_SUCCEEDED(RunStringResourceLookups(manager, nullptr, m_names, static_cast<UINT32>(m_names.size()), 1));
+
+    TB::Stopwatch stopwatch;
+    VERIFY_SUCCEEDED(RunStringResourceLookups(manager, nullptr, m_names, m_numLookups, 1));
+    double elapsed = stopwatch.ElapsedMilliseconds();
+
+    Report(L"MrmLoadStringResource", L"lookupsPerSecond", (m_numLookups * 1000.0) / elapsed, L"ops/s");
+    Report(L"MrmLoadStringResource", L"meanLatency", (elapsed * 1000.0) / m_numLookups, L"us");
+
+    // A second, shorter run with the manager's counters enabled shows where the time goes.
+    // It is kept separate so that counting does not skew the throughput numbers above.
+    UINT32 numCountedLookups = min(m_numLookups, static_cast<UINT32>(m_names.size()));
+    VERIFY_SUCCEEDED(MrmSetPerformanceCountersEnabled(manager, TRUE));
+    VERIFY_SUCCEEDED(RunStringResourceLookups(manager, nullptr, m_names, numCountedLookups, 2));
+    VERIFY_SUCCEEDED(MrmSetPerformanceCountersEnabled(manager, FALSE));
+
+    MrmPerformanceCounters counters;
+    VERIFY_SUCCEEDED(MrmGetPerformanceCounters(manager, &counters));
+
+    Report(L"MrmLoadStringResource", L"decisionCacheHitRate",
+        (counters.decisionCacheHits * 100.0) / max(1ull, counters.decisionCacheHits + counters.decisionCacheMisses), L"percent");
+    Report(L"MrmLoadStringResource", L"bytesCopiedPerLookup", static_cast<double>(counters.bytesCopied) / numCountedLookups, L"bytes");
+    Report(L"MrmLoadStringResource", L"resolutionTimePerLookup",
+        (counters.ticksPerSecond != 0) ? (counters.pathResolutionTicks * 1000000.0) / counters.ticksPerSecond / numCountedLookups : 0.0,
+        L"us");
+}
+
+void MrmBenchmarks::MultiThreadedLoadStringResourceBenchmark()
+{
+    MrmManagerHandle manager;
+    VERIFY_SUCCEEDED(MrmCreateResourceManager(static_cast<PCWSTR>(m_priPath), &manager));
+    auto destroyManager = wil::scope_exit([&] { MrmDestroyResourceManager(manager); });
+
+    VERIFY_SUCCEEDED(RunStringResourceLookups(manager, nullptr, m_names, static_cast<UINT32>(m_names.size()), 1));
+
+    // Threads share the manager's default context, which is how most callers use the API and
+    // is where contention on the resolver caches shows up.
+    // Thread counts double from 1 up to, and always including, the configured maximum.
+    UINT32 numThreads = 1;
+    while (true)
+    {
+        wil::unique_event startEvent;
+        startEvent.create(wil::EventOptions::ManualReset);
+
+        LookupThreadContext contexts[c_maxBenchmarkThreads];
+        wil::unique_handle threads[c_maxBenchmarkThreads];
+
+        for (UINT32 i = 0; i < numThreads; i++)
+        {
+            contexts[i] = {manager, &m_names, m_numLookups, i + 1, startEvent.get(), E_PENDING};
+            threads[i].reset(CreateThread(nullptr, 0, LookupThreadProc, &contexts[i], 0, nullptr));
+            VERIFY_IS_NOT_NULL(threads[i].get());
+        }
+
+        HANDLE threadHandles[c_maxBenchmarkThreads];
+        for (UINT32 i = 0; i < numThreads; i++)
+        {
+            threadHandles[i] = threads[i].get();
+        }
+
+        TB::Stopwatch stopwatch;
+        startEvent.SetEvent();
+        VERIFY_ARE_EQUAL(WAIT_OBJECT_0, WaitForMultipleObjects(numThreads, threadHandles, TRUE, INFINITE));
+        double elapsed = stopwatch.ElapsedMilliseconds();
+
+        for (UINT32 i = 0; i < numThreads; i++)
+        {
+            VERIFY_SUCCEEDED(contexts[i].hr);
+        }
+
+        Report(L"MrmLoadStringResourceMultiThreaded", L"lookupsPerSecond", (static_cast<double>(m_numLookups) * numThreads * 1000.0) / elapsed, L"ops/s", numThreads);
+
+        if (numThreads == m_maxThreads)
+        {
+            break;
+        }
+        numThreads = min(numThreads * 2, m_maxThreads);
+    }
+}
+
+void MrmBenchmarks::AllocationsPerLookupBenchmark()
+{
+    MrmManagerHandle manager;
+    VERIFY_SUCCEEDED(MrmCreateResourceManager(static_cast<PCWSTR>(m_priPath), &manager));
+    auto destroyManager = wil::scope_exit([&] { MrmDestroyResourceManager(manager); });
+
+    // Counts the internal string buffers allocated while resolving, not the copy returned to
+    // the caller. The cold pass includes filling the qualifier and decision caches; the warm
+    // pass is the steady state that the lookup paths are tuned for.
+    UINT32 numLookups = static_cast<UINT32>(m_names.size());
+    VERIFY_SUCCEEDED(MrmSetPerformanceCountersEnabled(manager, TRUE));
+
+    MrmPerformanceCounters cold;
+    VERIFY_SUCCEEDED(RunStringResourceLookups(manager, nullptr, m_names, numLookups, 1));
+    VERIFY_SUCCEEDED(MrmGetPerformanceCounters(manager, &cold));
+
+    MrmPerformanceCounters warm;
+    VERIFY_SUCCEEDED(RunStringResourceLookups(manager, nullptr, m_names, numLookups, 2));
+    VERIFY_SUCCEEDED(MrmGetPerformanceCounters(manager, &warm));
+
+    VERIFY_SUCCEEDED(MrmSetPerformanceCountersEnabled(manager, FALSE));
+
+    Report(L"AllocationsPerLookup", L"coldStringAllocationsPerLookup", static_cast<double>(cold.stringAllocations) / numLookups, L"allocs");
+    Report(
+        L"AllocationsPerLookup",
+        L"warmStringAllocationsPerLookup",
+        static_cast<double>(warm.stringAllocations - cold.stringAllocations) / numLookups,
+        L"allocs");
+}
+
+void MrmBenchmarks::MemoryFootprintBenchmark()
+{
+    PROCESS_MEMORY_COUNTERS_EX before, opened, touched;
+    VERIFY_WIN32_BOOL_SUCCEEDED(
+        GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PPROCESS_MEMORY_COUNTERS>(&before), sizeof(before)));
+
+    MrmManagerHandle manager;
+    VERIFY_SUCCEEDED(MrmCreateResourceManager(static_cast<PCWSTR>(m_priPath), &manager));
+    auto destroyManager = wil::scope_exit([&] { MrmDestroyResourceManager(manager); });
+
+    VERIFY_WIN32_BOOL_SUCCEEDED(
+        GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PPROCESS_MEMORY_COUNTERS>(&opened), sizeof(opened)));
+
+    // Touch every resource once so that all sections are faulted in and every decision is cached.
+    for (const std::wstring& name : m_names)
+    {
+        PWSTR value;
+        VERIFY_SUCCEEDED(MrmLoadStringResource(manager, nullptr, nullptr, name.c_str(), &value));
+        MrmFreeResource(value);
+    }
+
+    VERIFY_WIN32_BOOL_SUCCEEDED(
+        GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PPROCESS_MEMORY_COUNTERS>(&touched), sizeof(touched)));
+
+    Report(L"MemoryFootprint", L"privateBytesAfterOpen", static_cast<double>(opened.PrivateUsage) - before.PrivateUsage, L"bytes");
+    Report(L"MemoryFootprint", L"privateBytesAfterFullLookup", static_cast<double>(touched.PrivateUsage) - before.PrivateUsage, L"bytes");
+    Report(L"MemoryFootprint", L"workingSetAfterOpen", static_cast<double>(opened.WorkingSetSize) - before.WorkingSetSize, L"bytes");
+    Report(L"MemoryFootprint", L"workingSetAfterFullLookup", static_cast<double>(touched.WorkingSetSize) - before.WorkingSetSize, L"bytes");
+}
+
+} // namespace UnitTests
@@ -716,4 +716,118 @@ void StringResult_Buffer::Copy(void)
     delete pCopy;
 }
 
+class StringResult_Inline : public WEX::TestClass<StringResult_Inline>, public StringResult_Struct
+{
+    TEST_CLASS(StringResult_Inline);
+
+    TEST_METHOD(SetCopy);
+    TEST_METHOD(SetEmptyContents);
+    TEST_METHOD(GetWritableRef);
+    TEST_METHOD(ReleaseContents);
+    TEST_METHOD(SetContentsFromOther);
+};
+
+void StringResult_Inline::SetCopy(void)
+{
+    StringResultWithBuffer<8> result;
+
+    // Fits, so no heap buffer is allocated.
+    VERIFY_SUCCEEDED(result.SetCopy(shortStr));
+    VERIFY(result.GetType() == DefResultType_Buffer);
+    VERIFY(result.GetRef() != shortStr);
+    VERIFY_ARE_EQUAL(0, wcscmp(result.GetRef(), shortStr));
+    CHECK_STRINGRESULT_BUF_EMPTY(&result);
+
+    // Copying from our own contents is fine.
+    VERIFY_SUCCEEDED(result.SetCopy(result.GetRef() + 1));
+    VERIFY_ARE_EQUAL(0, wcscmp(result.GetRef(), L"ye!"));
+
+    // Doesn't fit, so it falls back to a heap buffer.
+    VERIFY_SUCCEEDED(result.SetCopy(longStr));
+    CHECK_STRINGRESULT_BUF(&result, longStr);
+
+    // And back again.
+    VERIFY_SUCCEEDED(result.SetCopy(medStr));
+    VERIFY(result.GetRef() != result.GetStringResult()->pBuf);
+    VERIFY_ARE_EQUAL(0, wcscmp(result.GetRef(), medStr));
+    VERIFY(result.GetType() == DefResultType_Buffer);
+
+    VERIFY_SUCCEEDED(result.SetCopy(NULL));
+    VERIFY_IS_NULL(result.GetRef());
+}
+
+void StringResult_Inline::SetEmptyContents(void)
+{
+    StringResultWithBuffer<8> result;
+    PWSTR pBuf = NULL;
+    size_t cchBuf = 0;
+
+    VERIFY_SUCCEEDED(result.SetEmptyContents(shortLen + 1, &pBuf, &cchBuf));
+    VERIFY_ARE_EQUAL(static_cast<size_t>(8), cchBuf);
+    VERIFY_ARE_EQUAL(L'\0', pBuf[0]);
+    VERIFY_ARE_EQUAL(static_cast<PCWSTR>(pBuf), result.GetRef());
+    CHECK_STRINGRESULT_BUF_EMPTY(&result);
+
+    VERIFY_SUCCEEDED(result.SetEmptyContents(longLen + 1, &pBuf, &cchBuf));
+    VERIFY_IS_TRUE(cchBuf >= longLen + 1);
+    VERIFY_ARE_EQUAL(static_cast<PCWSTR>(pBuf), static_cast<PCWSTR>(result.GetStringResult()->pBuf));
+}
+
+void StringResult_Inline::GetWritableRef(void)
+{
+    StringResultWithBuffer<8> result;
+    PWSTR pBuf = NULL;
+    size_t cchBuf = 0;
+
+    // A short reference becomes writable without a heap buffer.
+    VERIFY_SUCCEEDED(result.SetRef(shortStr));
+    VERIFY_SUCCEEDED(result.GetWritableRef(&pBuf, &cchBuf));
+    VERIFY(pBuf != shortStr);
+    VERIFY_ARE_EQUAL(0, wcscmp(pBuf, shortStr));
+    VERIFY_ARE_EQUAL(static_cast<size_t>(8), cchBuf);
+    CHECK_STRINGRESULT_BUF_EMPTY(&result);
+
+    // A long one still needs the heap.
+    VERIFY_SUCCEEDED(result.SetRef(longStr));
+    VERIFY_SUCCEEDED(result.GetWritableRef(&pBuf, &cchBuf));
+    CHECK_STRINGRESULT_BUF(&result, longStr);
+}
+
+void StringResult_Inline::ReleaseContents(void)
+{
+    StringResultWithBuffer<8> result;
+    PWSTR pBuf = NULL;
+    size_t cchBuf = 0;
+
+    VERIFY_SUCCEEDED(result.SetCopy(shortStr));
+    VERIFY_SUCCEEDED(result.ReleaseContents(&pBuf, &cchBuf));
+
+    // The caller owns what comes back, so it can't be the inline buffer.
+    VERIFY_IS_NOT_NULL(pBuf);
+    VERIFY(pBuf != result.GetRef());
+    VERIFY_ARE_EQUAL(0, wcscmp(pBuf, shortStr));
+    CHECK_STRINGRESULT_EMPTY(&result);
+
+    Def_Free(pBuf);
+}
+
+void StringResult_Inline::SetContentsFromOther(void)
+{
+    StringResult result;
+    PCWSTR pOtherRef;
+
+    {
+        StringResultWithBuffer<8> other;
+        VERIFY_SUCCEEDED(other.SetCopy(shortStr));
+        pOtherRef = other.GetRef();
+
+        VERIFY_SUCCEEDED(result.SetContentsFromOther(&other));
+        VERIFY_IS_NULL(other.GetRef());
+    }
+
+    // Our contents must not refer to the other result's storage.
+    VERIFY(result.GetRef() != pOtherRef);
+    CHECK_STRINGRESULT_BUF(&result, shortStr);
+}
+
 } // namespace UnitTests
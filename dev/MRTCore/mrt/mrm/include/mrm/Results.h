@@ -14,6 +14,16 @@ protected:
     DEFSTRINGRESULT* m_pString;
     DEFSTRINGRESULT m_string;
 
+    // Optional storage inside the owning object for short strings. See StringResultWithBuffer.
+    PWSTR m_pInlineBuffer;
+    UINT32 m_cchInlineBuffer;
+
+    StringResult(_Inout_updates_(cchInlineBuffer) PWSTR pInlineBuffer, _In_ UINT32 cchInlineBuffer);
+
+    // Inline storage only applies while we own the string, not after Init(DEFSTRINGRESULT*).
+    bool HasInlineBuffer() const { return (m_pInlineBuffer != nullptr) && (m_pString == &m_string); }
+    bool IsInline() const { return HasInlineBuffer() && (m_string.pRef == m_pInlineBuffer); }
+
 public:
     HRESULT Init(_In_opt_ PCWSTR initialString, _In_ DEFRESULTTYPE type);
 
@@ -144,6 +154,26 @@ public:
     bool Contains(_In_ PCWSTR str) const;
 };
 
+// A StringResult with room for a short string inside the object itself. SetCopy, SetEmptyContents
+// and GetWritableRef use that room when the string fits, so temporaries on lookup paths don't
+// have to allocate. The string still reports DefResultType_Buffer, and ReleaseContents always
+// hands back a heap buffer that the caller owns.
+//
+// Anything that refers to the contents (GetRef, or SetRef on another result) is only valid for
+// the lifetime of this object, exactly as with a heap buffer.
+template<UINT32 InlineChars = 64>
+class StringResultWithBuffer : public StringResult
+{
+public:
+    StringResultWithBuffer() : StringResult(m_inlineBuffer, InlineChars) { m_inlineBuffer[0] = L'\0'; }
+
+    StringResultWithBuffer(const StringResultWithBuffer&) = delete;
+    StringResultWithBuffer& operator=(const StringResultWithBuffer&) = delete;
+
+private:
+    WCHAR m_inlineBuffer[InlineChars];
+};
+
 class BlobResult : public DefObject
 {
 private:
@@ -0,0 +1,130 @@
+// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#pragma once
+
+namespace Microsoft::Resources
+{
+
+enum class MrmPerfCounter : UINT32
+{
+    Lookups,
+    PathResolutionTicks,
+    DecisionCacheHits,
+    DecisionCacheMisses,
+    QualifierEvaluations,
+    BytesCopied,
+    SectionsFaultedIn,
+    StringAllocations,
+    Count
+};
+
+// One block per thread per counter set. Only the owning thread writes to a block, so
+// updates need no interlocked add, but every read and write of a value is a single 64-bit
+// access so readers on other threads never see a torn value on 32-bit x86. Blocks are
+// cache aligned (and so padded to a whole number of lines) so that two threads never
+// share a cache line.
+typedef struct DECLSPEC_CACHEALIGN _MrmPerfCounterBlock
+{
+    volatile LONG64 values[static_cast<UINT32>(MrmPerfCounter::Count)];
+    struct _MrmPerfCounterBlock* pNext;
+    DWORD threadId;
+} MrmPerfCounterBlock;
+
+// Opt-in performance counters owned by a resource manager.
+//
+// Counting is attributed through a thread-local "current block" which is installed by
+// MrmPerfCounterScope at the API boundary. Code deeper in the stack (resolvers, files)
+// calls MrmPerfCounterSet::Increment, which is a single thread-local read and null check
+// when counters are disabled or no scope is active.
+//
+// Blocks are only ever added, never removed, while the set is alive. Reads walk the list
+// and sum every block; values are best effort and may be slightly stale.
+class MrmPerfCounterSet : public DefObject
+{
+public:
+    static HRESULT CreateInstance(_Outptr_ MrmPerfCounterSet** result);
+
+    ~MrmPerfCounterSet();
+
+    bool IsEnabled() const { return (m_enabled != 0); }
+
+    void SetEnabled(_In_ bool enabled) { InterlockedExchange(&m_enabled, enabled ? 1 : 0); }
+
+    HRESULT GetThreadBlock(_Outptr_ MrmPerfCounterBlock** result);
+
+    void Aggregate(_Out_writes_(numValues) UINT64* values, _In_ UINT32 numValues) const;
+
+    static void Increment(_In_ MrmPerfCounter counter, _In_ UINT64 value = 1)
+    {
+        MrmPerfCounterBlock* block = s_pCurrentBlock;
+        if (block != nullptr)
+        {
+            volatile LONG64* target = &block->values[static_cast<UINT32>(counter)];
+            WriteNoFence64(target, ReadNoFence64(target) + static_cast<LONG64>(value));
+        }
+    }
+
+    static bool IsCounting() { return (s_pCurrentBlock != nullptr); }
+
+private:
+    friend class MrmPerfCounterScope;
+
+    MrmPerfCounterSet() : m_id(0), m_enabled(0), m_pBlocks(nullptr) {}
+
+    UINT64 m_id;
+    volatile LONG m_enabled;
+    MrmPerfCounterBlock* volatile m_pBlocks;
+
+    static thread_local MrmPerfCounterBlock* s_pCurrentBlock;
+};
+
+// Installs the calling thread's counter block for the lifetime of the scope. Scopes nest;
+// the previous block is restored on exit. A null set installs nothing, and neither does a
+// disabled one unless countWhenDisabled is set (used while creating a resource manager,
+// before anyone could have enabled its counters).
+class MrmPerfCounterScope
+{
+public:
+    MrmPerfCounterScope(_In_opt_ MrmPerfCounterSet* set, _In_ bool countWhenDisabled = false);
+    ~MrmPerfCounterScope() { MrmPerfCounterSet::s_pCurrentBlock = m_pPrevious; }
+
+    MrmPerfCounterScope(const MrmPerfCounterScope&) = delete;
+    MrmPerfCounterScope& operator=(const MrmPerfCounterScope&) = delete;
+
+private:
+    MrmPerfCounterBlock* m_pPrevious;
+};
+
+// Adds the elapsed QueryPerformanceCounter ticks to a counter when the scope exits.
+class MrmPerfCounterTimer
+{
+public:
+    MrmPerfCounterTimer(_In_ MrmPerfCounter counter) : m_counter(counter)
+    {
+        m_start.QuadPart = 0;
+        if (MrmPerfCounterSet::IsCounting())
+        {
+            QueryPerformanceCounter(&m_start);
+        }
+    }
+
+    ~MrmPerfCounterTimer()
+    {
+        if ((m_start.QuadPart != 0) && MrmPerfCounterSet::IsCounting())
+        {
+            LARGE_INTEGER end;
+            QueryPerformanceCounter(&end);
+            MrmPerfCounterSet::Increment(m_counter, static_cast<UINT64>(end.QuadPart - m_start.QuadPart));
+        }
+    }
+
+    MrmPerfCounterTimer(const MrmPerfCounterTimer&) = delete;
+    MrmPerfCounterTimer& operator=(const MrmPerfCounterTimer&) = delete;
+
+private:
+    MrmPerfCounter m_counter;
+    LARGE_INTEGER m_start;
+};
+
+} // namespace Microsoft::Resources
@@ -10,6 +10,8 @@
 namespace Microsoft::Resources
 {
 
+class HierarchicalNames;
+
 class HierarchicalNamesConfig
 {
 public:
@@ -191,6 +193,8 @@ public:
         _Out_opt_ int* pNumItemsWritten) const;
 
 private:
+    friend class HierarchicalNamesItemEnumerator;
+
     bool m_largeNode;
     DEFFILE_HNAMES_HEADER_EX m_header;
     const DEFFILE_HNAMES_HEADER_EX* m_pHeader;
@@ -305,4 +309,64 @@ private:
     }
 };
 
+// Visits every item below a scope in a single depth-first walk, in the same order as
+// HierarchicalNames::GetDescendents. Names are relative to the starting scope and are
+// built in one buffer that is reused for the whole walk, so each scope name is copied
+// once per visit rather than once per item beneath it.
+class HierarchicalNamesItemEnumerator : public DefObject
+{
+public:
+    static HRESULT CreateInstance(_In_ const HierarchicalNames* pNames, _In_ int scopeIndex, _Outptr_ HierarchicalNamesItemEnumerator** result);
+
+    ~HierarchicalNamesItemEnumerator();
+
+    // Moves to the next item. *pbHasCurrent is false once every item has been visited.
+    HRESULT MoveNext(_Out_ bool* pbHasCurrent);
+
+    // Moves past up to numToSkip items without building their names. The enumerator is
+    // left before the next item, so call MoveNext to read it.
+    HRESULT Skip(_In_ int numToSkip, _Out_ int* pNumSkipped);
+
+    // Zero-based position of the current item among the scope's descendents.
+    int GetCurrentPosition() const { return m_position; }
+
+    int GetCurrentItemIndex() const { return m_currentItemIndex; }
+
+    // Only valid until the next call to MoveNext or Skip.
+    PCWSTR GetCurrentName() const { return (m_currentItemIndex >= 0) ? m_pPath : nullptr; }
+    size_t GetCurrentNameLength() const { return m_cchCurrentName; }
+
+private:
+    struct ScopeFrame
+    {
+        int firstChildNode;
+        int numChildren;
+        int nextChild;
+        int cchPrefix;
+    };
+
+    const HierarchicalNames* m_pNames;
+
+    _Field_size_(m_maxDepth) ScopeFrame* m_pFrames;
+    int m_maxDepth;
+    int m_depth;
+
+    _Field_size_(m_cchPath) PWSTR m_pPath;
+    int m_cchPath;
+    size_t m_cchCurrentName;
+
+    int m_position;
+    int m_currentItemIndex;
+
+    HierarchicalNamesItemEnumerator(_In_ const HierarchicalNames* pNames);
+
+    HRESULT Init(_In_ int scopeIndex);
+
+    HRESULT PushScope(_In_ int scopeIndex, _In_ int cchPrefix);
+
+    HRESULT AppendSegment(_In_ const DEFFILE_HNAMES_NODE_LARGE* pNode, _In_ int cchPrefix, _Out_ int* pcchPathOut);
+
+    HRESULT Advance(_In_ bool bBuildName, _Out_ bool* pbFound);
+};
+
 } // namespace Microsoft::Resources
@@ -654,6 +654,11 @@ public:
             scopeIndex, sizeScopes, pScopesOut, pNumScopesWritten, sizeItems, pItemsOut, pNumItemsWritten);
     }
 
+    HRESULT CreateItemEnumerator(_In_ int scopeIndex, _Outptr_ HierarchicalNamesItemEnumerator** result) const
+    {
+        return m_pCurrentSchema->CreateItemEnumerator(scopeIndex, result);
+    }
+
     HRESULT Clone(_Outptr_ IHierarchicalSchema**) const;
 
     HRESULT GetSchemaBlobFromFileSection(
@@ -1014,25 +1019,31 @@ public:
 
     virtual HRESULT GetQualifierValue(_In_ Atom qualifier, _Inout_ StringResult* pValue) const = 0;
 
-    HRESULT EvaluateQualifier(_In_ const IQualifier* pQualifier, _Out_ double* pScoreOut, _Out_ double* pFallbackScoreOut) const;
+    virtual HRESULT EvaluateQualifier(_In_ const IQualifier* pQualifier, _Out_ double* pScoreOut, _Out_ double* pFallbackScoreOut) const override;
 
-    HRESULT EvaluateQualifierSet(
+    virtual HRESULT EvaluateQualifierSet(
         _In_ const IQualifierSet* pQualifierSet,
         _Out_ bool* pbIsMatchOut,
         _Out_ bool* pbIsDefaultOut,
         _Out_ bool* pbIsMatchAsDefaultOut,
-        _Out_opt_ UINT16* pScoreOut) const;
+        _Out_opt_ UINT16* pScoreOut) const override;
 
-    HRESULT EvaluateDecision(_In_ const IDecision* pDecision, _Out_ int* pResultIndexOut, _Inout_ QualifierSetResult* pResultSetOut) const;
+    virtual HRESULT EvaluateDecision(_In_ const IDecision* pDecision, _Out_ int* pResultIndexOut, _Inout_ QualifierSetResult* pResultSetOut) const override;
 
-    HRESULT EvaluateDecision(
+    virtual HRESULT EvaluateDecision(
         _In_ const IDecision* pDecision,
         _In_ int numResults,
         _Out_writes_(numResults) int* pResultIndexesOut,
-        _Out_writes_(numResults) int* pResultSetIndexesOut) const;
+        _Out_writes_(numResults) int* pResultSetIndexesOut) const override;
 
     virtual HRESULT GetQualifierProvider(_In_ PCWSTR qualifierName, _Out_ const IQualifierValueProvider** provider) const override = 0;
 
+    // Replaces the contents of this resolver's score and decision caches with a copy of
+    // those in pSource. Both resolvers must use the same decision info.
+    HRESULT CopyCacheFrom(_In_ const ResolverBase* pSource);
+
+    UINT GetNumCachedDecisionSets() const;
+
 protected:
     ResolverBase(_In_ const UnifiedEnvironment* pEnvironment, _In_ const IDecisionInfo* pDecisions);
 
@@ -1085,15 +1096,41 @@ public:
 
     virtual HRESULT GetQualifierProvider(_In_ PCWSTR qualifierName, _Out_ const IQualifierValueProvider** provider) const override;
 
+    // Gives each calling thread a private score and decision cache, so that concurrent lookups
+    // against this resolver do not serialize on a shared cache. Qualifier values are still owned
+    // by this resolver; changing them invalidates every thread's cache.
+    HRESULT EnableThreadLocalResolvers();
+
+    bool HasThreadLocalResolvers() const { return (m_pThreadResolvers != nullptr); }
+
+    virtual HRESULT EvaluateQualifier(_In_ const IQualifier* pQualifier, _Out_ double* pScoreOut, _Out_ double* pFallbackScoreOut) const override;
+
+    virtual HRESULT EvaluateQualifierSet(
+        _In_ const IQualifierSet* pQualifierSet,
+        _Out_ bool* pbIsMatchOut,
+        _Out_ bool* pbIsDefaultOut,
+        _Out_ bool* pbIsMatchAsDefaultOut,
+        _Out_opt_ UINT16* pScoreOut) const override;
+
+    virtual HRESULT EvaluateDecision(_In_ const IDecision* pDecision, _Out_ int* pResultIndexOut, _Inout_ QualifierSetResult* pResultSetOut) const override;
+
+    virtual HRESULT EvaluateDecision(
+        _In_ const IDecision* pDecision,
+        _In_ int numResults,
+        _Out_writes_(numResults) int* pResultIndexesOut,
+        _Out_writes_(numResults) int* pResultSetIndexesOut) const override;
+
 protected:
     ProviderResolver(_In_ const UnifiedEnvironment* pEnvironment, _In_ const IDecisionInfo* pDecisions);
 
     HRESULT Init();
 
     class PerQualifierPoolInfo;
+    class ThreadResolverTable;
 
     mutable IProviderDataSources* m_pDataSources;
     mutable PerQualifierPoolInfo* m_pQualifiers;
+    mutable ThreadResolverTable* m_pThreadResolvers;
 };
 
 class PerThreadQualifier;
@@ -253,6 +253,14 @@ public:
         _Out_writes_to_opt_(sizeItems, *pNumItemsWritten) int* pItemsOut,
         _Out_opt_ int* pNumItemsWritten) const = 0;
 
+    // Schemas backed by a names section can walk all the items below a scope in one pass.
+    // Others return E_NOTIMPL, and callers look the names up one at a time instead.
+    virtual HRESULT CreateItemEnumerator(_In_ int /*scopeIndex*/, _Outptr_ HierarchicalNamesItemEnumerator** result) const
+    {
+        *result = nullptr;
+        return E_NOTIMPL;
+    }
+
     virtual HRESULT Clone(_Outptr_ IHierarchicalSchema** result) const = 0;
 
     virtual HRESULT GetSchemaBlobFromFileSection(
@@ -460,6 +468,11 @@ public:
         return m_pNames->GetDescendents(scopeIndex, sizeScopes, pScopesOut, pNumScopesWritten, sizeItems, pItemsOut, pNumItemsWritten);
     }
 
+    HRESULT CreateItemEnumerator(_In_ int scopeIndex, _Outptr_ HierarchicalNamesItemEnumerator** result) const
+    {
+        return HierarchicalNamesItemEnumerator::CreateInstance(m_pNames, scopeIndex, result);
+    }
+
     HRESULT Clone(_Outptr_ IHierarchicalSchema** result) const;
 
     virtual HRESULT GetSchemaBlobFromFileSection(
@@ -703,6 +716,8 @@ public:
     virtual UINT64 GetCurrentGeneration() const = 0;
 };
 
+class DescendentResourceEnumerator;
+
 class ResourceMapSubtree : protected DefObject
 {
 public:
@@ -751,6 +766,10 @@ public:
     // Gets the name of the resource relative to this scope
     HRESULT GetDescendentResourceName(_In_ int index, _Inout_ StringResult* pNameOut) const;
 
+    // Enumerates descendent resources in index order. Prefer this to GetDescendentResourceName
+    // when visiting many resources, since it doesn't rebuild each name from scratch.
+    HRESULT CreateDescendentResourceEnumerator(_Outptr_ DescendentResourceEnumerator** result) const;
+
     int GetNumDescendentScopes() const;
 
     HRESULT GetDescendentScopeSubtree(_In_ int index, _Out_ const ResourceMapSubtree** result) const;
@@ -769,6 +788,8 @@ public:
     bool IsValid() const;
 
 protected:
+    friend class DescendentResourceEnumerator;
+
     ResourceMapSubtree();
 
     HRESULT InitResourceMapSubtree(_In_ const IResourceMapBase* pFullMap, _In_ int scopeIndex);
@@ -795,6 +816,44 @@ protected:
     mutable UINT16 m_currentMinorVersion;
 };
 
+// Streams the descendent resources of a ResourceMapSubtree with their names relative to the
+// subtree, in the same order as ResourceMapSubtree::GetDescendentResource.
+class DescendentResourceEnumerator : public DefObject
+{
+public:
+    static HRESULT CreateInstance(_In_ const ResourceMapSubtree* pSubtree, _Outptr_ DescendentResourceEnumerator** result);
+
+    ~DescendentResourceEnumerator();
+
+    // Moves to the next resource. *pbHasCurrent is false once every resource has been visited.
+    HRESULT MoveNext(_Out_ bool* pbHasCurrent);
+
+    // Moves past up to numToSkip resources without building their names.
+    HRESULT Skip(_In_ int numToSkip);
+
+    // Index of the current resource, as accepted by ResourceMapSubtree::GetDescendentResource.
+    int GetCurrentIndex() const { return m_index; }
+
+    // Only valid until the next call to MoveNext or Skip.
+    PCWSTR GetCurrentName() const;
+
+    HRESULT GetCurrentResource(_Inout_ NamedResourceResult* pItemOut) const;
+
+private:
+    const ResourceMapSubtree* m_pSubtree;
+
+    // Null when the schema can't be walked directly, in which case each name is looked up by index.
+    HierarchicalNamesItemEnumerator* m_pItems;
+    StringResult m_name;
+
+    int m_index;
+    bool m_bHasCurrent;
+
+    DescendentResourceEnumerator(_In_ const ResourceMapSubtree* pSubtree);
+
+    HRESULT Init();
+};
+
 class IFileSectionResolver;
 class ResourceMapFileData;
 
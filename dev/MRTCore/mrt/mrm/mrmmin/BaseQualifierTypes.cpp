@@ -12,7 +12,7 @@ template<typename Func>
 HRESULT ProcessQualifierValueList(_In_ PCWSTR valueFromProvider, _In_ Func process)
 {
     unsigned positionInList = 0;
-    StringResult valueList;
+    StringResultWithBuffer<> valueList;
     StringResult value;
     size_t pos = 0;
     HRESULT hr = S_OK;
@@ -26,7 +26,8 @@ HRESULT ProcessQualifierValueList(_In_ PCWSTR valueFromProvider, _In_ Func proce
         // the whole list.
         RETURN_IF_FAILED(valueList.SetRef(valueFromProvider));
 
-        // GetWritableRef will make a copy for us and return a pointer.
+        // GetWritableRef will make a copy for us and return a pointer. Short lists are
+        // copied into valueList itself rather than onto the heap.
         size_t charsLeft = 0;
         PWSTR buf;
         bool last = false;
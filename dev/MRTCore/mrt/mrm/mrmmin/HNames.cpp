@@ -497,6 +497,9 @@ _Success_(return ) bool HierarchicalNames::TryGetName(
     return TryGetName(index, 0, pResult, pScopeIndexOut, pItemIndexOut);
 }
 
+// Builds the name in place in the caller's buffer with a single SetEmptyContents, so
+// there is no intermediate StringResult here; callers that pass a StringResultWithBuffer
+// get the inline storage without a heap allocation.
 _Success_(return ) bool HierarchicalNames::TryGetName(
     __in int nodeIndex,
     __in int relativeToScope,
@@ -1451,4 +1454,172 @@ HRESULT HierarchicalNames::GetDescendents(
 
 const DEFFILE_SECTION_TYPEID HierarchicalNames::GetSectionTypeId() { return gHierarchicalNamesSectionType; }
 
+HierarchicalNamesItemEnumerator::HierarchicalNamesItemEnumerator(_In_ const HierarchicalNames* pNames) :
+    m_pNames(pNames),
+    m_pFrames(nullptr),
+    m_maxDepth(0),
+    m_depth(0),
+    m_pPath(nullptr),
+    m_cchPath(0),
+    m_cchCurrentName(0),
+    m_position(-1),
+    m_currentItemIndex(-1)
+{}
+
+HierarchicalNamesItemEnumerator::~HierarchicalNamesItemEnumerator()
+{
+    Def_Free(m_pFrames);
+    Def_Free(m_pPath);
+}
+
+HRESULT HierarchicalNamesItemEnumerator::CreateInstance(
+    _In_ const HierarchicalNames* pNames,
+    _In_ int scopeIndex,
+    _Outptr_ HierarchicalNamesItemEnumerator** result)
+{
+    *result = nullptr;
+    RETURN_HR_IF_NULL(E_INVALIDARG, pNames);
+
+    AutoDeletePtr<HierarchicalNamesItemEnumerator> pRtrn = new HierarchicalNamesItemEnumerator(pNames);
+    RETURN_IF_NULL_ALLOC(pRtrn);
+    RETURN_IF_FAILED(pRtrn->Init(scopeIndex));
+
+    *result = pRtrn.Detach();
+    return S_OK;
+}
+
+HRESULT HierarchicalNamesItemEnumerator::Init(_In_ int scopeIndex)
+{
+    const DEFFILE_HNAMES_HEADER_EX* pHeader = m_pNames->m_pHeader;
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_MRM_INVALID_PRI_FILE), pHeader->numScopes == 0);
+    RETURN_HR_IF(E_INVALIDARG, (scopeIndex < 0) || (scopeIndex > static_cast<int>(pHeader->numScopes) - 1));
+
+    // Every level adds at least one character and a separator, and no scope can appear twice
+    // on one path, so both limits bound the depth of a valid file.
+    m_maxDepth = min(static_cast<int>(pHeader->numScopes), (pHeader->cchLongestPath / 2) + 1) + 1;
+    m_pFrames = _DefArray_AllocZeroed(ScopeFrame, m_maxDepth);
+    RETURN_IF_NULL_ALLOC(m_pFrames);
+
+    m_cchPath = pHeader->cchLongestPath + 1;
+    m_pPath = _DefArray_AllocZeroed(WCHAR, m_cchPath);
+    RETURN_IF_NULL_ALLOC(m_pPath);
+
+    return PushScope(scopeIndex, 0);
+}
+
+HRESULT HierarchicalNamesItemEnumerator::PushScope(_In_ int scopeIndex, _In_ int cchPrefix)
+{
+    RETURN_HR_IF(
+        HRESULT_FROM_WIN32(ERROR_MRM_INVALID_PRI_FILE),
+        (scopeIndex < 0) || (scopeIndex > static_cast<int>(m_pNames->m_pHeader->numScopes) - 1) || (m_depth >= m_maxDepth));
+
+    DEFFILE_HNAMES_SCOPE_LARGE scope;
+    if (m_pNames->m_largeNode)
+    {
+        scope = m_pNames->m_pScopesLarge[scopeIndex];
+    }
+    else
+    {
+        scope = HNAMES_SCOPE_TO_HNAMES_SCOPE_LARGE(&m_pNames->m_pScopes[scopeIndex]);
+    }
+
+    ScopeFrame* pFrame = &m_pFrames[m_depth++];
+    pFrame->firstChildNode = scope.firstChildNameNode;
+    pFrame->numChildren = scope.numChildNames;
+    pFrame->nextChild = 0;
+    pFrame->cchPrefix = cchPrefix;
+    return S_OK;
+}
+
+HRESULT HierarchicalNamesItemEnumerator::AppendSegment(_In_ const DEFFILE_HNAMES_NODE_LARGE* pNode, _In_ int cchPrefix, _Out_ int* pcchPathOut)
+{
+    *pcchPathOut = cchPrefix;
+
+    // Leave room for the separator or terminator that follows the segment.
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_MRM_INVALID_PRI_FILE), (cchPrefix + pNode->cchName + 1) > m_cchPath);
+    RETURN_IF_FAILED(m_pNames->CopyNameSegment(
+        pNode->flagsAndNameOffsetHigh, HNamesGetNodeNameOffsetLarge(pNode), pNode->cchName, &m_pPath[cchPrefix]));
+
+    *pcchPathOut = cchPrefix + pNode->cchName;
+    return S_OK;
+}
+
+HRESULT HierarchicalNamesItemEnumerator::Advance(_In_ bool bBuildName, _Out_ bool* pbFound)
+{
+    *pbFound = false;
+    m_currentItemIndex = -1;
+    m_cchCurrentName = 0;
+
+    while (m_depth > 0)
+    {
+        ScopeFrame* pFrame = &m_pFrames[m_depth - 1];
+        if (pFrame->nextChild >= pFrame->numChildren)
+        {
+            m_depth--;
+            continue;
+        }
+
+        int nodeIndex = pFrame->firstChildNode + pFrame->nextChild++;
+        RETURN_HR_IF(
+            HRESULT_FROM_WIN32(ERROR_MRM_INVALID_PRI_FILE), (nodeIndex < 0) || (nodeIndex > static_cast<int>(m_pNames->m_pHeader->numNodes) - 1));
+
+        DEFFILE_HNAMES_NODE_LARGE node;
+        if (m_pNames->m_largeNode)
+        {
+            node = m_pNames->m_pNodesLarge[nodeIndex];
+        }
+        else
+        {
+            node = HNAMES_NODE_TO_HNAMES_NODE_LARGE(&m_pNames->m_pNodes[nodeIndex]);
+        }
+
+        if ((node.flagsAndNameOffsetHigh & DEFFILE_HNAMES_FLAGS_NODE_IS_SCOPE) != 0)
+        {
+            // The scope's name stays in the buffer for as long as it is on the stack, so the
+            // items and scopes below it only have to write their own segment.
+            int cchPath;
+            RETURN_IF_FAILED(AppendSegment(&node, pFrame->cchPrefix, &cchPath));
+            m_pPath[cchPath++] = m_pNames->GetDefaultPathSeparator();
+            RETURN_IF_FAILED(PushScope(node.payload, cchPath));
+            continue;
+        }
+
+        if (bBuildName)
+        {
+            int cchName;
+            RETURN_IF_FAILED(AppendSegment(&node, pFrame->cchPrefix, &cchName));
+            m_pPath[cchName] = L'\0';
+            m_cchCurrentName = cchName;
+        }
+
+        m_currentItemIndex = node.payload;
+        m_position++;
+        *pbFound = true;
+        return S_OK;
+    }
+
+    return S_OK;
+}
+
+HRESULT HierarchicalNamesItemEnumerator::MoveNext(_Out_ bool* pbHasCurrent) { return Advance(true, pbHasCurrent); }
+
+HRESULT HierarchicalNamesItemEnumerator::Skip(_In_ int numToSkip, _Out_ int* pNumSkipped)
+{
+    *pNumSkipped = 0;
+
+    bool bFound = true;
+    while ((*pNumSkipped < numToSkip) && bFound)
+    {
+        RETURN_IF_FAILED(Advance(false, &bFound));
+        if (bFound)
+        {
+            (*pNumSkipped)++;
+        }
+    }
+
+    // There's no current item until the next MoveNext.
+    m_currentItemIndex = -1;
+    return S_OK;
+}
+
 } // namespace Microsoft::Resources
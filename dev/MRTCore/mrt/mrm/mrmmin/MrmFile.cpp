@@ -559,6 +559,7 @@ HRESULT MrmFile::InitializeAndGetSection(_In_ BaseFile::SectionIndex sectionInde
     if (!m_pSections[sectionIndex].IsInitialized())
     {
         RETURN_IF_FAILED(m_pSections[sectionIndex].Init(m_pBaseFile, sectionIndex));
+        MrmPerfCounterSet::Increment(MrmPerfCounter::SectionsFaultedIn);
     }
 
     *result = &m_pSections[sectionIndex];
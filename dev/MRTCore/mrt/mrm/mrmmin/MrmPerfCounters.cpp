@@ -0,0 +1,118 @@
+// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "stdafx.h"
+#include "mrm/common/MrmPerfCounters.h"
+#include <malloc.h>
+
+namespace Microsoft::Resources
+{
+
+thread_local MrmPerfCounterBlock* MrmPerfCounterSet::s_pCurrentBlock = nullptr;
+
+// Counter sets are identified by a process-unique id rather than by address, so the
+// per-thread lookup cache can never confuse a destroyed set with a new one that happens
+// to be allocated at the same address.
+static volatile LONG64 s_nextPerfCounterSetId = 0;
+
+static thread_local UINT64 t_cachedSetId = 0;
+static thread_local MrmPerfCounterBlock* t_pCachedBlock = nullptr;
+
+HRESULT MrmPerfCounterSet::CreateInstance(_Outptr_ MrmPerfCounterSet** result)
+{
+    *result = nullptr;
+
+    MrmPerfCounterSet* pRtrn = new MrmPerfCounterSet();
+    RETURN_IF_NULL_ALLOC(pRtrn);
+
+    pRtrn->m_id = static_cast<UINT64>(InterlockedIncrement64(&s_nextPerfCounterSetId));
+
+    *result = pRtrn;
+    return S_OK;
+}
+
+MrmPerfCounterSet::~MrmPerfCounterSet()
+{
+    MrmPerfCounterBlock* block = m_pBlocks;
+    while (block != nullptr)
+    {
+        MrmPerfCounterBlock* next = block->pNext;
+        _aligned_free(block);
+        block = next;
+    }
+    m_pBlocks = nullptr;
+}
+
+HRESULT MrmPerfCounterSet::GetThreadBlock(_Outptr_ MrmPerfCounterBlock** result)
+{
+    *result = nullptr;
+
+    if (t_cachedSetId == m_id)
+    {
+        *result = t_pCachedBlock;
+        return S_OK;
+    }
+
+    // Not the set this thread used last. Thread ids are recycled, so a new thread may pick
+    // up the block of a thread that has exited. That is fine since the values only ever
+    // accumulate, and it keeps the number of blocks bounded by the peak thread count.
+    DWORD threadId = GetCurrentThreadId();
+    MrmPerfCounterBlock* block = m_pBlocks;
+    while ((block != nullptr) && (block->threadId != threadId))
+    {
+        block = block->pNext;
+    }
+
+    if (block == nullptr)
+    {
+        // The process heap only guarantees 16 byte alignment, which isn't enough to keep
+        // blocks of different threads off each other's cache lines.
+        block = static_cast<MrmPerfCounterBlock*>(_aligned_malloc(sizeof(MrmPerfCounterBlock), alignof(MrmPerfCounterBlock)));
+        RETURN_IF_NULL_ALLOC(block);
+        ZeroMemory(block, sizeof(*block));
+        block->threadId = threadId;
+
+        // Blocks are only pushed, never popped, so a simple compare-exchange on the head is enough.
+        MrmPerfCounterBlock* head;
+        do
+        {
+            head = m_pBlocks;
+            block->pNext = head;
+        } while (InterlockedCompareExchangePointer(reinterpret_cast<PVOID volatile*>(&m_pBlocks), block, head) != head);
+    }
+
+    t_cachedSetId = m_id;
+    t_pCachedBlock = block;
+
+    *result = block;
+    return S_OK;
+}
+
+void MrmPerfCounterSet::Aggregate(_Out_writes_(numValues) UINT64* values, _In_ UINT32 numValues) const
+{
+    ZeroMemory(values, numValues * sizeof(*values));
+
+    UINT32 count = min(numValues, static_cast<UINT32>(MrmPerfCounter::Count));
+    for (const MrmPerfCounterBlock* block = m_pBlocks; block != nullptr; block = block->pNext)
+    {
+        for (UINT32 i = 0; i < count; i++)
+        {
+            values[i] += static_cast<UINT64>(ReadNoFence64(&block->values[i]));
+        }
+    }
+}
+
+MrmPerfCounterScope::MrmPerfCounterScope(_In_opt_ MrmPerfCounterSet* set, _In_ bool countWhenDisabled) :
+    m_pPrevious(MrmPerfCounterSet::s_pCurrentBlock)
+{
+    if ((set != nullptr) && (countWhenDisabled || set->IsEnabled()))
+    {
+        MrmPerfCounterBlock* block;
+        if (SUCCEEDED(set->GetThreadBlock(&block)))
+        {
+            MrmPerfCounterSet::s_pCurrentBlock = block;
+        }
+    }
+}
+
+} // namespace Microsoft::Resources
@@ -48,7 +48,7 @@ public:
     {
         RETURN_HR_IF(E_INVALIDARG, index >= GetNumPerThreadQualifiers());
 
-        StringResult strQualiferName;
+        StringResultWithBuffer<> strQualiferName;
         RETURN_IF_FAILED(m_pProfile->GetThreadAwareQualifierName(index, &strQualiferName));
 
         RETURN_IF_FAILED(m_Environment->GetQualifierNameAtom(strQualiferName.GetRef(), pAtom, nullptr));
@@ -108,12 +108,12 @@ public:
         RETURN_HR_IF(E_INVALIDARG, index >= GetNumPerThreadQualifiers());
 
         Atom name;
-        StringResult strParentValue;
+        StringResultWithBuffer<> strParentValue;
 
         RETURN_IF_FAILED(GetQualifierPerThread(index, &name));
         RETURN_IF_FAILED(m_pParentResolver->GetQualifierValue(name, &strParentValue));
 
-        StringResult strValue;
+        StringResultWithBuffer<> strValue;
         RETURN_IF_FAILED(GetQualifierValue(index, &strValue));
 
         DEFCOMPARISON result;
@@ -481,6 +481,32 @@ public:
         return Reset();
     }
 
+    HRESULT CopyFrom(_In_ DecisionInfoCache* pSource)
+    {
+        RETURN_HR_IF(E_INVALIDARG, (pSource == nullptr) || (pSource->m_pDecisions != m_pDecisions));
+
+        if (pSource == this)
+        {
+            return S_OK;
+        }
+
+        AutoReaderWriterLock autoLock(&m_srwLock);
+        AutoReaderWriterLock autoSourceLock(&pSource->m_srwLock, true);
+
+        RETURN_IF_FAILED(CopyArray(pSource->m_qualifierCache, &m_qualifierCache));
+        RETURN_IF_FAILED(CopyArray(pSource->m_qualifierSetCache, &m_qualifierSetCache));
+        RETURN_IF_FAILED(CopyArray(pSource->m_decisionPerSetInfo, &m_decisionPerSetInfo));
+        RETURN_IF_FAILED(CopyArray(pSource->m_decisionCache, &m_decisionCache));
+
+        return S_OK;
+    }
+
+    UINT GetNumCachedDecisionSets()
+    {
+        AutoReaderWriterLock autoLock(&m_srwLock, true);
+        return m_decisionPerSetInfo.Count();
+    }
+
     HRESULT GetQualifierScores(_In_ const IQualifier* pQualifier, _Out_ UINT16* pScoreOut, _Out_ UINT16* pFallbackScoreOut)
     {
         int index;
@@ -852,6 +878,25 @@ protected:
         ::InitializeSRWLock(&m_srwLock);
     }
 
+    template<typename T>
+    static HRESULT CopyArray(_In_ const DynamicArray<T>& source, _Inout_ DynamicArray<T>* pTarget)
+    {
+        // Entries past the count are reused by later Set calls, so clear them rather than just dropping the count.
+        if (pTarget->Count() > 0)
+        {
+            ZeroMemory(pTarget->GetAll(), pTarget->Count() * sizeof(T));
+        }
+        pTarget->Reset();
+
+        if (source.Count() > 0)
+        {
+            RETURN_IF_FAILED(pTarget->SetExtent(source.Count()));
+            CopyMemory(pTarget->GetAll(), source.GetAll(), source.Count() * sizeof(T));
+        }
+
+        return S_OK;
+    }
+
     int CompareQualifierSetResultDetails(_In_ int setIndexInPool1, _In_ int setIndexInPool2, _In_ const IResolver* pResolver)
     {
         QualifierSetResult set1;
@@ -1076,7 +1121,7 @@ protected:
         Atom qa1;
         Atom qa2;
         const IBuildQualifierType* type;
-        StringResult value;
+        StringResultWithBuffer<> value;
 
         if (SUCCEEDED(m_pDecisions->GetQualifier(qualifier1, &qr1)) && SUCCEEDED(m_pDecisions->GetQualifier(qualifier2, &qr2)) &&
             SUCCEEDED(qr1.GetOperand1Qualifier(&qa1)) && SUCCEEDED(qr2.GetOperand1Qualifier(&qa2)) && (qa1 == qa2) &&
@@ -1153,6 +1198,25 @@ HRESULT ResolverBase::Reset(__in_ecount(numQualifierNames) Atom* pQualifierNames
     return S_OK;
 }
 
+HRESULT ResolverBase::CopyCacheFrom(_In_ const ResolverBase* pSource)
+{
+    RETURN_HR_IF(E_INVALIDARG, (pSource == nullptr) || (pSource->m_pDecisions != m_pDecisions));
+
+    if (pSource == this)
+    {
+        return S_OK;
+    }
+
+    // Same lock order as Reset, so a copy never observes a decision that is only partially evaluated.
+    AutoReaderWriterLock autoLock(&m_srwLock);
+    AutoReaderWriterLock autoSourceLock(&pSource->m_srwLock, true);
+    RETURN_IF_FAILED(m_pCache->CopyFrom(pSource->m_pCache));
+
+    return S_OK;
+}
+
+UINT ResolverBase::GetNumCachedDecisionSets() const { return m_pCache->GetNumCachedDecisionSets(); }
+
 HRESULT ResolverBase::EvaluateQualifier(_In_ const IQualifier* pQualifier, _Out_ double* pScoreOut, _Out_ double* pFallbackScoreOut) const
 {
     UINT16 score = 0;
@@ -1178,9 +1242,10 @@ HRESULT ResolverBase::EvaluateQualifier(_In_ const IQualifier* pQualifier, _Out_
     RETURN_IF_FAILED(pQualifier->GetFallbackScore(&fallbackScore));
 
     // Nope. Try to evaluate it.
+    MrmPerfCounterSet::Increment(MrmPerfCounter::QualifierEvaluations);
     Atom qualifierName;
     const IBuildQualifierType* pType = NULL;
-    StringResult value;
+    StringResultWithBuffer<> value;
 
     // The method can be called by (1) under m_srwLock and m_srwQualifierSetLock exclusive lock, or (2) no lock
     AutoReaderWriterLock autoLock(&m_srwQualifierLock);
@@ -1321,8 +1386,11 @@ HRESULT ResolverBase::EvaluateDecision(
 
     if (SUCCEEDED(m_pCache->GetDecisionResults(pDecision, numResults, pResultIndexesOut, pResultSetIndexesOut)))
     {
+        MrmPerfCounterSet::Increment(MrmPerfCounter::DecisionCacheHits);
         return S_OK;
     }
+    MrmPerfCounterSet::Increment(MrmPerfCounter::DecisionCacheMisses);
+
     int numSets = 0;
     DecisionInfoCache::DecisionPerSetInfo* pResults;
     RETURN_IF_FAILED(m_pCache->BeginSetDecisionResults(pDecision, &pResults, &numSets));
@@ -1480,7 +1548,21 @@ public:
 
     HRESULT GetQualifierValue(_In_ Atom atom, _In_ const IProviderDataSources* pData, _Inout_ StringResult* pRtrn)
     {
-        AutoReaderWriterLock autoLock(&m_srwLock, true);
+        {
+            // Fast path for values that are already cached. Thread-local resolvers all read through
+            // here, so don't make them queue behind each other for the common case.
+            AutoReaderWriterLock autoSharedLock(&m_srwLock, true);
+            UINT32 atomIx = atom.GetIndex();
+            if ((atom.GetPoolIndex() == m_pPool->GetPoolIndex()) && (atomIx < static_cast<UINT32>(m_cacheSize)) && (atomIx < 32) &&
+                ((m_presentValues & (1 << atomIx)) != 0))
+            {
+                RETURN_IF_FAILED(pRtrn->SetRef(m_pCachedValues[atomIx].GetRef()));
+                return S_OK;
+            }
+        }
+
+        // Filling the cache modifies it, so that needs the lock exclusively.
+        AutoReaderWriterLock autoLock(&m_srwLock, false);
 
         UINT32 atomIx =
             atom.GetIndex(); // OACR doesn't like using atom.GetIndex() as an index on m_pCachedValues below (wasn't mollified with "__analysis_assume(atom.GetIndex() < m_cacheSize)")
@@ -1544,7 +1626,7 @@ protected:
     UINT32 m_ownedProviders;
 
     int m_cacheSize;
-    __ecount(m_cacheSize) mutable StringResult* m_pCachedValues;
+    __ecount(m_cacheSize) mutable StringResultWithBuffer<>* m_pCachedValues;
     UINT32 m_attemptedValues;
     UINT32 m_presentValues;
     SRWLOCK m_srwLock;
@@ -1564,7 +1646,7 @@ protected:
     HRESULT Init()
     {
         RETURN_IF_FAILED(DynamicArray<IQualifierValueProvider*>::CreateInstance(m_pPool->GetNumAtoms(), &m_pProviders));
-        m_pCachedValues = new StringResult[m_cacheSize];
+        m_pCachedValues = new StringResultWithBuffer<>[m_cacheSize];
         RETURN_IF_NULL_ALLOC(m_pCachedValues);
 
         RETURN_IF_FAILED(m_pProviders->SetExtent(m_pPool->GetNumAtoms()));
@@ -1572,6 +1654,249 @@ protected:
     }
 };
 
+// Tables are identified by a process-unique id rather than by address, so the per-thread
+// lookup cache can never confuse a destroyed table with a new one at the same address.
+static volatile LONG64 s_nextThreadResolverTableId = 0;
+
+// Per-thread resolvers for a ProviderResolver.
+//
+// Each thread that evaluates against the owner gets an OverrideResolver child with its own score
+// and decision caches. The child has no local qualifier values, so it reads them from the owner.
+// Only the owning thread ever evaluates against or resets its child, so the child's locks are
+// never contended and threads do not share cache lines on the lookup path.
+//
+// New and invalidated children are seeded from a read-only snapshot, which is an OverrideResolver
+// that is never evaluated against. Threads publish a larger snapshot as their own cache grows,
+// so threads that join late start out warm.
+//
+// The number of slots is fixed, which bounds memory for thread pools. Slots belong to a thread id
+// and are reused if that id is recycled. Threads that find the table full use the owner's shared
+// caches instead.
+class ProviderResolver::ThreadResolverTable : public DefObject
+{
+public:
+    static const int MaxThreadResolvers = 64;
+
+    static HRESULT CreateInstance(_In_ const ProviderResolver* pOwner, _Outptr_ ThreadResolverTable** result)
+    {
+        *result = nullptr;
+        RETURN_HR_IF_NULL(E_INVALIDARG, pOwner);
+
+        AutoDeletePtr<ThreadResolverTable> pRtrn = new ThreadResolverTable(pOwner);
+        RETURN_IF_NULL_ALLOC(pRtrn);
+        RETURN_IF_FAILED(pRtrn->Init());
+
+        *result = pRtrn.Detach();
+        return S_OK;
+    }
+
+    ~ThreadResolverTable()
+    {
+        if (m_pSlots != nullptr)
+        {
+            for (int i = 0; i < MaxThreadResolvers; i++)
+            {
+                delete m_pSlots[i].pResolver;
+            }
+
+            _aligned_free(m_pSlots);
+            m_pSlots = nullptr;
+        }
+
+        delete m_pSnapshot;
+        m_pSnapshot = nullptr;
+    }
+
+    // Called after any change to the owner's qualifier values. Children notice the new generation
+    // the next time their thread uses them, and reset themselves.
+    void Invalidate() { InterlockedIncrement(&m_generation); }
+
+    // Returns the calling thread's resolver, ready to evaluate against, or nullptr if the thread
+    // should use the owner's shared caches.
+    OverrideResolver* GetThreadResolver()
+    {
+        Slot* pSlot = GetThreadSlot();
+        if (pSlot == nullptr)
+        {
+            return nullptr;
+        }
+
+        LONG generation = m_generation;
+        if (pSlot->generation != generation)
+        {
+            if (pSlot->pResolver == nullptr)
+            {
+                if (FAILED(OverrideResolver::CreateInstance(m_pOwner, &pSlot->pResolver)))
+                {
+                    pSlot->pResolver = nullptr;
+                    return nullptr;
+                }
+            }
+            else
+            {
+                pSlot->pResolver->Reset();
+            }
+
+            {
+                AutoReaderWriterLock autoLock(&m_srwLock, true);
+                if ((m_pSnapshot != nullptr) && (m_snapshotGeneration == generation))
+                {
+                    // A failed copy leaves the child with an empty cache, which is still correct.
+                    (void)pSlot->pResolver->CopyCacheFrom(m_pSnapshot);
+                }
+            }
+
+            pSlot->numSetsToPublish = pSlot->pResolver->GetNumCachedDecisionSets() * 2 + PublishThreshold;
+            pSlot->generation = generation;
+        }
+
+        return pSlot->pResolver;
+    }
+
+    // Called by the owning thread after an evaluation against its resolver. Publishes a copy of
+    // the thread's caches as the new snapshot once they have grown enough to be worth sharing.
+    void OnEvaluated(_In_ const OverrideResolver* pResolver)
+    {
+        Slot* pSlot = GetThreadSlot();
+        if ((pSlot == nullptr) || (pSlot->pResolver != pResolver))
+        {
+            return;
+        }
+
+        UINT numSets = pResolver->GetNumCachedDecisionSets();
+        if (numSets < pSlot->numSetsToPublish)
+        {
+            return;
+        }
+        pSlot->numSetsToPublish = numSets * 2 + PublishThreshold;
+
+        LONG generation = pSlot->generation;
+        if ((generation != m_generation) || (numSets <= m_numSnapshotSets))
+        {
+            return;
+        }
+
+        OverrideResolver* pSnapshot;
+        if (FAILED(OverrideResolver::CreateInstance(m_pOwner, &pSnapshot)))
+        {
+            return;
+        }
+
+        if (FAILED(pSnapshot->CopyCacheFrom(pResolver)))
+        {
+            delete pSnapshot;
+            return;
+        }
+
+        {
+            AutoReaderWriterLock autoLock(&m_srwLock);
+            if ((generation == m_generation) && ((m_snapshotGeneration != generation) || (numSets > m_numSnapshotSets)))
+            {
+                OverrideResolver* pOldSnapshot = m_pSnapshot;
+                m_pSnapshot = pSnapshot;
+                m_snapshotGeneration = generation;
+                m_numSnapshotSets = numSets;
+                pSnapshot = pOldSnapshot;
+            }
+        }
+
+        // Either the snapshot we replaced or the one we didn't use. Nobody can be reading it now.
+        delete pSnapshot;
+    }
+
+protected:
+    // Minimum number of newly cached decision sets before a thread publishes a snapshot.
+    static const UINT PublishThreshold = 64;
+
+    // Each slot is only written by the thread that claimed it. Slots are cache aligned (and so
+    // padded to a whole line) so that two threads never share a cache line.
+    typedef struct DECLSPEC_CACHEALIGN _Slot
+    {
+        volatile LONG threadId;
+        LONG generation;
+        OverrideResolver* pResolver;
+        UINT numSetsToPublish;
+    } Slot;
+
+    const ProviderResolver* m_pOwner;
+    UINT64 m_id;
+    volatile LONG m_generation;
+    Slot* m_pSlots;
+
+    // Protects the snapshot. Only taken when a child is seeded or a snapshot is published.
+    SRWLOCK m_srwLock;
+    OverrideResolver* m_pSnapshot;
+    LONG m_snapshotGeneration;
+    volatile UINT m_numSnapshotSets;
+
+    static thread_local UINT64 t_cachedTableId;
+    static thread_local Slot* t_pCachedSlot;
+
+    ThreadResolverTable(_In_ const ProviderResolver* pOwner) :
+        m_pOwner(pOwner),
+        m_id(static_cast<UINT64>(InterlockedIncrement64(&s_nextThreadResolverTableId))),
+        m_generation(0),
+        m_pSlots(nullptr),
+        m_pSnapshot(nullptr),
+        m_snapshotGeneration(-1),
+        m_numSnapshotSets(0)
+    {
+        ::InitializeSRWLock(&m_srwLock);
+    }
+
+    HRESULT Init()
+    {
+        // The slots are allocated separately because the heap only guarantees 16 byte alignment,
+        // which isn't enough to keep them off each other's (and the table's) cache lines.
+        m_pSlots = static_cast<Slot*>(_aligned_malloc(sizeof(Slot) * MaxThreadResolvers, alignof(Slot)));
+        RETURN_IF_NULL_ALLOC(m_pSlots);
+
+        ZeroMemory(m_pSlots, sizeof(Slot) * MaxThreadResolvers);
+        for (int i = 0; i < MaxThreadResolvers; i++)
+        {
+            m_pSlots[i].generation = -1;
+        }
+        return S_OK;
+    }
+
+    Slot* GetThreadSlot()
+    {
+        if (t_cachedTableId == m_id)
+        {
+            return t_pCachedSlot;
+        }
+
+        LONG threadId = static_cast<LONG>(GetCurrentThreadId());
+        Slot* pSlot = nullptr;
+
+        for (int i = 0; (i < MaxThreadResolvers) && (pSlot == nullptr); i++)
+        {
+            if (m_pSlots[i].threadId == threadId)
+            {
+                pSlot = &m_pSlots[i];
+            }
+        }
+
+        // Thread ids are never zero, so zero marks a free slot. Slots are never released, so a
+        // thread only needs to claim one the first time it uses this table.
+        for (int i = 0; (i < MaxThreadResolvers) && (pSlot == nullptr); i++)
+        {
+            if ((m_pSlots[i].threadId == 0) && (InterlockedCompareExchange(&m_pSlots[i].threadId, threadId, 0) == 0))
+            {
+                pSlot = &m_pSlots[i];
+            }
+        }
+
+        // Remember a full table too, so that overflow threads don't rescan it on every call.
+        t_cachedTableId = m_id;
+        t_pCachedSlot = pSlot;
+        return pSlot;
+    }
+};
+
+thread_local UINT64 ProviderResolver::ThreadResolverTable::t_cachedTableId = 0;
+thread_local ProviderResolver::ThreadResolverTable::Slot* ProviderResolver::ThreadResolverTable::t_pCachedSlot = nullptr;
+
 HRESULT ProviderResolver::CreateInstance(
     _In_ CoreProfile* pProfile,
     _In_ const UnifiedEnvironment* pEnvironment,
@@ -1594,10 +1919,15 @@ HRESULT ProviderResolver::CreateInstance(
 }
 
 ProviderResolver::ProviderResolver(_In_ const UnifiedEnvironment* pEnvironment, _In_ const IDecisionInfo* pDecisions) :
-    ResolverBase(pEnvironment, pDecisions), m_pQualifiers(NULL), m_pDataSources(NULL)
+    ResolverBase(pEnvironment, pDecisions), m_pQualifiers(NULL), m_pDataSources(NULL), m_pThreadResolvers(NULL)
 {}
 
-ProviderResolver::~ProviderResolver() { delete m_pQualifiers; }
+ProviderResolver::~ProviderResolver()
+{
+    // Children read qualifier values from us, so they have to go first.
+    delete m_pThreadResolvers;
+    delete m_pQualifiers;
+}
 
 HRESULT ProviderResolver::Init()
 {
@@ -1661,6 +1991,11 @@ void ProviderResolver::Reset()
 {
     ResolverBase::Reset();
     m_pQualifiers->ResetCache();
+
+    if (m_pThreadResolvers != nullptr)
+    {
+        m_pThreadResolvers->Invalidate();
+    }
 }
 
 HRESULT ProviderResolver::Reset(__in_ecount(numQualifierNames) Atom* pQualifierNames, _In_ int numQualifierNames)
@@ -1685,6 +2020,11 @@ HRESULT ProviderResolver::Reset(__in_ecount(numQualifierNames) Atom* pQualifierN
         }
     }
 
+    if (m_pThreadResolvers != nullptr)
+    {
+        m_pThreadResolvers->Invalidate();
+    }
+
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_MRM_INVALID_FILE_TYPE), badPool);
 
     return S_OK;
@@ -1730,6 +2070,13 @@ HRESULT ProviderResolver::SetQualifier(_In_ Atom qualifier, _In_ PCWSTR pNewValu
 
     RETURN_IF_FAILED(m_pQualifiers->SetQualifierValue(qualifier, pNewValue, true));
 
+    // Reset already invalidated the per-thread caches, but a thread could have refilled its
+    // cache from the old value before the new one was stored.
+    if (m_pThreadResolvers != nullptr)
+    {
+        m_pThreadResolvers->Invalidate();
+    }
+
     return S_OK;
 }
 
@@ -1750,6 +2097,86 @@ HRESULT ProviderResolver::GetQualifierProvider(_In_ PCWSTR qualifierName, _Out_
     return S_OK;
 }
 
+HRESULT ProviderResolver::EnableThreadLocalResolvers()
+{
+    if (m_pThreadResolvers != nullptr)
+    {
+        return S_OK;
+    }
+
+    ThreadResolverTable* pTable;
+    RETURN_IF_FAILED(ThreadResolverTable::CreateInstance(this, &pTable));
+
+    if (InterlockedCompareExchangePointer(reinterpret_cast<PVOID volatile*>(&m_pThreadResolvers), pTable, nullptr) != nullptr)
+    {
+        // Someone else got there first.
+        delete pTable;
+    }
+
+    return S_OK;
+}
+
+HRESULT
+ProviderResolver::EvaluateQualifier(_In_ const IQualifier* pQualifier, _Out_ double* pScoreOut, _Out_ double* pFallbackScoreOut) const
+{
+    OverrideResolver* pThreadResolver = (m_pThreadResolvers != nullptr) ? m_pThreadResolvers->GetThreadResolver() : nullptr;
+    if (pThreadResolver != nullptr)
+    {
+        return pThreadResolver->EvaluateQualifier(pQualifier, pScoreOut, pFallbackScoreOut);
+    }
+
+    return ResolverBase::EvaluateQualifier(pQualifier, pScoreOut, pFallbackScoreOut);
+}
+
+HRESULT ProviderResolver::EvaluateQualifierSet(
+    _In_ const IQualifierSet* pQualifierSet,
+    _Out_ bool* pbIsMatchOut,
+    _Out_ bool* pbIsDefaultOut,
+    _Out_ bool* pbIsMatchOrDefaultOut,
+    _Out_opt_ UINT16* pScoreOut) const
+{
+    OverrideResolver* pThreadResolver = (m_pThreadResolvers != nullptr) ? m_pThreadResolvers->GetThreadResolver() : nullptr;
+    if (pThreadResolver != nullptr)
+    {
+        return pThreadResolver->EvaluateQualifierSet(pQualifierSet, pbIsMatchOut, pbIsDefaultOut, pbIsMatchOrDefaultOut, pScoreOut);
+    }
+
+    return ResolverBase::EvaluateQualifierSet(pQualifierSet, pbIsMatchOut, pbIsDefaultOut, pbIsMatchOrDefaultOut, pScoreOut);
+}
+
+HRESULT ProviderResolver::EvaluateDecision(
+    _In_ const IDecision* pDecision,
+    _Out_ int* pResultIndexOut,
+    _Inout_ QualifierSetResult* pResultSetOut) const
+{
+    OverrideResolver* pThreadResolver = (m_pThreadResolvers != nullptr) ? m_pThreadResolvers->GetThreadResolver() : nullptr;
+    if (pThreadResolver != nullptr)
+    {
+        RETURN_IF_FAILED(pThreadResolver->EvaluateDecision(pDecision, pResultIndexOut, pResultSetOut));
+        m_pThreadResolvers->OnEvaluated(pThreadResolver);
+        return S_OK;
+    }
+
+    return ResolverBase::EvaluateDecision(pDecision, pResultIndexOut, pResultSetOut);
+}
+
+HRESULT ProviderResolver::EvaluateDecision(
+    _In_ const IDecision* pDecision,
+    _In_ int numResults,
+    _Out_writes_(numResults) int* pResultIndexesOut,
+    _Out_writes_(numResults) int* pResultSetIndexesOut) const
+{
+    OverrideResolver* pThreadResolver = (m_pThreadResolvers != nullptr) ? m_pThreadResolvers->GetThreadResolver() : nullptr;
+    if (pThreadResolver != nullptr)
+    {
+        RETURN_IF_FAILED(pThreadResolver->EvaluateDecision(pDecision, numResults, pResultIndexesOut, pResultSetIndexesOut));
+        m_pThreadResolvers->OnEvaluated(pThreadResolver);
+        return S_OK;
+    }
+
+    return ResolverBase::EvaluateDecision(pDecision, numResults, pResultIndexesOut, pResultSetIndexesOut);
+}
+
 class OverrideResolver::PerQualifierPoolInfo : public DefObject
 {
 public:
@@ -1850,7 +2277,7 @@ protected:
     const IAtomPool* m_pPool;
 
     int m_cacheSize;
-    __ecount(m_cacheSize) mutable StringResult* m_pCachedValues;
+    __ecount(m_cacheSize) mutable StringResultWithBuffer<>* m_pCachedValues;
     UINT32 m_presentValues;
     SRWLOCK m_srwLock;
     mutable DynamicArray<IQualifierValueProvider*>* m_pProviders;
@@ -1869,7 +2296,7 @@ protected:
 
     HRESULT Init()
     {
-        m_pCachedValues = new StringResult[m_cacheSize];
+        m_pCachedValues = new StringResultWithBuffer<>[m_cacheSize];
         RETURN_IF_NULL_ALLOC(m_pCachedValues);
 
         return S_OK;
@@ -2096,7 +2523,7 @@ bool OverrideResolver::IsQualifierValueOverriden(_In_ PCWSTR pQualifierName) con
 
 bool OverrideResolver::IsQualifierValueOverriden(_In_ Atom qualifier) const
 {
-    StringResult strValue;
+    StringResultWithBuffer<> strValue;
     if (SUCCEEDED(m_pQualifiers->GetQualifierValue(qualifier, &strValue)))
     {
         return true;
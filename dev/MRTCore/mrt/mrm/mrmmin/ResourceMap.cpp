@@ -979,7 +979,7 @@ HRESULT ResourceMapSubtree::InitResourceMapSubtree(_In_ const IResourceMapBase*
     RETURN_IF_FAILED(m_strResMapFullScopeName.SetCopy(m_pSchema->GetSimpleId()));
     RETURN_IF_FAILED(m_strResMapFullScopeName.Concat(L"/"));
 
-    StringResult strResMapScopeName;
+    StringResultWithBuffer<> strResMapScopeName;
     if (m_pSchema->TryGetScopeInfo(m_scopeIndex, &strResMapScopeName, &numChildren))
     {
         RETURN_IF_FAILED(m_strResMapFullScopeName.Concat(strResMapScopeName.GetRef()));
@@ -993,7 +993,7 @@ PCWSTR ResourceMapSubtree::GetFullScopeName() const { return m_strResMapFullScop
 
 int ResourceMapSubtree::GetNumChildren() const
 {
-    StringResult name;
+    StringResultWithBuffer<> name;
     int numChildren = 0;
 
     if (m_pSchema->TryGetScopeInfo(m_scopeIndex, &name, &numChildren))
@@ -1203,6 +1203,104 @@ HRESULT ResourceMapSubtree::GetDescendentResourceName(_In_ int index, _Inout_ St
     return HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND);
 }
 
+HRESULT ResourceMapSubtree::CreateDescendentResourceEnumerator(_Outptr_ DescendentResourceEnumerator** result) const
+{
+    return DescendentResourceEnumerator::CreateInstance(this, result);
+}
+
+DescendentResourceEnumerator::DescendentResourceEnumerator(_In_ const ResourceMapSubtree* pSubtree) :
+    m_pSubtree(pSubtree), m_pItems(nullptr), m_index(-1), m_bHasCurrent(false)
+{}
+
+DescendentResourceEnumerator::~DescendentResourceEnumerator() { delete m_pItems; }
+
+HRESULT DescendentResourceEnumerator::CreateInstance(_In_ const ResourceMapSubtree* pSubtree, _Outptr_ DescendentResourceEnumerator** result)
+{
+    *result = nullptr;
+    RETURN_HR_IF_NULL(E_INVALIDARG, pSubtree);
+
+    AutoDeletePtr<DescendentResourceEnumerator> pRtrn = new DescendentResourceEnumerator(pSubtree);
+    RETURN_IF_NULL_ALLOC(pRtrn);
+    RETURN_IF_FAILED(pRtrn->Init());
+
+    *result = pRtrn.Detach();
+    return S_OK;
+}
+
+HRESULT DescendentResourceEnumerator::Init()
+{
+    HRESULT hr = m_pSubtree->m_pSchema->CreateItemEnumerator(m_pSubtree->m_scopeIndex, &m_pItems);
+    if (hr == E_NOTIMPL)
+    {
+        // Fall back to looking up each name by index.
+        m_pItems = nullptr;
+        return m_pSubtree->GetOrUpdateDescendents();
+    }
+    return hr;
+}
+
+HRESULT DescendentResourceEnumerator::MoveNext(_Out_ bool* pbHasCurrent)
+{
+    *pbHasCurrent = false;
+    m_bHasCurrent = false;
+
+    if (m_pItems != nullptr)
+    {
+        RETURN_IF_FAILED(m_pItems->MoveNext(&m_bHasCurrent));
+        m_index = m_pItems->GetCurrentPosition();
+    }
+    else if (m_index < m_pSubtree->GetNumDescendentResources())
+    {
+        m_index++;
+        if (m_index < m_pSubtree->GetNumDescendentResources())
+        {
+            RETURN_IF_FAILED(m_pSubtree->GetDescendentResourceName(m_index, &m_name));
+            m_bHasCurrent = true;
+        }
+    }
+
+    *pbHasCurrent = m_bHasCurrent;
+    return S_OK;
+}
+
+HRESULT DescendentResourceEnumerator::Skip(_In_ int numToSkip)
+{
+    RETURN_HR_IF(E_INVALIDARG, numToSkip < 0);
+    m_bHasCurrent = false;
+
+    if (m_pItems != nullptr)
+    {
+        int numSkipped;
+        RETURN_IF_FAILED(m_pItems->Skip(numToSkip, &numSkipped));
+        m_index = m_pItems->GetCurrentPosition();
+    }
+    else
+    {
+        m_index = min(m_index + numToSkip, m_pSubtree->GetNumDescendentResources() - 1);
+    }
+    return S_OK;
+}
+
+PCWSTR DescendentResourceEnumerator::GetCurrentName() const
+{
+    if (!m_bHasCurrent)
+    {
+        return nullptr;
+    }
+    return (m_pItems != nullptr) ? m_pItems->GetCurrentName() : m_name.GetRef();
+}
+
+HRESULT DescendentResourceEnumerator::GetCurrentResource(_Inout_ NamedResourceResult* pItemOut) const
+{
+    RETURN_HR_IF(E_ILLEGAL_METHOD_CALL, !m_bHasCurrent);
+
+    if (m_pItems != nullptr)
+    {
+        return m_pSubtree->m_pFullMap->GetResourceByIndex(m_pItems->GetCurrentItemIndex(), pItemOut);
+    }
+    return m_pSubtree->GetDescendentResource(m_index, pItemOut);
+}
+
 int ResourceMapSubtree::GetNumDescendentScopes() const
 {
     if (FAILED(GetOrUpdateDescendents()))
@@ -8,6 +8,7 @@
 #include "mrm/BaseInternal.h"
 #include "mrm/Collections.h"
 #include "mrm/common/file/MrmFiles.h"
+#include "mrm/common/MrmPerfCounters.h"
 #include "mrm/common/MrmProfileData.h"
 #include "mrm/Checksums.h"
 #include "mrm/MrmEnvironment.h"
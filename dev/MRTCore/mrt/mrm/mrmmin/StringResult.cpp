@@ -9,7 +9,14 @@ namespace Microsoft::Resources
 {
 
 // Constructors
-StringResult::StringResult()
+StringResult::StringResult() : m_pInlineBuffer(nullptr), m_cchInlineBuffer(0)
+{
+    DefStringResult_InitBuf(&m_string, NULL);
+    m_pString = &m_string;
+}
+
+StringResult::StringResult(_Inout_updates_(cchInlineBuffer) PWSTR pInlineBuffer, _In_ UINT32 cchInlineBuffer) :
+    m_pInlineBuffer(pInlineBuffer), m_cchInlineBuffer(cchInlineBuffer)
 {
     DefStringResult_InitBuf(&m_string, NULL);
     m_pString = &m_string;
@@ -97,7 +104,22 @@ _Use_decl_annotations_ HRESULT StringResult::Init(DEFSTRINGRESULT* pString)
 StringResult::~StringResult(void) { DefStringResult_Clear(&m_string, TRUE); }
 
 _Use_decl_annotations_ HRESULT StringResult::SetRef(PCWSTR pStr) { return DefStringResult_SetRef(m_pString, pStr); }
-_Use_decl_annotations_ HRESULT StringResult::SetCopy(PCWSTR pStr) { return DefStringResult_SetCopy(m_pString, pStr); }
+_Use_decl_annotations_ HRESULT StringResult::SetCopy(PCWSTR pStr)
+{
+    if (HasInlineBuffer() && (pStr != nullptr))
+    {
+        size_t cchStr = wcslen(pStr);
+        if (cchStr < m_cchInlineBuffer)
+        {
+            // pStr may already point into the inline buffer, so the copy has to tolerate overlap.
+            memmove(m_pInlineBuffer, pStr, (cchStr + 1) * sizeof(WCHAR));
+            m_string.pRef = m_pInlineBuffer;
+            return S_OK;
+        }
+    }
+
+    return DefStringResult_SetCopy(m_pString, pStr);
+}
 _Use_decl_annotations_ HRESULT StringResult::SetContents(PWSTR pBuffer, size_t cchBuffer)
 {
     return DefStringResult_SetContents(m_pString, pBuffer, cchBuffer);
@@ -110,7 +132,13 @@ _Use_decl_annotations_ HRESULT StringResult::SetContentsFromOther(StringResult*
         return E_INVALIDARG;
     }
 
-    if (pOther->GetType() == DEFRESULTTYPE::DefResultType_Reference)
+    if (pOther->IsInline())
+    {
+        // The contents live inside pOther, so they have to be copied rather than moved.
+        RETURN_IF_FAILED(SetCopy(pOther->GetRef()));
+        RETURN_IF_FAILED(pOther->SetRef(NULL));
+    }
+    else if (pOther->GetType() == DEFRESULTTYPE::DefResultType_Reference)
     {
         // pOther is a read only reference. No need for deep copy.
         RETURN_IF_FAILED(SetRef(pOther->GetRef()));
@@ -135,11 +163,34 @@ _Use_decl_annotations_ HRESULT StringResult::SetContentsFromOther(StringResult*
 
 _Use_decl_annotations_ HRESULT StringResult::SetEmptyContents(size_t cchBufferMin, PWSTR* result, size_t* pcchBufferOut)
 {
+    if (HasInlineBuffer() && (cchBufferMin <= m_cchInlineBuffer))
+    {
+        m_pInlineBuffer[0] = L'\0';
+        m_string.pRef = m_pInlineBuffer;
+
+        if (result != nullptr)
+        {
+            *result = m_pInlineBuffer;
+        }
+        if (pcchBufferOut != nullptr)
+        {
+            *pcchBufferOut = m_cchInlineBuffer;
+        }
+        return S_OK;
+    }
+
     return DefStringResult_SetEmptyContents(m_pString, cchBufferMin, result, pcchBufferOut);
 }
 
 _Use_decl_annotations_ HRESULT StringResult::ReleaseContents(PWSTR* ppBufferOut, size_t* pcchBufferOut)
 {
+    if (IsInline())
+    {
+        // The caller takes ownership, so move the contents to the heap first.
+        PWSTR pBuffer;
+        RETURN_IF_FAILED(DefStringResult_GetWritableRef(m_pString, 0, &pBuffer, nullptr));
+    }
+
     return DefStringResult_ReleaseContents(m_pString, ppBufferOut, pcchBufferOut);
 }
 
@@ -158,6 +209,27 @@ _Use_decl_annotations_ HRESULT StringResult::GetRef(PCWSTR* result) const { retu
 
 _Use_decl_annotations_ HRESULT StringResult::GetWritableRef(PWSTR* result, size_t* pcchRefOut)
 {
+    if (IsInline())
+    {
+        *result = m_pInlineBuffer;
+        if (pcchRefOut != nullptr)
+        {
+            *pcchRefOut = m_cchInlineBuffer;
+        }
+        return S_OK;
+    }
+
+    if (HasInlineBuffer() && (m_string.pRef != nullptr) && (m_string.pRef != m_string.pBuf))
+    {
+        // A reference that fits can become writable without touching the heap.
+        size_t cchRef = wcslen(m_string.pRef);
+        if (cchRef < m_cchInlineBuffer)
+        {
+            RETURN_IF_FAILED(SetCopy(m_string.pRef));
+            return GetWritableRef(result, pcchRefOut);
+        }
+    }
+
     return DefStringResult_GetWritableRef(m_pString, 0, result, pcchRefOut);
 }
 
@@ -168,7 +240,15 @@ _Use_decl_annotations_ HRESULT StringResult::GetCopy(StringResult* pStringRtrn)
     return DefStringResult_GetCopy(m_pString, pStringRtrn->GetStringResult());
 }
 
-DEFRESULTTYPE StringResult::GetType() const { return DefStringResult_GetType(m_pString); }
+DEFRESULTTYPE StringResult::GetType() const
+{
+    if (IsInline())
+    {
+        return DEFRESULTTYPE::DefResultType_Buffer;
+    }
+
+    return DefStringResult_GetType(m_pString);
+}
 
 _Use_decl_annotations_ HRESULT StringResult::GetLength(size_t* length) const { return DefStringResult_GetLength(m_pString, length); }
 _Use_decl_annotations_ HRESULT StringResult::GetSize(size_t* size) const { return DefStringResult_GetSize(m_pString, size); }
@@ -2,6 +2,8 @@
 // Licensed under the MIT License.
 
 #include "mrm/common/BaseInternal.h"
+#include "mrm/DefObject.h"
+#include "mrm/common/MrmPerfCounters.h"
 #include "stringresult.h"
 
 #define CHECK_DEFSTRING(str) \
@@ -20,6 +22,13 @@ void* _Def_Inspect(__in void* pSelf, __in PCWSTR typeStr, Def_DescribeCallback d
     return pSelf;
 }
 
+// Every string buffer allocation goes through here so that it shows up in the perf counters.
+static PWSTR _DefStringResult_AllocBuffer(_In_ size_t cchBuf)
+{
+    Microsoft::Resources::MrmPerfCounterSet::Increment(Microsoft::Resources::MrmPerfCounter::StringAllocations);
+    return _DefArray_AllocZeroed(WCHAR, cchBuf);
+}
+
 HRESULT _DefStringResult_Alloc(_Outptr_ DEFSTRINGRESULT** result)
 {
     *result = _DefAllocZeroed(DEFSTRINGRESULT);
@@ -134,7 +143,7 @@ static HRESULT _DefStringResult_EnsureEmptyBuffer(_Inout_ DEFSTRINGRESULT* pSelf
         pOldBuf = pSelf->pBuf;
     }
 
-    pNewBuf = _DefArray_AllocZeroed(WCHAR, cchMinBufferSize);
+    pNewBuf = _DefStringResult_AllocBuffer(cchMinBufferSize);
     if (pNewBuf == nullptr)
     {
         return E_OUTOFMEMORY;
@@ -210,7 +219,7 @@ static HRESULT _DefStringResult_EnsureBuffer(_Inout_ DEFSTRINGRESULT* pSelf, _In
         return S_OK;
     }
 
-    pNewBuf = _DefArray_AllocZeroed(WCHAR, cchMinBufferSize);
+    pNewBuf = _DefStringResult_AllocBuffer(cchMinBufferSize);
     if (pNewBuf == nullptr)
     {
         return E_OUTOFMEMORY;
@@ -261,7 +270,7 @@ static HRESULT _DefStringResult_InitEmpty(_Inout_ DEFSTRINGRESULT* pSelf, _In_ s
     }
 
     // Not Empty
-    pTempStr = _DefArray_AllocZeroed(wchar_t, cchBuf);
+    pTempStr = _DefStringResult_AllocBuffer(cchBuf);
     if (pTempStr == nullptr)
     {
         return E_OUTOFMEMORY;
@@ -323,7 +332,7 @@ DefStringResult_InitBuf(_Inout_ DEFSTRINGRESULT* pSelf, _In_opt_ PCWSTR pInitStr
         else
         {
             // Alloc new buffer
-            PWSTR pNewBuf = _DefArray_AllocZeroed(wchar_t, cchInitStr);
+            PWSTR pNewBuf = _DefStringResult_AllocBuffer(cchInitStr);
             if (pNewBuf == nullptr)
             {
                 return E_OUTOFMEMORY;
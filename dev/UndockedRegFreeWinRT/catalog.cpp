@@ -24,8 +24,8 @@ extern "C"
     typedef HRESULT(__stdcall* activation_factory_type)(HSTRING, IActivationFactory**);
 }
 
-// Intentionally no class factory cache here. That would be excessive since
-// other layers already cache.
+// Intentionally no class factory cache here. Factories are cached per
+// apartment by the activation detours (see factorycache.h).
 struct component
 {
     wstring module_name;
@@ -77,6 +77,7 @@ struct component
 };
 
 static unordered_map<wstring, shared_ptr<component>> g_types;
+static volatile ULONG g_typesRevisionId{};
 
 HRESULT LoadManifestFromPath(std::wstring path)
 {
@@ -296,9 +297,15 @@ HRESULT ParseActivatableClassTag(IXmlReader* xmlReader, PCWSTR fileName)
         return HRESULT_FROM_WIN32(ERROR_SXS_DUPLICATE_ACTIVATABLE_CLASS);
     }
     g_types[activatableClass] = this_component;
+    InterlockedIncrement(&g_typesRevisionId);
     return S_OK;
 }
 
+UINT32 WinRTGetCatalogRevisionId()
+{
+    return static_cast<UINT32>(ReadULongAcquire(&g_typesRevisionId));
+}
+
 HRESULT WinRTGetThreadingModel(HSTRING activatableClassId, ABI::Windows::Foundation::ThreadingType* threading_model)
 {
     HRESULT hr{ WinRTGetThreadingModel_PackageGraph(activatableClassId, threading_model) };
@@ -21,6 +21,8 @@ HRESULT ParseFileTag(IXmlReader* xmlReader);
 
 HRESULT ParseActivatableClassTag(IXmlReader* xmlReader, PCWSTR fileName);
 
+UINT32 WinRTGetCatalogRevisionId();
+
 HRESULT WinRTGetThreadingModel(
     HSTRING activatableClassId,
     ABI::Windows::Foundation::ThreadingType* threading_model);
@@ -0,0 +1,237 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include <pch.h>
+
+#include <roapi.h>
+#include <wrl.h>
+
+#include "factorycache.h"
+
+#include "catalog.h"
+
+namespace
+{
+struct CachedFactory
+{
+    std::wstring activatableClassId;
+    Microsoft::WRL::ComPtr<IActivationFactory> factory;
+
+    // Can the factory be released from any thread? Not guaranteed for third-party factories
+    bool agile{};
+};
+
+using CachedFactories = std::unordered_map<std::wstring_view, std::unique_ptr<CachedFactory>>;
+
+struct ApartmentCache
+{
+    UINT64 apartmentId{};
+    UINT64 revisionId{};
+    APARTMENT_SHUTDOWN_REGISTRATION_COOKIE shutdownCookie{};
+    CachedFactories factories;
+};
+
+struct FactoryCacheState
+{
+    wil::srwlock lock;
+    std::vector<std::unique_ptr<ApartmentCache>> apartments;
+};
+
+// Intentionally never freed. Factories must not be released during process shutdown, after their
+// apartments are gone. Apartments that shut down before the process release theirs via ApartmentShutdown.
+FactoryCacheState* GetState() noexcept
+{
+    static FactoryCacheState* state{ new (std::nothrow) FactoryCacheState() };
+    return state;
+}
+
+std::wstring_view ToStringView(HSTRING activatableClassId) noexcept
+{
+    UINT32 length{};
+    PCWSTR buffer{ WindowsGetStringRawBuffer(activatableClassId, &length) };
+    return std::wstring_view{ buffer, length };
+}
+
+ApartmentCache* FindApartment(FactoryCacheState& state, UINT64 apartmentId) noexcept
+{
+    for (auto& apartment : state.apartments)
+    {
+        if (apartment->apartmentId == apartmentId)
+        {
+            return apartment.get();
+        }
+    }
+    return nullptr;
+}
+
+class ApartmentShutdown : public Microsoft::WRL::RuntimeClass<Microsoft::WRL::RuntimeClassFlags<Microsoft::WRL::ClassicCom>, IApartmentShutdown>
+{
+public:
+    STDMETHODIMP_(void) OnUninitialize(UINT64 apartmentIdentifier) override
+    {
+        auto state{ GetState() };
+        std::unique_ptr<ApartmentCache> apartment;
+        {
+            auto lock{ state->lock.lock_exclusive() };
+            for (auto iterator = state->apartments.begin(); iterator != state->apartments.end(); ++iterator)
+            {
+                if ((*iterator)->apartmentId == apartmentIdentifier)
+                {
+                    apartment = std::move(*iterator);
+                    state->apartments.erase(iterator);
+                    break;
+                }
+            }
+        }
+
+        // The factories are released here, outside the lock, while their apartment is still alive
+    }
+};
+}
+
+UINT64 UndockedRegFreeWinRT::FactoryCache::RevisionId() noexcept
+{
+    return (static_cast<UINT64>(MddGetPackageGraphRevisionId()) << 32) | WinRTGetCatalogRevisionId();
+}
+
+bool UndockedRegFreeWinRT::FactoryCache::Find(
+    HSTRING activatableClassId,
+    IActivationFactory** factory) noexcept
+{
+    *factory = nullptr;
+
+    auto state{ GetState() };
+    if (!state)
+    {
+        return false;
+    }
+
+    UINT64 apartmentId{};
+    if (FAILED(RoGetApartmentIdentifier(&apartmentId)))
+    {
+        return false;
+    }
+    const auto revisionId{ RevisionId() };
+
+    auto lock{ state->lock.lock_shared() };
+    auto apartment{ FindApartment(*state, apartmentId) };
+    if (!apartment || (apartment->revisionId != revisionId))
+    {
+        return false;
+    }
+    auto iterator{ apartment->factories.find(ToStringView(activatableClassId)) };
+    if (iterator == apartment->factories.end())
+    {
+        return false;
+    }
+    iterator->second->factory.CopyTo(factory);
+    return true;
+}
+
+void UndockedRegFreeWinRT::FactoryCache::Add(
+    HSTRING activatableClassId,
+    IActivationFactory* factory,
+    UINT64 revisionId) noexcept try
+{
+    auto state{ GetState() };
+    if (!state || !factory)
+    {
+        return;
+    }
+
+    UINT64 apartmentId{};
+    if (FAILED(RoGetApartmentIdentifier(&apartmentId)))
+    {
+        return;
+    }
+
+    auto cachedFactory{ std::make_unique<CachedFactory>() };
+    cachedFactory->activatableClassId = ToStringView(activatableClassId);
+    cachedFactory->factory = factory;
+    Microsoft::WRL::ComPtr<IAgileObject> agileObject;
+    cachedFactory->agile = SUCCEEDED(cachedFactory->factory.As(&agileObject));
+
+    // Declared before the lock so stale factories are released after it's dropped
+    CachedFactories staleFactories;
+    auto lock{ state->lock.lock_exclusive() };
+
+    // Did the package graph or catalog change while the factory was resolved? A Purge for the change
+    // may already be done, so don't cache a factory that may come from a removed package
+    if (RevisionId() != revisionId)
+    {
+        return;
+    }
+
+    auto apartment{ FindApartment(*state, apartmentId) };
+    if (!apartment)
+    {
+        // First factory cached in this apartment. Don't cache unless we'll hear when it shuts down
+        auto newApartment{ std::make_unique<ApartmentCache>() };
+        newApartment->apartmentId = apartmentId;
+        newApartment->revisionId = revisionId;
+
+        auto apartmentShutdown{ Microsoft::WRL::Make<ApartmentShutdown>() };
+        THROW_IF_NULL_ALLOC(apartmentShutdown);
+        UINT64 registeredApartmentId{};
+        if (FAILED(RoRegisterForApartmentShutdown(apartmentShutdown.Get(), &registeredApartmentId, &newApartment->shutdownCookie)))
+        {
+            return;
+        }
+
+        state->apartments.push_back(std::move(newApartment));
+        apartment = state->apartments.back().get();
+    }
+    else if (apartment->revisionId != revisionId)
+    {
+        // The package graph or catalog changed. Everything cached for the apartment may be stale
+        staleFactories.swap(apartment->factories);
+        apartment->revisionId = revisionId;
+    }
+
+    const std::wstring_view key{ cachedFactory->activatableClassId };
+    apartment->factories.try_emplace(key, std::move(cachedFactory));
+}
+CATCH_LOG()
+
+void UndockedRegFreeWinRT::FactoryCache::Purge() noexcept try
+{
+    auto state{ GetState() };
+    if (!state)
+    {
+        return;
+    }
+
+    // Release the current apartment's factories and every agile one here. Any other factory must be
+    // released on its own apartment's thread, so it stays cached under the apartment's old revision,
+    // where Find ignores it, until that apartment's next Add or its shutdown releases it. Declared
+    // before the lock so they're released after it's dropped. An apartment we fail to purge keeps its
+    // old revision, so its entries are still ignored by Find
+    UINT64 currentApartmentId{};
+    const bool hasApartment{ SUCCEEDED(RoGetApartmentIdentifier(&currentApartmentId)) };
+    std::vector<std::unique_ptr<CachedFactory>> staleFactories;
+    const auto revisionId{ RevisionId() };
+    {
+        auto lock{ state->lock.lock_exclusive() };
+        for (auto& apartment : state->apartments)
+        {
+            const bool isCurrentApartment{ hasApartment && (apartment->apartmentId == currentApartmentId) };
+            for (auto iterator = apartment->factories.begin(); iterator != apartment->factories.end();)
+            {
+                if (isCurrentApartment || iterator->second->agile)
+                {
+                    staleFactories.push_back(std::move(iterator->second));
+                    iterator = apartment->factories.erase(iterator);
+                }
+                else
+                {
+                    ++iterator;
+                }
+            }
+            if (apartment->factories.empty())
+            {
+                apartment->revisionId = revisionId;
+            }
+        }
+    }
+}
+CATCH_LOG()
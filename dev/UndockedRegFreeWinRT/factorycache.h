@@ -0,0 +1,39 @@
+// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#if !defined(FACTORYCACHE_H)
+#define FACTORYCACHE_H
+
+#include <activation.h>
+
+namespace UndockedRegFreeWinRT
+{
+/// Per-apartment cache of the activation factories of classes we activate in the caller's apartment.
+///
+/// Entries are keyed by activatable class id. Every apartment's entries are ignored once the package graph
+/// or SxS catalog changes and released when the apartment shuts down. Purge releases them early, except
+/// non-agile factories of other apartments, which are released on their own apartment's thread.
+class FactoryCache
+{
+public:
+    /// Returns true and an AddRef'd factory if the current apartment has one cached for the class.
+    static bool Find(
+        HSTRING activatableClassId,
+        IActivationFactory** factory) noexcept;
+
+    /// Returns the revision to pass to Add. Read it before resolving the factory so a factory resolved
+    /// against an older package graph or catalog is never cached.
+    static UINT64 RevisionId() noexcept;
+
+    static void Add(
+        HSTRING activatableClassId,
+        IActivationFactory* factory,
+        UINT64 revisionId) noexcept;
+
+    /// Drops every apartment's cached factories. Called after the package graph changes, so no
+    /// factory from a removed package is handed out again.
+    static void Purge() noexcept;
+};
+}
+
+#endif // FACTORYCACHE_H
@@ -12,6 +12,7 @@
 #include "urfw.h"
 
 #include "catalog.h"
+#include "factorycache.h"
 #include "TypeResolution.h"
 
 #include <../Detours/detours.h>
@@ -118,23 +119,31 @@ HRESULT EnsureMTAInitialized()
     return S_OK;
 }
 
-HRESULT GetActivationLocation(HSTRING activatableClassId, ActivationLocation &activationLocation)
+bool IsInboxClass(HSTRING activatableClassId)
 {
-    // We don't override inbox (Windows.*) runtimeclasses
+    // Does the activatableClassId start with "Windows."?
     UINT32 activatableClassIdAsStringLength{};
     auto activatableClassIdAsString{ WindowsGetStringRawBuffer(activatableClassId, &activatableClassIdAsStringLength) };
+    auto windowsNamespacePrefix{ L"Windows." };
+    const int windowsNamespacePrefixLength{ 8 };
+    if (activatableClassIdAsStringLength >= windowsNamespacePrefixLength)
     {
-        // Does the activatableClassId start with "Windows."?
-        auto windowsNamespacePrefix{ L"Windows." };
-        const int windowsNamespacePrefixLength{ 8 };
-        if (activatableClassIdAsStringLength >= windowsNamespacePrefixLength)
+        if (CompareStringOrdinal(activatableClassIdAsString, windowsNamespacePrefixLength, windowsNamespacePrefix, windowsNamespacePrefixLength, FALSE) == CSTR_EQUAL)
         {
-            if (CompareStringOrdinal(activatableClassIdAsString, windowsNamespacePrefixLength, windowsNamespacePrefix, windowsNamespacePrefixLength, FALSE) == CSTR_EQUAL)
-            {
-                return REGDB_E_CLASSNOTREG;
-            }
+            return true;
         }
     }
+    return false;
+}
+
+HRESULT GetActivationLocation(HSTRING activatableClassId, ActivationLocation &activationLocation)
+{
+    // We don't override inbox (Windows.*) runtimeclasses
+    if (IsInboxClass(activatableClassId))
+    {
+        return REGDB_E_CLASSNOTREG;
+    }
+    auto activatableClassIdAsString{ WindowsGetStringRawBuffer(activatableClassId, nullptr) };
 
     APTTYPE aptType{};
     APTTYPEQUALIFIER aptQualifier{};
@@ -182,6 +191,20 @@ HRESULT GetActivationLocation(HSTRING activatableClassId, ActivationLocation &ac
 
 HRESULT WINAPI RoActivateInstanceDetour(HSTRING activatableClassId, IInspectable** instance)
 {
+    // We don't override inbox (Windows.*) runtimeclasses, and don't cache their factories either
+    if (IsInboxClass(activatableClassId))
+    {
+        return TrueRoActivateInstance(activatableClassId, instance);
+    }
+
+    // Have we already activated this class in the current apartment?
+    Microsoft::WRL::ComPtr<IActivationFactory> cachedFactory;
+    if (UndockedRegFreeWinRT::FactoryCache::Find(activatableClassId, &cachedFactory))
+    {
+        return cachedFactory->ActivateInstance(instance);
+    }
+    const auto cacheRevisionId{ UndockedRegFreeWinRT::FactoryCache::RevisionId() };
+
     ActivationLocation location;
     HRESULT hr = GetActivationLocation(activatableClassId, location);
     if (hr == REGDB_E_CLASSNOTREG)
@@ -195,6 +218,7 @@ HRESULT WINAPI RoActivateInstanceDetour(HSTRING activatableClassId, IInspectable
     {
         Microsoft::WRL::ComPtr<IActivationFactory> pFactory;
         RETURN_IF_FAILED(WinRTGetActivationFactory(activatableClassId, __uuidof(IActivationFactory), (void**)&pFactory));
+        UndockedRegFreeWinRT::FactoryCache::Add(activatableClassId, pFactory.Get(), cacheRevisionId);
         return pFactory->ActivateInstance(instance);
     }
 
@@ -230,6 +254,20 @@ HRESULT WINAPI RoActivateInstanceDetour(HSTRING activatableClassId, IInspectable
 
 HRESULT WINAPI RoGetActivationFactoryDetour(HSTRING activatableClassId, REFIID iid, void** factory)
 {
+    // We don't override inbox (Windows.*) runtimeclasses, and don't cache their factories either
+    if (IsInboxClass(activatableClassId))
+    {
+        return TrueRoGetActivationFactory(activatableClassId, iid, factory);
+    }
+
+    // Have we already activated this class in the current apartment?
+    Microsoft::WRL::ComPtr<IActivationFactory> cachedFactory;
+    if (UndockedRegFreeWinRT::FactoryCache::Find(activatableClassId, &cachedFactory))
+    {
+        return cachedFactory.CopyTo(iid, factory);
+    }
+    const auto cacheRevisionId{ UndockedRegFreeWinRT::FactoryCache::RevisionId() };
+
     ActivationLocation location;
     HRESULT hr = GetActivationLocation(activatableClassId, location);
     if (hr == REGDB_E_CLASSNOTREG)
@@ -241,8 +279,10 @@ HRESULT WINAPI RoGetActivationFactoryDetour(HSTRING activatableClassId, REFIID i
     // Activate in current apartment
     if (location == ActivationLocation::CurrentApartment)
     {
-        RETURN_IF_FAILED(WinRTGetActivationFactory(activatableClassId, iid, factory));
-        return S_OK;
+        Microsoft::WRL::ComPtr<IActivationFactory> pFactory;
+        RETURN_IF_FAILED(WinRTGetActivationFactory(activatableClassId, __uuidof(IActivationFactory), (void**)&pFactory));
+        UndockedRegFreeWinRT::FactoryCache::Add(activatableClassId, pFactory.Get(), cacheRevisionId);
+        return pFactory.CopyTo(iid, factory);
     }
     // Cross apartment MTA activation
     struct CrossApartmentMTAActData {
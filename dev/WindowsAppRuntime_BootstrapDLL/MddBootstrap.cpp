@@ -57,7 +57,27 @@ void FindDDLMViaEnumeration(
     PACKAGE_VERSION minVersion,
     std::wstring& ddlmPackageFamilyName,
     std::wstring& ddlmPackageFullName);
+bool IsDDLMInRelease(
+    PCWSTR packageFullName,
+    UINT16 majorVersion,
+    UINT16 minorVersion);
 CLSID GetClsid(const winrt::Windows::ApplicationModel::AppExtensions::AppExtension& appExtension);
+std::wstring GetDDLMCacheValueName(
+    PCWSTR algorithm,
+    UINT32 majorMinorVersion,
+    PCWSTR versionTag,
+    PACKAGE_VERSION minVersion);
+UINT64 GetPackageRepositoryStamp() noexcept;
+bool TryGetCachedDDLM(
+    PCWSTR valueName,
+    UINT64 packageRepositoryStamp,
+    std::wstring& packageFullName,
+    CLSID* clsid);
+void CacheDDLM(
+    PCWSTR valueName,
+    UINT64 packageRepositoryStamp,
+    PCWSTR packageFullName,
+    const CLSID* clsid) noexcept;
 bool IsOptionEnabled(PCWSTR name);
 HRESULT MddBootstrapInitialize_Log(
     HRESULT hrInitialize,
@@ -81,6 +101,9 @@ static UINT32 g_initializationMajorMinorVersion{};
 static std::wstring g_initializationVersionTag;
 static PACKAGE_VERSION g_initializationFrameworkPackageVersion{};
 
+static PCWSTR c_ddlmCacheKey{ L"Software\\Microsoft\\WindowsAppRuntime\\Bootstrap\\DDLM" };
+static PCWSTR c_packageRepositoryKey{ L"Software\\Classes\\Local Settings\\Software\\Microsoft\\Windows\\CurrentVersion\\AppModel\\Repository\\Packages" };
+
 static std::wstring g_test_ddlmPackageNamePrefix;
 static std::wstring g_test_ddlmPackagePublisherId;
 static std::wstring g_test_frameworkPackageNamePrefix;
@@ -662,11 +685,6 @@ CLSID FindDDLMViaAppExtension(
     PCWSTR versionTag,
     PACKAGE_VERSION minVersion)
 {
-    // Find the best fit
-    bool foundAny{};
-    PACKAGE_VERSION bestFitVersion{};
-    CLSID bestFitClsid{};
-
     // Look for windows.appExtension with name="microsoft.winappruntime.ddlm-<majorversion>.<minorversion>-<shortarchitecture>[-shorttag]"
     // NOTE: <majorversion>.<minorversion> MUST have a string length <= 8 characters ("12.34567", "12345.67", etc) to fit within
     //       the maximum allowed length of a windows.appExtension's Name (39 chars) on Windows versions <= RS5 (10.0.17763.0).
@@ -683,10 +701,26 @@ CLSID FindDDLMViaAppExtension(
         wsprintf(appExtensionName, L"microsoft.winappruntime.ddlm-%hu.%hu-%s", majorVersion, minorVersion, AppModel::Identity::GetCurrentArchitectureAsShortString());
     }
 
+    // Did we already find the answer earlier in this user session?
+    const auto cacheValueName{ GetDDLMCacheValueName(L"AppExtension", majorMinorVersion, versionTag, minVersion) };
+    const auto packageRepositoryStamp{ GetPackageRepositoryStamp() };
+    std::wstring cachedPackageFullName;
+    CLSID cachedClsid{};
+    if (TryGetCachedDDLM(cacheValueName.c_str(), packageRepositoryStamp, cachedPackageFullName, &cachedClsid))
+    {
+        return cachedClsid;
+    }
+
+    // Gather the candidates...
     auto catalog{ winrt::Windows::ApplicationModel::AppExtensions::AppExtensionCatalog::Open(appExtensionName) };
     auto appExtensions{ catalog.FindAllAsync().get() };
-    for (auto appExtension : appExtensions)
+    const auto appExtensionsCount{ appExtensions.Size() };
+    std::vector<::WindowsAppRuntime::DDLM::Candidate> candidates;
+    candidates.reserve(appExtensionsCount);
+    for (UINT32 index = 0; index < appExtensionsCount; ++index)
     {
+        const auto appExtension{ appExtensions.GetAt(index) };
+
         // Check the package identity against the package identity test qualifiers (if any)
         if (!g_test_ddlmPackageNamePrefix.empty())
         {
@@ -702,49 +736,26 @@ CLSID FindDDLMViaAppExtension(
 
         // appExtension.Id == "ddlm-<major.minor.build.revision>-<architecture>"
         const auto id{ appExtension.Id() };
-        PACKAGE_VERSION version{};
-        WCHAR architectureAsString[9 + 1]{};
-        const auto maxIdLength{ ARRAYSIZE(L"ddlm-12345.12345.12345.12345-abcdefghi") - 1 }; // -1 for length not counting null-terminator
-        if ((id.size() >= maxIdLength) ||
-            (swscanf_s(id.c_str(), L"ddlm-%hu.%hu.%hu.%hu-%9s", &version.Major, &version.Minor, &version.Build, &version.Revision, architectureAsString, static_cast<unsigned>(ARRAYSIZE(architectureAsString))) != 5))
+        ::WindowsAppRuntime::DDLM::Candidate candidate{};
+        if (!::WindowsAppRuntime::DDLM::ParseAppExtensionId(id.c_str(), candidate.version, candidate.architecture))
         {
             (void)LOG_WIN32_MSG(ERROR_INVALID_DATA, "%ls", id.c_str());
             continue;
         }
-
-        // Does the version meet the minVersion criteria?
-        if (version.Version < minVersion.Version)
-        {
-            continue;
-        }
-
-        // Does the architecture match?
-        const auto architecture{ AppModel::Identity::ParseArchitecture(architectureAsString) };
-        if (architecture != AppModel::Identity::GetCurrentArchitecture())
-        {
-            continue;
-        }
-
-        // Do we have a package under consideration?
-        if (!foundAny)
-        {
-            bestFitVersion = version;
-            bestFitClsid = GetClsid(appExtension);
-            foundAny = true;
-            continue;
-        }
-
-        // Do we already have a higher version under consideration?
-        if (bestFitVersion.Version < version.Version)
-        {
-            bestFitVersion = version;
-            bestFitClsid = GetClsid(appExtension);
-            continue;
-        }
+        candidate.index = index;
+        candidates.push_back(candidate);
     }
-    THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_NO_MATCH), !foundAny, "AppExtension.Name=%ls, Major=%hu, Minor=%hu, Tag=%ls, MinVersion=%hu.%hu.%hu.%hu",
+
+    // ...and pick the best fit. Only the winner's properties are fetched to get its CLSID
+    const auto bestFit{ ::WindowsAppRuntime::DDLM::FindBestFit(candidates, minVersion, AppModel::Identity::GetCurrentArchitecture()) };
+    THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_NO_MATCH), !bestFit, "AppExtension.Name=%ls, Major=%hu, Minor=%hu, Tag=%ls, MinVersion=%hu.%hu.%hu.%hu",
                     appExtensionName, majorVersion, minorVersion, (!versionTag ? L"" : versionTag),
                     minVersion.Major, minVersion.Minor, minVersion.Build, minVersion.Revision);
+    const auto bestFitAppExtension{ appExtensions.GetAt(bestFit->index) };
+    const auto bestFitClsid{ GetClsid(bestFitAppExtension) };
+
+    const auto bestFitPackageFullName{ bestFitAppExtension.Package().Id().FullName() };
+    CacheDDLM(cacheValueName.c_str(), packageRepositoryStamp, bestFitPackageFullName.c_str(), &bestFitClsid);
     return bestFitClsid;
 }
 
@@ -755,12 +766,6 @@ void FindDDLMViaEnumeration(
     std::wstring& ddlmPackageFamilyName,
     std::wstring& ddlmPackageFullName)
 {
-    // Find the best fit
-    bool foundAny{};
-    PACKAGE_VERSION bestFitVersion{};
-    winrt::hstring bestFitPackageFamilyName{};
-    winrt::hstring bestFitPackageFullName{};
-
     // We need to look for DDLM packages in the package family for release <major>.<minor> and <versiontag>
     // But we have no single (simple) enumeration to match that so our logic's more involved compared
     // to FindDDLMViaAppExtension():
@@ -769,10 +774,13 @@ void FindDDLMViaEnumeration(
     // 1b. Only consider packages whose Name starts with "microsoft.winappruntime.ddlm.<minorversion>."
     // 1c. If versiontag is specified, Only consider packages whose Name ends with [-shorttag]
     // 1d. Only consider packages whose PublisherID = "8wekyb3d8bbwe"
-    // 2. Check if the package is in the <majorversion>.<minorversion> release
-    // 2a. Check if the package's Description starts with "Microsoft Windows App Runtime DDLM <majorversion>.<minorversion> "
-    // 3. Check if the architecture matches
-    // 4. Check if the package meets the specified minVersion
+    // 2. Check if the architecture matches
+    // 3. Check if the package meets the specified minVersion
+    // 4. Check if the package is in the <majorversion>.<minorversion> release
+    // 4a. Check if the package contains the file "Microsoft.WindowsAppRuntime.Release!<majorversion>.<minorversion>"
+    //
+    // 1-3 only need the package's identity, which the enumeration already has in hand. 4 hits the filesystem
+    // so it's only done for the applicable candidates, best fit first, stopping at the first match.
 
     const UINT16 majorVersion{ HIWORD(majorMinorVersion) };
     const UINT16 minorVersion{ LOWORD(majorMinorVersion) };
@@ -807,12 +815,31 @@ void FindDDLMViaEnumeration(
                                                                  majorVersion, minorVersion, (!versionTag ? L"" : versionTag),
                                                                  minVersion.Major, minVersion.Minor, minVersion.Build, minVersion.Revision) };
 
+    // Did we already find the answer earlier in this user session?
+    const auto cacheValueName{ GetDDLMCacheValueName(L"Enumeration", majorMinorVersion, versionTag, minVersion) };
+    const auto packageRepositoryStamp{ GetPackageRepositoryStamp() };
+    std::wstring cachedPackageFullName;
+    if (TryGetCachedDDLM(cacheValueName.c_str(), packageRepositoryStamp, cachedPackageFullName, nullptr))
+    {
+        WCHAR packageFamilyName[PACKAGE_FAMILY_NAME_MAX_LENGTH + 1]{};
+        UINT32 packageFamilyNameLength{ ARRAYSIZE(packageFamilyName) };
+        THROW_IF_WIN32_ERROR(PackageFamilyNameFromFullName(cachedPackageFullName.c_str(), &packageFamilyNameLength, packageFamilyName));
+        (void)LOG_HR_MSG(MDD_E_BOOTSTRAP_INITIALIZE_DDLM_FOUND,
+                         "Bootstrap.Intitialize: %ls best matches the criteria (%ls) (cached)",
+                         cachedPackageFullName.c_str(), criteria.get());
+        ddlmPackageFamilyName = packageFamilyName;
+        ddlmPackageFullName = std::move(cachedPackageFullName);
+        return;
+    }
+
     winrt::Windows::Management::Deployment::PackageManager packageManager;
     winrt::hstring currentUser;
     const auto c_packageTypes{ winrt::Windows::Management::Deployment::PackageTypes::Main };
     auto packages{ packageManager.FindPackagesForUserWithPackageTypes(currentUser, c_packageTypes) };
     (void)LOG_HR_MSG(MDD_E_BOOTSTRAP_INITIALIZE_SCAN_FOR_DDLM, "Bootstrap.Intitialize: Scanning packages for %ls", criteria.get());
     int packagesScanned{};
+    std::vector<winrt::Windows::ApplicationModel::PackageId> packageIds;
+    std::vector<::WindowsAppRuntime::DDLM::Candidate> candidates;
     for (auto package : packages)
     {
         ++packagesScanned;
@@ -820,132 +847,100 @@ void FindDDLMViaEnumeration(
         // Check the package identity against the package identity test qualifiers (if any)
         const auto packageId{ package.Id() };
         const auto packageName{ packageId.Name() };
-        const auto packageNameLength{ packageName.size() };
-        if (packageNameLength < packageNamePrefixLength + packageNameSuffixLength)
-        {
-            // The package's Name can't match the expected prefix and/or suffix. Skip it
-            continue;
-        }
-        if (CompareStringOrdinal(packageName.c_str(), static_cast<int>(packageNamePrefixLength), packageNamePrefix, static_cast<int>(packageNamePrefixLength), TRUE) != CSTR_EQUAL)
+        if (!::WindowsAppRuntime::DDLM::IsPackageNameMatch(packageName.c_str(), packageName.size(),
+                                                          packageNamePrefix, packageNamePrefixLength,
+                                                          packageNameSuffix, packageNameSuffixLength))
         {
-            // The package's Name prefix doesn't match the expected value. Skip it
+            // The package's Name prefix and/or suffix doesn't match the expected value. Skip it
             continue;
         }
-        if (packageNameSuffixLength > 0)
-        {
-            const auto offsetToSuffix{ packageNameLength - packageNameSuffixLength };
-            if (CompareStringOrdinal(packageName.c_str() + offsetToSuffix, static_cast<int>(packageNameSuffixLength), packageNameSuffix, static_cast<int>(packageNameSuffixLength), TRUE) != CSTR_EQUAL)
-            {
-                // The package's Name suffix doesn't match the expected value. Skip it
-                continue;
-            }
-        }
         if (CompareStringOrdinal(packageId.PublisherId().c_str(), -1, expectedPublisherId, -1, TRUE) != CSTR_EQUAL)
         {
             // The package's PublisherId doesn't match the expected value. Skip it
             continue;
         }
 
-        // Is this DDLM in the major.minor release?
-        //
-        // NOTE: Package.InstalledLocation.Path can be expensive as it has to create
-        //       a StorageFolder just to get the path as a string. We'd like to use
-        //       Package.EffectivePath but that didn't exist until 20H1 and we need
-        //       to work down to RS5. So instead we'll use GetPackagePathByFullName()
-        //       as that exists since Win81 (and can be significantly faster than
-        //       Package.InstalledLocation).
+        const auto packageVersion{ packageId.Version() };
+        ::WindowsAppRuntime::DDLM::Candidate candidate{};
+        candidate.version.Major = packageVersion.Major;
+        candidate.version.Minor = packageVersion.Minor;
+        candidate.version.Build = packageVersion.Build;
+        candidate.version.Revision = packageVersion.Revision;
+        candidate.architecture = packageId.Architecture();
+        candidate.index = static_cast<UINT32>(packageIds.size());
+        candidates.push_back(candidate);
+        packageIds.push_back(packageId);
+    }
+
+    // Best fit first. The first one in the requested release wins
+    const auto candidatesFound{ candidates.size() };
+    ::WindowsAppRuntime::DDLM::SelectApplicable(candidates, minVersion, AppModel::Identity::GetCurrentArchitecture());
+    if (candidates.size() < candidatesFound)
+    {
+        (void)LOG_HR_MSG(MDD_E_BOOTSTRAP_INITIALIZE_DDLM_SCAN_NO_MATCH,
+                         "Bootstrap.Intitialize: %u packages not applicable. Version doesn't match MinVersion or architecture doesn't match current architecture %ls (%ls)",
+                         static_cast<UINT32>(candidatesFound - candidates.size()), ::AppModel::Identity::GetCurrentArchitectureAsString(), criteria.get());
+    }
+    for (const auto& candidate : candidates)
+    {
+        const auto& packageId{ packageIds[candidate.index] };
         const auto packageFullName{ packageId.FullName() };
-        wil::unique_cotaskmem_string packagePathBufferDynamic;
-        uint32_t packagePathLength{};
-        const auto rc{ GetPackagePathByFullName(packageFullName.c_str(), &packagePathLength, nullptr) };
-        if (rc != ERROR_INSUFFICIENT_BUFFER)
-        {
-            THROW_HR_MSG(HRESULT_FROM_WIN32(rc), "Enumeration: %ls", packageFullName.c_str());
-        }
-        auto packagePath{ wil::make_cotaskmem_string_nothrow(nullptr, packagePathLength) };
-        THROW_IF_WIN32_ERROR(GetPackagePathByFullName(packageFullName.c_str(), &packagePathLength, packagePath.get()));
-        auto fileSpec{ std::filesystem::path(packagePath.get()) };
-        fileSpec /= L"Microsoft.WindowsAppRuntime.Release!*";
-        //
-        WIN32_FIND_DATA findFileData{};
-        wil::unique_hfind hfind{ FindFirstFile(fileSpec.c_str(), &findFileData) };
-        if (!hfind)
-        {
-            // The package's release version couldn't be determined. Skip it
-            (void)LOG_LAST_ERROR_MSG("Enumeration: FindFirst(%ls)", fileSpec.c_str());
-            continue;
-        }
-        uint16_t releaseMajorVersion{};
-        uint16_t releaseMinorVersion{};
-        if (swscanf_s(findFileData.cFileName, L"Microsoft.WindowsAppRuntime.Release!%hu.%hu", &releaseMajorVersion, &releaseMinorVersion) != 2)
-        {
-            // These aren't the droids you're looking for...
-            (void)LOG_LAST_ERROR_MSG("Enumeration: FindFirst(%ls) found %ls", fileSpec.c_str(), findFileData.cFileName);
-            continue;
-        }
-        if ((releaseMajorVersion != majorVersion) || (releaseMinorVersion != minorVersion))
+        if (!IsDDLMInRelease(packageFullName.c_str(), majorVersion, minorVersion))
         {
             // The package's major or minor release version doesn't match the expected value. Skip it
             continue;
         }
 
-        // Does the version meet the minVersion criteria?
-        auto packageVersion{ packageId.Version() };
-        PACKAGE_VERSION version{};
-        version.Major = packageVersion.Major;
-        version.Minor = packageVersion.Minor;
-        version.Build = packageVersion.Build;
-        version.Revision = packageVersion.Revision;
-        if (version.Version < minVersion.Version)
-        {
-            (void)LOG_HR_MSG(MDD_E_BOOTSTRAP_INITIALIZE_DDLM_SCAN_NO_MATCH,
-                             "Bootstrap.Intitialize: %ls not applicable. Version doesn't match MinVersion criteria (%ls)",
-                             packageFullName.c_str(), criteria.get());
-            continue;
-        }
-
-        // Does the architecture match?
-        const auto architecture{ packageId.Architecture() };
-        const auto currentArchitecture{ AppModel::Identity::GetCurrentArchitecture() };
-        if (architecture != currentArchitecture)
-        {
-            (void)LOG_HR_MSG(MDD_E_BOOTSTRAP_INITIALIZE_DDLM_SCAN_NO_MATCH,
-                             "Bootstrap.Intitialize: %ls not applicable. Architecture doesn't match current architecture %ls (%ls)",
-                             packageFullName.c_str(), ::AppModel::Identity::GetCurrentArchitectureAsString(), criteria.get());
-            continue;
-        }
-
-        // Do we have a package under consideration?
-        if (!foundAny)
-        {
-            (void)LOG_HR_MSG(MDD_E_BOOTSTRAP_INITIALIZE_DDLM_SCAN_MATCH,
-                             "Bootstrap.Intitialize: %ls is applicable (%ls)",
-                             packageFullName.c_str(), criteria.get());
-            bestFitVersion = version;
-            bestFitPackageFamilyName = packageId.FamilyName();
-            bestFitPackageFullName = packageId.FullName();
-            foundAny = true;
-            continue;
-        }
+        (void)LOG_HR_MSG(MDD_E_BOOTSTRAP_INITIALIZE_DDLM_FOUND,
+                         "Bootstrap.Intitialize: %ls best matches the criteria (%ls) of %d packages scanned",
+                         packageFullName.c_str(), criteria.get(), packagesScanned);
+        ddlmPackageFamilyName = packageId.FamilyName().c_str();
+        ddlmPackageFullName = packageFullName.c_str();
+        CacheDDLM(cacheValueName.c_str(), packageRepositoryStamp, ddlmPackageFullName.c_str(), nullptr);
+        return;
+    }
+    THROW_HR_MSG(HRESULT_FROM_WIN32(ERROR_NO_MATCH), "Enumeration: %ls", criteria.get());
+}
 
-        // Do we already have a higher version under consideration?
-        if (bestFitVersion.Version < version.Version)
-        {
-            (void)LOG_HR_MSG(MDD_E_BOOTSTRAP_INITIALIZE_DDLM_SCAN_MATCH,
-                             "Bootstrap.Intitialize: %ls is more applicable (%ls)",
-                             packageFullName.c_str(), criteria.get());
-            bestFitVersion = version;
-            bestFitPackageFamilyName = packageId.FamilyName();
-            bestFitPackageFullName = packageId.FullName();
-            continue;
-        }
+bool IsDDLMInRelease(
+    PCWSTR packageFullName,
+    UINT16 majorVersion,
+    UINT16 minorVersion)
+{
+    // NOTE: Package.InstalledLocation.Path can be expensive as it has to create
+    //       a StorageFolder just to get the path as a string. We'd like to use
+    //       Package.EffectivePath but that didn't exist until 20H1 and we need
+    //       to work down to RS5. So instead we'll use GetPackagePathByFullName()
+    //       as that exists since Win81 (and can be significantly faster than
+    //       Package.InstalledLocation).
+    uint32_t packagePathLength{};
+    const auto rc{ GetPackagePathByFullName(packageFullName, &packagePathLength, nullptr) };
+    if (rc != ERROR_INSUFFICIENT_BUFFER)
+    {
+        THROW_HR_MSG(HRESULT_FROM_WIN32(rc), "Enumeration: %ls", packageFullName);
+    }
+    auto packagePath{ wil::make_cotaskmem_string_nothrow(nullptr, packagePathLength) };
+    THROW_IF_WIN32_ERROR(GetPackagePathByFullName(packageFullName, &packagePathLength, packagePath.get()));
+    auto fileSpec{ std::filesystem::path(packagePath.get()) };
+    fileSpec /= L"Microsoft.WindowsAppRuntime.Release!*";
+    //
+    WIN32_FIND_DATA findFileData{};
+    wil::unique_hfind hfind{ FindFirstFile(fileSpec.c_str(), &findFileData) };
+    if (!hfind)
+    {
+        // The package's release version couldn't be determined
+        (void)LOG_LAST_ERROR_MSG("Enumeration: FindFirst(%ls)", fileSpec.c_str());
+        return false;
     }
-    THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_NO_MATCH), !foundAny, "Enumeration: %ls", criteria.get());
-    (void)LOG_HR_MSG(MDD_E_BOOTSTRAP_INITIALIZE_DDLM_FOUND,
-                     "Bootstrap.Intitialize: %ls best matches the criteria (%ls) of %d packages scanned",
-                     bestFitPackageFullName.c_str(), criteria.get(), packagesScanned);
-    ddlmPackageFamilyName = bestFitPackageFamilyName.c_str();
-    ddlmPackageFullName = bestFitPackageFullName.c_str();
+    UINT16 releaseMajorVersion{};
+    UINT16 releaseMinorVersion{};
+    if (!::WindowsAppRuntime::DDLM::ParseReleaseFilename(findFileData.cFileName, releaseMajorVersion, releaseMinorVersion))
+    {
+        // These aren't the droids you're looking for...
+        (void)LOG_WIN32_MSG(ERROR_INVALID_DATA, "Enumeration: FindFirst(%ls) found %ls", fileSpec.c_str(), findFileData.cFileName);
+        return false;
+    }
+    return (releaseMajorVersion == majorVersion) && (releaseMinorVersion == minorVersion);
 }
 
 CLSID GetClsid(const winrt::Windows::ApplicationModel::AppExtensions::AppExtension& appExtension)
@@ -977,6 +972,157 @@ CLSID GetClsid(const winrt::Windows::ApplicationModel::AppExtensions::AppExtensi
     return clsid;
 }
 
+std::wstring GetDDLMCacheValueName(
+    PCWSTR algorithm,
+    UINT32 majorMinorVersion,
+    PCWSTR versionTag,
+    PACKAGE_VERSION minVersion)
+{
+    // <algorithm>;<major.minor>;<versiontag>;<minversion>;<architecture>
+    auto valueName{ wil::str_printf<wil::unique_cotaskmem_string>(L"%ls;%hu.%hu;%ls;%hu.%hu.%hu.%hu;%ls",
+                                                                  algorithm, HIWORD(majorMinorVersion), LOWORD(majorMinorVersion),
+                                                                  (!versionTag ? L"" : versionTag),
+                                                                  minVersion.Major, minVersion.Minor, minVersion.Build, minVersion.Revision,
+                                                                  AppModel::Identity::GetCurrentArchitectureAsString()) };
+    return std::wstring{ valueName.get() };
+}
+
+UINT64 GetPackageRepositoryStamp() noexcept
+{
+    // The user's package repository has a subkey per package registered to the user. Registering or
+    // removing a package adds or deletes one, which updates the key's last write time
+    wil::unique_hkey key;
+    if (RegOpenKeyExW(HKEY_CURRENT_USER, c_packageRepositoryKey, 0, KEY_QUERY_VALUE, &key) != ERROR_SUCCESS)
+    {
+        return 0;
+    }
+    FILETIME lastWriteTime{};
+    if (RegQueryInfoKeyW(key.get(), nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &lastWriteTime) != ERROR_SUCCESS)
+    {
+        return 0;
+    }
+    return (static_cast<UINT64>(lastWriteTime.dwHighDateTime) << 32) | lastWriteTime.dwLowDateTime;
+}
+
+bool TryGetCachedDDLM(
+    PCWSTR valueName,
+    UINT64 packageRepositoryStamp,
+    std::wstring& packageFullName,
+    CLSID* clsid)
+{
+    // The DDLM selected for a given criteria is remembered for the user's logon session in a volatile
+    // registry key, along with the package repository stamp read before the search. A package registered
+    // or removed since then (e.g. a newer DDLM) changes the stamp, so we search again (and update the cache).
+    // No stamp (0) means we can't tell, so we always search.
+    //
+    // The selection's also only as good as the package still being registered, so that's verified too.
+    //
+    // Test scenarios (MddBootstrapTestInitialize) repeatedly add and remove DDLM packages so they always search.
+    if (!g_test_ddlmPackageNamePrefix.empty() || (packageRepositoryStamp == 0))
+    {
+        return false;
+    }
+
+    wil::unique_hkey key;
+    if (RegOpenKeyExW(HKEY_CURRENT_USER, c_ddlmCacheKey, 0, KEY_QUERY_VALUE, &key) != ERROR_SUCCESS)
+    {
+        return false;
+    }
+
+    // Value = "<stamp>;[{clsid}]<packagefullname>"
+    const size_t c_stampLength{ 17 }; // "xxxxxxxxxxxxxxxx;"
+    const size_t c_clsidLength{ 38 }; // "{xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx}"
+    WCHAR stampAndValue[c_stampLength + c_clsidLength + PACKAGE_FULL_NAME_MAX_LENGTH + 1]{};
+    DWORD valueSize{ sizeof(stampAndValue) };
+    if (RegGetValueW(key.get(), nullptr, valueName, RRF_RT_REG_SZ, nullptr, stampAndValue, &valueSize) != ERROR_SUCCESS)
+    {
+        return false;
+    }
+
+    WCHAR stamp[c_stampLength + 1]{};
+    FAIL_FAST_IF_FAILED(StringCchPrintfW(stamp, ARRAYSIZE(stamp), L"%016I64X;", packageRepositoryStamp));
+    if (wcsncmp(stampAndValue, stamp, c_stampLength) != 0)
+    {
+        // Packages were registered or removed since the DDLM was selected
+        return false;
+    }
+    PWSTR value{ stampAndValue + c_stampLength };
+
+    PCWSTR cachedPackageFullName{ value };
+    CLSID cachedClsid{};
+    if (clsid)
+    {
+        if ((wcslen(value) <= c_clsidLength) || (value[0] != L'{') || (value[c_clsidLength - 1] != L'}'))
+        {
+            return false;
+        }
+        value[c_clsidLength - 1] = L'\0';
+        if (UuidFromStringW(reinterpret_cast<RPC_WSTR>(value + 1), &cachedClsid) != RPC_S_OK)
+        {
+            return false;
+        }
+        cachedPackageFullName = value + c_clsidLength;
+    }
+
+    // Is the package still registered to the user? GetPackagePathByFullName() succeeds if it's installed
+    // for any user, so look for it among the current user's packages in its package family
+    WCHAR packageFamilyName[PACKAGE_FAMILY_NAME_MAX_LENGTH + 1]{};
+    UINT32 packageFamilyNameLength{ ARRAYSIZE(packageFamilyName) };
+    if (PackageFamilyNameFromFullName(cachedPackageFullName, &packageFamilyNameLength, packageFamilyName) != ERROR_SUCCESS)
+    {
+        return false;
+    }
+    bool isRegistered{};
+    for (const auto& registeredPackageFullName : AppModel::Package::FindByFamily(packageFamilyName))
+    {
+        if (CompareStringOrdinal(registeredPackageFullName.c_str(), -1, cachedPackageFullName, -1, TRUE) == CSTR_EQUAL)
+        {
+            isRegistered = true;
+            break;
+        }
+    }
+    if (!isRegistered)
+    {
+        return false;
+    }
+
+    packageFullName = cachedPackageFullName;
+    if (clsid)
+    {
+        *clsid = cachedClsid;
+    }
+    return true;
+}
+
+void CacheDDLM(
+    PCWSTR valueName,
+    UINT64 packageRepositoryStamp,
+    PCWSTR packageFullName,
+    const CLSID* clsid) noexcept try
+{
+    if (!g_test_ddlmPackageNamePrefix.empty() || (packageRepositoryStamp == 0))
+    {
+        return;
+    }
+
+    // Best effort. Not every caller can write to HKCU (e.g. AppContainer)
+    wil::unique_hkey key;
+    if (RegCreateKeyExW(HKEY_CURRENT_USER, c_ddlmCacheKey, 0, nullptr, REG_OPTION_VOLATILE, KEY_SET_VALUE, nullptr, &key, nullptr) != ERROR_SUCCESS)
+    {
+        return;
+    }
+
+    std::wstring value{ wil::str_printf<wil::unique_cotaskmem_string>(L"%016I64X;", packageRepositoryStamp).get() };
+    if (clsid)
+    {
+        value += winrt::to_hstring(*clsid).c_str();
+    }
+    value += packageFullName;
+    const auto valueSize{ static_cast<DWORD>((value.size() + 1) * sizeof(value[0])) };
+    (void)LOG_IF_WIN32_ERROR(RegSetValueExW(key.get(), valueName, 0, REG_SZ, reinterpret_cast<const BYTE*>(value.c_str()), valueSize));
+}
+CATCH_LOG_RETURN()
+
 bool IsOptionEnabled(PCWSTR name)
 {
     WCHAR value[1 + 1]{};
@@ -25,8 +25,10 @@
 #include <winrt/Windows.Management.Deployment.h>
 
 #include <appmodel.identity.h>
+#include <appmodel.package.h>
 #include <iswindowsversion.h>
 #include <security.integritylevel.h>
 #include <WindowsAppRuntime.VersionInfo.h>
+#include <WindowsAppRuntime.DDLM.h>
 
 #include "wil_msixdynamicdependency.h"
@@ -0,0 +1,497 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include <atomic>
+#include <thread>
+
+#include "..\..\dev\AppLifecycle\RedirectionRequestQueue.h"
+#include "..\..\dev\AppLifecycle\RedirectionRequestSlab.h"
+
+#include <WindowsAppRuntime.Test.Benchmark.h>
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using RedirectionRequestQueue = winrt::Microsoft::Windows::AppLifecycle::implementation::RedirectionRequestQueue;
+using RedirectionRequestSlab = winrt::Microsoft::Windows::AppLifecycle::implementation::RedirectionRequestSlab;
+
+namespace TB = ::Test::Benchmark;
+
+namespace Test::AppLifecycle
+{
+    class RedirectionRequestQueueTests
+    {
+    public:
+        BEGIN_TEST_CLASS(RedirectionRequestQueueTests)
+            TEST_CLASS_PROPERTY(L"ThreadingModel", L"MTA")
+        END_TEST_CLASS()
+
+        TEST_METHOD(FirstInFirstOut)
+        {
+            RedirectionRequestQueue queue;
+            queue.Init(UniqueQueueName());
+            VERIFY_IS_TRUE(queue.Dequeue() == GUID_NULL);
+
+            const UINT32 c_count{ 10 };
+            for (UINT32 index = 0; index < c_count; ++index)
+            {
+                queue.Enqueue(MakeId(0, index));
+            }
+            for (UINT32 index = 0; index < c_count; ++index)
+            {
+                VERIFY_IS_TRUE(queue.Dequeue() == MakeId(0, index));
+            }
+            VERIFY_IS_TRUE(queue.Dequeue() == GUID_NULL);
+        }
+
+        TEST_METHOD(FullQueue)
+        {
+            const auto name{ UniqueQueueName() };
+            RedirectionRequestQueue consumer;
+            consumer.Init(name);
+            RedirectionRequestQueue producer;
+            producer.Init(name);
+
+            SetVerifyOutput verifySettings(VerifyOutputSettings::LogOnlyFailures);
+
+            // Fill it up. The capacity is an implementation detail but it's bounded.
+            UINT32 count{};
+            for (;;)
+            {
+                try
+                {
+                    producer.Enqueue(MakeId(0, count));
+                    ++count;
+                }
+                catch (const wil::ResultException& e)
+                {
+                    VERIFY_ARE_EQUAL(E_OUTOFMEMORY, e.GetErrorCode());
+                    break;
+                }
+            }
+            Log::Comment(String().Format(L"Capacity: %u", count));
+            VERIFY_IS_TRUE(count > 0);
+
+            // Freeing one slot makes room for exactly one more, at the end of the line.
+            VERIFY_IS_TRUE(consumer.Dequeue() == MakeId(0, 0));
+            producer.Enqueue(MakeId(0, count));
+            VERIFY_THROWS_SPECIFIC(producer.Enqueue(MakeId(0, count + 1)), wil::ResultException,
+                [](const wil::ResultException& e) { return e.GetErrorCode() == E_OUTOFMEMORY; });
+            for (UINT32 index = 1; index <= count; ++index)
+            {
+                VERIFY_IS_TRUE(consumer.Dequeue() == MakeId(0, index));
+            }
+            VERIFY_IS_TRUE(consumer.Dequeue() == GUID_NULL);
+        }
+
+        TEST_METHOD(AbandonedSlot)
+        {
+            const auto name{ UniqueQueueName() };
+            RedirectionRequestQueue consumer;
+            consumer.Init(name);
+            RedirectionRequestQueue producer;
+            producer.Init(name);
+
+            // The 2nd slot is claimed but never published, as if its producer died before publishing.
+            producer.Enqueue(MakeId(0, 0));
+            const auto abandoned{ producer.Claim() };
+            producer.Enqueue(MakeId(0, 2));
+
+            // Its owner's alive so the consumer waits for it...
+            VERIFY_IS_TRUE(consumer.Dequeue() == MakeId(0, 0));
+            VERIFY_IS_TRUE(consumer.Dequeue() == GUID_NULL);
+
+            // ...until it's been stuck too long. Then it's skipped and the requests behind it delivered.
+            consumer.SetAbandonTimeout(0);
+            VERIFY_IS_TRUE(consumer.Dequeue() == MakeId(0, 2));
+            VERIFY_IS_TRUE(consumer.Dequeue() == GUID_NULL);
+
+            // A producer publishing after all finds the slot reclaimed.
+            VERIFY_IS_FALSE(producer.Publish(abandoned, MakeId(0, 1)));
+            VERIFY_IS_TRUE(consumer.Dequeue() == GUID_NULL);
+
+            // The slot's back in the ring: a full lap goes through it.
+            SetVerifyOutput verifySettings(VerifyOutputSettings::LogOnlyFailures);
+            for (UINT32 index = 3; index < 3 + 4096; ++index)
+            {
+                producer.Enqueue(MakeId(0, index));
+                VERIFY_IS_TRUE(consumer.Dequeue() == MakeId(0, index));
+            }
+            VERIFY_IS_TRUE(consumer.Dequeue() == GUID_NULL);
+        }
+
+        TEST_METHOD(LateProducerNextLap)
+        {
+            const auto name{ UniqueQueueName() };
+            RedirectionRequestQueue consumer;
+            consumer.Init(name);
+            RedirectionRequestQueue producer;
+            producer.Init(name);
+
+            // A slot is claimed, stalls and is skipped.
+            const auto stalled{ producer.Claim() };
+            consumer.SetAbandonTimeout(0);
+            VERIFY_IS_TRUE(consumer.Dequeue() == GUID_NULL);
+            consumer.SetAbandonTimeout(INFINITE);
+
+            // A full lap later another producer claims the same slot...
+            SetVerifyOutput verifySettings(VerifyOutputSettings::LogOnlyFailures);
+            for (UINT32 index = 1; index < 4096; ++index)
+            {
+                producer.Enqueue(MakeId(0, index));
+                VERIFY_IS_TRUE(consumer.Dequeue() == MakeId(0, index));
+            }
+            const auto nextLap{ producer.Claim() };
+            VERIFY_ARE_EQUAL(stalled + 4096, nextLap);
+
+            // ...so the stalled producer, publishing at last, must leave it alone.
+            VERIFY_IS_FALSE(producer.Publish(stalled, MakeId(0, 0), 1));
+            VERIFY_IS_TRUE(producer.Publish(nextLap, MakeId(1, 0)));
+            UINT32 block{};
+            VERIFY_IS_TRUE(consumer.Dequeue(block) == MakeId(1, 0));
+            VERIFY_ARE_EQUAL(RedirectionRequestSlab::c_noBlock, block);
+            VERIFY_IS_TRUE(consumer.Dequeue() == GUID_NULL);
+        }
+
+        TEST_METHOD(ConcurrentProducers)
+        {
+            // Every producer opens its own view of the shared memory, as each redirecting process does.
+            // Producers outrun the consumer so the ring wraps many times and fills up along the way.
+            const auto name{ UniqueQueueName() };
+            RedirectionRequestQueue consumer;
+            consumer.Init(name);
+
+            const UINT32 c_producers{ 8 };
+            const UINT32 c_itemsPerProducer{ 20000 };
+            std::vector<std::thread> producers;
+            for (UINT32 producer = 0; producer < c_producers; ++producer)
+            {
+                producers.emplace_back([&name, producer]()
+                {
+                    RedirectionRequestQueue queue;
+                    queue.Init(name);
+                    for (UINT32 index = 0; index < c_itemsPerProducer;)
+                    {
+                        try
+                        {
+                            queue.Enqueue(MakeId(producer, index));
+                            ++index;
+                        }
+                        catch (const wil::ResultException&)
+                        {
+                            // Full. Give the consumer a chance to catch up.
+                            SwitchToThread();
+                        }
+                    }
+                });
+            }
+
+            // Each producer's items must arrive exactly once and in the order that producer enqueued them.
+            // Keep draining even after a mismatch so the producers can finish.
+            std::vector<UINT32> expectedIndex(c_producers);
+            UINT32 received{};
+            bool inOrder{ true };
+            while (received < c_producers * c_itemsPerProducer)
+            {
+                const auto id{ consumer.Dequeue() };
+                if (id == GUID_NULL)
+                {
+                    SwitchToThread();
+                    continue;
+                }
+                ++received;
+                const auto producer{ static_cast<UINT32>(id.Data2) };
+                const auto index{ id.Data1 };
+                if ((producer >= c_producers) || (index != expectedIndex[producer]))
+                {
+                    inOrder = false;
+                    continue;
+                }
+                ++expectedIndex[producer];
+            }
+            for (auto& producer : producers)
+            {
+                producer.join();
+            }
+            VERIFY_IS_TRUE(inOrder);
+            VERIFY_ARE_EQUAL(c_producers * c_itemsPerProducer, received);
+            VERIFY_IS_TRUE(consumer.Dequeue() == GUID_NULL);
+        }
+
+        TEST_METHOD(SlabBlocks)
+        {
+            const auto name{ UniqueQueueName() };
+            RedirectionRequestSlab consumer;
+            consumer.Init(name);
+            RedirectionRequestSlab producer;
+            producer.Init(name);
+
+            UINT32 block{};
+            VERIFY_IS_NULL(producer.TryAllocate(RedirectionRequestSlab::c_maxPayloadSize + 1, block));
+            VERIFY_ARE_EQUAL(RedirectionRequestSlab::c_noBlock, block);
+
+            // Take every block; each is distinct and the payload written through one view is visible through the other.
+            std::vector<UINT32> blocks;
+            for (;;)
+            {
+                const auto size{ (blocks.size() % 2) ? RedirectionRequestSlab::c_maxPayloadSize : sizeof(UINT32) };
+                auto buffer{ producer.TryAllocate(size, block) };
+                if (!buffer)
+                {
+                    break;
+                }
+                const auto value{ static_cast<UINT32>(blocks.size()) };
+                memcpy(buffer, &value, sizeof(value));
+                blocks.push_back(block);
+            }
+            VERIFY_IS_TRUE(blocks.size() > 1);
+
+            for (UINT32 index = 0; index < blocks.size(); ++index)
+            {
+                size_t size{};
+                auto payload{ consumer.Get(blocks[index], size) };
+                VERIFY_ARE_EQUAL((index % 2) ? RedirectionRequestSlab::c_maxPayloadSize : sizeof(UINT32), size);
+                UINT32 value{};
+                memcpy(&value, payload, sizeof(value));
+                VERIFY_ARE_EQUAL(index, value);
+            }
+
+            // Freeing a block makes exactly that one available again.
+            consumer.Free(blocks[3]);
+            VERIFY_IS_NOT_NULL(producer.TryAllocate(sizeof(UINT32), block));
+            VERIFY_ARE_EQUAL(blocks[3], block);
+            VERIFY_IS_NULL(producer.TryAllocate(sizeof(UINT32), block));
+
+            // The block travels with its request id.
+            RedirectionRequestQueue queue;
+            queue.Init(name + L"_Queue");
+            queue.Enqueue(MakeId(0, 0));
+            queue.Enqueue(MakeId(0, 1), blocks[3]);
+            VERIFY_IS_TRUE(queue.Dequeue(block) == MakeId(0, 0));
+            VERIFY_ARE_EQUAL(RedirectionRequestSlab::c_noBlock, block);
+            VERIFY_IS_TRUE(queue.Dequeue(block) == MakeId(0, 1));
+            VERIFY_ARE_EQUAL(blocks[3], block);
+        }
+
+        TEST_METHOD(SlabReclaimsDeadSenders)
+        {
+            const auto name{ UniqueQueueName() };
+            RedirectionRequestSlab slab;
+            slab.Init(name);
+
+            // A sender that's exited.
+            const auto deadSender{ ExitedProcess() };
+
+            // It claimed two blocks but only handed one over before it died.
+            UINT32 abandonedBlock{};
+            VERIFY_IS_NOT_NULL(slab.TryAllocate(sizeof(UINT32), abandonedBlock, deadSender.dwProcessId));
+            UINT32 queuedBlock{};
+            VERIFY_IS_NOT_NULL(slab.TryAllocate(sizeof(UINT32), queuedBlock, deadSender.dwProcessId));
+            slab.MarkQueued(queuedBlock);
+
+            // Every free block goes first, then the abandoned one. The queued one's left for the target.
+            std::vector<UINT32> blocks;
+            UINT32 block{};
+            while (slab.TryAllocate(sizeof(UINT32), block))
+            {
+                blocks.push_back(block);
+            }
+            VERIFY_IS_TRUE(blocks.size() > 1);
+            VERIFY_ARE_EQUAL(abandonedBlock, blocks.back());
+            VERIFY_IS_TRUE(std::find(blocks.begin(), blocks.end(), queuedBlock) == blocks.end());
+
+            // Blocks held by a live sender (us) are never taken back.
+            slab.Free(queuedBlock);
+            VERIFY_IS_NOT_NULL(slab.TryAllocate(sizeof(UINT32), block));
+            VERIFY_ARE_EQUAL(queuedBlock, block);
+            VERIFY_IS_NULL(slab.TryAllocate(sizeof(UINT32), block));
+        }
+
+        TEST_METHOD(QueueReclaimsDeadSendersBlocks)
+        {
+            const auto name{ UniqueQueueName() };
+            RedirectionRequestQueue queue;
+            queue.Init(name);
+            RedirectionRequestSlab slab;
+            slab.Init(name + L"_Slab");
+            const auto deadSender{ ExitedProcess() };
+
+            // The dead sender handed over two blocks but published only one of them. We handed over one too.
+            UINT32 published{};
+            VERIFY_IS_NOT_NULL(slab.TryAllocate(sizeof(UINT32), published, deadSender.dwProcessId));
+            slab.MarkQueued(published);
+            queue.Enqueue(MakeId(0, 0), published);
+            UINT32 unpublished{};
+            VERIFY_IS_NOT_NULL(slab.TryAllocate(sizeof(UINT32), unpublished, deadSender.dwProcessId));
+            slab.MarkQueued(unpublished);
+            UINT32 ours{};
+            VERIFY_IS_NOT_NULL(slab.TryAllocate(sizeof(UINT32), ours));
+            slab.MarkQueued(ours);
+
+            // Only the dead sender's unpublished block is taken back...
+            queue.ReclaimBlocks(slab);
+            UINT32 block{};
+            VERIFY_IS_NOT_NULL(slab.TryAllocate(sizeof(UINT32), block));
+            while (block != unpublished)
+            {
+                VERIFY_ARE_NOT_EQUAL(published, block);
+                VERIFY_ARE_NOT_EQUAL(ours, block);
+                VERIFY_IS_NOT_NULL(slab.TryAllocate(sizeof(UINT32), block));
+            }
+
+            // ...and the published one's still delivered, and stays ours once dequeued.
+            VERIFY_IS_TRUE(queue.Dequeue(block, slab) == MakeId(0, 0));
+            VERIFY_ARE_EQUAL(published, block);
+            queue.ReclaimBlocks(slab);
+            while (slab.TryAllocate(sizeof(UINT32), block))
+            {
+                VERIFY_ARE_NOT_EQUAL(published, block);
+                VERIFY_ARE_NOT_EQUAL(ours, block);
+            }
+        }
+
+        TEST_METHOD(RedirectRoundTrip_Benchmark)
+        {
+            // Time from a redirecting instance handing over a payload until the target has consumed it, for
+            // the slab (one copy into a pre-allocated block plus one signal) and for the named packet (a
+            // mapping and an event created per request, held until the target acknowledges). The payload is
+            // sized like a typical file activation.
+            const UINT32 iterations{ TB::GetUIntParameter(L"RedirectIterations", 2000) };
+            const size_t c_payloadSize{ 600 };
+            std::vector<uint8_t> payload(c_payloadSize, 0x5A);
+
+            const auto name{ UniqueQueueName() };
+            RedirectionRequestQueue queue;
+            queue.Init(name);
+            RedirectionRequestSlab slab;
+            slab.Init(name + L"_Slab");
+
+            // The target: woken by the activation signal, drains the queue and acknowledges each request.
+            wil::unique_event activated{ wil::EventOptions::None };
+            wil::unique_event consumed{ wil::EventOptions::None };
+            std::atomic<bool> stop{ false };
+            std::thread target([&]()
+            {
+                RedirectionRequestQueue targetQueue;
+                targetQueue.Init(name);
+                RedirectionRequestSlab targetSlab;
+                targetSlab.Init(name + L"_Slab");
+                std::vector<uint8_t> received(c_payloadSize);
+                while (activated.wait(), !stop)
+                {
+                    GUID id{};
+                    UINT32 block{};
+                    while ((id = targetQueue.Dequeue(block, targetSlab)) != GUID_NULL)
+                    {
+                        if (block != RedirectionRequestSlab::c_noBlock)
+                        {
+                            size_t size{};
+                            memcpy(received.data(), targetSlab.Get(block, size), size);
+                            targetSlab.Free(block);
+                        }
+                        else
+                        {
+                            const auto packetName{ PacketName(name, id) };
+                            SharedMemory<uint8_t> packet;
+                            packet.Open(packetName);
+                            memcpy(received.data(), packet.Get(), packet.Size());
+                            wil::unique_event cleanupEvent;
+                            if (cleanupEvent.try_open((packetName + L"_ActivatedEvent").c_str()))
+                            {
+                                cleanupEvent.SetEvent();
+                            }
+                        }
+                        consumed.SetEvent();
+                    }
+                }
+            });
+            auto stopOnExit = wil::scope_exit([&]()
+            {
+                stop = true;
+                activated.SetEvent();
+                target.join();
+            });
+
+            auto slabRoundTrip = [&]()
+            {
+                GUID id{};
+                THROW_IF_FAILED(CoCreateGuid(&id));
+                UINT32 block{};
+                auto buffer{ slab.TryAllocate(payload.size(), block) };
+                THROW_HR_IF_NULL(E_OUTOFMEMORY, buffer);
+                memcpy(buffer, payload.data(), payload.size());
+                queue.Enqueue(id, block);
+                activated.SetEvent();
+                consumed.wait();
+            };
+
+            auto packetRoundTrip = [&]()
+            {
+                GUID id{};
+                THROW_IF_FAILED(CoCreateGuid(&id));
+                const auto packetName{ PacketName(name, id) };
+                SharedMemory<uint8_t> packet;
+                packet.Open(packetName);
+                packet.Resize(payload.size());
+                memcpy(packet.Get(), payload.data(), payload.size());
+                wil::unique_event cleanupEvent;
+                cleanupEvent.create(wil::EventOptions::ManualReset, (packetName + L"_ActivatedEvent").c_str());
+                queue.Enqueue(id);
+                activated.SetEvent();
+                cleanupEvent.wait();
+                consumed.wait();
+            };
+
+            const auto slabTime{ TimeRoundTrips(iterations, slabRoundTrip) };
+            const auto packetTime{ TimeRoundTrips(iterations, packetRoundTrip) };
+            Log::Comment(String().Format(L"Redirect round trip, %u iterations, %zu byte payload", iterations, c_payloadSize));
+            Log::Comment(String().Format(L"  Slab block:   %.2f us", slabTime));
+            Log::Comment(String().Format(L"  Named packet: %.2f us", packetTime));
+        }
+
+    private:
+        // A process that's exited. Holding its handle keeps its process id from being reused.
+        static wil::unique_process_information ExitedProcess()
+        {
+            WCHAR commandLine[]{ L"cmd.exe /c exit" };
+            STARTUPINFOW startupInfo{ sizeof(startupInfo) };
+            wil::unique_process_information process;
+            VERIFY_WIN32_BOOL_SUCCEEDED(CreateProcessW(nullptr, commandLine, nullptr, nullptr, FALSE, CREATE_NO_WINDOW, nullptr, nullptr, &startupInfo, &process));
+            VERIFY_ARE_EQUAL(static_cast<DWORD>(WAIT_OBJECT_0), WaitForSingleObject(process.hProcess, INFINITE));
+            return process;
+        }
+
+        // Average microseconds per call of roundTrip, after a warm up.
+        template <typename TRoundTrip>
+        static double TimeRoundTrips(UINT32 iterations, TRoundTrip&& roundTrip)
+        {
+            TB::TimeIterations((iterations / 10) + 1, roundTrip);
+            return (TB::TimeIterations(iterations, roundTrip) * 1e6) / iterations;
+        }
+
+        static std::wstring PacketName(const std::wstring& name, const GUID& id)
+        {
+            wil::unique_cotaskmem_string idString;
+            THROW_IF_FAILED(StringFromCLSID(id, &idString));
+            return name + L"_RedirectionRequest_" + idString.get();
+        }
+
+        static std::wstring UniqueQueueName()
+        {
+            GUID id{};
+            THROW_IF_FAILED(CoCreateGuid(&id));
+            wil::unique_cotaskmem_string idString;
+            THROW_IF_FAILED(StringFromCLSID(id, &idString));
+            return std::wstring(L"RedirectionRequestQueueTests_") + idString.get();
+        }
+
+        static GUID MakeId(UINT32 producer, UINT32 index)
+        {
+            // Never GUID_NULL; Data4 marks it as ours.
+            return GUID{ index, static_cast<USHORT>(producer), 0x4152, { 'R', 'e', 'd', 'i', 'r', 'e', 'c', 't' } };
+        }
+    };
+}
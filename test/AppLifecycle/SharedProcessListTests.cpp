@@ -0,0 +1,209 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <thread>
+
+#include "..\..\dev\AppLifecycle\SharedProcessList.h"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using SharedProcessList = winrt::Microsoft::Windows::AppLifecycle::implementation::SharedProcessList;
+using winrt::Microsoft::Windows::AppLifecycle::implementation::c_maxInstanceCount;
+
+namespace Test::AppLifecycle
+{
+    class SharedProcessListTests
+    {
+    public:
+        BEGIN_TEST_CLASS(SharedProcessListTests)
+            TEST_CLASS_PROPERTY(L"ThreadingModel", L"MTA")
+        END_TEST_CLASS()
+
+        TEST_METHOD(InsertRemove)
+        {
+            const auto name{ UniqueListName() };
+            SharedProcessList list;
+            list.Init(name);
+            SharedProcessList other;
+            other.Init(name);
+            VERIFY_ARE_EQUAL(DWORD{ 0 }, list.Size());
+            VERIFY_IS_TRUE(list.GetProcessIds().empty());
+
+            SetVerifyOutput verifySettings(VerifyOutputSettings::LogOnlyFailures);
+
+            // Fill it through one view; the other sees every entry and can't add a duplicate or one more.
+            for (DWORD index = 1; index <= c_maxInstanceCount; ++index)
+            {
+                list.Insert(index * 4);
+            }
+            VERIFY_ARE_EQUAL(static_cast<DWORD>(c_maxInstanceCount), other.Size());
+            VERIFY_THROWS_SPECIFIC(other.Insert(8), wil::ResultException,
+                [](const wil::ResultException& e) { return e.GetErrorCode() == E_UNEXPECTED; });
+            VERIFY_THROWS_SPECIFIC(other.Insert((c_maxInstanceCount + 1) * 4), wil::ResultException,
+                [](const wil::ResultException& e) { return e.GetErrorCode() == E_OUTOFMEMORY; });
+
+            // Remove every other entry in a batch; removing an unknown or already removed id is a no-op.
+            std::vector<DWORD> odd;
+            for (DWORD index = 1; index <= c_maxInstanceCount; index += 2)
+            {
+                odd.push_back(index * 4);
+            }
+            other.Remove(odd);
+            other.Remove(odd);
+            other.Remove(12345);
+            VERIFY_ARE_EQUAL(static_cast<DWORD>(c_maxInstanceCount / 2), list.Size());
+            const auto processIds{ list.GetProcessIds() };
+            VERIFY_ARE_EQUAL(static_cast<size_t>(c_maxInstanceCount / 2), processIds.size());
+            for (const auto processId : processIds)
+            {
+                VERIFY_ARE_EQUAL(DWORD{ 0 }, (processId / 4) % 2);
+            }
+
+            // Freed slots are reused.
+            for (DWORD index = 1; index <= c_maxInstanceCount; index += 2)
+            {
+                list.Insert((index * 4) + 0x100000);
+            }
+            VERIFY_ARE_EQUAL(static_cast<DWORD>(c_maxInstanceCount), list.Size());
+            other.Remove(list.GetProcessIds());
+            VERIFY_ARE_EQUAL(DWORD{ 0 }, list.Size());
+            VERIFY_IS_TRUE(list.GetProcessIds().empty());
+        }
+
+        TEST_METHOD(ConcurrentInsertRemove)
+        {
+            // Every thread opens its own view, as each instance does, and churns its own ids while
+            // checking they're all visible to enumeration.
+            const auto name{ UniqueListName() };
+            const UINT32 c_threads{ 8 };
+            const UINT32 c_idsPerThread{ 40 };
+            const UINT32 c_rounds{ 2000 };
+            std::atomic<UINT32> missing{};
+            std::vector<std::thread> threads;
+            for (UINT32 thread = 0; thread < c_threads; ++thread)
+            {
+                threads.emplace_back([&name, &missing, thread]()
+                {
+                    SharedProcessList list;
+                    list.Init(name);
+                    for (UINT32 round = 0; round < c_rounds; ++round)
+                    {
+                        std::vector<DWORD> processIds;
+                        for (UINT32 index = 0; index < c_idsPerThread; ++index)
+                        {
+                            const DWORD processId{ ((thread * 0x100000) + (round * c_idsPerThread) + index + 1) * 4 };
+                            list.Insert(processId);
+                            processIds.push_back(processId);
+                        }
+
+                        const auto liveIds{ list.GetProcessIds() };
+                        const std::set<DWORD> live(liveIds.begin(), liveIds.end());
+                        for (const auto processId : processIds)
+                        {
+                            if (live.find(processId) == live.end())
+                            {
+                                ++missing;
+                            }
+                        }
+                        list.Remove(processIds);
+                    }
+                });
+            }
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+
+            SharedProcessList list;
+            list.Init(name);
+            VERIFY_ARE_EQUAL(0u, missing.load());
+            VERIFY_ARE_EQUAL(DWORD{ 0 }, list.Size());
+            VERIFY_IS_TRUE(list.GetProcessIds().empty());
+        }
+
+        TEST_METHOD(TombstonesReclaimed)
+        {
+            const auto name{ UniqueListName() };
+            SharedProcessList list;
+            list.Init(name);
+
+            SetVerifyOutput verifySettings(VerifyOutputSettings::LogOnlyFailures);
+
+            // Churn through many more ids than the index holds, removing them in and against insertion
+            // order. Each removal that ends a run of tombstones clears the run, so nothing is left behind.
+            for (UINT32 round = 0; round < 16; ++round)
+            {
+                std::vector<DWORD> processIds;
+                for (DWORD index = 1; index <= c_maxInstanceCount; ++index)
+                {
+                    processIds.push_back(((round * 0x10000) + index) * 4);
+                    list.Insert(processIds.back());
+                }
+                if (round % 2)
+                {
+                    std::reverse(processIds.begin(), processIds.end());
+                }
+                list.Remove(processIds);
+
+                VERIFY_ARE_EQUAL(DWORD{ 0 }, list.Size());
+                VERIFY_ARE_EQUAL(0u, list.TestIndexEntriesInUse());
+            }
+        }
+
+        TEST_METHOD(AbandonedSlotsReclaimed)
+        {
+            const auto name{ UniqueListName() };
+            SharedProcessList list;
+            list.Init(name);
+
+            // A process that's exited. Holding its handle keeps its process id from being reused.
+            WCHAR commandLine[]{ L"cmd.exe /c exit" };
+            STARTUPINFOW startupInfo{ sizeof(startupInfo) };
+            PROCESS_INFORMATION processInformation{};
+            VERIFY_WIN32_BOOL_SUCCEEDED(CreateProcessW(nullptr, commandLine, nullptr, nullptr, FALSE, CREATE_NO_WINDOW, nullptr, nullptr, &startupInfo, &processInformation));
+            wil::unique_handle process{ processInformation.hProcess };
+            wil::unique_handle thread{ processInformation.hThread };
+            VERIFY_ARE_EQUAL(static_cast<DWORD>(WAIT_OBJECT_0), WaitForSingleObject(process.get(), INFINITE));
+
+            // Fill all but two slots.
+            for (DWORD index = 1; index <= c_maxInstanceCount - 2; ++index)
+            {
+                list.Insert(index * 4);
+            }
+
+            // It died claiming one slot (process id in, bit not yet set) and another died releasing the
+            // other (process id cleared, bit not yet cleared). Neither shows up, nor is counted.
+            list.TestAbandonClaim(c_maxInstanceCount - 2, processInformation.dwProcessId);
+            list.TestAbandonRelease(c_maxInstanceCount - 1);
+            VERIFY_ARE_EQUAL(static_cast<DWORD>(c_maxInstanceCount - 2), list.Size());
+            const auto processIds{ list.GetProcessIds() };
+            VERIFY_ARE_EQUAL(static_cast<size_t>(c_maxInstanceCount - 2), processIds.size());
+            VERIFY_IS_TRUE(std::find(processIds.begin(), processIds.end(), processInformation.dwProcessId) == processIds.end());
+
+            // Both are taken back once everything else is in use.
+            list.Insert((c_maxInstanceCount - 1) * 4);
+            list.Insert(c_maxInstanceCount * 4);
+            VERIFY_ARE_EQUAL(static_cast<DWORD>(c_maxInstanceCount), list.Size());
+            VERIFY_ARE_EQUAL(static_cast<size_t>(c_maxInstanceCount), list.GetProcessIds().size());
+            VERIFY_THROWS_SPECIFIC(list.Insert((c_maxInstanceCount + 1) * 4), wil::ResultException,
+                [](const wil::ResultException& e) { return e.GetErrorCode() == E_OUTOFMEMORY; });
+        }
+
+    private:
+        static std::wstring UniqueListName()
+        {
+            GUID id{};
+            THROW_IF_FAILED(CoCreateGuid(&id));
+            wil::unique_cotaskmem_string idString;
+            THROW_IF_FAILED(StringFromCLSID(id, &idString));
+            return std::wstring(L"SharedProcessListTests_") + idString.get();
+        }
+    };
+}
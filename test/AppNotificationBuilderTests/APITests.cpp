@@ -3,6 +3,10 @@
 
 #include "pch.h"
 
+#include <WindowsAppRuntime.Test.Benchmark.h>
+
+namespace TB = ::Test::Benchmark;
+
 namespace winrt
 {
     using namespace winrt::Microsoft::Windows::AppNotifications::Builder;
@@ -223,6 +227,19 @@ namespace Test::AppNotification::Builder
             VERIFY_ARE_EQUAL(builder.BuildNotification().Payload(), expected);
         }
 
+        TEST_METHOD(AppNotificationBuilderAddTextPropertiesChangedAfterAdd)
+        {
+            auto properties{ winrt::AppNotificationTextProperties().SetLanguage(L"en-US") };
+            auto builder{ winrt::AppNotificationBuilder().AddText(L"first", properties) };
+
+            properties.SetLanguage(L"fr-FR").SetMaxLines(2);
+            builder.AddText(L"second", properties);
+
+            auto expected{ L"<toast><visual><binding template='ToastGeneric'><text lang='en-US'>first</text><text lang='fr-FR' hint-maxLines='2'>second</text></binding></visual></toast>" };
+
+            VERIFY_ARE_EQUAL(builder.BuildNotification().Payload(), expected);
+        }
+
         TEST_METHOD(AppNotificationBuilderAddTextThrows)
         {
             VERIFY_THROWS_HR(winrt::AppNotificationBuilder()
@@ -666,5 +683,168 @@ namespace Test::AppNotification::Builder
             VERIFY_ARE_EQUAL(Decode(LR"(&%3B"%3D'%25<>)"), LR"(&;"='%<>)");
             VERIFY_ARE_EQUAL(Decode(L"%3B%3D%25"), L";=%");
         }
+
+        TEST_METHOD(AppNotificationBuilderEscapeXmlCharactersInAttributes)
+        {
+            auto builder{ winrt::AppNotificationBuilder()
+                .SetInlineImage(winrt::Windows::Foundation::Uri{ L"http://www.microsoft.com/?a=1&b=2" })
+                .AddButton(winrt::AppNotificationButton(L"Don't")
+                    .AddArgument(L"key", L"value")
+                    .SetToolTip(L"<tip>")) };
+            auto expected{ L"<toast><visual><binding template='ToastGeneric'><image src='http://www.microsoft.com/?a=1&amp;b=2'/></binding></visual><actions><action content='Don&apos;t' arguments='key=value' hint-toolTip='&lt;tip&gt;'/></actions></toast>" };
+            VERIFY_ARE_EQUAL(builder.BuildNotification().Payload(), expected);
+        }
+
+        TEST_METHOD(AppNotificationBuilder_Benchmark)
+        {
+            // Build a typical chat toast repeatedly, and the same payload the way the builder used to assemble
+            // it: a formatted fragment per element, concatenated again into the final string.
+            const UINT32 iterations{ TB::GetUIntParameter(L"BuildIterations", 20000) };
+
+            const winrt::hstring c_sender{ L"Andrew" };
+            const winrt::hstring c_message{ L"Are you free for lunch? Let's try the new place on 3rd & Pine" };
+
+            auto buildChatToast = [&]()
+            {
+                return winrt::AppNotificationBuilder()
+                    .AddArgument(L"action", L"openThread")
+                    .AddArgument(L"threadId", L"9218")
+                    .AddText(c_sender)
+                    .AddText(c_message)
+                    .SetAppLogoOverride(c_sampleUri, winrt::AppNotificationImageCrop::Circle)
+                    .AddTextBox(L"textBox", L"Type a reply", L"Reply")
+                    .AddButton(winrt::AppNotificationButton(L"Reply")
+                        .AddArgument(L"action", L"reply")
+                        .SetInputId(L"textBox"))
+                    .BuildNotification();
+            };
+
+            auto legacyChatToast = [&]()
+            {
+                std::vector<std::wstring> textLines;
+                textLines.push_back(wil::str_printf<std::wstring>(L"<text>%ls</text>", EncodeXml(c_sender).c_str()));
+                textLines.push_back(wil::str_printf<std::wstring>(L"<text>%ls</text>", EncodeXml(c_message).c_str()));
+                std::wstring text;
+                for (auto const& line : textLines)
+                {
+                    text.append(line);
+                }
+                auto appLogoOverride{ wil::str_printf<std::wstring>(L"<image placement='appLogoOverride' src='%ls' hint-crop='circle'/>", c_sampleUri.ToString().c_str()) };
+                auto textBox{ wil::str_printf<std::wstring>(L"<input id='%ls' type='text' placeHolderContent='%ls' title='%ls'/>", EncodeXml(L"textBox").c_str(), EncodeXml(L"Type a reply").c_str(), EncodeXml(L"Reply").c_str()) };
+                auto button{ wil::str_printf<std::wstring>(L"<action content='%ls' arguments='%ls'%ls/>", L"Reply", wil::str_printf<std::wstring>(L"%ls=%ls", EncodeArgument(L"action").c_str(), EncodeArgument(L"reply").c_str()).c_str(),
+                    wil::str_printf<std::wstring>(L" hint-inputId='%ls'", EncodeXml(L"textBox").c_str()).c_str()) };
+                auto actions{ wil::str_printf<std::wstring>(L"<actions>%ls%ls</actions>", textBox.c_str(), button.c_str()) };
+                auto launch{ wil::str_printf<std::wstring>(L" launch='%ls=%ls;%ls=%ls'", EncodeArgument(L"action").c_str(), EncodeArgument(L"openThread").c_str(), EncodeArgument(L"threadId").c_str(), EncodeArgument(L"9218").c_str()) };
+                auto xml{ wil::str_printf<std::wstring>(L"<toast%ls><visual><binding template='ToastGeneric'>%ls%ls</binding></visual>%ls</toast>",
+                    launch.c_str(), text.c_str(), appLogoOverride.c_str(), actions.c_str()) };
+                return winrt::Microsoft::Windows::AppNotifications::AppNotification(xml);
+            };
+
+            VERIFY_ARE_EQUAL(buildChatToast().Payload(), legacyChatToast().Payload());
+
+            const auto builderSeconds{ TB::TimeIterations(iterations, buildChatToast) };
+            const auto legacySeconds{ TB::TimeIterations(iterations, legacyChatToast) };
+            WEX::Logging::Log::Comment(WEX::Common::String().Format(L"Chat toast, %u builds", iterations));
+            WEX::Logging::Log::Comment(WEX::Common::String().Format(L"  AppNotificationBuilder: %.2f us/toast", (builderSeconds * 1e6) / iterations));
+            WEX::Logging::Log::Comment(WEX::Common::String().Format(L"  Fragments (previous):   %.2f us/toast", (legacySeconds * 1e6) / iterations));
+        }
+
+        static winrt::AppNotificationBuilder ChatToastBuilder(winrt::hstring const& threadId, winrt::hstring const& sender, winrt::hstring const& message)
+        {
+            return winrt::AppNotificationBuilder()
+                .AddArgument(L"action", L"openThread")
+                .AddArgument(L"threadId", threadId)
+                .AddText(sender)
+                .AddText(message)
+                .SetAppLogoOverride(c_sampleUri, winrt::AppNotificationImageCrop::Circle)
+                .AddTextBox(L"textBox", L"Type a reply", L"Reply")
+                .AddButton(winrt::AppNotificationButton(L"Reply")
+                    .AddArgument(L"action", L"reply")
+                    .AddArgument(L"threadId", threadId)
+                    .SetInputId(L"textBox"))
+                .SetTag(L"chat")
+                .SetGroup(L"messages");
+        }
+
+        static winrt::Windows::Foundation::Collections::IMapView<winrt::hstring, winrt::hstring> ChatToastValues(winrt::hstring const& threadId, winrt::hstring const& sender, winrt::hstring const& message)
+        {
+            auto values{ winrt::single_threaded_map<winrt::hstring, winrt::hstring>() };
+            values.Insert(L"threadId", threadId);
+            values.Insert(L"sender", sender);
+            values.Insert(L"message", message);
+            return values.GetView();
+        }
+
+        TEST_METHOD(AppNotificationTemplateInstantiate)
+        {
+            auto appNotificationTemplate{ ChatToastBuilder(L"{{threadId}}", L"{{sender}}", L"{{message}}").BuildTemplate() };
+
+            auto slotNames{ appNotificationTemplate.SlotNames() };
+            VERIFY_ARE_EQUAL(slotNames.Size(), 3u);
+            VERIFY_ARE_EQUAL(slotNames.GetAt(0), L"threadId");
+            VERIFY_ARE_EQUAL(slotNames.GetAt(1), L"sender");
+            VERIFY_ARE_EQUAL(slotNames.GetAt(2), L"message");
+
+            // Each instance matches a full rebuild with the same values, escaping included
+            const PCWSTR c_values[][3]{
+                { L"9218", L"Andrew", L"Are you free for lunch?" },
+                { L"a=b;c%d", LR"(Tom & "Jerry")", L"<3 it's {{sender}}" },
+                { L"", L"Andrew", L"" },    // an empty argument value is written as a bare key
+            };
+            for (auto const& value : c_values)
+            {
+                auto appNotification{ appNotificationTemplate.Instantiate(ChatToastValues(value[0], value[1], value[2])) };
+                auto expected{ ChatToastBuilder(value[0], value[1], value[2]).BuildNotification() };
+                VERIFY_ARE_EQUAL(appNotification.Payload(), expected.Payload());
+                VERIFY_ARE_EQUAL(appNotification.Tag(), L"chat");
+                VERIFY_ARE_EQUAL(appNotification.Group(), L"messages");
+            }
+        }
+
+        TEST_METHOD(AppNotificationTemplateWithoutSlots)
+        {
+            auto appNotificationTemplate{ winrt::AppNotificationBuilder().AddText(L"{text} {{}} {{not a slot}}").BuildTemplate() };
+            VERIFY_ARE_EQUAL(appNotificationTemplate.SlotNames().Size(), 0u);
+            VERIFY_ARE_EQUAL(appNotificationTemplate.Instantiate(winrt::single_threaded_map<winrt::hstring, winrt::hstring>().GetView()).Payload(),
+                L"<toast><visual><binding template='ToastGeneric'><text>{text} {{}} {{not a slot}}</text></binding></visual></toast>");
+        }
+
+        TEST_METHOD(AppNotificationTemplateMissingSlotValue)
+        {
+            auto appNotificationTemplate{ winrt::AppNotificationBuilder().AddText(L"{{sender}}").AddText(L"{{message}}").BuildTemplate() };
+
+            auto values{ winrt::single_threaded_map<winrt::hstring, winrt::hstring>() };
+            values.Insert(L"sender", L"Andrew");
+            VERIFY_THROWS_HR(appNotificationTemplate.Instantiate(values.GetView()), E_INVALIDARG);
+        }
+
+        TEST_METHOD(AppNotificationTemplateInstanceTooLarge)
+        {
+            auto appNotificationTemplate{ winrt::AppNotificationBuilder().AddText(L"{{text}}").BuildTemplate() };
+
+            auto values{ winrt::single_threaded_map<winrt::hstring, winrt::hstring>() };
+            values.Insert(L"text", winrt::hstring{ std::wstring(5120, L'&') });
+            VERIFY_THROWS_HR(appNotificationTemplate.Instantiate(values.GetView()), E_FAIL);
+        }
+
+        TEST_METHOD(AppNotificationTemplate_Benchmark)
+        {
+            // Post the chat toast with a new message each time: instantiate a template vs. rebuild from scratch.
+            const UINT32 iterations{ TB::GetUIntParameter(L"BuildIterations", 20000) };
+
+            const winrt::hstring c_threadId{ L"9218" };
+            const winrt::hstring c_sender{ L"Andrew" };
+            const winrt::hstring c_message{ L"Are you free for lunch? Let's try the new place on 3rd & Pine" };
+
+            auto appNotificationTemplate{ ChatToastBuilder(L"{{threadId}}", L"{{sender}}", L"{{message}}").BuildTemplate() };
+            auto values{ ChatToastValues(c_threadId, c_sender, c_message) };
+            VERIFY_ARE_EQUAL(appNotificationTemplate.Instantiate(values).Payload(), ChatToastBuilder(c_threadId, c_sender, c_message).BuildNotification().Payload());
+
+            const auto templateSeconds{ TB::TimeIterations(iterations, [&]() { return appNotificationTemplate.Instantiate(values); }) };
+            const auto builderSeconds{ TB::TimeIterations(iterations, [&]() { return ChatToastBuilder(c_threadId, c_sender, c_message).BuildNotification(); }) };
+            WEX::Logging::Log::Comment(WEX::Common::String().Format(L"Chat toast, %u notifications", iterations));
+            WEX::Logging::Log::Comment(WEX::Common::String().Format(L"  AppNotificationTemplate.Instantiate: %.2f us/toast", (templateSeconds * 1e6) / iterations));
+            WEX::Logging::Log::Comment(WEX::Common::String().Format(L"  AppNotificationBuilder (rebuild):    %.2f us/toast", (builderSeconds * 1e6) / iterations));
+        }
     };
 }
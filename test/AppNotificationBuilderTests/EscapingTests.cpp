@@ -0,0 +1,157 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+#include <random>
+#include <unordered_map>
+
+namespace Test::AppNotification::Builder
+{
+    // The map-based implementations the escaping engine replaced, kept as the reference it must match byte-for-byte.
+    namespace Reference
+    {
+        inline std::wstring EncodeArgument(std::wstring const& value)
+        {
+            const std::unordered_map<wchar_t, std::wstring> percentEncodings{ { L'%', L"%25" }, { L';', L"%3B" }, { L'=', L"%3D" } };
+            const std::unordered_map<wchar_t, std::wstring> xmlEncodings{ { L'&', L"&amp;" }, { L'\"', L"&quot;" }, { L'<', L"&lt;" }, { L'>', L"&gt;" }, { L'\'', L"&apos;" } };
+
+            std::wstring encodedValue{};
+            for (auto ch : value)
+            {
+                if (percentEncodings.find(ch) != percentEncodings.end())
+                {
+                    encodedValue.append(percentEncodings.at(ch));
+                }
+                else if (xmlEncodings.find(ch) != xmlEncodings.end())
+                {
+                    encodedValue.append(xmlEncodings.at(ch));
+                }
+                else
+                {
+                    encodedValue.push_back(ch);
+                }
+            }
+            return encodedValue;
+        }
+
+        inline std::wstring EncodeXml(std::wstring const& value)
+        {
+            const std::unordered_map<wchar_t, std::wstring> xmlEncodings{ { L'&', L"&amp;" }, { L'\"', L"&quot;" }, { L'<', L"&lt;" }, { L'>', L"&gt;" }, { L'\'', L"&apos;" } };
+
+            std::wstring encodedValue{};
+            for (auto ch : value)
+            {
+                if (xmlEncodings.find(ch) != xmlEncodings.end())
+                {
+                    encodedValue.append(xmlEncodings.at(ch));
+                }
+                else
+                {
+                    encodedValue.push_back(ch);
+                }
+            }
+            return encodedValue;
+        }
+
+        inline std::wstring Decode(std::wstring const& value)
+        {
+            const std::unordered_map<std::wstring, wchar_t> percentEncodings{ { L"%25", L'%' }, { L"%3B", L';' }, { L"%3D", L'=' } };
+
+            std::wstring result{};
+            for (size_t index = 0; index < value.size();)
+            {
+                std::wstring curr{ value.substr(index, 3) };
+                if (percentEncodings.find(curr) != percentEncodings.end())
+                {
+                    result.push_back(percentEncodings.at(curr));
+                    index += 3;
+                }
+                else
+                {
+                    result.push_back(value.at(index));
+                    index++;
+                }
+            }
+            return result;
+        }
+    }
+
+    class EscapingTests
+    {
+    public:
+        BEGIN_TEST_CLASS(EscapingTests)
+            TEST_CLASS_PROPERTY(L"ThreadingModel", L"MTA")
+        END_TEST_CLASS()
+
+        TEST_METHOD(EscapeTables)
+        {
+            for (wchar_t ch = 0; ch < AppNotificationEscaping::c_tableSize; ++ch)
+            {
+                const std::wstring value(1, ch);
+                VERIFY_ARE_EQUAL(EncodeXml(winrt::hstring{ value }), Reference::EncodeXml(value));
+                VERIFY_ARE_EQUAL(EncodeArgument(value), Reference::EncodeArgument(value));
+            }
+
+            // Characters outside the table, including ones whose low byte collides with a special character
+            for (wchar_t ch : { L'\x80', L'\xff', L'\x0126', L'\x2026', L'\x3C3C', L'\xD83D', L'\xDE00', L'\xFFFF' })
+            {
+                const std::wstring value(1, ch);
+                VERIFY_ARE_EQUAL(EncodeXml(winrt::hstring{ value }), value);
+                VERIFY_ARE_EQUAL(EncodeArgument(value), value);
+            }
+        }
+
+        TEST_METHOD(ExactEncodedLength)
+        {
+            for (auto value : { L"", L"plain", L"&\"<>'", L"%;=", L"0123456789abcdef&", L"&0123456789abcdef", L"a=b;c%d&e<f>g'h\"i" })
+            {
+                VERIFY_ARE_EQUAL(AppNotificationEscaping::EncodedLength(value, AppNotificationEscaping::c_xmlEscapes), Reference::EncodeXml(value).size());
+                VERIFY_ARE_EQUAL(AppNotificationEscaping::EncodedLength(value, AppNotificationEscaping::c_argumentEscapes), Reference::EncodeArgument(value).size());
+            }
+        }
+
+        TEST_METHOD(DecodePartialSequences)
+        {
+            for (auto value : { L"%", L"%2", L"%3", L"%%", L"%%25", L"%253B", L"%3b%3d", L"%25%", L"a%3", L"%3B%3", L"%%%3D" })
+            {
+                VERIFY_ARE_EQUAL(Decode(value), Reference::Decode(value));
+            }
+        }
+
+        // Random strings drawn mostly from the characters the encoders care about (plus digits and letters
+        // that form partial percent sequences) and non-ASCII text, at lengths straddling the 8-character vector width.
+        TEST_METHOD(FuzzEquivalence)
+        {
+            const wchar_t c_alphabet[]{ L'&', L'"', L'<', L'>', L'\'', L'%', L';', L'=', L'2', L'3', L'5', L'B', L'D', L'b', L'd', L'a', L' ', L'\x00e9', L'\x263A', L'\xD83D', L'\xDE00', L'\x2626', L'\x3C00', L'\0' };
+            std::mt19937 random{ 20231017 };
+            std::uniform_int_distribution<size_t> lengthDistribution{ 0, 40 };
+            std::uniform_int_distribution<size_t> alphabetDistribution{ 0, ARRAYSIZE(c_alphabet) - 1 };
+            std::uniform_int_distribution<size_t> plainRunDistribution{ 0, 3 };
+
+            const uint32_t c_iterations{ 20000 };
+            for (uint32_t iteration = 0; iteration < c_iterations; ++iteration)
+            {
+                std::wstring value;
+                const auto length{ lengthDistribution(random) };
+                while (value.size() < length)
+                {
+                    // Favor long clean runs now and then so the vector scan skips whole blocks
+                    if (plainRunDistribution(random) == 0)
+                    {
+                        value.append(lengthDistribution(random), L'x');
+                    }
+                    value.push_back(c_alphabet[alphabetDistribution(random)]);
+                }
+
+                const auto encodedXml{ EncodeXml(winrt::hstring{ value }) };
+                VERIFY_ARE_EQUAL(encodedXml, Reference::EncodeXml(value));
+
+                const auto encodedArgument{ EncodeArgument(value) };
+                VERIFY_ARE_EQUAL(encodedArgument, Reference::EncodeArgument(value));
+
+                VERIFY_ARE_EQUAL(Decode(value), Reference::Decode(value));
+                VERIFY_ARE_EQUAL(Decode(encodedArgument), Reference::Decode(encodedArgument));
+            }
+        }
+    };
+}
@@ -256,6 +256,34 @@ void BaseTestSuite::VerifyFailedUpdateNotificationDataWithoutPostToast()
     ProgressResultOperationHelper(progressResultOperation, winrt::AppNotificationProgressResult::AppNotificationNotFound);
 }
 
+void BaseTestSuite::VerifyCoalescedProgressUpdatesSurviveCancelledCaller()
+{
+    RegisterWithAppNotificationManager();
+    PostToastHelper(L"Tag", L"Group");
+
+    auto appNotificationManager{ AppNotificationManager::Default() };
+    const auto previousInterval{ appNotificationManager.ProgressUpdateInterval() };
+    auto restoreInterval = wil::scope_exit(
+    [&] {
+        appNotificationManager.ProgressUpdateInterval(previousInterval);
+    });
+    appNotificationManager.ProgressUpdateInterval(std::chrono::milliseconds(200));
+
+    // The 1st update is applied right away; the next two land within the interval and are coalesced
+    auto firstOperation{ appNotificationManager.UpdateAsync(GetToastProgressData(L"Status", L"Title", 0.10, L"10%", 1), L"Tag", L"Group") };
+    ProgressResultOperationHelper(firstOperation, winrt::AppNotificationProgressResult::Succeeded);
+
+    // Whichever of these opens the window, cancelling one mustn't strand the other...
+    auto cancelledOperation{ appNotificationManager.UpdateAsync(GetToastProgressData(L"Status", L"Title", 0.20, L"20%", 2), L"Tag", L"Group") };
+    auto coalescedOperation{ appNotificationManager.UpdateAsync(GetToastProgressData(L"Status", L"Title", 0.30, L"30%", 3), L"Tag", L"Group") };
+    cancelledOperation.Cancel();
+    ProgressResultOperationHelper(coalescedOperation, winrt::AppNotificationProgressResult::Succeeded);
+
+    // ...or later updates for the same tag and group
+    auto laterOperation{ appNotificationManager.UpdateAsync(GetToastProgressData(L"Status", L"Title", 0.40, L"40%", 4), L"Tag", L"Group") };
+    ProgressResultOperationHelper(laterOperation, winrt::AppNotificationProgressResult::Succeeded);
+}
+
 void BaseTestSuite::VerifyGetAllAsyncWithZeroActiveToast()
 {
     auto retrieveNotificationsAsync{ AppNotificationManager::Default().GetAllAsync() };
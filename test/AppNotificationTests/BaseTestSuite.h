@@ -33,6 +33,7 @@ class BaseTestSuite
         void VerifyUpdateToastProgressDataUsingEmptyTagAndEmptyGroup();
         void VerifyFailedUpdateNotificationDataWithNonExistentTagAndGroup();
         void VerifyFailedUpdateNotificationDataWithoutPostToast();
+        void VerifyCoalescedProgressUpdatesSurviveCancelledCaller();
         void VerifyGetAllAsyncWithZeroActiveToast();
         void VerifyGetAllAsyncWithOneActiveToast();
         void VerifyGetAllAsyncWithMultipleActiveToasts();
@@ -103,6 +103,11 @@ void PackagedTests::VerifyFailedUpdateNotificationDataWithoutPostToast()
     BaseTestSuite::VerifyFailedUpdateNotificationDataWithoutPostToast();
 }
 
+void PackagedTests::VerifyCoalescedProgressUpdatesSurviveCancelledCaller()
+{
+    BaseTestSuite::VerifyCoalescedProgressUpdatesSurviveCancelledCaller();
+}
+
 void PackagedTests::VerifyGetAllAsyncWithZeroActiveToast()
 {
     BaseTestSuite::VerifyGetAllAsyncWithZeroActiveToast();
@@ -0,0 +1,182 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "..\..\dev\AppNotifications\ProgressUpdateCoalescer.h"
+
+using namespace std::chrono_literals;
+
+namespace Test::AppNotifications
+{
+    // Updates are represented by their sequence number and callers by an id; time comes from a fake clock.
+    using Coalescer = ::Microsoft::Windows::AppNotifications::Helpers::ProgressUpdateCoalescer<uint32_t, int>;
+
+    class ProgressUpdateCoalescerTests
+    {
+    public:
+        BEGIN_TEST_CLASS(ProgressUpdateCoalescerTests)
+            TEST_CLASS_PROPERTY(L"ThreadingModel", L"MTA")
+        END_TEST_CLASS()
+
+        TEST_METHOD(FirstUpdateIsDueImmediately)
+        {
+            Coalescer coalescer{ 100ms };
+            const auto due{ coalescer.Submit(c_key, 1, 1, 1, At(0ms)) };
+            VERIFY_IS_TRUE(due.has_value());
+            VERIFY_IS_TRUE(*due == At(0ms));
+
+            const auto flushes{ coalescer.TakeDue(At(0ms)) };
+            VERIFY_ARE_EQUAL(flushes.size(), 1u);
+            VERIFY_IS_TRUE(flushes[0].key == c_key);
+            VERIFY_ARE_EQUAL(flushes[0].update, 1u);
+            VERIFY_IS_TRUE(flushes[0].waiters == std::vector<int>{ 1 });
+        }
+
+        TEST_METHOD(UpdatesWithinIntervalAreCoalesced)
+        {
+            Coalescer coalescer{ 100ms };
+            coalescer.Submit(c_key, 1, 1, 1, At(0ms));
+            coalescer.TakeDue(At(0ms));
+
+            // The next update waits for the interval; later ones join it and only the newest sequence is kept
+            const auto due{ coalescer.Submit(c_key, 3, 3, 2, At(10ms)) };
+            VERIFY_IS_TRUE(due.has_value());
+            VERIFY_IS_TRUE(*due == At(100ms));
+            VERIFY_IS_FALSE(coalescer.Submit(c_key, 5, 5, 3, At(20ms)).has_value());
+            VERIFY_IS_FALSE(coalescer.Submit(c_key, 4, 4, 4, At(30ms)).has_value());
+
+            VERIFY_ARE_EQUAL(coalescer.TakeDue(At(99ms)).size(), 0u);
+
+            const auto flushes{ coalescer.TakeDue(At(100ms)) };
+            VERIFY_ARE_EQUAL(flushes.size(), 1u);
+            VERIFY_ARE_EQUAL(flushes[0].update, 5u);
+            VERIFY_IS_TRUE(flushes[0].waiters == (std::vector<int>{ 2, 3, 4 }));
+        }
+
+        TEST_METHOD(FlushRateIsLimited)
+        {
+            // A steady stream of updates every 5ms is applied at most once per 50ms
+            Coalescer coalescer{ 50ms };
+            uint32_t flushCount{};
+            uint32_t lastApplied{};
+            std::optional<Coalescer::Clock::time_point> nextDue;
+            for (uint32_t sequenceNumber = 1; sequenceNumber <= 200; ++sequenceNumber)
+            {
+                const auto now{ At(sequenceNumber * 5ms) };
+                if (nextDue && (*nextDue <= now))
+                {
+                    for (auto const& flush : coalescer.TakeDue(*nextDue))
+                    {
+                        VERIFY_IS_GREATER_THAN(flush.update, lastApplied);
+                        lastApplied = flush.update;
+                        ++flushCount;
+                    }
+                    nextDue.reset();
+                }
+
+                if (auto due{ coalescer.Submit(c_key, sequenceNumber, sequenceNumber, static_cast<int>(sequenceNumber), now) })
+                {
+                    nextDue = due;
+                }
+            }
+            for (auto const& flush : coalescer.TakeDue(*nextDue))
+            {
+                lastApplied = flush.update;
+                ++flushCount;
+            }
+
+            // 200 updates from 5ms to 1000ms are applied at 5ms, 55ms, ..., 955ms and 1005ms
+            VERIFY_ARE_EQUAL(flushCount, 21u);
+            VERIFY_ARE_EQUAL(lastApplied, 200u);
+        }
+
+        TEST_METHOD(KeysAreIndependent)
+        {
+            Coalescer coalescer{ 100ms };
+            const Coalescer::Key c_groupedKey{ L"download", L"files" };
+            const Coalescer::Key c_otherKey{ L"upload", L"" };
+
+            VERIFY_IS_TRUE(*coalescer.Submit(c_key, 1, 1, 1, At(0ms)) == At(0ms));
+            VERIFY_IS_TRUE(*coalescer.Submit(c_groupedKey, 1, 1, 2, At(0ms)) == At(0ms));
+            VERIFY_IS_TRUE(*coalescer.Submit(c_otherKey, 1, 1, 3, At(0ms)) == At(0ms));
+            VERIFY_ARE_EQUAL(coalescer.TakeDue(At(0ms)).size(), 3u);
+
+            VERIFY_IS_TRUE(*coalescer.Submit(c_groupedKey, 2, 2, 4, At(10ms)) == At(100ms));
+            VERIFY_IS_TRUE(*coalescer.Submit(c_key, 2, 2, 5, At(60ms)) == At(100ms));
+
+            const auto flushes{ coalescer.TakeDue(At(100ms)) };
+            VERIFY_ARE_EQUAL(flushes.size(), 2u);
+        }
+
+        TEST_METHOD(NextDueIsEarliestPending)
+        {
+            Coalescer coalescer{ 100ms };
+            const Coalescer::Key c_otherKey{ L"upload", L"" };
+            VERIFY_IS_FALSE(coalescer.NextDue().has_value());
+
+            coalescer.Submit(c_key, 1, 1, 1, At(0ms));
+            coalescer.TakeDue(At(0ms));
+            coalescer.Submit(c_otherKey, 1, 1, 2, At(20ms));
+            coalescer.TakeDue(At(20ms));
+            VERIFY_IS_FALSE(coalescer.NextDue().has_value());
+
+            coalescer.Submit(c_otherKey, 2, 2, 3, At(30ms));
+            coalescer.Submit(c_key, 2, 2, 4, At(50ms));
+            VERIFY_IS_TRUE(*coalescer.NextDue() == At(100ms));
+
+            // Taking one leaves the other's due time; taking both leaves nothing
+            VERIFY_ARE_EQUAL(coalescer.TakeDue(At(100ms)).size(), 1u);
+            VERIFY_IS_TRUE(*coalescer.NextDue() == At(120ms));
+            VERIFY_ARE_EQUAL(coalescer.TakeDue(At(120ms)).size(), 1u);
+            VERIFY_IS_FALSE(coalescer.NextDue().has_value());
+        }
+
+        TEST_METHOD(IdleKeysAreForgotten)
+        {
+            Coalescer coalescer{ 100ms };
+            coalescer.Submit(c_key, 1, 1, 1, At(0ms));
+            coalescer.TakeDue(At(0ms));
+            VERIFY_ARE_EQUAL(coalescer.Size(), 1u);
+
+            VERIFY_ARE_EQUAL(coalescer.TakeDue(At(99ms)).size(), 0u);
+            VERIFY_ARE_EQUAL(coalescer.Size(), 1u);
+            VERIFY_ARE_EQUAL(coalescer.TakeDue(At(100ms)).size(), 0u);
+            VERIFY_ARE_EQUAL(coalescer.Size(), 0u);
+
+            // After a full interval the next update is due immediately
+            VERIFY_IS_TRUE(*coalescer.Submit(c_key, 2, 2, 2, At(250ms)) == At(250ms));
+        }
+
+        TEST_METHOD(ZeroIntervalIsAlwaysDue)
+        {
+            Coalescer coalescer;
+            for (uint32_t sequenceNumber = 1; sequenceNumber <= 3; ++sequenceNumber)
+            {
+                VERIFY_IS_TRUE(*coalescer.Submit(c_key, sequenceNumber, sequenceNumber, 0, At(1ms)) == At(1ms));
+                VERIFY_ARE_EQUAL(coalescer.TakeDue(At(1ms)).size(), 1u);
+            }
+        }
+
+        TEST_METHOD(IntervalChangeAppliesToNewUpdates)
+        {
+            Coalescer coalescer{ 100ms };
+            coalescer.Submit(c_key, 1, 1, 1, At(0ms));
+            coalescer.TakeDue(At(0ms));
+            VERIFY_IS_TRUE(*coalescer.Submit(c_key, 2, 2, 2, At(10ms)) == At(100ms));
+
+            coalescer.Interval(20ms);
+            VERIFY_ARE_EQUAL(coalescer.TakeDue(At(50ms)).size(), 0u);
+            VERIFY_ARE_EQUAL(coalescer.TakeDue(At(100ms)).size(), 1u);
+            VERIFY_IS_TRUE(*coalescer.Submit(c_key, 3, 3, 3, At(110ms)) == At(120ms));
+        }
+
+    private:
+        static Coalescer::Clock::time_point At(Coalescer::Clock::duration offset)
+        {
+            return Coalescer::Clock::time_point{} + offset;
+        }
+
+        inline static const Coalescer::Key c_key{ L"download", L"" };
+    };
+}
@@ -103,6 +103,11 @@ void UnpackagedTests::VerifyFailedUpdateNotificationDataWithoutPostToast()
     BaseTestSuite::VerifyFailedUpdateNotificationDataWithoutPostToast();
 }
 
+void UnpackagedTests::VerifyCoalescedProgressUpdatesSurviveCancelledCaller()
+{
+    BaseTestSuite::VerifyCoalescedProgressUpdatesSurviveCancelledCaller();
+}
+
 void UnpackagedTests::VerifyGetAllAsyncWithZeroActiveToast()
 {
     BaseTestSuite::VerifyGetAllAsyncWithZeroActiveToast();
@@ -62,6 +62,7 @@ class UnpackagedTests : BaseTestSuite
     TEST_METHOD(VerifyUpdateToastProgressDataUsingEmptyTagAndEmptyGroup);
     TEST_METHOD(VerifyFailedUpdateNotificationDataWithNonExistentTagAndGroup);
     TEST_METHOD(VerifyFailedUpdateNotificationDataWithoutPostToast);
+    TEST_METHOD(VerifyCoalescedProgressUpdatesSurviveCancelledCaller);
     TEST_METHOD(VerifyGetAllAsyncWithZeroActiveToast);
     TEST_METHOD(VerifyGetAllAsyncWithOneActiveToast);
     TEST_METHOD(VerifyGetAllAsyncWithMultipleActiveToasts);
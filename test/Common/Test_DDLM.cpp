@@ -0,0 +1,176 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+namespace DDLM = ::WindowsAppRuntime::DDLM;
+
+using winrt::Windows::System::ProcessorArchitecture;
+
+namespace Test::Common
+{
+    class DDLMTests
+    {
+    public:
+        BEGIN_TEST_CLASS(DDLMTests)
+        END_TEST_CLASS()
+
+        TEST_METHOD(ParseAppExtensionId)
+        {
+            PACKAGE_VERSION version{};
+            auto architecture{ ProcessorArchitecture::Unknown };
+            VERIFY_IS_TRUE(DDLM::ParseAppExtensionId(L"ddlm-1.2.3.4-x64", version, architecture));
+            VERIFY_ARE_EQUAL(MakeVersion(1, 2, 3, 4).Version, version.Version);
+            VERIFY_IS_TRUE(architecture == ProcessorArchitecture::X64);
+
+            VERIFY_IS_TRUE(DDLM::ParseAppExtensionId(L"ddlm-65535.0.65535.0-arm64", version, architecture));
+            VERIFY_ARE_EQUAL(MakeVersion(65535, 0, 65535, 0).Version, version.Version);
+            VERIFY_IS_TRUE(architecture == ProcessorArchitecture::Arm64);
+
+            VERIFY_IS_TRUE(DDLM::ParseAppExtensionId(L"ddlm-1.2.3.4-sparc", version, architecture));
+            VERIFY_IS_TRUE(architecture == ProcessorArchitecture::Unknown);
+        }
+
+        TEST_METHOD(ParseAppExtensionId_Invalid)
+        {
+            PCWSTR c_invalidIds[]{
+                L"",
+                L"ddlm-",
+                L"ddlm-1.2.3.4",
+                L"ddlm-1.2.3.4-",
+                L"ddlm-1.2.3-x64",
+                L"ddlm-1.2.3.-x64",
+                L"ddlm-1..3.4-x64",
+                L"ddlm-1.2.3.65536-x64",
+                L"ddlm-1.2.3.4-abcdefghij",
+                L"DDLM-1.2.3.4-x64",
+                L"ddlm.1.2.3.4-x64",
+                L"ddlm--1.2.3.4-x64",
+            };
+            for (auto id : c_invalidIds)
+            {
+                PACKAGE_VERSION version{ MakeVersion(9, 9, 9, 9) };
+                auto architecture{ ProcessorArchitecture::Neutral };
+                VERIFY_IS_FALSE(DDLM::ParseAppExtensionId(id, version, architecture), id);
+                VERIFY_ARE_EQUAL(MakeVersion(9, 9, 9, 9).Version, version.Version, id);
+                VERIFY_IS_TRUE(architecture == ProcessorArchitecture::Neutral, id);
+            }
+        }
+
+        TEST_METHOD(ParseReleaseFilename)
+        {
+            UINT16 majorVersion{};
+            UINT16 minorVersion{};
+            VERIFY_IS_TRUE(DDLM::ParseReleaseFilename(L"Microsoft.WindowsAppRuntime.Release!1.2", majorVersion, minorVersion));
+            VERIFY_ARE_EQUAL(1u, static_cast<UINT32>(majorVersion));
+            VERIFY_ARE_EQUAL(2u, static_cast<UINT32>(minorVersion));
+
+            VERIFY_IS_TRUE(DDLM::ParseReleaseFilename(L"microsoft.windowsappruntime.release!0.319", majorVersion, minorVersion));
+            VERIFY_ARE_EQUAL(0u, static_cast<UINT32>(majorVersion));
+            VERIFY_ARE_EQUAL(319u, static_cast<UINT32>(minorVersion));
+
+            VERIFY_IS_FALSE(DDLM::ParseReleaseFilename(L"Microsoft.WindowsAppRuntime.Release!", majorVersion, minorVersion));
+            VERIFY_IS_FALSE(DDLM::ParseReleaseFilename(L"Microsoft.WindowsAppRuntime.Release!1", majorVersion, minorVersion));
+            VERIFY_IS_FALSE(DDLM::ParseReleaseFilename(L"Microsoft.WindowsAppRuntime.Release!1.", majorVersion, minorVersion));
+            VERIFY_IS_FALSE(DDLM::ParseReleaseFilename(L"Microsoft.WindowsAppRuntime.Releases!1.2", majorVersion, minorVersion));
+            VERIFY_IS_FALSE(DDLM::ParseReleaseFilename(L"Microsoft", majorVersion, minorVersion));
+        }
+
+        TEST_METHOD(IsPackageNameMatch)
+        {
+            PCWSTR c_prefix{ L"microsoft.winappruntime.ddlm." };
+            const auto c_prefixLength{ wcslen(c_prefix) };
+            VERIFY_IS_TRUE(IsPackageNameMatch(L"Microsoft.WinAppRuntime.DDLM.4000.x64", c_prefix, c_prefixLength, L"", 0));
+            VERIFY_IS_TRUE(IsPackageNameMatch(L"Microsoft.WinAppRuntime.DDLM.4000.x64-p1", c_prefix, c_prefixLength, L"-p1", 3));
+            VERIFY_IS_FALSE(IsPackageNameMatch(L"Microsoft.WinAppRuntime.DDLM.4000.x64", c_prefix, c_prefixLength, L"-p1", 3));
+            VERIFY_IS_FALSE(IsPackageNameMatch(L"Microsoft.WinAppRuntime.4000.x64", c_prefix, c_prefixLength, L"", 0));
+            VERIFY_IS_FALSE(IsPackageNameMatch(L"Microsoft.WinAppRuntime.DDLM", c_prefix, c_prefixLength, L"", 0));
+            VERIFY_IS_FALSE(IsPackageNameMatch(L"Microsoft.WinAppRuntime.DDLM-p1", c_prefix, c_prefixLength, L"-p1", 3));
+        }
+
+        TEST_METHOD(FindBestFit)
+        {
+            const auto c_architecture{ ProcessorArchitecture::X64 };
+            const std::vector<DDLM::Candidate> candidates{
+                MakeCandidate(MakeVersion(1, 0, 0, 0), ProcessorArchitecture::X64, 0),
+                MakeCandidate(MakeVersion(3, 0, 0, 0), ProcessorArchitecture::X86, 1),
+                MakeCandidate(MakeVersion(2, 0, 0, 0), ProcessorArchitecture::X64, 2),
+                MakeCandidate(MakeVersion(2, 0, 0, 0), ProcessorArchitecture::X64, 3),
+                MakeCandidate(MakeVersion(1, 5, 0, 0), ProcessorArchitecture::X64, 4),
+            };
+
+            // Highest applicable version wins, the earliest of equals
+            auto bestFit{ DDLM::FindBestFit(candidates, MakeVersion(0, 0, 0, 0), c_architecture) };
+            VERIFY_IS_NOT_NULL(bestFit);
+            VERIFY_ARE_EQUAL(2u, bestFit->index);
+
+            // The architecture must match
+            bestFit = DDLM::FindBestFit(candidates, MakeVersion(0, 0, 0, 0), ProcessorArchitecture::X86);
+            VERIFY_IS_NOT_NULL(bestFit);
+            VERIFY_ARE_EQUAL(1u, bestFit->index);
+
+            // MinVersion is inclusive
+            bestFit = DDLM::FindBestFit(candidates, MakeVersion(2, 0, 0, 0), c_architecture);
+            VERIFY_IS_NOT_NULL(bestFit);
+            VERIFY_ARE_EQUAL(2u, bestFit->index);
+
+            VERIFY_IS_NULL(DDLM::FindBestFit(candidates, MakeVersion(2, 0, 0, 1), c_architecture));
+            VERIFY_IS_NULL(DDLM::FindBestFit(candidates, MakeVersion(0, 0, 0, 0), ProcessorArchitecture::Arm64));
+            VERIFY_IS_NULL(DDLM::FindBestFit(std::vector<DDLM::Candidate>{}, MakeVersion(0, 0, 0, 0), c_architecture));
+        }
+
+        TEST_METHOD(SelectApplicable)
+        {
+            const auto c_architecture{ ProcessorArchitecture::X64 };
+            std::vector<DDLM::Candidate> candidates{
+                MakeCandidate(MakeVersion(1, 0, 0, 0), ProcessorArchitecture::X64, 0),
+                MakeCandidate(MakeVersion(3, 0, 0, 0), ProcessorArchitecture::X86, 1),
+                MakeCandidate(MakeVersion(2, 0, 0, 0), ProcessorArchitecture::X64, 2),
+                MakeCandidate(MakeVersion(2, 0, 0, 0), ProcessorArchitecture::X64, 3),
+                MakeCandidate(MakeVersion(1, 5, 0, 0), ProcessorArchitecture::X64, 4),
+                MakeCandidate(MakeVersion(0, 9, 0, 0), ProcessorArchitecture::X64, 5),
+            };
+
+            // The head of the list is the FindBestFit answer, the rest follow in the order to try them
+            const auto bestFit{ DDLM::FindBestFit(candidates, MakeVersion(1, 0, 0, 0), c_architecture) };
+            VERIFY_IS_NOT_NULL(bestFit);
+            const auto bestFitIndex{ bestFit->index };
+            DDLM::SelectApplicable(candidates, MakeVersion(1, 0, 0, 0), c_architecture);
+            const UINT32 c_expected[]{ 2, 3, 4, 0 };
+            VERIFY_ARE_EQUAL(ARRAYSIZE(c_expected), candidates.size());
+            for (size_t index = 0; index < ARRAYSIZE(c_expected); ++index)
+            {
+                VERIFY_ARE_EQUAL(c_expected[index], candidates[index].index);
+            }
+            VERIFY_ARE_EQUAL(bestFitIndex, candidates[0].index);
+
+            DDLM::SelectApplicable(candidates, MakeVersion(9, 0, 0, 0), c_architecture);
+            VERIFY_IS_TRUE(candidates.empty());
+        }
+
+    private:
+        static PACKAGE_VERSION MakeVersion(UINT16 major, UINT16 minor, UINT16 build, UINT16 revision)
+        {
+            PACKAGE_VERSION version{};
+            version.Major = major;
+            version.Minor = minor;
+            version.Build = build;
+            version.Revision = revision;
+            return version;
+        }
+
+        static DDLM::Candidate MakeCandidate(PACKAGE_VERSION version, ProcessorArchitecture architecture, UINT32 index)
+        {
+            DDLM::Candidate candidate{};
+            candidate.version = version;
+            candidate.architecture = architecture;
+            candidate.index = index;
+            return candidate;
+        }
+
+        static bool IsPackageNameMatch(PCWSTR name, PCWSTR prefix, size_t prefixLength, PCWSTR suffix, size_t suffixLength)
+        {
+            return DDLM::IsPackageNameMatch(name, wcslen(name), prefix, prefixLength, suffix, suffixLength);
+        }
+    };
+}
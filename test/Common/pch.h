@@ -37,8 +37,10 @@
 
 #include <WexTestClass.h>
 
+#include <AppModel.Identity.h>
 #include <Microsoft.Utf8.h>
 #include <Security.User.h>
+#include <WindowsAppRuntime.DDLM.h>
 #include <WindowsAppRuntime.SelfContained.h>
 #include <WindowsAppRuntime.VersionInfo.h>
 
@@ -0,0 +1,265 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "DetoursFixtures.h"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+// Binary editing tests.
+//
+// Each test opens a copy of a system DLL with DetourBinaryOpen, edits it, writes it with
+// DetourBinaryWrite, and reopens the result to check the imports, payloads, and sections. The
+// golden test instead edits the image from BuildImportFixture and compares the output with what
+// CImage::Write produced before the write plan.
+
+namespace Test::Detours
+{
+    // {2f5d0c7e-4b8a-4d53-9e57-1c3a60f0b9d4}
+    static const GUID c_payloadGuid{ 0x2f5d0c7e, 0x4b8a, 0x4d53, { 0x9e, 0x57, 0x1c, 0x3a, 0x60, 0xf0, 0xb9, 0xd4 } };
+    static const char c_bywayName[]{ "detourstestbyway.dll" };
+
+    static std::wstring SystemImagePath()
+    {
+        WCHAR path[MAX_PATH]{};
+        VERIFY_ARE_NOT_EQUAL(GetSystemDirectoryW(path, ARRAYSIZE(path)), 0u);
+        return std::wstring{ path } + L"\\version.dll";
+    }
+
+    static std::wstring TempImagePath()
+    {
+        WCHAR dir[MAX_PATH]{};
+        WCHAR path[MAX_PATH]{};
+        VERIFY_ARE_NOT_EQUAL(GetTempPathW(ARRAYSIZE(dir), dir), 0u);
+        VERIFY_ARE_NOT_EQUAL(GetTempFileNameW(dir, L"dtr", 0, path), 0u);
+        return path;
+    }
+
+    // The fixture edited as in WriteEditedImage, as written by the single-pass CImage::Write of
+    // Detours 4.0.1 (before the write plan): file size and FNV-1a 64 digest of the whole file.
+#if defined(_WIN64)
+    static const size_t c_goldenSize{ 9216 };
+    static const ULONGLONG c_goldenDigest{ 0xb25c5c227bd07021 };
+#else
+    static const size_t c_goldenSize{ 8704 };
+    static const ULONGLONG c_goldenDigest{ 0xf3eda06270849f3f };
+#endif
+
+    static ULONGLONG Fnv1a64(_In_ const std::vector<BYTE>& data)
+    {
+        ULONGLONG hash{ 0xcbf29ce484222325 };
+        for (BYTE value : data)
+        {
+            hash = (hash ^ value) * 0x100000001b3;
+        }
+        return hash;
+    }
+
+    static void WriteImage(_In_ const std::wstring& path, _In_ const std::vector<BYTE>& image)
+    {
+        HANDLE file{ CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        VERIFY_ARE_NOT_EQUAL(file, INVALID_HANDLE_VALUE);
+        DWORD written{};
+        VERIFY_WIN32_BOOL_SUCCEEDED(WriteFile(file, image.data(), static_cast<DWORD>(image.size()), &written, nullptr));
+        VERIFY_ARE_EQUAL(written, static_cast<DWORD>(image.size()));
+        CloseHandle(file);
+    }
+
+    static std::vector<BYTE> ReadImage(_In_ const std::wstring& path)
+    {
+        HANDLE file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        VERIFY_ARE_NOT_EQUAL(file, INVALID_HANDLE_VALUE);
+
+        LARGE_INTEGER size{};
+        VERIFY_WIN32_BOOL_SUCCEEDED(GetFileSizeEx(file, &size));
+        std::vector<BYTE> image(static_cast<size_t>(size.QuadPart));
+        DWORD read{};
+        VERIFY_WIN32_BOOL_SUCCEEDED(ReadFile(file, image.data(), static_cast<DWORD>(image.size()), &read, nullptr));
+        VERIFY_ARE_EQUAL(read, static_cast<DWORD>(image.size()));
+        CloseHandle(file);
+        return image;
+    }
+
+    static PDETOUR_BINARY OpenBinary(_In_ const std::wstring& path)
+    {
+        HANDLE file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        VERIFY_ARE_NOT_EQUAL(file, INVALID_HANDLE_VALUE);
+        PDETOUR_BINARY binary{ DetourBinaryOpen(file) };
+        CloseHandle(file);
+        VERIFY_IS_NOT_NULL(binary);
+        return binary;
+    }
+
+    static void WriteBinary(_In_ PDETOUR_BINARY binary, _In_ const std::wstring& path)
+    {
+        HANDLE file{ CreateFileW(path.c_str(), GENERIC_WRITE | GENERIC_READ, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        VERIFY_ARE_NOT_EQUAL(file, INVALID_HANDLE_VALUE);
+        VERIFY_WIN32_BOOL_SUCCEEDED(DetourBinaryWrite(binary, file));
+        CloseHandle(file);
+    }
+
+    static BOOL CALLBACK AddByway(_In_opt_ PVOID context, _In_opt_ LPCSTR file, _Outptr_result_maybenull_ LPCSTR* outFile)
+    {
+        bool* added{ static_cast<bool*>(context) };
+        *outFile = file;
+        if (file == nullptr && !*added)
+        {
+            *added = true;
+            *outFile = c_bywayName;
+        }
+        return TRUE;
+    }
+
+    static BOOL CALLBACK CollectFile(_In_opt_ PVOID context, _In_ LPCSTR, _In_ LPCSTR file, _Outptr_result_maybenull_ LPCSTR* outFile)
+    {
+        static_cast<std::vector<std::string>*>(context)->push_back(file);
+        *outFile = file;
+        return TRUE;
+    }
+
+    static BOOL CALLBACK CollectByway(_In_opt_ PVOID context, _In_opt_ LPCSTR file, _Outptr_result_maybenull_ LPCSTR* outFile)
+    {
+        if (file != nullptr)
+        {
+            static_cast<std::vector<std::string>*>(context)->push_back(file);
+        }
+        *outFile = file;
+        return TRUE;
+    }
+
+    // Writes the source image (the system image by default) with a byway import and a payload added.
+    static void WriteEditedImage(_In_ const std::wstring& path, _In_ const std::wstring& source = SystemImagePath())
+    {
+        PDETOUR_BINARY binary{ OpenBinary(source) };
+
+        bool added{};
+        VERIFY_WIN32_BOOL_SUCCEEDED(DetourBinaryEditImports(binary, &added, AddByway, nullptr, nullptr, nullptr));
+        VERIFY_IS_TRUE(added);
+
+        const char payload[]{ "write plan payload" };
+        VERIFY_IS_NOT_NULL(DetourBinarySetPayload(binary, c_payloadGuid, const_cast<char*>(payload), sizeof(payload)));
+
+        WriteBinary(binary, path);
+        VERIFY_WIN32_BOOL_SUCCEEDED(DetourBinaryClose(binary));
+    }
+
+    static PIMAGE_SECTION_HEADER SectionHeaders(_In_ std::vector<BYTE>& image, _Out_ WORD* sectionCount)
+    {
+        auto dos{ reinterpret_cast<PIMAGE_DOS_HEADER>(image.data()) };
+        auto nt{ reinterpret_cast<PIMAGE_NT_HEADERS>(image.data() + dos->e_lfanew) };
+        *sectionCount = nt->FileHeader.NumberOfSections;
+        return IMAGE_FIRST_SECTION(nt);
+    }
+
+    class DetoursBinaryTests
+    {
+    public:
+        BEGIN_TEST_CLASS(DetoursBinaryTests)
+            TEST_CLASS_PROPERTY(L"ThreadingModel", L"MTA")
+        END_TEST_CLASS()
+
+        // The edited image carries the byway import ahead of the original imports and the payload.
+        TEST_METHOD(BinaryWrite_EditImports_RoundTrip)
+        {
+            std::wstring path{ TempImagePath() };
+            WriteEditedImage(path);
+
+            std::vector<std::string> original;
+            PDETOUR_BINARY binary{ OpenBinary(SystemImagePath()) };
+            VERIFY_WIN32_BOOL_SUCCEEDED(DetourBinaryEditImports(binary, &original, nullptr, CollectFile, nullptr, nullptr));
+            VERIFY_WIN32_BOOL_SUCCEEDED(DetourBinaryClose(binary));
+
+            std::vector<std::string> byways;
+            std::vector<std::string> files;
+            binary = OpenBinary(path);
+            VERIFY_WIN32_BOOL_SUCCEEDED(DetourBinaryEditImports(binary, &byways, CollectByway, nullptr, nullptr, nullptr));
+            VERIFY_WIN32_BOOL_SUCCEEDED(DetourBinaryEditImports(binary, &files, nullptr, CollectFile, nullptr, nullptr));
+
+            VERIFY_ARE_EQUAL(byways.size(), 1u);
+            VERIFY_ARE_EQUAL(strcmp(byways[0].c_str(), c_bywayName), 0);
+            VERIFY_IS_TRUE(files == original);
+
+            DWORD cbData{};
+            auto data{ static_cast<const char*>(DetourBinaryFindPayload(binary, c_payloadGuid, &cbData)) };
+            VERIFY_IS_NOT_NULL(data);
+            VERIFY_ARE_EQUAL(strcmp(data, "write plan payload"), 0);
+            VERIFY_WIN32_BOOL_SUCCEEDED(DetourBinaryClose(binary));
+
+            DeleteFileW(path.c_str());
+        }
+
+        // The same edits always produce the same bytes.
+        TEST_METHOD(BinaryWrite_IsDeterministic)
+        {
+            std::wstring first{ TempImagePath() };
+            std::wstring second{ TempImagePath() };
+            WriteEditedImage(first);
+            WriteEditedImage(second);
+
+            VERIFY_IS_TRUE(ReadImage(first) == ReadImage(second));
+
+            DeleteFileW(first.c_str());
+            DeleteFileW(second.c_str());
+        }
+
+        // Resetting the imports drops the .detour section and leaves every original section's raw
+        // data in place, byte for byte.
+        TEST_METHOD(BinaryWrite_ResetImports_PreservesSections)
+        {
+            std::wstring edited{ TempImagePath() };
+            std::wstring restored{ TempImagePath() };
+            WriteEditedImage(edited);
+
+            PDETOUR_BINARY binary{ OpenBinary(edited) };
+            VERIFY_WIN32_BOOL_SUCCEEDED(DetourBinaryResetImports(binary));
+            VERIFY_WIN32_BOOL_SUCCEEDED(DetourBinaryPurgePayloads(binary));
+            WriteBinary(binary, restored);
+            VERIFY_WIN32_BOOL_SUCCEEDED(DetourBinaryClose(binary));
+
+            std::vector<BYTE> originalImage{ ReadImage(SystemImagePath()) };
+            std::vector<BYTE> restoredImage{ ReadImage(restored) };
+            VERIFY_ARE_EQUAL(restoredImage.size(), originalImage.size());
+
+            WORD originalCount{};
+            WORD restoredCount{};
+            PIMAGE_SECTION_HEADER originalSections{ SectionHeaders(originalImage, &originalCount) };
+            PIMAGE_SECTION_HEADER restoredSections{ SectionHeaders(restoredImage, &restoredCount) };
+            VERIFY_ARE_EQUAL(restoredCount, originalCount);
+
+            for (WORD n = 0; n < originalCount; n++)
+            {
+                VERIFY_ARE_EQUAL(memcmp(originalSections[n].Name, restoredSections[n].Name, IMAGE_SIZEOF_SHORT_NAME), 0);
+                VERIFY_ARE_EQUAL(restoredSections[n].PointerToRawData, originalSections[n].PointerToRawData);
+                VERIFY_ARE_EQUAL(restoredSections[n].SizeOfRawData, originalSections[n].SizeOfRawData);
+
+                const BYTE* originalData{ originalImage.data() + originalSections[n].PointerToRawData };
+                const BYTE* restoredData{ restoredImage.data() + restoredSections[n].PointerToRawData };
+                VERIFY_ARE_EQUAL(memcmp(originalData, restoredData, originalSections[n].SizeOfRawData), 0);
+            }
+
+            DeleteFileW(edited.c_str());
+            DeleteFileW(restored.c_str());
+        }
+
+        // Editing the native fixture image produces the same bytes as the baseline writer.
+        TEST_METHOD(BinaryWrite_Fixture_MatchesBaseline)
+        {
+            std::wstring fixture{ TempImagePath() };
+            std::wstring edited{ TempImagePath() };
+            WriteImage(fixture, BuildImportFixture(sizeof(ULONG_PTR) == sizeof(ULONGLONG)));
+            WriteEditedImage(edited, fixture);
+
+            std::vector<BYTE> image{ ReadImage(edited) };
+            const ULONGLONG digest{ Fnv1a64(image) };
+            Log::Comment(String().Format(L"Edited fixture: %zu bytes, digest 0x%016llx", image.size(), digest));
+            VERIFY_ARE_EQUAL(image.size(), c_goldenSize);
+            VERIFY_ARE_EQUAL(digest, c_goldenDigest);
+
+            DeleteFileW(fixture.c_str());
+            DeleteFileW(edited.c_str());
+        }
+    };
+}
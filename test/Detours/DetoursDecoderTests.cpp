@@ -0,0 +1,280 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+namespace TB = ::Test::Benchmark;
+
+EXTERN_C IMAGE_DOS_HEADER __ImageBase;
+
+// Differential tests for DetourDecodeInstructions against DetourCopyInstruction.
+//
+// Every byte sequence is measured by both decoders; lengths and targets must agree. The corpus is
+// every 3 byte sequence followed by nop padding, then random sequences. Controlled with TAEF
+// runtime parameters, for example:
+//
+//   te DetoursTests.dll /name:*Decoder* /p:DecoderCorpus=10000000 /p:DecoderSeed=42
+//
+//   DecoderCorpus   Number of random sequences (default 1000000).
+//   DecoderSeed     Seed for the random sequences (default 1).
+
+namespace Test::Detours
+{
+#if defined(_M_IX86) || defined(_M_X64)
+    // Room for the longest prefix run in a random sequence plus the longest instruction.
+    static const UINT32 c_sequenceSize = 64;
+    static const UINT32 c_randomSize = 16;
+    static const BYTE c_nop = 0x90;
+
+    // DetourDecodeInstructions never reads CALL [] or JMP [] targets from memory, while
+    // DetourCopyInstruction does when the slot lies in the code module.
+    static bool IsIndirectThroughMemory(_In_ const BYTE* sequence, _In_ const DETOUR_INSTRUCTION& instruction)
+    {
+        return (instruction.cbInstruction >= 6) &&
+               (sequence[instruction.cbInstruction - 6] == 0xff) &&
+               ((sequence[instruction.cbInstruction - 5] == 0x15) || (sequence[instruction.cbInstruction - 5] == 0x25));
+    }
+
+    // Returns true when both decoders agree on the sequence, logging the first few disagreements.
+    static bool CompareDecoders(_In_ BYTE* sequence, _Inout_ UINT32& mismatches)
+    {
+        PVOID copyTarget{};
+        LONG copyExtra{};
+        auto next{ static_cast<BYTE*>(DetourCopyInstruction(nullptr, nullptr, sequence, &copyTarget, &copyExtra)) };
+        const ULONG copyLength{ static_cast<ULONG>(next - sequence) };
+
+        DETOUR_INSTRUCTION instruction{};
+        if (DetourDecodeInstructions(sequence, 0, &instruction, 1) != 1)
+        {
+            return false;
+        }
+
+        if ((instruction.cbInstruction == copyLength) &&
+            ((instruction.pTarget == copyTarget) ||
+             ((instruction.pTarget == DETOUR_INSTRUCTION_TARGET_DYNAMIC) && IsIndirectThroughMemory(sequence, instruction))))
+        {
+            return true;
+        }
+
+        if (mismatches++ < 16)
+        {
+            Log::Comment(String().Format(L"%02x %02x %02x %02x %02x %02x: DetourCopyInstruction %u bytes, target %p; DetourDecodeInstructions %u bytes, target %p",
+                sequence[0], sequence[1], sequence[2], sequence[3], sequence[4], sequence[5],
+                copyLength, copyTarget, instruction.cbInstruction, instruction.pTarget));
+        }
+        return false;
+    }
+
+    class DetoursDecoderTests
+    {
+    public:
+        BEGIN_TEST_CLASS(DetoursDecoderTests)
+            TEST_CLASS_PROPERTY(L"ThreadingModel", L"MTA")
+        END_TEST_CLASS()
+
+        // Keep DetourCopyInstruction from following CALL [] and JMP [] into random addresses.
+        TEST_CLASS_SETUP(ClassSetup)
+        {
+            VERIFY_WIN32_BOOL_SUCCEEDED(DetourSetCodeModule(reinterpret_cast<HMODULE>(&__ImageBase), TRUE));
+            return true;
+        }
+
+        TEST_CLASS_CLEANUP(ClassCleanup)
+        {
+            VERIFY_WIN32_BOOL_SUCCEEDED(DetourSetCodeModule(nullptr, FALSE));
+            return true;
+        }
+
+        TEST_METHOD(DecodeInstruction_KnownEncodings)
+        {
+            struct Encoding
+            {
+                BYTE bytes[16];
+                ULONG length;
+            };
+            static const Encoding c_encodings[]
+            {
+                { { 0x55 }, 1 },                                        // push ebp/rbp
+                { { 0x8b, 0xff }, 2 },                                  // mov edi, edi
+                { { 0x8b, 0x44, 0x24, 0x08 }, 4 },                      // mov eax, [esp+8]
+                { { 0x81, 0xec, 0x00, 0x01, 0x00, 0x00 }, 6 },          // sub esp, 100h
+                { { 0x66, 0xb8, 0x34, 0x12 }, 4 },                      // mov ax, 1234h
+                { { 0xe8, 0x00, 0x00, 0x00, 0x00 }, 5 },                // call rel32
+                { { 0xeb, 0xfe }, 2 },                                  // jmp $
+                { { 0x0f, 0x84, 0x00, 0x00, 0x00, 0x00 }, 6 },          // je rel32
+                { { 0xc5, 0xf8, 0x77 }, 3 },                            // vzeroupper
+#if defined(_M_X64)
+                { { 0x48, 0x89, 0x5c, 0x24, 0x08 }, 5 },                // mov [rsp+8], rbx
+                { { 0x48, 0x8b, 0x05, 0x00, 0x00, 0x00, 0x00 }, 7 },    // mov rax, [rip+0]
+                { { 0x48, 0xb8, 1, 2, 3, 4, 5, 6, 7, 8 }, 10 },         // mov rax, imm64
+#endif
+            };
+
+            for (const auto& encoding : c_encodings)
+            {
+                BYTE sequence[c_sequenceSize];
+                memset(sequence, c_nop, sizeof(sequence));
+                memcpy(sequence, encoding.bytes, encoding.length);
+
+                VERIFY_ARE_EQUAL(DetourGetInstructionLength(sequence), encoding.length);
+            }
+
+            // The short jump targets itself, and is enlarged by DetourCopyInstruction.
+            BYTE jump[c_sequenceSize]{ 0xeb, 0xfe };
+            DETOUR_INSTRUCTION instruction{};
+            VERIFY_ARE_EQUAL(DetourDecodeInstructions(jump, 0, &instruction, 1), 1u);
+            VERIFY_ARE_EQUAL(instruction.pTarget, static_cast<PVOID>(jump));
+            VERIFY_ARE_EQUAL(instruction.obDisplacement, 1u);
+            VERIFY_ARE_EQUAL(instruction.cbDisplacement, 1u);
+            VERIFY_IS_TRUE((instruction.fFlags & DETOUR_INSTRUCTION_FLAG_ENLARGE) != 0);
+        }
+
+        // Encodings the opcode tables mark invalid have no length; DetourDecodeInstructions still
+        // reports how far it got, flagged invalid.
+        TEST_METHOD(DecodeInstruction_InvalidEncodings)
+        {
+            struct Encoding
+            {
+                BYTE bytes[16];
+                ULONG prefixes;
+            };
+            static const Encoding c_encodings[]
+            {
+                { { 0xd6 }, 0 },                                        // salc
+                { { 0x0f, 0x04 }, 1 },
+                { { 0x0f, 0x0a }, 1 },
+                { { 0x0f, 0x25 }, 1 },
+                { { 0x66, 0xd6 }, 1 },                                  // operand size prefix, then salc
+                { { 0xf0, 0x2e, 0x0f, 0x0c }, 3 },                      // lock and cs prefixes, then 0f 0c
+#if defined(_M_X64)
+                { { 0x06 }, 0 },                                        // push es
+                { { 0x60 }, 0 },                                        // pushad
+                { { 0x48, 0xd4, 0x0a }, 1 },                            // rex.w, then aam
+#endif
+            };
+
+            for (const auto& encoding : c_encodings)
+            {
+                BYTE sequence[c_sequenceSize];
+                memset(sequence, c_nop, sizeof(sequence));
+                memcpy(sequence, encoding.bytes, encoding.prefixes + 1);
+
+                SetLastError(ERROR_SUCCESS);
+                VERIFY_ARE_EQUAL(DetourGetInstructionLength(sequence), 0u);
+                VERIFY_ARE_EQUAL(GetLastError(), static_cast<DWORD>(ERROR_INVALID_DATA));
+
+                DETOUR_INSTRUCTION instructions[2]{};
+                VERIFY_ARE_EQUAL(DetourDecodeInstructions(sequence, 0, instructions, ARRAYSIZE(instructions)), 1u);
+                VERIFY_IS_TRUE((instructions[0].fFlags & DETOUR_INSTRUCTION_FLAG_INVALID) != 0);
+                VERIFY_ARE_EQUAL(instructions[0].cbInstruction, encoding.prefixes + 1);
+            }
+        }
+
+        TEST_METHOD(DecodeInstruction_MatchesCopyInstruction_Exhaustive)
+        {
+            BYTE sequence[c_sequenceSize];
+            UINT32 mismatches{};
+
+            for (UINT32 value{}; value < (1u << 24); value++)
+            {
+                memset(sequence, c_nop, sizeof(sequence));
+                sequence[0] = static_cast<BYTE>(value);
+                sequence[1] = static_cast<BYTE>(value >> 8);
+                sequence[2] = static_cast<BYTE>(value >> 16);
+                CompareDecoders(sequence, mismatches);
+            }
+            VERIFY_ARE_EQUAL(mismatches, 0u);
+        }
+
+        TEST_METHOD(DecodeInstruction_MatchesCopyInstruction_Random)
+        {
+            const UINT32 count{ TB::GetUIntParameter(L"DecoderCorpus", 1000000, 0) };
+            const UINT32 seed{ TB::GetUIntParameter(L"DecoderSeed", 1, 0) };
+            Log::Comment(String().Format(L"%u sequences, seed %u", count, seed));
+
+            std::mt19937 random{ seed };
+            BYTE sequence[c_sequenceSize];
+            UINT32 mismatches{};
+
+            for (UINT32 i{}; i < count; i++)
+            {
+                memset(sequence, c_nop, sizeof(sequence));
+                for (UINT32 j{}; j < c_randomSize; j++)
+                {
+                    sequence[j] = static_cast<BYTE>(random());
+                }
+                CompareDecoders(sequence, mismatches);
+            }
+            VERIFY_ARE_EQUAL(mismatches, 0u);
+        }
+
+        // Batch decoding walks the same instruction boundaries as repeated DetourCopyInstruction.
+        TEST_METHOD(DecodeInstructions_MatchesCopyInstructionStream)
+        {
+            const UINT32 seed{ TB::GetUIntParameter(L"DecoderSeed", 1, 0) };
+            std::mt19937 random{ seed };
+
+            std::vector<BYTE> stream(0x10000 + c_sequenceSize, c_nop);
+            for (UINT32 i{}; i < 0x10000; i++)
+            {
+                stream[i] = static_cast<BYTE>(random());
+            }
+
+            std::vector<DETOUR_INSTRUCTION> instructions(64);
+            UINT32 mismatches{};
+            UINT32 offset{};
+            while (offset < 0x10000)
+            {
+                const ULONG decoded{ DetourDecodeInstructions(&stream[offset], 0, instructions.data(), static_cast<ULONG>(instructions.size())) };
+                VERIFY_IS_TRUE(decoded > 0);
+
+                for (ULONG i{}; i < decoded; i++)
+                {
+                    auto next{ static_cast<BYTE*>(DetourCopyInstruction(nullptr, nullptr, &stream[offset], nullptr, nullptr)) };
+                    if (static_cast<ULONG>(next - &stream[offset]) != instructions[i].cbInstruction)
+                    {
+                        mismatches++;
+                    }
+                    offset += instructions[i].cbInstruction;
+                }
+            }
+            VERIFY_ARE_EQUAL(mismatches, 0u);
+
+            // cbMinimum stops at the first instruction boundary at or past it, as when sizing a detour.
+            ULONG covered{};
+            const ULONG decoded{ DetourDecodeInstructions(stream.data(), 5, instructions.data(), static_cast<ULONG>(instructions.size())) };
+            for (ULONG i{}; i < decoded; i++)
+            {
+                if (i + 1 < decoded)
+                {
+                    VERIFY_IS_TRUE((instructions[i].fFlags & DETOUR_INSTRUCTION_FLAG_INVALID) == 0);
+                }
+                covered += instructions[i].cbInstruction;
+            }
+            VERIFY_IS_TRUE((covered >= 5) || ((instructions[decoded - 1].fFlags & DETOUR_INSTRUCTION_FLAG_INVALID) != 0));
+            VERIFY_IS_TRUE((covered - instructions[decoded - 1].cbInstruction) < 5);
+        }
+    };
+#else
+    class DetoursDecoderTests
+    {
+    public:
+        BEGIN_TEST_CLASS(DetoursDecoderTests)
+            TEST_CLASS_PROPERTY(L"ThreadingModel", L"MTA")
+        END_TEST_CLASS()
+
+        TEST_METHOD(DecodeInstructions_NotSupported)
+        {
+            const ULONG code{};
+            DETOUR_INSTRUCTION instruction{};
+            VERIFY_ARE_EQUAL(DetourDecodeInstructions(const_cast<ULONG*>(&code), 0, &instruction, 1), 0u);
+            VERIFY_ARE_EQUAL(GetLastError(), static_cast<DWORD>(ERROR_NOT_SUPPORTED));
+            VERIFY_ARE_EQUAL(DetourGetInstructionLength(const_cast<ULONG*>(&code)), 0u);
+        }
+    };
+#endif
+}
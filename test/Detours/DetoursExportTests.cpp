@@ -0,0 +1,197 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "DetoursFixtures.h"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+// Export index tests, against the images from BuildExportFixture and the loaded system modules.
+
+namespace Test::Detours
+{
+    static void VerifyExport(_In_ PDETOUR_EXPORT_INDEX index, _In_ PCSTR name, _In_ ULONG ordinal, _In_ DWORD rva, _In_opt_ PCSTR forwarder)
+    {
+        DETOUR_EXPORT byName{};
+        VERIFY_IS_TRUE(DetourFindExport(index, name, &byName));
+        VERIFY_ARE_EQUAL(byName.nOrdinal, ordinal);
+        VERIFY_ARE_EQUAL(byName.nRva, rva);
+        VERIFY_ARE_EQUAL(strcmp(byName.pszName, name), 0);
+        if (forwarder)
+        {
+            VERIFY_IS_NOT_NULL(byName.pszForwarder);
+            VERIFY_ARE_EQUAL(strcmp(byName.pszForwarder, forwarder), 0);
+        }
+        else
+        {
+            VERIFY_IS_NULL(byName.pszForwarder);
+        }
+
+        DETOUR_EXPORT byOrdinal{};
+        VERIFY_IS_TRUE(DetourFindExportByOrdinal(index, ordinal, &byOrdinal));
+        VERIFY_ARE_EQUAL(byOrdinal.nRva, rva);
+        VERIFY_ARE_EQUAL(byOrdinal.pszForwarder, byName.pszForwarder);
+    }
+
+    static void VerifyFixture(_In_ bool pe32Plus, _In_ PCSTR forwarderByOrdinal)
+    {
+        std::vector<BYTE> image{ BuildExportFixture(pe32Plus) };
+        PDETOUR_EXPORT_INDEX index{ DetourCreateExportIndex(image.data(), image.size(), FALSE) };
+        VERIFY_IS_NOT_NULL(index);
+
+        VerifyExport(index, "Alpha", 5, 0x1000, nullptr);
+        VerifyExport(index, "Beta", 7, 0x1020, nullptr);
+        VerifyExport(index, "Forwarded", 8, 0, "KERNEL32.GetTickCount");
+        VerifyExport(index, "ForwardedByOrdinal", 9, 0, forwarderByOrdinal);
+        VerifyExport(index, "Gamma", 11, 0x1030, nullptr);
+        VerifyExport(index, "GammaAlias", 11, 0x1030, nullptr);
+
+        // Every hashed name, and the first name of each ordinal.
+        UINT32 mismatches{};
+        for (ULONG n{}; n < 300; n++)
+        {
+            char name[16];
+            sprintf_s(name, "Export%04u", n);
+
+            DETOUR_EXPORT found{};
+            if (!DetourFindExport(index, name, &found) || (found.nOrdinal != 12 + n) || (found.nRva != 0x1040 + n))
+            {
+                mismatches++;
+            }
+            if (!DetourFindExportByOrdinal(index, 12 + n, &found) || (strcmp(found.pszName, name) != 0))
+            {
+                mismatches++;
+            }
+        }
+        VERIFY_ARE_EQUAL(mismatches, 0u);
+
+        DETOUR_EXPORT found{};
+        VERIFY_IS_TRUE(DetourFindExportByOrdinal(index, 6, &found));
+        VERIFY_ARE_EQUAL(found.nRva, 0x1010u);
+        VERIFY_IS_NULL(found.pszName);
+
+        VERIFY_IS_TRUE(DetourFindExportByOrdinal(index, 10, &found));
+        VERIFY_ARE_EQUAL(found.nRva, 0u);
+        VERIFY_IS_NULL(found.pszName);
+        VERIFY_IS_NULL(found.pszForwarder);
+
+        VERIFY_IS_TRUE(DetourFindExportByOrdinal(index, 11, &found));
+        VERIFY_ARE_EQUAL(strcmp(found.pszName, "Gamma"), 0);
+
+        VERIFY_IS_FALSE(DetourFindExport(index, "Delta", &found));
+        VERIFY_ARE_EQUAL(GetLastError(), static_cast<DWORD>(ERROR_PROC_NOT_FOUND));
+        VERIFY_IS_FALSE(DetourFindExport(index, "alpha", &found));
+        VERIFY_IS_FALSE(DetourFindExportByOrdinal(index, 4, &found));
+        VERIFY_IS_FALSE(DetourFindExportByOrdinal(index, 5 + c_fixtureExports, &found));
+
+        DetourFreeExportIndex(index);
+    }
+
+    struct LoadedExport
+    {
+        ULONG ordinal;
+        LPCSTR name;
+        PVOID code;
+    };
+
+    static BOOL CALLBACK CollectExport(_In_opt_ PVOID context, _In_ ULONG ordinal, _In_opt_ LPCSTR name, _In_opt_ PVOID code)
+    {
+        static_cast<std::vector<LoadedExport>*>(context)->push_back({ ordinal, name, code });
+        return TRUE;
+    }
+
+    class DetoursExportTests
+    {
+    public:
+        BEGIN_TEST_CLASS(DetoursExportTests)
+            TEST_CLASS_PROPERTY(L"ThreadingModel", L"MTA")
+        END_TEST_CLASS()
+
+        TEST_METHOD(ExportIndex_Fixture_PE32)
+        {
+            VerifyFixture(false, "exports_x86.#5");
+        }
+
+        TEST_METHOD(ExportIndex_Fixture_PE32Plus)
+        {
+            VerifyFixture(true, "exports_x64.#5");
+        }
+
+        // A truncated image either fails cleanly or, once the export data is complete, indexes fully.
+        TEST_METHOD(ExportIndex_Fixture_Truncated)
+        {
+            for (bool pe32Plus : { false, true })
+            {
+                std::vector<BYTE> image{ BuildExportFixture(pe32Plus) };
+                UINT32 failures{};
+                UINT32 incomplete{};
+                for (size_t size{}; size < image.size(); size++)
+                {
+                    // A private copy so reads past the end fault instead of landing in the original.
+                    std::vector<BYTE> truncated(image.begin(), image.begin() + size);
+                    PDETOUR_EXPORT_INDEX index{ DetourCreateExportIndex(truncated.data(), truncated.size(), FALSE) };
+                    if (index == nullptr)
+                    {
+                        const DWORD error{ GetLastError() };
+                        if ((error != ERROR_BAD_EXE_FORMAT) && (error != ERROR_INVALID_EXE_SIGNATURE) && (error != ERROR_EXE_MARKED_INVALID))
+                        {
+                            failures++;
+                        }
+                        continue;
+                    }
+
+                    DETOUR_EXPORT found{};
+                    if (!DetourFindExport(index, "Export0299", &found) || !DetourFindExportByOrdinal(index, 9, &found))
+                    {
+                        incomplete++;
+                    }
+                    DetourFreeExportIndex(index);
+                }
+                VERIFY_ARE_EQUAL(failures, 0u);
+                VERIFY_ARE_EQUAL(incomplete, 0u);
+            }
+        }
+
+        // The cached index of a loaded module agrees with the loader, forwarders included.
+        TEST_METHOD(ExportIndex_LoadedModules_MatchGetProcAddress)
+        {
+            for (auto moduleName : { "kernel32.dll", "kernelbase.dll", "ntdll.dll" })
+            {
+                HMODULE module{ GetModuleHandleA(moduleName) };
+                VERIFY_IS_NOT_NULL(module);
+
+                std::vector<LoadedExport> exports;
+                VERIFY_IS_TRUE(DetourEnumerateExports(module, &exports, CollectExport));
+                VERIFY_IS_TRUE(exports.size() > 0);
+
+                UINT32 mismatches{};
+                UINT32 named{};
+                for (const auto& entry : exports)
+                {
+                    // Forwarders are enumerated without code.
+                    if ((entry.code != nullptr) &&
+                        (reinterpret_cast<PVOID>(GetProcAddress(module, MAKEINTRESOURCEA(entry.ordinal))) != entry.code))
+                    {
+                        mismatches++;
+                    }
+                    if (entry.name != nullptr)
+                    {
+                        named++;
+                        if (DetourFindFunction(moduleName, entry.name) != reinterpret_cast<PVOID>(GetProcAddress(module, entry.name)))
+                        {
+                            if (mismatches++ < 16)
+                            {
+                                Log::Comment(String().Format(L"%hs!%hs differs from GetProcAddress", moduleName, entry.name));
+                            }
+                        }
+                    }
+                }
+                Log::Comment(String().Format(L"%hs: %u exports, %u named", moduleName, static_cast<UINT32>(exports.size()), named));
+                VERIFY_ARE_EQUAL(mismatches, 0u);
+            }
+        }
+    };
+}
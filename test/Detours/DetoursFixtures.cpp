@@ -0,0 +1,302 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "DetoursFixtures.h"
+
+namespace Test::Detours
+{
+    static const DWORD c_fileAlignment{ 0x200 };
+    static const DWORD c_sectionAlignment{ 0x1000 };
+    static const DWORD c_timeDateStamp{ 0x5f000000 };
+    static const DWORD c_ntHeadersOffset{ 0x80 };
+    static const DWORD c_textRva{ 0x1000 };
+    static const DWORD c_textSize{ 0x200 };
+    static const DWORD c_rdataRva{ 0x2000 };
+    static const DWORD c_ordinalBase{ 5 };
+    static const DWORD c_generatedExports{ 300 };
+
+    struct FixtureImport
+    {
+        PCSTR dllName;
+        std::vector<std::string> names;
+    };
+
+    struct FixtureFunction
+    {
+        DWORD rva;
+        std::string forwarder;
+    };
+
+    static DWORD AlignUp(_In_ DWORD value, _In_ DWORD alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    template <typename T>
+    static T* At(_In_ std::vector<BYTE>& buffer, _In_ size_t offset)
+    {
+        return reinterpret_cast<T*>(&buffer[offset]);
+    }
+
+    // The export directory, its tables and its strings, laid out as the .rdata section at c_rdataRva.
+    static std::vector<BYTE> BuildExportData(_In_ const std::string& dllName)
+    {
+        std::vector<FixtureFunction> functions{
+            { 0x1000, {} },                                         // Alpha
+            { 0x1010, {} },                                         // (ordinal only)
+            { 0x1020, {} },                                         // Beta
+            { 0, "KERNEL32.GetTickCount" },                         // Forwarded
+            { 0, dllName.substr(0, dllName.find('.')) + ".#5" },    // ForwardedByOrdinal
+            { 0, {} },                                              // (unused)
+            { 0x1030, {} },                                         // Gamma, GammaAlias
+        };
+        std::vector<std::pair<std::string, WORD>> names{
+            { "Alpha", 0 }, { "Beta", 2 }, { "Forwarded", 3 }, { "ForwardedByOrdinal", 4 }, { "Gamma", 6 }, { "GammaAlias", 6 }
+        };
+        for (DWORD n{}; n < c_generatedExports; n++)
+        {
+            char name[16];
+            sprintf_s(name, "Export%04u", n);
+            names.emplace_back(name, static_cast<WORD>(functions.size()));
+            functions.push_back({ 0x1040 + n, {} });
+        }
+
+        // The name table is sorted so the loader can binary search it.
+        std::sort(names.begin(), names.end());
+
+        const size_t functionsOffset{ sizeof(IMAGE_EXPORT_DIRECTORY) };
+        const size_t namesOffset{ functionsOffset + (functions.size() * sizeof(DWORD)) };
+        const size_t ordinalsOffset{ namesOffset + (names.size() * sizeof(DWORD)) };
+        std::vector<BYTE> data(ordinalsOffset + (names.size() * sizeof(WORD)));
+
+        auto appendString = [&](const std::string& value)
+        {
+            const DWORD rva{ c_rdataRva + static_cast<DWORD>(data.size()) };
+            data.insert(data.end(), value.begin(), value.end());
+            data.push_back(0);
+            return rva;
+        };
+
+        const DWORD dllNameRva{ appendString(dllName) };
+        for (size_t n{}; n < names.size(); n++)
+        {
+            const DWORD nameRva{ appendString(names[n].first) };
+            *At<DWORD>(data, namesOffset + (n * sizeof(DWORD))) = nameRva;
+            *At<WORD>(data, ordinalsOffset + (n * sizeof(WORD))) = names[n].second;
+        }
+        for (size_t n{}; n < functions.size(); n++)
+        {
+            // A forwarder is an RVA pointing back into the export directory.
+            const DWORD rva{ functions[n].forwarder.empty() ? functions[n].rva : appendString(functions[n].forwarder) };
+            *At<DWORD>(data, functionsOffset + (n * sizeof(DWORD))) = rva;
+        }
+
+        auto directory{ At<IMAGE_EXPORT_DIRECTORY>(data, 0) };
+        directory->TimeDateStamp = c_timeDateStamp;
+        directory->Name = dllNameRva;
+        directory->Base = c_ordinalBase;
+        directory->NumberOfFunctions = static_cast<DWORD>(functions.size());
+        directory->NumberOfNames = static_cast<DWORD>(names.size());
+        directory->AddressOfFunctions = c_rdataRva + static_cast<DWORD>(functionsOffset);
+        directory->AddressOfNames = c_rdataRva + static_cast<DWORD>(namesOffset);
+        directory->AddressOfNameOrdinals = c_rdataRva + static_cast<DWORD>(ordinalsOffset);
+        return data;
+    }
+
+    // The import descriptors, lookup and address tables, hint/name entries and strings, laid out at
+    // rva. A name of the form "#n" imports by ordinal n.
+    static std::vector<BYTE> BuildImportData(_In_ bool pe32Plus, _In_ DWORD rva, _Out_ DWORD* importSize, _Out_ DWORD* iatRva, _Out_ DWORD* iatSize)
+    {
+        const std::vector<FixtureImport> imports{
+            { "KERNEL32.dll", { "GetTickCount", "Sleep" } },
+            { "USER32.dll", { "MessageBeep", "#2" } },
+        };
+        const size_t thunkSize{ pe32Plus ? sizeof(IMAGE_THUNK_DATA64) : sizeof(IMAGE_THUNK_DATA32) };
+
+        size_t thunkCount{};
+        for (const auto& import : imports)
+        {
+            thunkCount += import.names.size() + 1;
+        }
+
+        const size_t descriptorsSize{ (imports.size() + 1) * sizeof(IMAGE_IMPORT_DESCRIPTOR) };
+        const size_t lookupOffset{ AlignUp(static_cast<DWORD>(descriptorsSize), static_cast<DWORD>(thunkSize)) };
+        const size_t addressOffset{ lookupOffset + (thunkCount * thunkSize) };
+        std::vector<BYTE> data(addressOffset + (thunkCount * thunkSize));
+
+        auto appendName = [&](WORD hint, const std::string& value)
+        {
+            // Hint/name entries are word aligned.
+            data.resize(AlignUp(static_cast<DWORD>(data.size()), static_cast<DWORD>(sizeof(WORD))));
+            const DWORD nameRva{ rva + static_cast<DWORD>(data.size()) };
+            data.push_back(static_cast<BYTE>(hint));
+            data.push_back(static_cast<BYTE>(hint >> 8));
+            data.insert(data.end(), value.begin(), value.end());
+            data.push_back(0);
+            return nameRva;
+        };
+        auto setThunk = [&](size_t offset, ULONGLONG value)
+        {
+            if (pe32Plus)
+            {
+                At<IMAGE_THUNK_DATA64>(data, offset)->u1.AddressOfData = value;
+            }
+            else
+            {
+                At<IMAGE_THUNK_DATA32>(data, offset)->u1.AddressOfData = static_cast<DWORD>(value);
+            }
+        };
+
+        size_t thunk{};
+        for (size_t n{}; n < imports.size(); n++)
+        {
+            auto descriptor{ At<IMAGE_IMPORT_DESCRIPTOR>(data, n * sizeof(IMAGE_IMPORT_DESCRIPTOR)) };
+            descriptor->OriginalFirstThunk = rva + static_cast<DWORD>(lookupOffset + (thunk * thunkSize));
+            descriptor->FirstThunk = rva + static_cast<DWORD>(addressOffset + (thunk * thunkSize));
+
+            WORD hint{};
+            for (const auto& name : imports[n].names)
+            {
+                ULONGLONG value{};
+                if (name[0] == '#')
+                {
+                    const ULONGLONG ordinalFlag{ pe32Plus ? IMAGE_ORDINAL_FLAG64 : IMAGE_ORDINAL_FLAG32 };
+                    value = ordinalFlag | strtoul(name.c_str() + 1, nullptr, 10);
+                }
+                else
+                {
+                    value = appendName(hint++, name);
+                }
+                setThunk(lookupOffset + (thunk * thunkSize), value);
+                setThunk(addressOffset + (thunk * thunkSize), value);
+                thunk++;
+            }
+            thunk++;
+        }
+
+        for (size_t n{}; n < imports.size(); n++)
+        {
+            const DWORD nameRva{ rva + static_cast<DWORD>(data.size()) };
+            data.insert(data.end(), imports[n].dllName, imports[n].dllName + strlen(imports[n].dllName) + 1);
+            At<IMAGE_IMPORT_DESCRIPTOR>(data, n * sizeof(IMAGE_IMPORT_DESCRIPTOR))->Name = nameRva;
+        }
+
+        *importSize = static_cast<DWORD>(descriptorsSize);
+        *iatRva = rva + static_cast<DWORD>(addressOffset);
+        *iatSize = static_cast<DWORD>(thunkCount * thunkSize);
+        return data;
+    }
+
+    static void InitFileHeader(_Out_ IMAGE_FILE_HEADER& header, _In_ WORD machine, _In_ WORD sizeOfOptionalHeader, _In_ WORD characteristics)
+    {
+        header.Machine = machine;
+        header.NumberOfSections = 2;
+        header.TimeDateStamp = c_timeDateStamp;
+        header.SizeOfOptionalHeader = sizeOfOptionalHeader;
+        header.Characteristics = IMAGE_FILE_EXECUTABLE_IMAGE | IMAGE_FILE_DLL | characteristics;
+    }
+
+    template <typename TOptionalHeader>
+    static void InitOptionalHeader(_Out_ TOptionalHeader& header, _In_ WORD magic, _In_ DWORD rdataSize, _In_ DWORD exportSize)
+    {
+        header.Magic = magic;
+        header.MajorLinkerVersion = 14;
+        header.SizeOfCode = c_textSize;
+        header.SizeOfInitializedData = AlignUp(rdataSize, c_fileAlignment);
+        header.BaseOfCode = c_textRva;
+        header.SectionAlignment = c_sectionAlignment;
+        header.FileAlignment = c_fileAlignment;
+        header.MajorOperatingSystemVersion = 6;
+        header.MajorSubsystemVersion = 6;
+        header.SizeOfImage = c_rdataRva + AlignUp(rdataSize, c_sectionAlignment);
+        header.SizeOfHeaders = c_fileAlignment;
+        header.Subsystem = IMAGE_SUBSYSTEM_WINDOWS_CUI;
+        header.DllCharacteristics = IMAGE_DLLCHARACTERISTICS_HIGH_ENTROPY_VA | IMAGE_DLLCHARACTERISTICS_DYNAMIC_BASE | IMAGE_DLLCHARACTERISTICS_NX_COMPAT;
+        header.SizeOfStackReserve = 0x100000;
+        header.SizeOfStackCommit = 0x1000;
+        header.SizeOfHeapReserve = 0x100000;
+        header.SizeOfHeapCommit = 0x1000;
+        header.NumberOfRvaAndSizes = IMAGE_NUMBEROF_DIRECTORY_ENTRIES;
+        header.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT].VirtualAddress = c_rdataRva;
+        header.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT].Size = exportSize;
+    }
+
+    static void InitSection(_Out_ IMAGE_SECTION_HEADER& section, _In_ PCSTR name, _In_ DWORD virtualSize, _In_ DWORD rva, _In_ DWORD pointerToRawData, _In_ DWORD characteristics)
+    {
+        memcpy(section.Name, name, strlen(name));
+        section.Misc.VirtualSize = virtualSize;
+        section.VirtualAddress = rva;
+        section.SizeOfRawData = AlignUp(virtualSize, c_fileAlignment);
+        section.PointerToRawData = pointerToRawData;
+        section.Characteristics = characteristics;
+    }
+
+    static std::vector<BYTE> BuildFixture(_In_ bool pe32Plus, _In_ bool withImports)
+    {
+        std::vector<BYTE> rdata{ BuildExportData(pe32Plus ? "exports_x64.dll" : "exports_x86.dll") };
+        const DWORD exportSize{ static_cast<DWORD>(rdata.size()) };
+
+        // The import data follows the export data, quad aligned.
+        IMAGE_DATA_DIRECTORY importDirectory{};
+        IMAGE_DATA_DIRECTORY iatDirectory{};
+        if (withImports)
+        {
+            rdata.resize(AlignUp(exportSize, static_cast<DWORD>(sizeof(ULONGLONG))));
+            importDirectory.VirtualAddress = c_rdataRva + static_cast<DWORD>(rdata.size());
+            const std::vector<BYTE> imports{ BuildImportData(pe32Plus, importDirectory.VirtualAddress, &importDirectory.Size, &iatDirectory.VirtualAddress, &iatDirectory.Size) };
+            rdata.insert(rdata.end(), imports.begin(), imports.end());
+        }
+        const DWORD rdataSize{ static_cast<DWORD>(rdata.size()) };
+        const DWORD textOffset{ c_fileAlignment };
+        const DWORD rdataOffset{ textOffset + c_textSize };
+
+        std::vector<BYTE> image(rdataOffset + AlignUp(rdataSize, c_fileAlignment));
+        auto dosHeader{ At<IMAGE_DOS_HEADER>(image, 0) };
+        dosHeader->e_magic = IMAGE_DOS_SIGNATURE;
+        dosHeader->e_lfanew = c_ntHeadersOffset;
+
+        PIMAGE_SECTION_HEADER sections{};
+        if (pe32Plus)
+        {
+            auto ntHeaders{ At<IMAGE_NT_HEADERS64>(image, c_ntHeadersOffset) };
+            ntHeaders->Signature = IMAGE_NT_SIGNATURE;
+            InitFileHeader(ntHeaders->FileHeader, IMAGE_FILE_MACHINE_AMD64, sizeof(ntHeaders->OptionalHeader), IMAGE_FILE_LARGE_ADDRESS_AWARE);
+            InitOptionalHeader(ntHeaders->OptionalHeader, IMAGE_NT_OPTIONAL_HDR64_MAGIC, rdataSize, exportSize);
+            ntHeaders->OptionalHeader.ImageBase = 0x180000000;
+            ntHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_IMPORT] = importDirectory;
+            ntHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_IAT] = iatDirectory;
+            sections = IMAGE_FIRST_SECTION(ntHeaders);
+        }
+        else
+        {
+            auto ntHeaders{ At<IMAGE_NT_HEADERS32>(image, c_ntHeadersOffset) };
+            ntHeaders->Signature = IMAGE_NT_SIGNATURE;
+            InitFileHeader(ntHeaders->FileHeader, IMAGE_FILE_MACHINE_I386, sizeof(ntHeaders->OptionalHeader), IMAGE_FILE_32BIT_MACHINE);
+            InitOptionalHeader(ntHeaders->OptionalHeader, IMAGE_NT_OPTIONAL_HDR32_MAGIC, rdataSize, exportSize);
+            ntHeaders->OptionalHeader.BaseOfData = c_rdataRva;
+            ntHeaders->OptionalHeader.ImageBase = 0x10000000;
+            ntHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_IMPORT] = importDirectory;
+            ntHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_IAT] = iatDirectory;
+            sections = IMAGE_FIRST_SECTION(ntHeaders);
+        }
+        InitSection(sections[0], ".text", c_textSize, c_textRva, textOffset, IMAGE_SCN_CNT_CODE | IMAGE_SCN_MEM_EXECUTE | IMAGE_SCN_MEM_READ);
+        InitSection(sections[1], ".rdata", rdataSize, c_rdataRva, rdataOffset, IMAGE_SCN_CNT_INITIALIZED_DATA | IMAGE_SCN_MEM_READ);
+
+        // The functions are never called; fill the code with int3.
+        memset(&image[textOffset], 0xcc, c_textSize);
+        memcpy(&image[rdataOffset], rdata.data(), rdata.size());
+        return image;
+    }
+
+    std::vector<BYTE> BuildExportFixture(bool pe32Plus)
+    {
+        return BuildFixture(pe32Plus, false);
+    }
+
+    std::vector<BYTE> BuildImportFixture(bool pe32Plus)
+    {
+        return BuildFixture(pe32Plus, true);
+    }
+}
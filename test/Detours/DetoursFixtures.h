@@ -0,0 +1,33 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#ifndef __DETOURSFIXTURES_H
+#define __DETOURSFIXTURES_H
+
+namespace Test::Detours
+{
+    // Builds a minimal PE32 (exports_x86.dll) or PE32+ (exports_x64.dll) image, never loaded, whose
+    // file and section alignments differ so RVAs must be translated through the section headers.
+    // Both export, with ordinal base 5:
+    //
+    //   5    Alpha                   RVA 0x1000
+    //   6    (ordinal only)          RVA 0x1010
+    //   7    Beta                    RVA 0x1020
+    //   8    Forwarded               -> KERNEL32.GetTickCount
+    //   9    ForwardedByOrdinal      -> exports_x86.#5 or exports_x64.#5
+    //   10   (unused)                RVA 0
+    //   11   Gamma, GammaAlias       RVA 0x1030
+    //   12+n Export0000..Export0299  RVA 0x1040 + n
+    std::vector<BYTE> BuildExportFixture(bool pe32Plus);
+
+    // Builds the same image with an import directory and IAT appended to .rdata, for the binary
+    // editing tests:
+    //
+    //   KERNEL32.dll    GetTickCount, Sleep
+    //   USER32.dll      MessageBeep, #2
+    std::vector<BYTE> BuildImportFixture(bool pe32Plus);
+
+    const ULONG c_fixtureExports{ 307 };
+}
+
+#endif // __DETOURSFIXTURES_H
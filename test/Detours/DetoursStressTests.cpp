@@ -0,0 +1,288 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+namespace TB = ::Test::Benchmark;
+
+// Attach/detach stress for the trampoline allocator.
+//
+// Each hook target is a small generated function returning its own index, so thousands of
+// distinct targets can be hooked without shipping thousands of functions. The targets are
+// spread over several code blocks so trampolines land in several regions. Controlled with
+// TAEF runtime parameters, for example:
+//
+//   te DetoursTests.dll /name:*Stress* /p:Hooks=16384 /p:HooksPerBlock=512
+//
+//   Hooks           Number of distinct functions hooked (default 4096).
+//   HooksPerBlock   Number of functions per generated code block (default 1024).
+
+namespace Test::Detours
+{
+    typedef int (WINAPI *StubFunction)();
+
+    static const int c_detouredResult = -1;
+    static const UINT32 c_stubSize = 16;
+    static const UINT32 c_codeBlockSize = 0x10000;
+
+    static int WINAPI DetouredStub()
+    {
+        return c_detouredResult;
+    }
+
+    // Writes a function returning index, long enough for Detours to relocate into a trampoline.
+    static void WriteStub(_Out_writes_bytes_(c_stubSize) BYTE* code, _In_ UINT32 index)
+    {
+        const UINT32 value{ index & 0xffff };
+#if defined(_M_IX86) || defined(_M_X64)
+        memset(code, 0xcc, c_stubSize);                 // int3 padding
+        code[0] = 0xb8;                                 // mov eax, imm32
+        memcpy(&code[1], &value, sizeof(value));
+        code[5] = 0xc3;                                 // ret
+#elif defined(_M_ARM64)
+        ULONG* instructions{ reinterpret_cast<ULONG*>(code) };
+        instructions[0] = 0x52800000 | (value << 5);    // movz w0, #value
+        instructions[1] = 0xd503201f;                   // nop
+        instructions[2] = 0xd503201f;                   // nop
+        instructions[3] = 0xd65f03c0;                   // ret
+#else
+#error Unsupported architecture
+#endif
+    }
+
+    class CodeBlocks
+    {
+    public:
+        ~CodeBlocks()
+        {
+            for (auto block : m_blocks)
+            {
+                VirtualFree(block, 0, MEM_RELEASE);
+            }
+        }
+
+        void Generate(_In_ UINT32 count, _In_ UINT32 perBlock, _Inout_ std::vector<PVOID>& stubs)
+        {
+            stubs.resize(count);
+            for (UINT32 index{}; index < count; index += perBlock)
+            {
+                auto block{ static_cast<BYTE*>(VirtualAlloc(nullptr, c_codeBlockSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE)) };
+                VERIFY_IS_NOT_NULL(block);
+                m_blocks.push_back(block);
+
+                const UINT32 blockCount{ min(perBlock, count - index) };
+                for (UINT32 i{}; i < blockCount; i++)
+                {
+                    WriteStub(block + (i * c_stubSize), index + i);
+                    stubs[index + i] = block + (i * c_stubSize);
+                }
+
+                DWORD oldProtect{};
+                VERIFY_WIN32_BOOL_SUCCEEDED(VirtualProtect(block, c_codeBlockSize, PAGE_EXECUTE_READ, &oldProtect));
+                VERIFY_WIN32_BOOL_SUCCEEDED(FlushInstructionCache(GetCurrentProcess(), block, c_codeBlockSize));
+            }
+        }
+
+    private:
+        std::vector<BYTE*> m_blocks;
+    };
+
+    static void VerifyStubs(_In_ const std::vector<PVOID>& stubs, _In_ bool detoured)
+    {
+        UINT32 mismatches{};
+        for (UINT32 i{}; i < stubs.size(); i++)
+        {
+            const int expected{ detoured ? c_detouredResult : static_cast<int>(i & 0xffff) };
+            if (reinterpret_cast<StubFunction>(stubs[i])() != expected)
+            {
+                mismatches++;
+            }
+        }
+        VERIFY_ARE_EQUAL(mismatches, 0u);
+    }
+
+    // Attaches or detaches targets[first], targets[first + step], ... with one transaction each.
+    // Returns the number of hooks that failed so the timed loops don't log every verification.
+    static UINT32 UpdateEach(_Inout_ std::vector<PVOID>& targets, _In_ bool attach, _In_ UINT32 first = 0, _In_ UINT32 step = 1)
+    {
+        UINT32 failures{};
+        for (UINT32 i{ first }; i < targets.size(); i += step)
+        {
+            LONG error{ DetourTransactionBegin() };
+            if (error == NO_ERROR)
+            {
+                error = attach ? DetourAttach(&targets[i], DetouredStub) : DetourDetach(&targets[i], DetouredStub);
+                if (error == NO_ERROR)
+                {
+                    error = DetourTransactionCommit();
+                }
+                else
+                {
+                    DetourTransactionAbort();
+                }
+            }
+            if (error != NO_ERROR)
+            {
+                failures++;
+            }
+        }
+        return failures;
+    }
+
+    // Attaches or detaches every target in a single transaction.
+    static LONG UpdateAll(_Inout_ std::vector<PVOID>& targets, _In_ bool attach)
+    {
+        LONG error{ DetourTransactionBegin() };
+        if (error != NO_ERROR)
+        {
+            return error;
+        }
+        for (auto& target : targets)
+        {
+            error = attach ? DetourAttach(&target, DetouredStub) : DetourDetach(&target, DetouredStub);
+            if (error != NO_ERROR)
+            {
+                DetourTransactionAbort();
+                return error;
+            }
+        }
+        return DetourTransactionCommit();
+    }
+
+    class DetoursStressTests
+    {
+    public:
+        BEGIN_TEST_CLASS(DetoursStressTests)
+            TEST_CLASS_PROPERTY(L"ThreadingModel", L"MTA")
+        END_TEST_CLASS()
+
+        // One transaction per hook, the pattern of an agent hooking DLLs as they load. Every
+        // attach has to find a trampoline within jump range of its target, so this measures the
+        // region lookup as the number of regions grows.
+        TEST_METHOD(AttachDetachOnePerTransaction_Stress)
+        {
+            const UINT32 hooks{ TB::GetUIntParameter(L"Hooks", 4096, 1, 1 << 20) };
+            const UINT32 perBlock{ TB::GetUIntParameter(L"HooksPerBlock", 1024, 1, c_codeBlockSize / c_stubSize) };
+
+            CodeBlocks blocks;
+            std::vector<PVOID> stubs;
+            blocks.Generate(hooks, perBlock, stubs);
+            std::vector<PVOID> targets{ stubs };
+
+            TB::Stopwatch stopwatch;
+            VERIFY_ARE_EQUAL(UpdateEach(targets, true), 0u);
+            TB::LogThroughput(L"Attach (one per transaction)", hooks, stopwatch.ElapsedSeconds());
+
+            VerifyStubs(stubs, true);
+
+            stopwatch.Restart();
+            VERIFY_ARE_EQUAL(UpdateEach(targets, false), 0u);
+            TB::LogThroughput(L"Detach (one per transaction)", hooks, stopwatch.ElapsedSeconds());
+
+            VerifyStubs(stubs, false);
+            VERIFY_IS_TRUE(targets == stubs);
+        }
+
+        // All hooks in a single transaction, then detached in a single transaction.
+        TEST_METHOD(AttachDetachOneTransaction_Stress)
+        {
+            const UINT32 hooks{ TB::GetUIntParameter(L"Hooks", 4096, 1, 1 << 20) };
+            const UINT32 perBlock{ TB::GetUIntParameter(L"HooksPerBlock", 1024, 1, c_codeBlockSize / c_stubSize) };
+
+            CodeBlocks blocks;
+            std::vector<PVOID> stubs;
+            blocks.Generate(hooks, perBlock, stubs);
+            std::vector<PVOID> targets{ stubs };
+
+            TB::Stopwatch stopwatch;
+            VERIFY_ARE_EQUAL(UpdateAll(targets, true), NO_ERROR);
+            TB::LogThroughput(L"Attach (single transaction)", hooks, stopwatch.ElapsedSeconds());
+
+            VerifyStubs(stubs, true);
+
+            stopwatch.Restart();
+            VERIFY_ARE_EQUAL(UpdateAll(targets, false), NO_ERROR);
+            TB::LogThroughput(L"Detach (single transaction)", hooks, stopwatch.ElapsedSeconds());
+
+            VerifyStubs(stubs, false);
+            VERIFY_IS_TRUE(targets == stubs);
+        }
+
+        // Times the commit of one large transaction on its own. Generated functions are packed
+        // many to a page, so the commit cost is dominated by restoring page protection and
+        // flushing the instruction cache for the patched code.
+        TEST_METHOD(CommitLatency_Stress)
+        {
+            const UINT32 hooks{ TB::GetUIntParameter(L"Hooks", 4096, 1, 1 << 20) };
+            const UINT32 perBlock{ TB::GetUIntParameter(L"HooksPerBlock", 1024, 1, c_codeBlockSize / c_stubSize) };
+
+            CodeBlocks blocks;
+            std::vector<PVOID> stubs;
+            blocks.Generate(hooks, perBlock, stubs);
+            std::vector<PVOID> targets{ stubs };
+
+            for (bool attach : { true, false })
+            {
+                TB::Stopwatch stopwatch;
+                VERIFY_ARE_EQUAL(DetourTransactionBegin(), NO_ERROR);
+                UINT32 failures{};
+                for (auto& target : targets)
+                {
+                    if ((attach ? DetourAttach(&target, DetouredStub) : DetourDetach(&target, DetouredStub)) != NO_ERROR)
+                    {
+                        failures++;
+                    }
+                }
+                const double queueSeconds{ stopwatch.ElapsedSeconds() };
+                stopwatch.Restart();
+                const LONG error{ DetourTransactionCommit() };
+                const double commitSeconds{ stopwatch.ElapsedSeconds() };
+
+                VERIFY_ARE_EQUAL(failures, 0u);
+                VERIFY_ARE_EQUAL(error, NO_ERROR);
+                TB::LogThroughput(attach ? L"Queue attach" : L"Queue detach", hooks, queueSeconds);
+                TB::LogThroughput(attach ? L"Commit attach" : L"Commit detach", hooks, commitSeconds);
+
+                VerifyStubs(stubs, attach);
+            }
+            VERIFY_IS_TRUE(targets == stubs);
+        }
+
+        // Hooks are detached in an interleaved order so regions become partly free and are
+        // reused by later attaches before they are released.
+        TEST_METHOD(ReuseFreedTrampolines_Stress)
+        {
+            const UINT32 hooks{ TB::GetUIntParameter(L"Hooks", 4096, 2, 1 << 20) };
+            const UINT32 perBlock{ TB::GetUIntParameter(L"HooksPerBlock", 1024, 1, c_codeBlockSize / c_stubSize) };
+
+            CodeBlocks blocks;
+            std::vector<PVOID> stubs;
+            blocks.Generate(hooks, perBlock, stubs);
+            std::vector<PVOID> targets{ stubs };
+
+            VERIFY_ARE_EQUAL(UpdateEach(targets, true), 0u);
+
+            TB::Stopwatch stopwatch;
+            UINT32 failures{};
+            for (UINT32 pass{}; pass < 4; pass++)
+            {
+                // Detach every other hook, then attach them again.
+                failures += UpdateEach(targets, false, pass % 2, 2);
+                failures += UpdateEach(targets, true, pass % 2, 2);
+            }
+            const double seconds{ stopwatch.ElapsedSeconds() };
+            VERIFY_ARE_EQUAL(failures, 0u);
+            TB::LogThroughput(L"Detach and reattach", hooks * 4, seconds);
+
+            VerifyStubs(stubs, true);
+
+            VERIFY_ARE_EQUAL(UpdateAll(targets, false), NO_ERROR);
+            VerifyStubs(stubs, false);
+            VERIFY_IS_TRUE(targets == stubs);
+        }
+    };
+}
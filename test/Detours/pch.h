@@ -0,0 +1,20 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#ifndef PCH_H
+#define PCH_H
+
+#include <windows.h>
+
+#include <WexTestClass.h>
+
+#include <WindowsAppRuntime.Test.Benchmark.h>
+
+#include <detours.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#endif //PCH_H
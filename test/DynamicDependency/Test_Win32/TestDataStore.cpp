@@ -0,0 +1,86 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include <algorithm>
+
+namespace TP = ::Test::Packages;
+
+namespace Test::DataStore
+{
+    std::filesystem::path GetDynamicDependencyPathForUser()
+    {
+        // Same place MddCore::DataStore resolves for a non-AppContainer caller
+        winrt::hstring packageFamilyName{ TP::WindowsAppRuntimeMain::c_PackageFamilyName };
+        auto applicationData{ winrt::Windows::Management::Core::ApplicationDataManager::CreateForPackageFamily(packageFamilyName) };
+        std::filesystem::path path{ applicationData.LocalFolder().Path().c_str() };
+        path /= L"DynamicDependency";
+        return path;
+    }
+
+    std::vector<BYTE> ReadFile(const std::filesystem::path& filename)
+    {
+        wil::unique_hfile file{ ::CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        VERIFY_IS_TRUE(!!file, WEX::Common::String().Format(L"Error %u opening %s", GetLastError(), filename.c_str()));
+
+        LARGE_INTEGER fileSize{};
+        VERIFY_WIN32_BOOL_SUCCEEDED(::GetFileSizeEx(file.get(), &fileSize));
+        std::vector<BYTE> data(static_cast<size_t>(fileSize.QuadPart));
+        DWORD bytesRead{};
+        VERIFY_WIN32_BOOL_SUCCEEDED(::ReadFile(file.get(), data.data(), static_cast<DWORD>(data.size()), &bytesRead, nullptr));
+        VERIFY_ARE_EQUAL(data.size(), static_cast<size_t>(bytesRead));
+        return data;
+    }
+
+    void WriteFile(const std::filesystem::path& filename, const std::vector<BYTE>& data)
+    {
+        wil::unique_hfile file{ ::CreateFileW(filename.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        VERIFY_IS_TRUE(!!file, WEX::Common::String().Format(L"Error %u creating %s", GetLastError(), filename.c_str()));
+
+        DWORD bytesWritten{};
+        VERIFY_WIN32_BOOL_SUCCEEDED(::WriteFile(file.get(), data.data(), static_cast<DWORD>(data.size()), &bytesWritten, nullptr));
+        VERIFY_ARE_EQUAL(data.size(), static_cast<size_t>(bytesWritten));
+    }
+
+    void DeleteFileIfExists(const std::filesystem::path& filename)
+    {
+        if (!::DeleteFileW(filename.c_str()))
+        {
+            const auto lastError{ GetLastError() };
+            VERIFY_IS_TRUE((lastError == ERROR_FILE_NOT_FOUND) || (lastError == ERROR_PATH_NOT_FOUND),
+                           WEX::Common::String().Format(L"Error %u deleting %s", lastError, filename.c_str()));
+        }
+    }
+
+    UINT64 GetLastWriteTime(const std::filesystem::path& filename)
+    {
+        WIN32_FILE_ATTRIBUTE_DATA attributes{};
+        VERIFY_WIN32_BOOL_SUCCEEDED(::GetFileAttributesExW(filename.c_str(), GetFileExInfoStandard, &attributes));
+        return (static_cast<UINT64>(attributes.ftLastWriteTime.dwHighDateTime) << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+    }
+
+    void UpdateChecksum(std::vector<BYTE>& data, const size_t headerSize, const size_t checksumOffset)
+    {
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(data.size(), headerSize);
+
+        UINT32 hash{ 2166136261u };
+        for (size_t index=headerSize; index < data.size(); ++index)
+        {
+            hash ^= data[index];
+            hash *= 16777619u;
+        }
+        memcpy(data.data() + checksumOffset, &hash, sizeof(hash));
+    }
+
+    void ReplaceString(std::vector<BYTE>& data, PCWSTR oldString, PCWSTR newString)
+    {
+        const auto length{ wcslen(oldString) };
+        VERIFY_ARE_EQUAL(length, wcslen(newString));
+
+        const auto oldBytes{ reinterpret_cast<const BYTE*>(oldString) };
+        auto iterator{ std::search(data.begin(), data.end(), oldBytes, oldBytes + (length * sizeof(WCHAR))) };
+        VERIFY_IS_TRUE(iterator != data.end(), WEX::Common::String().Format(L"%s not found", oldString));
+        memcpy(&*iterator, newString, length * sizeof(WCHAR));
+    }
+}
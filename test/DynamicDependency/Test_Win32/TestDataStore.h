@@ -0,0 +1,22 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+namespace Test::DataStore
+{
+    /// The user's DynamicDependency data store folder, where .mdd files and the WinRT manifest cache live.
+    std::filesystem::path GetDynamicDependencyPathForUser();
+
+    std::vector<BYTE> ReadFile(const std::filesystem::path& filename);
+
+    void WriteFile(const std::filesystem::path& filename, const std::vector<BYTE>& data);
+
+    void DeleteFileIfExists(const std::filesystem::path& filename);
+
+    UINT64 GetLastWriteTime(const std::filesystem::path& filename);
+
+    /// Recompute a cache file's FNV-1a checksum (over everything after the header) after editing it.
+    void UpdateChecksum(std::vector<BYTE>& data, const size_t headerSize, const size_t checksumOffset);
+
+    /// Replace the first occurrence of a (non-NUL-terminated) UTF-16 string with another of the same length.
+    void ReplaceString(std::vector<BYTE>& data, PCWSTR oldString, PCWSTR newString);
+}
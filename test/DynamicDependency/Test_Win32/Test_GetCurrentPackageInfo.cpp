@@ -162,6 +162,57 @@ namespace Test::DynamicDependency
             MddDeletePackageDependency(packageDependencyId_FrameworkMathAdd.get());
         }
 
+        TEST_METHOD(Unpackaged_PackageGraph1_RepeatedQueries)
+        {
+            // -- TryCreate
+            const PACKAGE_VERSION minVersion{};
+            const MddPackageDependencyProcessorArchitectures architectures{};
+            const auto lifetimeKind{ MddPackageDependencyLifetimeKind::Process };
+            PCWSTR lifetimeArtifact{};
+            const MddCreatePackageDependencyOptions createOptions{};
+            wil::unique_process_heap_string packageDependencyId_FrameworkMathAdd;
+            VERIFY_ARE_EQUAL(S_OK, MddTryCreatePackageDependency(nullptr, TP::FrameworkMathAdd::c_PackageFamilyName, minVersion, architectures, lifetimeKind, lifetimeArtifact, createOptions, &packageDependencyId_FrameworkMathAdd));
+
+            // -- Add
+            const auto rank{ MDD_PACKAGE_DEPENDENCY_RANK_DEFAULT };
+            const MddAddPackageDependencyOptions addOptions{};
+            MDD_PACKAGEDEPENDENCY_CONTEXT packageDependencyContext_FrameworkMathAdd{};
+            wil::unique_process_heap_string packageFullName_FrameworkMathAdd;
+            VERIFY_ARE_EQUAL(S_OK, MddAddPackageDependency(packageDependencyId_FrameworkMathAdd.get(), rank, addOptions, &packageDependencyContext_FrameworkMathAdd, &packageFullName_FrameworkMathAdd));
+
+            // Repeated queries (the 2nd+ are answered from the serialized result of the 1st)
+            // must return the same data with pointers into the caller's buffer
+            const UINT32 flags{ PACKAGE_FILTER_DIRECT | PACKAGE_FILTER_DYNAMIC };
+            for (int pass=0; pass < 3; ++pass)
+            {
+                UINT32 bufferLength{};
+                UINT32 count{};
+                VERIFY_ARE_EQUAL(ERROR_INSUFFICIENT_BUFFER, GetCurrentPackageInfo2(flags, PackagePathType_Install, &bufferLength, nullptr, &count));
+                VERIFY_ARE_EQUAL(1u, count);
+                VERIFY_IS_TRUE(bufferLength >= sizeof(PACKAGE_INFO));
+
+                auto buffer{ wil::make_unique_nothrow<BYTE[]>(bufferLength) };
+                VERIFY_IS_NOT_NULL(buffer.get());
+                count = 0;
+                VERIFY_ARE_EQUAL(ERROR_SUCCESS, GetCurrentPackageInfo2(flags, PackagePathType_Install, &bufferLength, buffer.get(), &count));
+                VERIFY_ARE_EQUAL(1u, count);
+
+                const auto packageInfo{ reinterpret_cast<const PACKAGE_INFO*>(buffer.get()) };
+                const auto packageFullName{ reinterpret_cast<const BYTE*>(packageInfo->packageFullName) };
+                VERIFY_IS_TRUE((packageFullName >= buffer.get()) && (packageFullName < buffer.get() + bufferLength));
+                VERIFY_ARE_EQUAL(std::wstring(packageFullName_FrameworkMathAdd.get()), std::wstring(packageInfo->packageFullName));
+            }
+
+            // -- Remove
+            MddRemovePackageDependency(packageDependencyContext_FrameworkMathAdd);
+
+            // The package graph changed so the previous answer no longer applies
+            VerifyGetCurrentPackageInfo123(flags);
+
+            // -- Delete
+            MddDeletePackageDependency(packageDependencyId_FrameworkMathAdd.get());
+        }
+
         void VerifyGetCurrentPackageInfo1(
             const UINT32 flags,
             const HRESULT expectedHR = HRESULT_FROM_WIN32(APPMODEL_ERROR_NO_PACKAGE),
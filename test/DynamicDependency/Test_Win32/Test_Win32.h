@@ -46,6 +46,19 @@ namespace Test::DynamicDependency
 
         TEST_METHOD(WinRTReentrancy);
 
+        TEST_METHOD(WinRTActivation_Benchmark);
+
+        TEST_METHOD(WinRTPackageCache_RoundTrip);
+        TEST_METHOD(WinRTPackageCache_Corrupted);
+        TEST_METHOD(WinRTPackageCache_VersionMismatch);
+        TEST_METHOD(WinRTPackageCache_ManifestUpdated);
+
+        TEST_METHOD(DataStore_LoadPersisted);
+        TEST_METHOD(DataStore_RewrittenInPlace);
+        TEST_METHOD(PackageDependency_IdIsCaseInsensitive);
+
+        TEST_METHOD(PackageGraph_Benchmark);
+
     private:
         static void VerifyPackageDependency(
             PCWSTR packageDependencyId,
@@ -96,6 +109,8 @@ namespace Test::DynamicDependency
             const size_t packageInfoCount,
             const PACKAGE_INFO* packageInfo);
 
+        void VerifyWinRTPackageCache(const HRESULT expectedActivationHR);
+
     private:
         // Overloads and conveniences for TryCreate to simplify test readability
         wil::unique_process_heap_string Mdd_TryCreate(
@@ -0,0 +1,123 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include <MsixDynamicDependency.h>
+
+#include "Test_Win32.h"
+
+namespace TD = ::Test::DataStore;
+namespace TP = ::Test::Packages;
+
+static std::filesystem::path GetPackageDependencyFilename(const std::wstring& packageDependencyId)
+{
+    return TD::GetDynamicDependencyPathForUser() / (packageDependencyId + L".mdd");
+}
+
+static std::wstring ToUpper(const std::wstring& string)
+{
+    std::wstring upper{ string };
+    ::CharUpperBuffW(upper.data(), static_cast<DWORD>(upper.length()));
+    return upper;
+}
+
+static std::wstring ToLower(const std::wstring& string)
+{
+    std::wstring lower{ string };
+    ::CharLowerBuffW(lower.data(), static_cast<DWORD>(lower.length()));
+    return lower;
+}
+
+static std::vector<BYTE> ReplacePackageFamilyName(const std::vector<BYTE>& data, PCWSTR oldPackageFamilyName, PCWSTR newPackageFamilyName)
+{
+    // .mdd files are UTF-8 JSON and package family names are ASCII
+    std::string json(reinterpret_cast<const char*>(data.data()), data.size());
+    const std::filesystem::path oldName{ oldPackageFamilyName };
+    const std::filesystem::path newName{ newPackageFamilyName };
+    const auto offset{ json.find(oldName.string()) };
+    VERIFY_ARE_NOT_EQUAL(offset, std::string::npos);
+    json.replace(offset, oldName.string().length(), newName.string());
+    return std::vector<BYTE>(json.begin(), json.end());
+}
+
+void Test::DynamicDependency::Test_Win32::DataStore_LoadPersisted()
+{
+    std::wstring expectedPackageFullName_FrameworkMathAdd{ TP::FrameworkMathAdd::c_PackageFullName };
+
+    auto lifetimeArtifactFilename{ std::filesystem::temp_directory_path() / L"Test-DataStore-LifetimeArtifact.tmp" };
+    wil::unique_hfile lifetimeArtifactFile{ File_CreateTemporary(lifetimeArtifactFilename) };
+    VERIFY_IS_TRUE(lifetimeArtifactFile.is_valid());
+    wil::unique_process_heap_string packageDependencyId_FrameworkMathAdd{ Mdd_TryCreate_FrameworkMathAdd(MddPackageDependencyLifetimeKind::FilePath, lifetimeArtifactFilename.c_str()) };
+
+    // A package dependency this process never created is only known by its file name
+    const std::wstring persistedId{ std::wstring(packageDependencyId_FrameworkMathAdd.get()) + L"-Persisted" };
+    const auto persistedFilename{ GetPackageDependencyFilename(persistedId) };
+    TD::WriteFile(persistedFilename, TD::ReadFile(GetPackageDependencyFilename(packageDependencyId_FrameworkMathAdd.get())));
+
+    // Found via the data store under a differently cased id, and reported under the id it was saved as
+    VerifyPackageDependency(ToUpper(persistedId).c_str(), S_OK, expectedPackageFullName_FrameworkMathAdd);
+
+    wil::unique_process_heap_string packageFullName;
+    MDD_PACKAGEDEPENDENCY_CONTEXT packageDependencyContext{ Mdd_Add(persistedId.c_str(), packageFullName) };
+    VERIFY_ARE_EQUAL(expectedPackageFullName_FrameworkMathAdd, std::wstring(packageFullName.get()));
+    wil::unique_process_heap_string id;
+    VERIFY_ARE_EQUAL(S_OK, MddGetIdForPackageDependencyContext(packageDependencyContext, wil::out_param(id)));
+    VERIFY_ARE_EQUAL(persistedId, std::wstring(id.get()));
+    MddRemovePackageDependency(packageDependencyContext);
+
+    MddDeletePackageDependency(persistedId.c_str());
+    VerifyPackageDependency(persistedId.c_str(), HRESULT_FROM_WIN32(ERROR_NOT_FOUND));
+    VERIFY_IS_FALSE(std::filesystem::exists(persistedFilename));
+
+    MddDeletePackageDependency(packageDependencyId_FrameworkMathAdd.get());
+}
+
+void Test::DynamicDependency::Test_Win32::DataStore_RewrittenInPlace()
+{
+    auto lifetimeArtifactFilename{ std::filesystem::temp_directory_path() / L"Test-DataStore-LifetimeArtifact.tmp" };
+    wil::unique_hfile lifetimeArtifactFile{ File_CreateTemporary(lifetimeArtifactFilename) };
+    VERIFY_IS_TRUE(lifetimeArtifactFile.is_valid());
+    wil::unique_process_heap_string packageDependencyId_FrameworkMathAdd{ Mdd_TryCreate_FrameworkMathAdd(MddPackageDependencyLifetimeKind::FilePath, lifetimeArtifactFilename.c_str()) };
+    const auto data{ TD::ReadFile(GetPackageDependencyFilename(packageDependencyId_FrameworkMathAdd.get())) };
+
+    // Two package dependencies this process hasn't seen. Looking up the 1st indexes both
+    const std::wstring indexedId{ std::wstring(packageDependencyId_FrameworkMathAdd.get()) + L"-Indexed" };
+    const std::wstring rewrittenId{ std::wstring(packageDependencyId_FrameworkMathAdd.get()) + L"-Rewritten" };
+    TD::WriteFile(GetPackageDependencyFilename(indexedId), data);
+    TD::WriteFile(GetPackageDependencyFilename(rewrittenId), data);
+    VerifyPackageDependency(indexedId.c_str(), S_OK, TP::FrameworkMathAdd::c_PackageFullName);
+
+    // Rewriting a file in place doesn't change the folder but the index must not return the old definition
+    const auto folderLastWriteTime{ TD::GetLastWriteTime(TD::GetDynamicDependencyPathForUser()) };
+    TD::WriteFile(GetPackageDependencyFilename(rewrittenId), ReplacePackageFamilyName(data, TP::FrameworkMathAdd::c_PackageFamilyName, TP::WindowsAppRuntimeFramework::c_PackageFamilyName));
+    VERIFY_ARE_EQUAL(folderLastWriteTime, TD::GetLastWriteTime(TD::GetDynamicDependencyPathForUser()));
+    VerifyPackageDependency(rewrittenId.c_str(), S_OK, TP::WindowsAppRuntimeFramework::c_PackageFullName);
+
+    MddDeletePackageDependency(rewrittenId.c_str());
+    MddDeletePackageDependency(indexedId.c_str());
+    MddDeletePackageDependency(packageDependencyId_FrameworkMathAdd.get());
+}
+
+void Test::DynamicDependency::Test_Win32::PackageDependency_IdIsCaseInsensitive()
+{
+    std::wstring expectedPackageFullName_FrameworkMathAdd{ TP::FrameworkMathAdd::c_PackageFullName };
+
+    wil::unique_process_heap_string packageDependencyId_FrameworkMathAdd{ Mdd_TryCreate_FrameworkMathAdd() };
+    const std::wstring upperId{ ToUpper(packageDependencyId_FrameworkMathAdd.get()) };
+    const std::wstring lowerId{ ToLower(packageDependencyId_FrameworkMathAdd.get()) };
+
+    VerifyPackageDependency(upperId.c_str(), S_OK, expectedPackageFullName_FrameworkMathAdd);
+    VerifyPackageDependency(lowerId.c_str(), S_OK, expectedPackageFullName_FrameworkMathAdd);
+
+    wil::unique_process_heap_string packageFullName;
+    MDD_PACKAGEDEPENDENCY_CONTEXT packageDependencyContext{ Mdd_Add(lowerId.c_str(), packageFullName) };
+    VERIFY_ARE_EQUAL(expectedPackageFullName_FrameworkMathAdd, std::wstring(packageFullName.get()));
+    VerifyPackageInPackageGraph(expectedPackageFullName_FrameworkMathAdd, S_OK);
+    MddRemovePackageDependency(packageDependencyContext);
+    VerifyPackageNotInPackageGraph(expectedPackageFullName_FrameworkMathAdd, S_OK);
+
+    // Deleting by any spelling deletes the one package dependency
+    MddDeletePackageDependency(upperId.c_str());
+    VerifyPackageDependency(packageDependencyId_FrameworkMathAdd.get(), HRESULT_FROM_WIN32(ERROR_NOT_FOUND));
+}
@@ -0,0 +1,84 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include <MsixDynamicDependency.h>
+
+#include <WindowsAppRuntime.Test.Benchmark.h>
+
+#include "Test_Win32.h"
+
+namespace TB = ::Test::Benchmark;
+namespace TF = ::Test::FileSystem;
+namespace TP = ::Test::Packages;
+
+void Test::DynamicDependency::Test_Win32::PackageGraph_Benchmark()
+{
+    // Setup our dynamic dependencies
+
+    std::wstring expectedPackageFullName_WindowsAppRuntimeFramework{ TP::WindowsAppRuntimeFramework::c_PackageFullName };
+    std::wstring expectedPackageFullName_FrameworkMathAdd{ TP::FrameworkMathAdd::c_PackageFullName };
+
+    VerifyPackageInPackageGraph(expectedPackageFullName_WindowsAppRuntimeFramework, S_OK);
+    VerifyPackageNotInPackageGraph(expectedPackageFullName_FrameworkMathAdd, S_OK);
+    auto pathEnvironmentVariable{ GetPathEnvironmentVariableMinusWindowsAppRuntimeFramework() };
+    auto packagePath_WindowsAppRuntimeFramework{ TP::GetPackagePath(expectedPackageFullName_WindowsAppRuntimeFramework) };
+    VerifyPathEnvironmentVariable(packagePath_WindowsAppRuntimeFramework, pathEnvironmentVariable.c_str());
+
+    // -- TryCreate
+
+    wil::unique_process_heap_string packageDependencyId_FrameworkMathAdd{ Mdd_TryCreate_FrameworkMathAdd() };
+
+    // -- Add the same package many times, across a handful of ranks, both appended and prepended
+
+    const auto nodes{ TB::GetUIntParameter(L"PackageGraphNodes", 500) };
+    std::vector<MDD_PACKAGEDEPENDENCY_CONTEXT> packageDependencyContexts;
+    packageDependencyContexts.reserve(nodes);
+
+    WEX::TestExecution::SetVerifyOutput verifySettings(WEX::TestExecution::VerifyOutputSettings::LogOnlyFailures);
+    TB::Stopwatch stopwatch;
+    for (UINT32 index = 0; index < nodes; ++index)
+    {
+        const INT32 rank{ static_cast<INT32>(index % 7) - 3 };
+        const auto options{ (index % 2) ? MddAddPackageDependencyOptions::PrependIfRankCollision : MddAddPackageDependencyOptions::None };
+        wil::unique_process_heap_string packageFullName;
+        packageDependencyContexts.push_back(Mdd_Add(packageDependencyId_FrameworkMathAdd.get(), rank, options, packageFullName));
+    }
+    TB::LogThroughput(L"MddAddPackageDependency", nodes, stopwatch.ElapsedSeconds());
+
+    VerifyPackageInPackageGraph(expectedPackageFullName_FrameworkMathAdd, S_OK);
+    {
+        UINT32 packageInfoCount{};
+        const PACKAGE_INFO* packageInfo{};
+        wil::unique_cotaskmem_ptr<BYTE[]> buffer;
+        VERIFY_ARE_EQUAL(S_OK, GetCurrentPackageInfo(packageInfoCount, packageInfo, buffer));
+        VERIFY_IS_TRUE(packageInfoCount >= nodes + 1);
+    }
+
+    // -- Remove from the middle out: odd adds first, then even adds newest to oldest
+
+    stopwatch.Restart();
+    for (UINT32 index = 1; index < nodes; index += 2)
+    {
+        MddRemovePackageDependency(packageDependencyContexts[index]);
+    }
+    for (auto index{ static_cast<INT64>(nodes) - 1 }; index >= 0; --index)
+    {
+        if ((index % 2) == 0)
+        {
+            MddRemovePackageDependency(packageDependencyContexts[static_cast<size_t>(index)]);
+        }
+    }
+    TB::LogThroughput(L"MddRemovePackageDependency", nodes, stopwatch.ElapsedSeconds());
+
+    // Everything we added is gone, and PATH is exactly as we found it
+
+    VerifyPackageNotInPackageGraph(expectedPackageFullName_FrameworkMathAdd, S_OK);
+    VerifyPathEnvironmentVariable(packagePath_WindowsAppRuntimeFramework, pathEnvironmentVariable.c_str());
+
+    // -- Delete
+
+    MddDeletePackageDependency(packageDependencyId_FrameworkMathAdd.get());
+    VerifyPackageDependency(packageDependencyId_FrameworkMathAdd.get(), HRESULT_FROM_WIN32(ERROR_NOT_FOUND));
+}
@@ -0,0 +1,87 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include <activation.h>
+
+#include <MsixDynamicDependency.h>
+
+#include <WindowsAppRuntime.Test.Benchmark.h>
+
+#include "Test_Win32.h"
+
+namespace TB = ::Test::Benchmark;
+namespace TF = ::Test::FileSystem;
+namespace TP = ::Test::Packages;
+
+void Test::DynamicDependency::Test_Win32::WinRTActivation_Benchmark()
+{
+    // Setup our dynamic dependencies
+
+    std::wstring expectedPackageFullName_FrameworkWidgets{ TP::FrameworkWidgets::c_PackageFullName };
+    VerifyPackageNotInPackageGraph(expectedPackageFullName_FrameworkWidgets, S_OK);
+
+    auto architectures{ MddPackageDependencyProcessorArchitectures::Neutral };
+    wil::unique_process_heap_string packageDependencyId_FrameworkWidgets{ Mdd_TryCreate_FrameworkWidgets(architectures) };
+
+    wil::unique_process_heap_string packageFullName_FrameworkWidgets;
+    MDD_PACKAGEDEPENDENCY_CONTEXT packageDependencyContext_FrameworkWidgets{ Mdd_Add(packageDependencyId_FrameworkWidgets.get(), packageFullName_FrameworkWidgets) };
+    VERIFY_IS_NOT_NULL(packageFullName_FrameworkWidgets.get());
+    VerifyPackageInPackageGraph(expectedPackageFullName_FrameworkWidgets, S_OK);
+
+    // Activate an inproc class from the dynamically added package, via the package graph
+
+    const auto iterations{ TB::GetUIntParameter(L"ActivationIterations", 100000) };
+    auto acid{ wil::make_unique_string<wil::unique_hstring>(L"Microsoft.Test.DynamicDependency.Widgets.Widget1") };
+
+    // -- Cold: resolves the class and loads the component
+
+    const auto coldSeconds{ TB::TimeIterations(1, [&]()
+    {
+        wil::com_ptr<IInspectable> instance;
+        VERIFY_SUCCEEDED(::RoActivateInstance(acid.get(), instance.put()));
+        VERIFY_IS_NOT_NULL(instance.get());
+    }) };
+    TB::LogThroughput(L"RoActivateInstance (cold)", 1, coldSeconds);
+
+    // -- Warm: the same class, over and over
+
+    WEX::TestExecution::SetVerifyOutput verifySettings(WEX::TestExecution::VerifyOutputSettings::LogOnlyFailures);
+    const auto activateSeconds{ TB::TimeIterations(iterations, [&]()
+    {
+        wil::com_ptr<IInspectable> instance;
+        VERIFY_SUCCEEDED(::RoActivateInstance(acid.get(), instance.put()));
+    }) };
+    TB::LogThroughput(L"RoActivateInstance (warm)", iterations, activateSeconds);
+
+    const auto factorySeconds{ TB::TimeIterations(iterations, [&]()
+    {
+        wil::com_ptr<IActivationFactory> factory;
+        VERIFY_SUCCEEDED(::RoGetActivationFactory(acid.get(), IID_PPV_ARGS(factory.put())));
+    }) };
+    TB::LogThroughput(L"RoGetActivationFactory (warm)", iterations, factorySeconds);
+
+    // Tear down our dynamic dependencies
+
+    // -- Remove
+
+    MddRemovePackageDependency(packageDependencyContext_FrameworkWidgets);
+    VerifyPackageNotInPackageGraph(expectedPackageFullName_FrameworkWidgets, S_OK);
+
+    // Nothing cached before the package graph changed may be used after
+    {
+        wil::com_ptr<IInspectable> instance;
+        VERIFY_ARE_EQUAL(REGDB_E_CLASSNOTREG, ::RoActivateInstance(acid.get(), instance.put()));
+        VERIFY_IS_NULL(instance.get());
+
+        wil::com_ptr<IActivationFactory> factory;
+        VERIFY_ARE_EQUAL(REGDB_E_CLASSNOTREG, ::RoGetActivationFactory(acid.get(), IID_PPV_ARGS(factory.put())));
+        VERIFY_IS_NULL(factory.get());
+    }
+
+    // -- Delete
+
+    MddDeletePackageDependency(packageDependencyId_FrameworkWidgets.get());
+    VerifyPackageDependency(packageDependencyId_FrameworkWidgets.get(), HRESULT_FROM_WIN32(ERROR_NOT_FOUND));
+}
@@ -0,0 +1,149 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include <activation.h>
+
+#include <MsixDynamicDependency.h>
+
+#include "Test_Win32.h"
+
+namespace TD = ::Test::DataStore;
+namespace TP = ::Test::Packages;
+
+// Entry header offsets. Mirrors the Header in dev\DynamicDependency\API\WinRTPackageCache.cpp
+constexpr size_t c_winrtPackageCacheHeaderSize{ 48 };
+constexpr size_t c_winrtPackageCacheVersionOffset{ 4 };
+constexpr size_t c_winrtPackageCacheManifestLastWriteTimeOffset{ 16 };
+constexpr size_t c_winrtPackageCacheChecksumOffset{ 44 };
+
+constexpr PCWSTR c_widget1ActivatableClassId{ L"Microsoft.Test.DynamicDependency.Widgets.Widget1" };
+constexpr PCWSTR c_widget9ActivatableClassId{ L"Microsoft.Test.DynamicDependency.Widgets.Widget9" };
+
+static std::filesystem::path GetWinRTPackageCacheFilename()
+{
+    auto filename{ TD::GetDynamicDependencyPathForUser() };
+    filename /= L"WinRT";
+    filename /= std::wstring(TP::FrameworkWidgets::c_PackageFullName) + L".winrt";
+    return filename;
+}
+
+void Test::DynamicDependency::Test_Win32::VerifyWinRTPackageCache(const HRESULT expectedActivationHR)
+{
+    // Add the Widgets package (reading or writing its cache entry) and activate one of its classes
+
+    auto architectures{ MddPackageDependencyProcessorArchitectures::Neutral };
+    wil::unique_process_heap_string packageDependencyId_FrameworkWidgets{ Mdd_TryCreate_FrameworkWidgets(architectures) };
+
+    wil::unique_process_heap_string packageFullName_FrameworkWidgets;
+    MDD_PACKAGEDEPENDENCY_CONTEXT packageDependencyContext_FrameworkWidgets{ Mdd_Add(packageDependencyId_FrameworkWidgets.get(), packageFullName_FrameworkWidgets) };
+    VerifyPackageInPackageGraph(TP::FrameworkWidgets::c_PackageFullName, S_OK);
+
+    auto acid{ wil::make_unique_string<wil::unique_hstring>(c_widget1ActivatableClassId) };
+    wil::com_ptr<IInspectable> instance;
+    VERIFY_ARE_EQUAL(expectedActivationHR, ::RoActivateInstance(acid.get(), instance.put()));
+    instance.reset();
+
+    MddRemovePackageDependency(packageDependencyContext_FrameworkWidgets);
+    VerifyPackageNotInPackageGraph(TP::FrameworkWidgets::c_PackageFullName, S_OK);
+
+    MddDeletePackageDependency(packageDependencyId_FrameworkWidgets.get());
+}
+
+void Test::DynamicDependency::Test_Win32::WinRTPackageCache_RoundTrip()
+{
+    const auto filename{ GetWinRTPackageCacheFilename() };
+    TD::DeleteFileIfExists(filename);
+
+    // Not cached. The manifest is parsed and the entry written
+    VerifyWinRTPackageCache(S_OK);
+    const auto entry{ TD::ReadFile(filename) };
+    const auto lastWriteTime{ TD::GetLastWriteTime(filename) };
+
+    // Cached. The entry is read, not rewritten
+    VerifyWinRTPackageCache(S_OK);
+    VERIFY_IS_TRUE(TD::ReadFile(filename) == entry);
+    VERIFY_ARE_EQUAL(lastWriteTime, TD::GetLastWriteTime(filename));
+
+    // A valid entry is trusted over the manifest. Renaming the class in it hides the real one
+    auto renamedEntry{ entry };
+    TD::ReplaceString(renamedEntry, c_widget1ActivatableClassId, c_widget9ActivatableClassId);
+    TD::UpdateChecksum(renamedEntry, c_winrtPackageCacheHeaderSize, c_winrtPackageCacheChecksumOffset);
+    TD::WriteFile(filename, renamedEntry);
+    VerifyWinRTPackageCache(REGDB_E_CLASSNOTREG);
+
+    TD::DeleteFileIfExists(filename);
+}
+
+void Test::DynamicDependency::Test_Win32::WinRTPackageCache_Corrupted()
+{
+    const auto filename{ GetWinRTPackageCacheFilename() };
+    TD::DeleteFileIfExists(filename);
+    VerifyWinRTPackageCache(S_OK);
+    const auto entry{ TD::ReadFile(filename) };
+
+    // A checksum mismatch is a miss. The manifest is parsed and the entry rewritten
+    auto corruptedEntry{ entry };
+    corruptedEntry.back() ^= 0xFF;
+    TD::WriteFile(filename, corruptedEntry);
+    VerifyWinRTPackageCache(S_OK);
+    VERIFY_IS_TRUE(TD::ReadFile(filename) == entry);
+
+    // Ditto a truncated entry
+    const std::vector<BYTE> truncatedEntry(entry.begin(), entry.begin() + (entry.size() / 2));
+    TD::WriteFile(filename, truncatedEntry);
+    VerifyWinRTPackageCache(S_OK);
+    VERIFY_IS_TRUE(TD::ReadFile(filename) == entry);
+
+    // Ditto a header-only entry
+    const std::vector<BYTE> headerOnlyEntry(entry.begin(), entry.begin() + c_winrtPackageCacheHeaderSize);
+    TD::WriteFile(filename, headerOnlyEntry);
+    VerifyWinRTPackageCache(S_OK);
+    VERIFY_IS_TRUE(TD::ReadFile(filename) == entry);
+
+    TD::DeleteFileIfExists(filename);
+}
+
+void Test::DynamicDependency::Test_Win32::WinRTPackageCache_VersionMismatch()
+{
+    const auto filename{ GetWinRTPackageCacheFilename() };
+    TD::DeleteFileIfExists(filename);
+    VerifyWinRTPackageCache(S_OK);
+    const auto entry{ TD::ReadFile(filename) };
+
+    // An entry in another format version is a miss, even if it's otherwise intact
+    auto otherVersionEntry{ entry };
+    UINT32 version{};
+    memcpy(&version, otherVersionEntry.data() + c_winrtPackageCacheVersionOffset, sizeof(version));
+    ++version;
+    memcpy(otherVersionEntry.data() + c_winrtPackageCacheVersionOffset, &version, sizeof(version));
+    TD::WriteFile(filename, otherVersionEntry);
+    VerifyWinRTPackageCache(S_OK);
+    VERIFY_IS_TRUE(TD::ReadFile(filename) == entry);
+
+    TD::DeleteFileIfExists(filename);
+}
+
+void Test::DynamicDependency::Test_Win32::WinRTPackageCache_ManifestUpdated()
+{
+    const auto filename{ GetWinRTPackageCacheFilename() };
+    TD::DeleteFileIfExists(filename);
+    VerifyWinRTPackageCache(S_OK);
+    const auto entry{ TD::ReadFile(filename) };
+
+    // An entry saved for an older manifest (here, naming a class the manifest no longer has) is
+    // stale. It's ignored, the current manifest is parsed, and the entry rewritten
+    auto staleEntry{ entry };
+    TD::ReplaceString(staleEntry, c_widget1ActivatableClassId, c_widget9ActivatableClassId);
+    UINT64 manifestLastWriteTime{};
+    memcpy(&manifestLastWriteTime, staleEntry.data() + c_winrtPackageCacheManifestLastWriteTimeOffset, sizeof(manifestLastWriteTime));
+    --manifestLastWriteTime;
+    memcpy(staleEntry.data() + c_winrtPackageCacheManifestLastWriteTimeOffset, &manifestLastWriteTime, sizeof(manifestLastWriteTime));
+    TD::UpdateChecksum(staleEntry, c_winrtPackageCacheHeaderSize, c_winrtPackageCacheChecksumOffset);
+    TD::WriteFile(filename, staleEntry);
+    VerifyWinRTPackageCache(S_OK);
+    VERIFY_IS_TRUE(TD::ReadFile(filename) == entry);
+
+    TD::DeleteFileIfExists(filename);
+}
@@ -37,6 +37,7 @@
 
 #include <WexTestClass.h>
 
+#include "TestDataStore.h"
 #include "TestFilesystem.h"
 #include "TestPackages.h"
 
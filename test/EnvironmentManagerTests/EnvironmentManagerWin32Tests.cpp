@@ -519,4 +519,61 @@ namespace WindowsAppSDKEnvironmentManagerTests
 
         VERIFY_ARE_EQUAL(currentPath, pathToManipulate);
     }
+
+    void EnvironmentManagerWin32Tests::TestGetSnapshotForProcess()
+    {
+        EnvironmentManager environmentManager{ EnvironmentManager::GetForProcess() };
+        EnvironmentSnapshot snapshot{ environmentManager.GetSnapshot() };
+        CompareIMapViews(snapshot.Variables(), GetEnvironmentVariablesForProcess());
+
+        // Nothing changed so the same snapshot is returned
+        VERIFY_IS_TRUE(snapshot == environmentManager.GetSnapshot());
+
+        VERIFY_NO_THROW(environmentManager.SetEnvironmentVariable(c_EvKeyName, c_EvValueName));
+        EnvironmentSnapshot afterAdd{ environmentManager.GetSnapshot() };
+        VERIFY_IS_GREATER_THAN(afterAdd.Version(), snapshot.Version());
+        VERIFY_ARE_EQUAL(std::wstring{ c_EvValueName }, std::wstring{ afterAdd.GetEnvironmentVariable(c_EvKeyName) });
+
+        auto changes{ afterAdd.GetChangesSince(snapshot) };
+        VERIFY_ARE_EQUAL(1u, changes.Size());
+        VERIFY_IS_TRUE(changes.GetAt(0).Kind == EnvironmentVariableChangeKind::Added);
+        VERIFY_ARE_EQUAL(std::wstring{ c_EvKeyName }, std::wstring{ changes.GetAt(0).Name });
+
+        // Changes made without the EnvironmentManager are seen too
+        VERIFY_WIN32_BOOL_SUCCEEDED(::SetEnvironmentVariable(c_EvKeyName, nullptr));
+        EnvironmentSnapshot afterRemove{ environmentManager.GetSnapshot() };
+        changes = afterRemove.GetChangesSince(afterAdd);
+        VERIFY_ARE_EQUAL(1u, changes.Size());
+        VERIFY_IS_TRUE(changes.GetAt(0).Kind == EnvironmentVariableChangeKind::Removed);
+        VERIFY_ARE_EQUAL(std::wstring{ c_EvValueName }, std::wstring{ changes.GetAt(0).OldValue });
+        VERIFY_ARE_EQUAL(0u, afterRemove.GetChangesSince(snapshot).Size());
+    }
+
+    void EnvironmentManagerWin32Tests::TestGetSnapshotForUser()
+    {
+        EnvironmentManager environmentManager{ EnvironmentManager::GetForUser() };
+        EnvironmentSnapshot snapshot{ environmentManager.GetSnapshot() };
+        CompareIMapViews(snapshot.Variables(), GetEnvironmentVariablesForUser());
+        VERIFY_IS_TRUE(snapshot == environmentManager.GetSnapshot());
+
+        if (!IsILAtOrAbove(ProcessRunLevel::Standard))
+        {
+            return;
+        }
+
+        VERIFY_NO_THROW(environmentManager.SetEnvironmentVariable(c_EvKeyName, c_EvValueName));
+        EnvironmentSnapshot afterAdd{ environmentManager.GetSnapshot() };
+        VERIFY_ARE_EQUAL(std::wstring{ c_EvValueName }, std::wstring{ afterAdd.GetEnvironmentVariable(c_EvKeyName) });
+
+        VERIFY_NO_THROW(environmentManager.SetEnvironmentVariable(c_EvKeyName, c_EvValueName2));
+        EnvironmentSnapshot afterChange{ environmentManager.GetSnapshot() };
+        auto changes{ afterChange.GetChangesSince(afterAdd) };
+        VERIFY_ARE_EQUAL(1u, changes.Size());
+        VERIFY_IS_TRUE(changes.GetAt(0).Kind == EnvironmentVariableChangeKind::Changed);
+        VERIFY_ARE_EQUAL(std::wstring{ c_EvValueName }, std::wstring{ changes.GetAt(0).OldValue });
+        VERIFY_ARE_EQUAL(std::wstring{ c_EvValueName2 }, std::wstring{ changes.GetAt(0).NewValue });
+
+        VERIFY_NO_THROW(environmentManager.SetEnvironmentVariable(c_EvKeyName, L""));
+        VERIFY_IS_TRUE(environmentManager.GetSnapshot().GetEnvironmentVariable(c_EvKeyName).empty());
+    }
 }
@@ -84,5 +84,8 @@ namespace WindowsAppSDKEnvironmentManagerTests
         TEST_METHOD(TestRemoveFromPathExtForProcess);
         TEST_METHOD(TestRemoveFromPathExtForUser);
         TEST_METHOD(TestRemoveFromPathExtForMachine);
+
+        TEST_METHOD(TestGetSnapshotForProcess);
+        TEST_METHOD(TestGetSnapshotForUser);
     };
 }
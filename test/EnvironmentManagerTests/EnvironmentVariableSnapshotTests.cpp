@@ -0,0 +1,246 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include "EnvironmentVariableSnapshotTests.h"
+#include "..\..\dev\EnvironmentManager\API\EnvironmentVariableSnapshot.h"
+#include <random>
+
+using winrt::Microsoft::Windows::System::implementation::EnvironmentVariableSnapshot;
+
+namespace WindowsAppSDKEnvironmentManagerTests
+{
+    namespace
+    {
+        // Environment blocks are double null terminated, which a string literal can't end with on its own
+        std::wstring MakeEnvironmentBlock(std::initializer_list<PCWSTR> entries)
+        {
+            std::wstring block;
+            for (auto entry : entries)
+            {
+                block += entry;
+                block += L'\0';
+            }
+            block += L'\0';
+            return block;
+        }
+
+        EnvironmentVariableSnapshot MakeSnapshot(std::initializer_list<PCWSTR> entries, uint64_t version = 1)
+        {
+            return EnvironmentVariableSnapshot::FromEnvironmentBlock(MakeEnvironmentBlock(entries).c_str(), version);
+        }
+
+        void VerifyChange(EnvironmentVariableSnapshot::Change const& change, EnvironmentVariableSnapshot::ChangeKind kind, PCWSTR name, PCWSTR oldValue, PCWSTR newValue)
+        {
+            VERIFY_IS_TRUE(change.kind == kind);
+            VERIFY_ARE_EQUAL(std::wstring{ name }, std::wstring{ change.name });
+            VERIFY_ARE_EQUAL(std::wstring{ oldValue }, std::wstring{ change.oldValue });
+            VERIFY_ARE_EQUAL(std::wstring{ newValue }, std::wstring{ change.newValue });
+        }
+    }
+
+    void EnvironmentVariableSnapshotTests::TestParseEnvironmentBlock()
+    {
+        const auto block{ MakeEnvironmentBlock({ L"Path=C:\\Windows;C:\\Tools", L"=C:=C:\\src", L"Empty=", L"Equation=a=b" }) };
+        VERIFY_ARE_EQUAL(block.size(), EnvironmentVariableSnapshot::EnvironmentBlockLength(block.c_str()));
+
+        const auto variables{ EnvironmentVariableSnapshot::ParseEnvironmentBlock(block.c_str()) };
+        VERIFY_ARE_EQUAL(4u, variables.size());
+        VERIFY_ARE_EQUAL(std::wstring{ L"Path" }, variables[0].name);
+        VERIFY_ARE_EQUAL(std::wstring{ L"C:\\Windows;C:\\Tools" }, variables[0].value);
+
+        // Split at the first '=', like GetEnvironmentVariables always has
+        VERIFY_ARE_EQUAL(std::wstring{}, variables[1].name);
+        VERIFY_ARE_EQUAL(std::wstring{ L"C:=C:\\src" }, variables[1].value);
+        VERIFY_ARE_EQUAL(std::wstring{}, variables[2].value);
+        VERIFY_ARE_EQUAL(std::wstring{ L"a=b" }, variables[3].value);
+
+        const std::wstring emptyBlock(2, L'\0');
+        VERIFY_ARE_EQUAL(1u, EnvironmentVariableSnapshot::EnvironmentBlockLength(emptyBlock.c_str()));
+        VERIFY_ARE_EQUAL(0u, EnvironmentVariableSnapshot::FromEnvironmentBlock(emptyBlock.c_str(), 1).Size());
+    }
+
+    void EnvironmentVariableSnapshotTests::TestFindIgnoresCase()
+    {
+        const auto snapshot{ MakeSnapshot({ L"windir=C:\\Windows", L"Path=C:\\Tools", L"TEMP=C:\\Temp", L"APPDATA=C:\\Roaming" }, 7) };
+        VERIFY_ARE_EQUAL(7u, snapshot.Version());
+        VERIFY_ARE_EQUAL(4u, snapshot.Size());
+
+        // Sorted by name ignoring case
+        auto const& variables{ snapshot.Variables() };
+        VERIFY_ARE_EQUAL(std::wstring{ L"APPDATA" }, variables[0].name);
+        VERIFY_ARE_EQUAL(std::wstring{ L"Path" }, variables[1].name);
+        VERIFY_ARE_EQUAL(std::wstring{ L"TEMP" }, variables[2].name);
+        VERIFY_ARE_EQUAL(std::wstring{ L"windir" }, variables[3].name);
+
+        for (auto name : { L"path", L"PATH", L"Path" })
+        {
+            const auto found{ snapshot.Find(name) };
+            VERIFY_IS_NOT_NULL(found);
+            VERIFY_ARE_EQUAL(std::wstring{ L"C:\\Tools" }, found->value);
+        }
+        VERIFY_ARE_EQUAL(std::wstring{ L"C:\\Windows" }, snapshot.Find(L"WINDIR")->value);
+        VERIFY_IS_NULL(snapshot.Find(L"Pat"));
+        VERIFY_IS_NULL(snapshot.Find(L"Paths"));
+        VERIFY_IS_NULL(snapshot.Find(L"ZZZ"));
+        VERIFY_IS_NULL(snapshot.Find(L""));
+    }
+
+    void EnvironmentVariableSnapshotTests::TestDuplicateNamesLastWins()
+    {
+        const auto snapshot{ MakeSnapshot({ L"=C:=C:\\src", L"Path=first", L"=D:=D:\\", L"PATH=second" }) };
+        VERIFY_ARE_EQUAL(2u, snapshot.Size());
+        VERIFY_ARE_EQUAL(std::wstring{ L"D:=D:\\" }, snapshot.Find(L"")->value);
+        VERIFY_ARE_EQUAL(std::wstring{ L"PATH" }, snapshot.Find(L"path")->name);
+        VERIFY_ARE_EQUAL(std::wstring{ L"second" }, snapshot.Find(L"path")->value);
+    }
+
+    void EnvironmentVariableSnapshotTests::TestChangesSince()
+    {
+        const auto older{ MakeSnapshot({ L"A=1", L"B=2", L"C=3", L"E=5" }, 1) };
+        const auto newer{ MakeSnapshot({ L"B=2", L"C=30", L"D=4", L"E=5", L"F=" }, 2) };
+
+        const auto changes{ newer.ChangesSince(older) };
+        VERIFY_ARE_EQUAL(4u, changes.size());
+        VerifyChange(changes[0], EnvironmentVariableSnapshot::ChangeKind::Removed, L"A", L"1", L"");
+        VerifyChange(changes[1], EnvironmentVariableSnapshot::ChangeKind::Changed, L"C", L"3", L"30");
+        VerifyChange(changes[2], EnvironmentVariableSnapshot::ChangeKind::Added, L"D", L"", L"4");
+        VerifyChange(changes[3], EnvironmentVariableSnapshot::ChangeKind::Added, L"F", L"", L"");
+
+        // Diffing the other way round swaps Added and Removed
+        const auto reversed{ older.ChangesSince(newer) };
+        VERIFY_ARE_EQUAL(4u, reversed.size());
+        VerifyChange(reversed[0], EnvironmentVariableSnapshot::ChangeKind::Added, L"A", L"", L"1");
+        VerifyChange(reversed[1], EnvironmentVariableSnapshot::ChangeKind::Changed, L"C", L"30", L"3");
+        VerifyChange(reversed[2], EnvironmentVariableSnapshot::ChangeKind::Removed, L"D", L"4", L"");
+        VerifyChange(reversed[3], EnvironmentVariableSnapshot::ChangeKind::Removed, L"F", L"", L"");
+
+        VERIFY_ARE_EQUAL(0u, newer.ChangesSince(newer).size());
+        VERIFY_IS_FALSE(newer.HasSameVariables(older));
+        VERIFY_IS_TRUE(newer.HasSameVariables(MakeSnapshot({ L"F=", L"E=5", L"D=4", L"C=30", L"B=2" }, 3)));
+
+        const EnvironmentVariableSnapshot empty;
+        VERIFY_ARE_EQUAL(older.Size(), older.ChangesSince(empty).size());
+        VERIFY_ARE_EQUAL(older.Size(), empty.ChangesSince(older).size());
+    }
+
+    void EnvironmentVariableSnapshotTests::TestChangesSinceIgnoresCaseOfNames()
+    {
+        const auto older{ MakeSnapshot({ L"Path=C:\\Tools", L"temp=C:\\Temp" }) };
+        const auto newer{ MakeSnapshot({ L"PATH=C:\\Tools", L"TEMP=D:\\Temp" }) };
+
+        // Values are compared exactly, names ignoring case
+        const auto changes{ newer.ChangesSince(older) };
+        VERIFY_ARE_EQUAL(1u, changes.size());
+        VerifyChange(changes[0], EnvironmentVariableSnapshot::ChangeKind::Changed, L"TEMP", L"C:\\Temp", L"D:\\Temp");
+
+        const auto caseOnly{ MakeSnapshot({ L"PATH=c:\\tools", L"TEMP=D:\\Temp" }) };
+        VERIFY_ARE_EQUAL(1u, caseOnly.ChangesSince(newer).size());
+    }
+
+    void EnvironmentVariableSnapshotTests::TestChangesSinceMatchesBruteForce()
+    {
+        // Random pairs of blocks drawn from a small set of names, in random case, so duplicates, case
+        // differences and every kind of change are common. The merge has to agree with comparing every
+        // name of one snapshot against the other.
+        std::mt19937 random{ 20231019 };
+        const PCWSTR c_names[]{ L"Path", L"PathExt", L"Temp", L"Tmp", L"windir", L"A", L"AB", L"B", L"_", L"Z9" };
+        const PCWSTR c_values[]{ L"", L"1", L"2", L"C:\\x", L"c:\\X" };
+
+        auto randomEntries = [&]()
+        {
+            std::vector<std::wstring> entries;
+            const auto count{ random() % 12 };
+            for (size_t index = 0; index < count; ++index)
+            {
+                std::wstring name{ c_names[random() % ARRAYSIZE(c_names)] };
+                for (auto& c : name)
+                {
+                    if (random() % 2)
+                    {
+                        c = static_cast<wchar_t>(towupper(c));
+                    }
+                }
+                entries.push_back(name + L"=" + c_values[random() % ARRAYSIZE(c_values)]);
+            }
+            return entries;
+        };
+        auto toSnapshot = [](std::vector<std::wstring> const& entries)
+        {
+            std::wstring block;
+            for (auto const& entry : entries)
+            {
+                block += entry;
+                block += L'\0';
+            }
+            block += L'\0';
+            return EnvironmentVariableSnapshot::FromEnvironmentBlock(block.c_str(), 1);
+        };
+
+        for (int iteration = 0; iteration < 5000; ++iteration)
+        {
+            const auto older{ toSnapshot(randomEntries()) };
+            const auto newer{ toSnapshot(randomEntries()) };
+
+            size_t expectedChanges{};
+            for (auto const& variable : newer.Variables())
+            {
+                const auto before{ older.Find(variable.name) };
+                if (!before || (before->value != variable.value))
+                {
+                    ++expectedChanges;
+                }
+            }
+            for (auto const& variable : older.Variables())
+            {
+                if (!newer.Find(variable.name))
+                {
+                    ++expectedChanges;
+                }
+            }
+
+            const auto changes{ newer.ChangesSince(older) };
+            VERIFY_ARE_EQUAL(expectedChanges, changes.size());
+            for (size_t index = 0; index < changes.size(); ++index)
+            {
+                auto const& change{ changes[index] };
+                if (index > 0)
+                {
+                    VERIFY_IS_LESS_THAN(EnvironmentVariableSnapshot::CompareNames(changes[index - 1].name, change.name), 0);
+                }
+
+                const auto before{ older.Find(change.name) };
+                const auto after{ newer.Find(change.name) };
+                switch (change.kind)
+                {
+                case EnvironmentVariableSnapshot::ChangeKind::Added:
+                    VERIFY_IS_NULL(before);
+                    VERIFY_IS_NOT_NULL(after);
+                    VERIFY_ARE_EQUAL(after->value, std::wstring{ change.newValue });
+                    break;
+                case EnvironmentVariableSnapshot::ChangeKind::Removed:
+                    VERIFY_IS_NOT_NULL(before);
+                    VERIFY_IS_NULL(after);
+                    VERIFY_ARE_EQUAL(before->value, std::wstring{ change.oldValue });
+                    break;
+                case EnvironmentVariableSnapshot::ChangeKind::Changed:
+                    VERIFY_IS_NOT_NULL(before);
+                    VERIFY_IS_NOT_NULL(after);
+                    VERIFY_ARE_EQUAL(before->value, std::wstring{ change.oldValue });
+                    VERIFY_ARE_EQUAL(after->value, std::wstring{ change.newValue });
+                    VERIFY_ARE_NOT_EQUAL(before->value, after->value);
+                    break;
+                }
+            }
+
+            if (newer.HasSameVariables(older))
+            {
+                VERIFY_IS_TRUE(changes.empty());
+            }
+            if (changes.empty())
+            {
+                VERIFY_ARE_EQUAL(older.Size(), newer.Size());
+            }
+        }
+    }
+}
@@ -0,0 +1,21 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#pragma once
+
+namespace WindowsAppSDKEnvironmentManagerTests
+{
+    // Parsing, lookup and diffing of snapshots built from in-memory environment blocks.
+    class EnvironmentVariableSnapshotTests {
+        BEGIN_TEST_CLASS(EnvironmentVariableSnapshotTests)
+            TEST_CLASS_PROPERTY(L"ThreadingModel", L"MTA")
+        END_TEST_CLASS()
+
+        TEST_METHOD(TestParseEnvironmentBlock);
+        TEST_METHOD(TestFindIgnoresCase);
+        TEST_METHOD(TestDuplicateNamesLastWins);
+        TEST_METHOD(TestChangesSince);
+        TEST_METHOD(TestChangesSinceIgnoresCaseOfNames);
+        TEST_METHOD(TestChangesSinceMatchesBruteForce);
+    };
+}
@@ -0,0 +1,80 @@
+﻿// Copyright (c) Microsoft Corporation and Contributors.
+// Licensed under the MIT License.
+
+#ifndef __WINDOWSAPPRUNTIME_TEST_BENCHMARK_H
+#define __WINDOWSAPPRUNTIME_TEST_BENCHMARK_H
+
+#include <algorithm>
+
+#include <WexTestClass.h>
+
+// Benchmarks are sized with TAEF runtime parameters, for example
+//
+//   te Foo.dll /name:*Benchmark* /p:Iterations=100000
+namespace Test::Benchmark
+{
+    // Returns the runtime parameter as an unsigned integer, or defaultValue if it isn't set,
+    // clamped to [minValue, maxValue].
+    inline UINT32 GetUIntParameter(PCWSTR name, UINT32 defaultValue, UINT32 minValue = 1, UINT32 maxValue = MAXUINT32)
+    {
+        WEX::Common::String value;
+        UINT32 result{ defaultValue };
+        if (SUCCEEDED(WEX::TestExecution::RuntimeParameters::TryGetValue(name, value)) && !value.IsEmpty())
+        {
+            result = static_cast<UINT32>(wcstoul(static_cast<PCWSTR>(value), nullptr, 10));
+        }
+        return (std::max)(minValue, (std::min)(result, maxValue));
+    }
+
+    // Time since construction or the last Restart(), from QueryPerformanceCounter.
+    class Stopwatch
+    {
+    public:
+        Stopwatch()
+        {
+            Restart();
+        }
+
+        void Restart()
+        {
+            QueryPerformanceCounter(&m_start);
+        }
+
+        double ElapsedSeconds() const
+        {
+            LARGE_INTEGER now{};
+            QueryPerformanceCounter(&now);
+            LARGE_INTEGER frequency{};
+            QueryPerformanceFrequency(&frequency);
+            return static_cast<double>(now.QuadPart - m_start.QuadPart) / static_cast<double>(frequency.QuadPart);
+        }
+
+        double ElapsedMilliseconds() const
+        {
+            return ElapsedSeconds() * 1000.0;
+        }
+
+    private:
+        LARGE_INTEGER m_start{};
+    };
+
+    // Returns the seconds taken to call function iterations times.
+    template <typename TFunction>
+    double TimeIterations(UINT32 iterations, TFunction&& function)
+    {
+        Stopwatch stopwatch;
+        for (UINT32 index = 0; index < iterations; ++index)
+        {
+            function();
+        }
+        return stopwatch.ElapsedSeconds();
+    }
+
+    inline void LogThroughput(PCWSTR name, UINT32 iterations, double seconds)
+    {
+        WEX::Logging::Log::Comment(WEX::Common::String().Format(L"%s: %u calls in %.3f ms = %.0f calls/sec, %.2f us/call",
+            name, iterations, seconds * 1000.0, iterations / seconds, (seconds * 1e6) / iterations));
+    }
+}
+
+#endif // __WINDOWSAPPRUNTIME_TEST_BENCHMARK_H